@@ -0,0 +1,231 @@
+// Copyright (C) 2023 Speedb Ltd. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rocksdb/background_job_scheduler.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ROCKSDB_NAMESPACE {
+
+struct BackgroundJobScheduler::Job {
+  Env* env;
+  void (*function)(void* arg);
+  void* arg;
+  uint64_t tag;
+  void* env_tag;
+  void (*unsched_function)(void* arg);
+  uint64_t seqno;
+  // Set when dispatched, keeps the scheduler alive until the job completes
+  std::shared_ptr<BackgroundJobScheduler> scheduler;
+};
+
+BackgroundJobScheduler::BackgroundJobScheduler(int max_running_jobs,
+                                               int fairness_interval)
+    : fairness_interval_(std::max(fairness_interval, 0)),
+      max_running_jobs_(std::max(max_running_jobs, 1)) {}
+
+BackgroundJobScheduler::~BackgroundJobScheduler() {
+  // The dbs drop their queued jobs when closed
+  assert(num_queued_ == 0U);
+  assert(num_running_ == 0U);
+}
+
+void BackgroundJobScheduler::SetMaxRunningJobs(int max_running_jobs) {
+  std::vector<Job*> jobs;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_running_jobs_ = std::max(max_running_jobs, 1);
+    PickJobsToDispatch(&jobs);
+  }
+  Dispatch(jobs);
+}
+
+int BackgroundJobScheduler::GetMaxRunningJobs() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return max_running_jobs_;
+}
+
+uint64_t BackgroundJobScheduler::GetNumRunningJobs() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_running_;
+}
+
+uint64_t BackgroundJobScheduler::GetNumQueuedJobs() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_queued_;
+}
+
+uint64_t BackgroundJobScheduler::NewTag() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return next_tag_++;
+}
+
+void BackgroundJobScheduler::Schedule(Env* env, void (*function)(void* arg),
+                                      void* arg, uint64_t tag, void* env_tag,
+                                      void (*unschedFunction)(void* arg),
+                                      double urgency) {
+  assert(env != nullptr);
+  assert(function != nullptr);
+
+  std::vector<Job*> jobs;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto* job = new Job{env, function, arg, tag, env_tag, unschedFunction,
+                        next_job_seqno_++, nullptr /* scheduler */};
+    auto& tag_info = tags_[tag];
+    tag_info.urgency = urgency;
+    tag_info.queued_jobs.push_back(job);
+    ++num_queued_;
+    PickJobsToDispatch(&jobs);
+  }
+  Dispatch(jobs);
+}
+
+void BackgroundJobScheduler::UpdateUrgency(uint64_t tag, double urgency) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto tag_iter = tags_.find(tag);
+  if (tag_iter != tags_.end()) {
+    tag_iter->second.urgency = urgency;
+  }
+}
+
+int BackgroundJobScheduler::UnSchedule(uint64_t tag) {
+  std::deque<Job*> dropped_jobs;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto tag_iter = tags_.find(tag);
+    if (tag_iter == tags_.end()) {
+      return 0;
+    }
+    dropped_jobs.swap(tag_iter->second.queued_jobs);
+    assert(num_queued_ >= dropped_jobs.size());
+    num_queued_ -= dropped_jobs.size();
+    if (tag_iter->second.num_running == 0U) {
+      tags_.erase(tag_iter);
+    }
+  }
+
+  // Run unschedule functions outside the mutex
+  for (auto* job : dropped_jobs) {
+    if (job->unsched_function != nullptr) {
+      job->unsched_function(job->arg);
+    }
+    delete job;
+  }
+  return static_cast<int>(dropped_jobs.size());
+}
+
+void BackgroundJobScheduler::RunJob(void* arg) {
+  std::unique_ptr<Job> job(static_cast<Job*>(arg));
+  job->function(job->arg);
+
+  // The db may be gone once function() returns, but its tag is not reused.
+  // Release the job before the scheduler, which it may be the last owner of.
+  auto scheduler = std::move(job->scheduler);
+  uint64_t tag = job->tag;
+  job.reset();
+  scheduler->OnJobDone(tag);
+}
+
+void BackgroundJobScheduler::UnscheduleJob(void* arg) {
+  std::unique_ptr<Job> job(static_cast<Job*>(arg));
+  if (job->unsched_function != nullptr) {
+    job->unsched_function(job->arg);
+  }
+
+  auto scheduler = std::move(job->scheduler);
+  uint64_t tag = job->tag;
+  job.reset();
+  scheduler->OnJobDone(tag);
+}
+
+void BackgroundJobScheduler::OnJobDone(uint64_t tag) {
+  std::vector<Job*> jobs;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto tag_iter = tags_.find(tag);
+    assert(tag_iter != tags_.end());
+    auto& tag_info = tag_iter->second;
+    assert(tag_info.num_running > 0U);
+    --tag_info.num_running;
+    assert(num_running_ > 0U);
+    --num_running_;
+    if (tag_info.num_running == 0U && tag_info.queued_jobs.empty()) {
+      tags_.erase(tag_iter);
+    }
+    PickJobsToDispatch(&jobs);
+  }
+  Dispatch(jobs);
+}
+
+bool BackgroundJobScheduler::IsPreferred(const TagInfo& lhs,
+                                         const TagInfo& rhs,
+                                         bool fairness_turn) const {
+  if (!fairness_turn) {
+    const bool lhs_urgent = lhs.urgency >= 1.0;
+    const bool rhs_urgent = rhs.urgency >= 1.0;
+    if (lhs_urgent != rhs_urgent) {
+      return lhs_urgent;
+    }
+    if (lhs_urgent && lhs.urgency != rhs.urgency) {
+      return lhs.urgency > rhs.urgency;
+    }
+    if (!lhs_urgent && lhs.num_running != rhs.num_running) {
+      return lhs.num_running < rhs.num_running;
+    }
+  }
+  if (lhs.last_dispatch != rhs.last_dispatch) {
+    return lhs.last_dispatch < rhs.last_dispatch;
+  }
+  return lhs.queued_jobs.front()->seqno < rhs.queued_jobs.front()->seqno;
+}
+
+void BackgroundJobScheduler::PickJobsToDispatch(std::vector<Job*>* jobs) {
+  while (num_queued_ > 0U &&
+         num_running_ < static_cast<uint64_t>(max_running_jobs_)) {
+    const bool fairness_turn =
+        fairness_interval_ > 0 &&
+        (num_dispatched_ + 1) % static_cast<uint64_t>(fairness_interval_) == 0;
+
+    TagInfo* best = nullptr;
+    for (auto& tag_entry : tags_) {
+      auto& tag_info = tag_entry.second;
+      if (!tag_info.queued_jobs.empty() &&
+          (best == nullptr || IsPreferred(tag_info, *best, fairness_turn))) {
+        best = &tag_info;
+      }
+    }
+    assert(best != nullptr);
+
+    auto* job = best->queued_jobs.front();
+    best->queued_jobs.pop_front();
+    --num_queued_;
+    ++best->num_running;
+    ++num_running_;
+    best->last_dispatch = ++num_dispatched_;
+    jobs->push_back(job);
+  }
+}
+
+void BackgroundJobScheduler::Dispatch(const std::vector<Job*>& jobs) {
+  for (auto* job : jobs) {
+    job->scheduler = shared_from_this();
+    job->env->Schedule(&BackgroundJobScheduler::RunJob, job,
+                       Env::Priority::LOW, job->env_tag,
+                       &BackgroundJobScheduler::UnscheduleJob);
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
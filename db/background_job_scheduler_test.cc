@@ -0,0 +1,256 @@
+// Copyright (C) 2023 Speedb Ltd. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rocksdb/background_job_scheduler.h"
+
+#include <deque>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "rocksdb/db.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+// Keeps the jobs scheduled in the LOW pool until the test runs them
+class ManualScheduleEnv : public EnvWrapper {
+ public:
+  explicit ManualScheduleEnv(Env* base) : EnvWrapper(base) {}
+  static const char* kClassName() { return "ManualScheduleEnv"; }
+  const char* Name() const override { return kClassName(); }
+
+  void Schedule(void (*function)(void* arg), void* arg, Priority /*pri*/,
+                void* /*tag*/, void (*/*unschedFunction*/)(void* arg)) override {
+    jobs_.emplace_back(function, arg);
+  }
+
+  size_t NumScheduled() const { return jobs_.size(); }
+
+  void RunNext() {
+    ASSERT_FALSE(jobs_.empty());
+    auto job = jobs_.front();
+    jobs_.pop_front();
+    job.first(job.second);
+  }
+
+ private:
+  std::deque<std::pair<void (*)(void*), void*>> jobs_;
+};
+
+struct TestJob {
+  int id;
+  std::vector<int>* run_order;
+  std::vector<int>* unscheduled;
+};
+
+void RunTestJob(void* arg) {
+  auto* job = static_cast<TestJob*>(arg);
+  job->run_order->push_back(job->id);
+}
+
+void UnscheduleTestJob(void* arg) {
+  auto* job = static_cast<TestJob*>(arg);
+  job->unscheduled->push_back(job->id);
+}
+}  // anonymous namespace
+
+class BackgroundJobSchedulerTest : public testing::Test {
+ public:
+  BackgroundJobSchedulerTest() : env_(Env::Default()) {}
+
+  // Each db is represented by its tag
+  void Schedule(BackgroundJobScheduler* scheduler, int tag, int id,
+                double urgency) {
+    jobs_.push_back(TestJob{id, &run_order_, &unscheduled_});
+    scheduler->Schedule(&env_, &RunTestJob, &jobs_.back(), TagOf(tag),
+                        &env_tags_[tag], &UnscheduleTestJob, urgency);
+  }
+
+  uint64_t TagOf(int tag) { return static_cast<uint64_t>(tag); }
+
+  ManualScheduleEnv env_;
+  // A deque keeps the addresses of the jobs stable
+  std::deque<TestJob> jobs_;
+  int env_tags_[4] = {};
+  std::vector<int> run_order_;
+  std::vector<int> unscheduled_;
+};
+
+TEST_F(BackgroundJobSchedulerTest, LimitsRunningJobs) {
+  auto scheduler = std::make_shared<BackgroundJobScheduler>(
+      2 /* max_running_jobs */, 0 /* fairness_interval */);
+  for (int id = 0; id < 3; ++id) {
+    Schedule(scheduler.get(), 0, id, 0.0);
+  }
+  ASSERT_EQ(2U, env_.NumScheduled());
+  ASSERT_EQ(2U, scheduler->GetNumRunningJobs());
+  ASSERT_EQ(1U, scheduler->GetNumQueuedJobs());
+
+  env_.RunNext();
+  ASSERT_EQ(2U, env_.NumScheduled());
+  ASSERT_EQ(2U, scheduler->GetNumRunningJobs());
+  ASSERT_EQ(0U, scheduler->GetNumQueuedJobs());
+
+  env_.RunNext();
+  env_.RunNext();
+  ASSERT_EQ(0U, scheduler->GetNumRunningJobs());
+  ASSERT_EQ(run_order_, std::vector<int>({0, 1, 2}));
+
+  // Raising the limit dispatches the waiting jobs
+  scheduler->SetMaxRunningJobs(1);
+  Schedule(scheduler.get(), 0, 3, 0.0);
+  Schedule(scheduler.get(), 0, 4, 0.0);
+  ASSERT_EQ(1U, env_.NumScheduled());
+  scheduler->SetMaxRunningJobs(2);
+  ASSERT_EQ(2U, env_.NumScheduled());
+  env_.RunNext();
+  env_.RunNext();
+}
+
+TEST_F(BackgroundJobSchedulerTest, MostUrgentFirst) {
+  auto scheduler = std::make_shared<BackgroundJobScheduler>(
+      1 /* max_running_jobs */, 0 /* fairness_interval */);
+  // Occupies the only slot
+  Schedule(scheduler.get(), 0, 0, 0.0);
+  Schedule(scheduler.get(), 1, 1, 0.5);
+  Schedule(scheduler.get(), 2, 2, 2.0);
+  Schedule(scheduler.get(), 3, 3, 1.5);
+  ASSERT_EQ(3U, scheduler->GetNumQueuedJobs());
+
+  // The urgency of a waiting db may change
+  scheduler->UpdateUrgency(TagOf(1), 3.0);
+
+  for (int i = 0; i < 4; ++i) {
+    env_.RunNext();
+  }
+  ASSERT_EQ(run_order_, std::vector<int>({0, 1, 2, 3}));
+}
+
+TEST_F(BackgroundJobSchedulerTest, LeastRecentlyServedFirst) {
+  auto scheduler = std::make_shared<BackgroundJobScheduler>(
+      1 /* max_running_jobs */, 0 /* fairness_interval */);
+  // A busy db queues many jobs before a quiet one queues a single job
+  for (int id = 0; id < 4; ++id) {
+    Schedule(scheduler.get(), 0, id, 0.5);
+  }
+  Schedule(scheduler.get(), 1, 10, 0.5);
+
+  for (int i = 0; i < 5; ++i) {
+    env_.RunNext();
+  }
+  ASSERT_EQ(run_order_, std::vector<int>({0, 10, 1, 2, 3}));
+}
+
+TEST_F(BackgroundJobSchedulerTest, FairnessBoundsWait) {
+  auto scheduler = std::make_shared<BackgroundJobScheduler>(
+      1 /* max_running_jobs */, 3 /* fairness_interval */);
+  // An urgent db would keep the slot to itself
+  for (int id = 0; id < 6; ++id) {
+    Schedule(scheduler.get(), 0, id, 2.0);
+  }
+  Schedule(scheduler.get(), 1, 10, 0.0);
+
+  for (int i = 0; i < 7; ++i) {
+    env_.RunNext();
+  }
+  // Every 3rd slot goes to the least recently served db
+  ASSERT_EQ(run_order_, std::vector<int>({0, 1, 10, 2, 3, 4, 5}));
+}
+
+TEST_F(BackgroundJobSchedulerTest, UnSchedule) {
+  auto scheduler = std::make_shared<BackgroundJobScheduler>(
+      1 /* max_running_jobs */, 0 /* fairness_interval */);
+  Schedule(scheduler.get(), 0, 0, 0.0);
+  Schedule(scheduler.get(), 0, 1, 0.0);
+  Schedule(scheduler.get(), 1, 10, 0.0);
+  Schedule(scheduler.get(), 0, 2, 0.0);
+
+  // Only the queued jobs are dropped
+  ASSERT_EQ(2, scheduler->UnSchedule(TagOf(0)));
+  ASSERT_EQ(unscheduled_, std::vector<int>({1, 2}));
+  ASSERT_EQ(0, scheduler->UnSchedule(TagOf(2)));
+
+  env_.RunNext();
+  env_.RunNext();
+  ASSERT_EQ(run_order_, std::vector<int>({0, 10}));
+  ASSERT_EQ(0U, scheduler->GetNumRunningJobs());
+  ASSERT_EQ(0U, scheduler->GetNumQueuedJobs());
+}
+
+TEST_F(BackgroundJobSchedulerTest, NewTag) {
+  auto scheduler = std::make_shared<BackgroundJobScheduler>(1);
+  std::set<uint64_t> tags;
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(tags.insert(scheduler->NewTag()).second);
+  }
+}
+
+TEST_F(BackgroundJobSchedulerTest, SharedByDbs) {
+  auto scheduler = std::make_shared<BackgroundJobScheduler>(1);
+
+  Options options;
+  options.create_if_missing = true;
+  options.level0_file_num_compaction_trigger = 2;
+  options.background_job_scheduler = scheduler;
+
+  std::vector<std::string> dbnames;
+  std::vector<std::unique_ptr<DB>> dbs;
+  for (int i = 0; i < 3; ++i) {
+    dbnames.push_back(
+        test::PerThreadDBPath("background_job_scheduler_test" +
+                              std::to_string(i)));
+    ASSERT_OK(DestroyDB(dbnames.back(), options));
+    DB* db = nullptr;
+    ASSERT_OK(DB::Open(options, dbnames.back(), &db));
+    dbs.emplace_back(db);
+  }
+
+  for (int file = 0; file < 4; ++file) {
+    for (auto& db : dbs) {
+      for (int key = 0; key < 10; ++key) {
+        ASSERT_OK(db->Put(WriteOptions(), "key" + std::to_string(key),
+                          "val" + std::to_string(file)));
+      }
+      ASSERT_OK(db->Flush(FlushOptions()));
+    }
+  }
+
+  for (auto& db : dbs) {
+    ASSERT_OK(db->WaitForCompact(WaitForCompactOptions()));
+    std::string num_l0_files;
+    ASSERT_TRUE(db->GetProperty("rocksdb.num-files-at-level0", &num_l0_files));
+    ASSERT_LT(std::stoi(num_l0_files), 2);
+    std::string value;
+    ASSERT_OK(db->Get(ReadOptions(), "key0", &value));
+    ASSERT_EQ("val3", value);
+  }
+  ASSERT_EQ(0U, scheduler->GetNumQueuedJobs());
+
+  for (size_t i = 0; i < dbs.size(); ++i) {
+    ASSERT_OK(dbs[i]->Close());
+    dbs[i].reset();
+    ASSERT_OK(DestroyDB(dbnames[i], options));
+  }
+  ASSERT_EQ(0U, scheduler->GetNumRunningJobs());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1514,6 +1514,12 @@ Status ColumnFamilyData::ValidateOptions(
     s = Status::InvalidArgument(
         "max_successive_merges > 0 is incompatible with unordered_write");
   }
+  if (s.ok() && db_options.memtable_wal_value_threshold > 0 &&
+      cf_options.inplace_update_support) {
+    s = Status::InvalidArgument(
+        "inplace_update_support is incompatible with "
+        "memtable_wal_value_threshold");
+  }
   if (s.ok()) {
     s = CheckCFPathsSupported(db_options, cf_options);
   }
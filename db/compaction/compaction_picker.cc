@@ -1126,9 +1126,11 @@ void CompactionPicker::RegisterCompaction(Compaction* c) {
                                           c->GetPenultimateLevel()));
   // CompactionReason::kExternalSstIngestion's start level is just a placeholder
   // number without actual meaning as file ingestion technically does not have
-  // an input level like other compactions
+  // an input level like other compactions. Same for the output range of a
+  // flush to a non-overlapping level (CompactionReason::kFlush)
   if ((c->start_level() == 0 &&
-       c->compaction_reason() != CompactionReason::kExternalSstIngestion) ||
+       c->compaction_reason() != CompactionReason::kExternalSstIngestion &&
+       c->compaction_reason() != CompactionReason::kFlush) ||
       ioptions_.compaction_style == kCompactionStyleUniversal) {
     level0_compactions_in_progress_.insert(c);
   }
@@ -22,6 +22,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include <cstring>
+#include <future>
 
 #include "db/db_test_util.h"
 #include "options/options_helper.h"
@@ -3447,6 +3448,38 @@ TEST_F(DBBasicTest, ConcurrentlyCloseDB) {
   }
 }
 
+TEST_F(DBBasicTest, CloseAsync) {
+  Options options = CurrentOptions();
+  options.max_background_flushes = 4;
+  CreateAndReopenWithCF({"one", "two", "three", "four", "five"}, options);
+
+  // Only the flushes at shutdown persist the data
+  WriteOptions write_options;
+  write_options.disableWAL = true;
+  for (size_t cf = 0; cf < handles_.size(); ++cf) {
+    ASSERT_OK(Put(static_cast<int>(cf), "key", "value" + std::to_string(cf),
+                  write_options));
+  }
+
+  // All the column families are scheduled to be flushed before waiting for
+  // any of them
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"DBImpl::FlushAllColumnFamiliesConcurrently:Scheduled",
+        "DBImpl::BackgroundCallFlush:start"}});
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  std::future<Status> closed = db_->CloseAsync();
+  ASSERT_OK(closed.get());
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ReopenWithColumnFamilies({"default", "one", "two", "three", "four", "five"},
+                           options);
+  for (size_t cf = 0; cf < handles_.size(); ++cf) {
+    ASSERT_EQ("value" + std::to_string(cf), Get(static_cast<int>(cf), "key"));
+  }
+}
+
 class DBBasicTestTrackWal : public DBTestBase,
                             public testing::WithParamInterface<bool> {
  public:
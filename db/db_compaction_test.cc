@@ -23,6 +23,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <future>
 #include <memory>
@@ -10467,6 +10468,109 @@ TEST_F(DBCompactionTest, VerifyRecordCount) {
   ASSERT_TRUE(std::strstr(s.getState(), expect));
 }
 
+TEST_F(DBCompactionTest, NonBlockingCompactRangeQueue) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.max_non_blocking_compact_range_threads = 1;
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_OK(Put(Key(i), "val"));
+    ASSERT_OK(Flush());
+  }
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<int> completion_order;
+  std::vector<Status> completion_statuses;
+
+  class RecordingCb : public CompactRangeCompletedCbIf {
+   public:
+    RecordingCb(int id, std::mutex* mutex, std::condition_variable* cv,
+                std::vector<int>* order, std::vector<Status>* statuses)
+        : id_(id),
+          mutex_(mutex),
+          cv_(cv),
+          order_(order),
+          statuses_(statuses) {}
+
+    void CompletedCb(Status completion_status) override {
+      std::lock_guard<std::mutex> lock(*mutex_);
+      order_->push_back(id_);
+      statuses_->push_back(completion_status);
+      cv_->notify_all();
+    }
+
+   private:
+    int id_;
+    std::mutex* mutex_;
+    std::condition_variable* cv_;
+    std::vector<int>* order_;
+    std::vector<Status>* statuses_;
+  };
+
+  // Hold the single worker thread in the first request until the others
+  // were queued
+  std::promise<void> release_first;
+  std::shared_future<void> release_first_future =
+      release_first.get_future().share();
+  std::atomic<bool> first_started{false};
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::CompactRangeNonBlockingThread:Start", [&](void* /*arg*/) {
+        if (!first_started.exchange(true)) {
+          release_first_future.wait();
+        }
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  std::atomic<bool> canceled{false};
+  auto Submit = [&](int id, int priority, std::atomic<bool>* cancel_flag) {
+    CompactRangeOptions cro;
+    cro.async_completion_cb = std::make_shared<RecordingCb>(
+        id, &mutex, &cv, &completion_order, &completion_statuses);
+    cro.async_priority = priority;
+    cro.canceled = cancel_flag;
+    ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  };
+
+  Submit(1, 0, nullptr);
+  while (!first_started.load()) {
+    env_->SleepForMicroseconds(1000);
+  }
+  Submit(2, 0, nullptr);
+  Submit(3, 10, nullptr);
+  Submit(4, 0, &canceled);
+
+  uint64_t queue_len = 0;
+  ASSERT_TRUE(db_->GetIntProperty(
+      DB::Properties::kNumQueuedNonBlockingCompactRange, &queue_len));
+  ASSERT_EQ(3U, queue_len);
+
+  // Cancel a queued request before it starts
+  canceled.store(true);
+  release_first.set_value();
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(30),
+                            [&] { return completion_order.size() == 4; }));
+  }
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // Higher priority first, FIFO otherwise
+  ASSERT_EQ(completion_order, std::vector<int>({1, 3, 2, 4}));
+  ASSERT_OK(completion_statuses[0]);
+  ASSERT_OK(completion_statuses[1]);
+  ASSERT_OK(completion_statuses[2]);
+  ASSERT_TRUE(completion_statuses[3].IsManualCompactionPaused());
+
+  ASSERT_TRUE(db_->GetIntProperty(
+      DB::Properties::kNumQueuedNonBlockingCompactRange, &queue_len));
+  ASSERT_EQ(0U, queue_len);
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+}
+
 INSTANTIATE_TEST_CASE_P(DBCompactionTestWithMCC, DBCompactionTestWithMCC,
                         testing::Bool());
 
@@ -278,6 +278,170 @@ TEST_F(DBFlushTest, ManualFlushWithMinWriteBufferNumberToMerge) {
   t.join();
 }
 
+TEST_F(DBFlushTest, FlushMergesReadyMemtables) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.max_write_buffer_number = 10;
+  options.min_write_buffer_number_to_merge = 1;
+  DestroyAndReopen(options);
+
+  // More memtables become ready while a flush waits for the flush thread
+  test::SleepingBackgroundTask sleeping_task;
+  env_->SetBackgroundThreads(1, Env::HIGH);
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &sleeping_task,
+                 Env::Priority::HIGH);
+  sleeping_task.WaitUntilSleeping();
+
+  ASSERT_OK(Put("a", "value"));
+  FlushOptions flush_options;
+  flush_options.wait = false;
+  flush_options.allow_write_stall = true;
+  ASSERT_OK(dbfull()->Flush(flush_options));
+  ASSERT_OK(Put("b", "value"));
+  ASSERT_OK(dbfull()->TEST_SwitchMemtable());
+  ASSERT_OK(Put("c", "value"));
+  ASSERT_OK(dbfull()->TEST_SwitchMemtable());
+
+  sleeping_task.WakeUp();
+  sleeping_task.WaitUntilDone();
+  ASSERT_OK(dbfull()->TEST_WaitForBackgroundWork());
+
+  // The flush picks all the memtables ready when it starts, into one L0 file
+  uint64_t num_imm = 0;
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kNumImmutableMemTable, &num_imm));
+  ASSERT_EQ(0U, num_imm);
+  ASSERT_EQ(1, NumTableFilesAtLevel(0));
+  for (const char* key : {"a", "b", "c"}) {
+    ASSERT_EQ("value", Get(key));
+  }
+}
+
+TEST_F(DBFlushTest, FlushToNonOverlappingLevel) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.level_compaction_dynamic_level_bytes = false;
+  options.num_levels = 4;
+  options.flush_to_non_overlapping_level = true;
+  DestroyAndReopen(options);
+
+  // Sequential key ranges go to the last level
+  ASSERT_OK(Put("a", "v1"));
+  ASSERT_OK(Put("c", "v1"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("d", "v1"));
+  ASSERT_OK(Put("f", "v1"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("0,0,0,2", FilesPerLevel());
+
+  // An overlapping range stops at the level above the overlap
+  ASSERT_OK(Put("b", "v2"));
+  ASSERT_OK(Put("e", "v2"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("0,0,1,2", FilesPerLevel());
+  ASSERT_OK(Put("c", "v3"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("0,1,1,2", FilesPerLevel());
+  ASSERT_OK(Put("c", "v4"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("1,1,1,2", FilesPerLevel());
+
+  // L0 overlaps
+  ASSERT_OK(Put("a", "v5"));
+  ASSERT_OK(Put("d", "v5"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("2,1,1,2", FilesPerLevel());
+
+  // Disabled dynamically
+  ASSERT_OK(dbfull()->SetOptions({{"flush_to_non_overlapping_level", "false"}}));
+  ASSERT_OK(Put("x", "v6"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("3,1,1,2", FilesPerLevel());
+
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ("v5", Get("a"));
+    ASSERT_EQ("v2", Get("b"));
+    ASSERT_EQ("v4", Get("c"));
+    ASSERT_EQ("v5", Get("d"));
+    ASSERT_EQ("v2", Get("e"));
+    ASSERT_EQ("v1", Get("f"));
+    ASSERT_EQ("v6", Get("x"));
+    ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  }
+}
+
+TEST_F(DBFlushTest, FlushToNonOverlappingLevelRegistersRange) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.level_compaction_dynamic_level_bytes = false;
+  options.num_levels = 4;
+  options.flush_to_non_overlapping_level = true;
+  DestroyAndReopen(options);
+  auto* cfd =
+      static_cast_with_check<ColumnFamilyHandleImpl>(db_->DefaultColumnFamily())
+          ->cfd();
+
+  // Until the flush is installed, the compaction picker sees its output range
+  // as taken in the last level
+  int checked = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "FlushJob::InstallResults", [&](void* /*arg*/) {
+        ASSERT_TRUE(cfd->RangeOverlapWithCompaction("b", "b", 3));
+        ASSERT_FALSE(cfd->RangeOverlapWithCompaction("d", "d", 3));
+        ASSERT_FALSE(cfd->RangeOverlapWithCompaction("b", "b", 2));
+        ++checked;
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_OK(Put("a", "v1"));
+  ASSERT_OK(Put("c", "v1"));
+  ASSERT_OK(Flush());
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_EQ(1, checked);
+  ASSERT_EQ("0,0,0,1", FilesPerLevel());
+  {
+    InstrumentedMutexLock l(dbfull()->mutex());
+    ASSERT_FALSE(cfd->RangeOverlapWithCompaction("b", "b", 3));
+  }
+
+  // Atomic flushes stay in L0
+  options.atomic_flush = true;
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("a", "v1"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("1", FilesPerLevel());
+}
+
+TEST_F(DBFlushTest, FlushToNonOverlappingLevelSequentialWrites) {
+  // With auto flushes and compactions, sequential keys go straight to the last
+  // level and are never compacted
+  Options options = CurrentOptions();
+  options.level_compaction_dynamic_level_bytes = false;
+  options.num_levels = 4;
+  options.write_buffer_size = 64 << 10;
+  options.level0_file_num_compaction_trigger = 2;
+  options.max_bytes_for_level_base = 64 << 10;
+  options.target_file_size_base = 32 << 10;
+  options.flush_to_non_overlapping_level = true;
+  options.statistics = CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  for (int i = 0; i < 20000; ++i) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(100)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  ASSERT_EQ(0, NumTableFilesAtLevel(1));
+  ASSERT_EQ(0, NumTableFilesAtLevel(2));
+  ASSERT_GT(NumTableFilesAtLevel(3), 1);
+  ASSERT_EQ(0, options.statistics->getTickerCount(COMPACT_WRITE_BYTES));
+  for (int i = 0; i < 20000; i += 997) {
+    ASSERT_EQ(100, Get(Key(i)).size());
+  }
+}
+
 TEST_F(DBFlushTest, ScheduleOnlyOneBgThread) {
   Options options = CurrentOptions();
   Reopen(options);
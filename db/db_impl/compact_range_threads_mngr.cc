@@ -15,43 +15,90 @@
 #include "compact_range_threads_mngr.h"
 
 #include <algorithm>
-
-#include "rocksdb/options.h"
+#include <cassert>
 
 namespace ROCKSDB_NAMESPACE {
 
+CompactRangeThreadsMngr::CompactRangeThreadsMngr(int max_threads)
+    : max_threads_(static_cast<size_t>(std::max(max_threads, 1))) {}
+
 CompactRangeThreadsMngr::~CompactRangeThreadsMngr() { Shutdown(); }
 
 void CompactRangeThreadsMngr::Shutdown() {
-  std::lock_guard<std::mutex> lock(lock_);
+  std::vector<QueuedJob> aborted_jobs;
+  std::vector<port::Thread> threads;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    shutting_down_ = true;
+    while (!queue_.empty()) {
+      aborted_jobs.push_back(queue_.top());
+      queue_.pop();
+    }
+    threads.swap(threads_);
+  }
+  cv_.notify_all();
 
-  CleanupCompletedThreads();
-  // At this point (shutdown), expecting all objs will have their callbacks
-  // called => joined and removed from the list
-  assert(threads_infos_.empty());
+  // Report completion of jobs that never started outside the lock as the
+  // jobs call user callbacks
+  for (auto& queued_job : aborted_jobs) {
+    queued_job.job(true /* aborted */);
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
 }
 
-void CompactRangeThreadsMngr::AddThread(
-    port::Thread&& thread, std::shared_ptr<CompactRangeCompletedCbIf> cb_obj) {
+bool CompactRangeThreadsMngr::Schedule(Job job, int priority) {
+  std::unique_lock<std::mutex> lock(lock_);
+  if (shutting_down_) {
+    return false;
+  }
+
+  queue_.push({priority, next_seqno_++, std::move(job)});
+
+  // Wake an idle worker if there is one, otherwise create a new one unless
+  // the limit was reached (the job will wait for the next free worker)
+  if (num_idle_threads_ >= queue_.size()) {
+    lock.unlock();
+    cv_.notify_one();
+  } else if (threads_.size() < max_threads_) {
+    threads_.emplace_back(&CompactRangeThreadsMngr::WorkerThread, this);
+  }
+  return true;
+}
+
+uint64_t CompactRangeThreadsMngr::GetQueueLen() const {
   std::lock_guard<std::mutex> lock(lock_);
+  return queue_.size();
+}
 
-  // Lazy removal (and destruction) of completed threads
-  CleanupCompletedThreads();
-  threads_infos_.push_back(std::make_pair(std::move(thread), cb_obj));
+uint64_t CompactRangeThreadsMngr::GetNumRunning() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return num_running_;
 }
 
-void CompactRangeThreadsMngr::CleanupCompletedThreads() {
-  auto threads_infos_iter = begin(threads_infos_);
-  while (threads_infos_iter != threads_infos_.end()) {
-    auto& thread = threads_infos_iter->first;
-    auto& cb_obj = threads_infos_iter->second;
-
-    if (cb_obj->WasCbCalled()) {
-      // Thread may safely be joined. Expecting the join() to end
-      // immediately (callback as already called).
-      thread.join();
-      threads_infos_iter = threads_infos_.erase(threads_infos_iter);
+void CompactRangeThreadsMngr::WorkerThread() {
+  std::unique_lock<std::mutex> lock(lock_);
+  while (true) {
+    ++num_idle_threads_;
+    cv_.wait(lock, [this] { return shutting_down_ || !queue_.empty(); });
+    --num_idle_threads_;
+    if (queue_.empty()) {
+      assert(shutting_down_);
+      break;
     }
+
+    Job job = std::move(const_cast<QueuedJob&>(queue_.top()).job);
+    queue_.pop();
+    ++num_running_;
+
+    lock.unlock();
+    job(false /* aborted */);
+    lock.lock();
+
+    assert(num_running_ > 0U);
+    --num_running_;
   }
 }
 
@@ -12,55 +12,81 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
-// This class keeps track of the information about internal threads created to
-// handle non-blocking CompactRange() user requests.
-// A new internal thread is created for every non-blocking request. This class
-// allows the DB to know which threads exist and control their lifetime.
+// This class runs the jobs created to handle non-blocking CompactRange() user
+// requests. Jobs are queued and executed by a bounded set of worker threads
+// that are created lazily (up to max_threads) and reused until Shutdown().
+// Queued jobs are dequeued in descending priority order (FIFO for equal
+// priorities).
 
 #pragma once
 
-#include <list>
-#include <memory>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <mutex>
-#include <thread>
-#include <utility>
+#include <queue>
+#include <vector>
 
 #include "port/port.h"
 #include "rocksdb/rocksdb_namespace.h"
-#include "rocksdb/status.h"
 
 namespace ROCKSDB_NAMESPACE {
 
-// Forward Declaration
-class CompactRangeCompletedCbIf;
-
 class CompactRangeThreadsMngr {
  public:
+  // A job is called exactly once. aborted is true when the job is dropped
+  // (due to a Shutdown()) before it was started, in which case the job is
+  // expected to only report its completion.
+  using Job = std::function<void(bool aborted)>;
+
+  explicit CompactRangeThreadsMngr(int max_threads);
   ~CompactRangeThreadsMngr();
 
+  // Aborts all queued jobs, waits for the running ones to complete and
+  // joins the worker threads. Must not be called while holding a lock that a
+  // running job may need.
   void Shutdown();
 
-  // In addition to adding the thread and callback obj, this method lazily
-  // removes, from its container, threads that may be joined (those whose
-  // callbacks were already called). Alternatively, this could have been done as
-  // a periodic activity in the periodic scheduler, but seems not to be a
-  // worthwhile periodic activity.
-  void AddThread(port::Thread&& thread,
-                 std::shared_ptr<CompactRangeCompletedCbIf> cb_obj);
+  // Queues a job for execution. Returns false (without calling the job) if
+  // Shutdown() was already called.
+  bool Schedule(Job job, int priority);
 
- private:
-  void CleanupCompletedThreads();
+  // Number of jobs that were scheduled but have not started yet
+  uint64_t GetQueueLen() const;
+
+  // Number of jobs currently being executed
+  uint64_t GetNumRunning() const;
 
  private:
-  using ThreadInfo =
-      std::pair<port::Thread, std::shared_ptr<CompactRangeCompletedCbIf>>;
+  struct QueuedJob {
+    int priority;
+    uint64_t seqno;
+    Job job;
+  };
+
+  struct QueuedJobCmp {
+    bool operator()(const QueuedJob& lhs, const QueuedJob& rhs) const {
+      if (lhs.priority != rhs.priority) {
+        return lhs.priority < rhs.priority;
+      }
+      return lhs.seqno > rhs.seqno;
+    }
+  };
+
+  void WorkerThread();
 
  private:
+  const size_t max_threads_;
+
   mutable std::mutex lock_;
+  std::condition_variable cv_;
 
-  // A list should be fine as there is no random access required
-  // and a very small number of threads is expected
-  std::list<ThreadInfo> threads_infos_;
+  std::priority_queue<QueuedJob, std::vector<QueuedJob>, QueuedJobCmp> queue_;
+  uint64_t next_seqno_ = 0U;
+  std::vector<port::Thread> threads_;
+  size_t num_idle_threads_ = 0U;
+  uint64_t num_running_ = 0U;
+  bool shutting_down_ = false;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -87,6 +87,7 @@
 #include "options/options_helper.h"
 #include "options/options_parser.h"
 #include "port/port.h"
+#include "rocksdb/background_job_scheduler.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/compaction_filter.h"
 #include "rocksdb/convenience.h"
@@ -224,6 +225,11 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       logfile_number_(0),
       log_dir_synced_(false),
       log_empty_(true),
+      // Read-only instances must not release the records of the primary
+      shared_wal_(read_only ? nullptr
+                            : static_cast_with_check<SharedWalImpl>(
+                                  immutable_db_options_.shared_wal.get())),
+      shared_wal_last_record_(0),
       persist_stats_cf_handle_(nullptr),
       log_sync_cv_(&log_write_mutex_),
       total_log_size_(0),
@@ -238,6 +244,10 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       unscheduled_compactions_(0),
       bg_bottom_compaction_scheduled_(0),
       bg_compaction_scheduled_(0),
+      job_scheduler_tag_(
+          immutable_db_options_.background_job_scheduler
+              ? immutable_db_options_.background_job_scheduler->NewTag()
+              : 0),
       num_running_compactions_(0),
       bg_flush_scheduled_(0),
       num_running_flushes_(0),
@@ -280,7 +290,9 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       blob_callback_(immutable_db_options_.sst_file_manager.get(), &mutex_,
                      &error_handler_, &event_logger_,
                      immutable_db_options_.listeners, dbname_),
-      lock_wal_count_(0) {
+      lock_wal_count_(0),
+      compact_range_threads_mngr_(
+          immutable_db_options_.max_non_blocking_compact_range_threads) {
   // !batch_per_trx_ implies seq_per_batch_ because it is only unset for
   // WriteUnprepared, which should use seq_per_batch_.
   assert(batch_per_txn_ || seq_per_batch_);
@@ -613,6 +625,14 @@ Status DBImpl::CloseHelper() {
     DisableManualCompaction();
   }
   mutex_.Lock();
+  // Drop the automatic compactions still waiting for a slot in the shared
+  // scheduler rather than waiting for the other dbs to free one. This must
+  // come first, as a slot freed meanwhile would dispatch one of them to the
+  // Env after the Env jobs were unscheduled.
+  if (immutable_db_options_.background_job_scheduler) {
+    immutable_db_options_.background_job_scheduler->UnSchedule(
+        job_scheduler_tag_);
+  }
   // Unschedule all tasks for this DB
   for (uint8_t i = 0; i < static_cast<uint8_t>(TaskType::kCount); i++) {
     env_->UnSchedule(GetTaskTag(i), Env::Priority::BOTTOM);
@@ -650,7 +670,11 @@ Status DBImpl::CloseHelper() {
 
   // Wait for all non-blocking manual compactions that may still be in progress.
   // Do it only after cleaning up all compaction-related activity above.
+  // Queued requests that have not started yet complete with
+  // ShutdownInProgress. Running ones may need the DB mutex to complete.
+  mutex_.Unlock();
   compact_range_threads_mngr_.Shutdown();
+  mutex_.Lock();
 
   if (default_cf_handle_ != nullptr || persist_stats_cf_handle_ != nullptr) {
     // we need to delete handle outside of lock because it does its own locking
@@ -734,6 +758,10 @@ Status DBImpl::CloseHelper() {
   // references to table_cache.
   versions_.reset();
   mutex_.Unlock();
+  if (shared_wal_db_open_) {
+    shared_wal_->CloseDb(db_id_);
+    shared_wal_db_open_ = false;
+  }
   if (db_lock_ != nullptr) {
     // TODO: Check for unlock error
     env_->UnlockFile(db_lock_).PermitUncheckedError();
@@ -1235,7 +1263,20 @@ void DBImpl::FlushInfoLog() {
     return;
   }
   TEST_SYNC_POINT("DBImpl::FlushInfoLog:StartRunning");
-  LogFlush(immutable_db_options_.info_log);
+  Logger* info_log = immutable_db_options_.info_log.get();
+  if (info_log == nullptr) {
+    return;
+  }
+  // Skip the flush when nothing was logged since the last one, as on an idle
+  // db
+  const size_t log_size = info_log->GetLogFileSize();
+  if (log_size != info_log->kDoNotSupportGetLogFileSize &&
+      log_size == info_log_size_at_flush_) {
+    TEST_SYNC_POINT("DBImpl::FlushInfoLog:Skip");
+    return;
+  }
+  LogFlush(info_log);
+  info_log_size_at_flush_ = log_size;
 }
 
 // Periodically checks to see if the new options should be loaded into the
@@ -1696,7 +1737,15 @@ Status DBImpl::SyncWAL() {
   RecordTick(stats_, WAL_FILE_SYNCED);
   Status status;
   IOStatus io_s;
+  if (shared_wal_ != nullptr) {
+    io_s = shared_wal_->Sync(
+        shared_wal_last_record_.load(std::memory_order_acquire));
+    status = io_s;
+  }
   for (log::Writer* log : logs_to_sync) {
+    if (!io_s.ok()) {
+      break;
+    }
     io_s = log->file()->SyncWithoutFlush(immutable_db_options_.use_fsync);
     if (!io_s.ok()) {
       status = io_s;
@@ -4990,6 +5039,10 @@ Status DB::DestroyColumnFamilyHandle(ColumnFamilyHandle* column_family) {
 
 DB::~DB() {}
 
+std::future<Status> DB::CloseAsync() {
+  return std::async(std::launch::async, [this]() { return Close(); });
+}
+
 Status DBImpl::Close() {
   InstrumentedMutexLock closing_lock_guard(&closing_mutex_);
   if (closed_) {
@@ -55,6 +55,7 @@
 #include "db/range_del_aggregator.h"
 #include "db/read_callback.h"
 #include "db/seqno_to_time_mapping.h"
+#include "db/shared_wal_impl.h"
 #include "db/snapshot_checker.h"
 #include "db/snapshot_impl.h"
 #include "db/trim_history_scheduler.h"
@@ -828,6 +829,11 @@ class DBImpl : public DB {
   };
   // Returns maximum background flushes and compactions allowed to be scheduled
   BGJobLimits GetBGJobLimits() const;
+  // Returns how close the column families are to a write slowdown because of
+  // compaction debt (L0 files or pending compaction bytes). 1.0 means at
+  // the slowdown trigger. Used to prioritize the compactions of this db in
+  // the BackgroundJobScheduler.
+  double GetCompactionUrgency() const;
   // Need a static version that can be called during SanitizeOptions().
   static BGJobLimits GetBGJobLimits(int max_background_flushes,
                                     int max_background_compactions,
@@ -1486,6 +1492,11 @@ class DBImpl : public DB {
 
   Status FlushAllColumnFamilies(const FlushOptions& flush_options,
                                 FlushReason flush_reason);
+  // Used by FlushAllColumnFamilies() at shutdown (without atomic flush).
+  // Schedules the flushes of all the column families, and then waits for all
+  // of them. Must be called with mutex_ held.
+  Status FlushAllColumnFamiliesConcurrently(const FlushOptions& flush_options,
+                                            FlushReason flush_reason);
 
   virtual Status FlushForGetLiveFiles();
 
@@ -1936,10 +1947,13 @@ class DBImpl : public DB {
 
   // REQUIRES: log_numbers are sorted in ascending order
   // corrupted_log_found is set to true if we recover from a corrupted log file.
+  // With a shared WAL, the records are taken from shared_wal_records instead
+  // of the log files.
   Status RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
                          SequenceNumber* next_sequence, bool read_only,
                          bool* corrupted_log_found,
-                         RecoveryContext* recovery_ctx);
+                         RecoveryContext* recovery_ctx,
+                         SharedWalImpl::DbRecords* shared_wal_records);
 
   // The following two methods are used to flush a memtable to
   // storage. The first one is used at database RecoveryTime (when the
@@ -2098,10 +2112,13 @@ class DBImpl : public DB {
   // rate_limiter_priority is used to charge `DBOptions::rate_limiter`
   // for automatic WAL flush (`Options::manual_wal_flush` == false)
   // associated with this WriteToWAL
+  // If record_offset is not null, it is set to the file offset the record of
+  // merged_batch is added at.
   IOStatus WriteToWAL(const WriteBatch& merged_batch, log::Writer* log_writer,
                       uint64_t* log_used, uint64_t* log_size,
                       Env::IOPriority rate_limiter_priority,
-                      LogFileNumberSize& log_file_number_size);
+                      LogFileNumberSize& log_file_number_size,
+                      uint64_t* record_offset = nullptr);
 
   IOStatus WriteToWAL(const WriteThread::WriteGroup& write_group,
                       log::Writer* log_writer, uint64_t* log_used,
@@ -2113,6 +2130,15 @@ class DBImpl : public DB {
                                 uint64_t* log_used,
                                 SequenceNumber* last_sequence, size_t seq_inc);
 
+  // With memtable_wal_value_threshold, sets the WalValueLocation of the
+  // writers of write_group, whose merged_batch was written to log_writer at
+  // record_offset. Called by the WAL writer after a successful WAL write.
+  // The locations are left unset, keeping the values in the memtables, if the
+  // WAL file can't be opened for reading.
+  void SetWalValueLocations(const WriteThread::WriteGroup& write_group,
+                            const WriteBatch* merged_batch,
+                            log::Writer* log_writer, uint64_t record_offset);
+
   // Used by WriteImpl to update bg_error_ if paranoid check is enabled.
   // Caller must hold mutex_.
   void WriteStatusCheckOnLocked(const Status& status);
@@ -2305,8 +2331,18 @@ class DBImpl : public DB {
   size_t GetWalPreallocateBlockSize(uint64_t write_buffer_size) const;
   Env::WriteLifeTimeHint CalculateWALWriteHint() { return Env::WLTH_SHORT; }
 
+  // compression_dict is the WAL compression dictionary of the new WAL, if any
   IOStatus CreateWAL(uint64_t log_file_num, uint64_t recycle_log_number,
-                     size_t preallocate_block_size, log::Writer** new_log);
+                     size_t preallocate_block_size, log::Writer** new_log,
+                     const Slice& compression_dict = Slice());
+
+  // With preallocated_wal_ring, fills log_recycle_files_ up to
+  // recycle_log_file_num with the ring files left by the previous run, then
+  // with new zero-filled files of file_size bytes. REQUIRES: mutex_ held
+  IOStatus PreallocateWalRing(size_t file_size);
+  // Zero-fills the WAL file fname (creating it if missing) up to file_size
+  // bytes and syncs it
+  IOStatus FillWalRingFile(const std::string& fname, uint64_t file_size);
 
   // Validate self-consistency of DB options
   static Status ValidateOptions(const DBOptions& db_options);
@@ -2470,6 +2506,15 @@ class DBImpl : public DB {
   // expensive mutex_ lock during WAL write, which update log_empty_.
   bool log_empty_;
 
+  // Not null with DBOptions::shared_wal. The WAL records are then written to
+  // the shared log, tagged with db_id_ and the number of the current WAL file,
+  // and the WAL files of the db stay empty.
+  SharedWalImpl* const shared_wal_;
+  // The position in shared_wal_ of the last record written by this db
+  std::atomic<uint64_t> shared_wal_last_record_;
+  // Whether db_id_ is registered with shared_wal_->OpenDb()
+  bool shared_wal_db_open_ = false;
+
   ColumnFamilyHandleImpl* persist_stats_cf_handle_;
 
   bool persistent_stats_cfd_exists_ = true;
@@ -2592,6 +2637,13 @@ class DBImpl : public DB {
 
   WriteThread write_thread_;
   WriteBatch tmp_batch_;
+  // The current WAL file opened for reading, for the memtables to read the
+  // values that they reference in it (see memtable_wal_value_threshold).
+  // Only used by the WAL writer.
+  std::shared_ptr<WalValueFile> wal_value_file_;
+  // The number of the last WAL file that could not be opened for reading, 0
+  // if none. Only used by the WAL writer.
+  uint64_t wal_value_file_open_failed_ = 0;
   // The write thread when the writers have no memtable write. This will be used
   // in 2PC to batch the prepares separately from the serial commit.
   WriteThread nonmem_write_thread_;
@@ -2671,6 +2723,9 @@ class DBImpl : public DB {
   // count how many background compactions are running or have been scheduled
   int bg_compaction_scheduled_;
 
+  // Identifies this db in immutable_db_options_.background_job_scheduler
+  uint64_t job_scheduler_tag_;
+
   // stores the number of compactions are currently running
   int num_running_compactions_;
 
@@ -2765,6 +2820,10 @@ class DBImpl : public DB {
   // It contains the implementations for each periodic task.
   std::map<PeriodicTaskType, const PeriodicTaskFunc> periodic_task_functions_;
 
+  // The info log size at the last FlushInfoLog(), only accessed by the
+  // periodic task
+  size_t info_log_size_at_flush_ = 0;
+
   // When set, we use a separate queue for writes that don't write to memtable.
   // In 2PC these are the writes at Prepare phase.
   const bool two_write_queues_;
@@ -2832,7 +2891,7 @@ class DBImpl : public DB {
   // See also lock_wal_write_token_
   uint32_t lock_wal_count_;
 
-  // Tracks threads created internally to handle non-blocking
+  // Queues and runs (on a bounded set of internal threads) non-blocking
   // CompactRange() requests.
   CompactRangeThreadsMngr compact_range_threads_mngr_;
 };
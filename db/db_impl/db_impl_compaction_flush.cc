@@ -39,6 +39,7 @@
 #include "monitoring/thread_status_updater.h"
 #include "monitoring/thread_status_util.h"
 #include "port/port.h"
+#include "rocksdb/background_job_scheduler.h"
 #include "test_util/sync_point.h"
 #include "util/cast_util.h"
 #include "util/coding.h"
@@ -176,6 +177,11 @@ IOStatus DBImpl::SyncClosedLogs(JobContext* job_context,
         }
       }
     }
+    if (io_s.ok() && shared_wal_ != nullptr) {
+      // The records of the closed logs are in the shared log
+      io_s = shared_wal_->Sync(
+          shared_wal_last_record_.load(std::memory_order_acquire));
+    }
     if (io_s.ok()) {
       io_s = directories_.GetWalDir()->FsyncWithDirOptions(
           IOOptions(), nullptr,
@@ -1124,6 +1130,7 @@ void DBImpl::CompactRangeNonBlockingThread(const CompactRangeOptions options,
                                            std::string end_str,
                                            const std::string trim_ts) {
   assert(options.async_completion_cb);
+  TEST_SYNC_POINT("DBImpl::CompactRangeNonBlockingThread:Start");
 
   if (shutdown_initiated_) {
     options.async_completion_cb->InternalCompletedCb(
@@ -1131,6 +1138,15 @@ void DBImpl::CompactRangeNonBlockingThread(const CompactRangeOptions options,
     return;
   }
 
+  // The request may have been canceled while it was queued
+  if (manual_compaction_paused_.load(std::memory_order_acquire) > 0 ||
+      (options.canceled &&
+       options.canceled->load(std::memory_order_acquire))) {
+    options.async_completion_cb->InternalCompletedCb(
+        Status::Incomplete(Status::SubCode::kManualCompactionPaused));
+    return;
+  }
+
   Slice begin{begin_str};
   Slice* begin_to_use = begin.empty() ? nullptr : &begin;
   Slice end{end_str};
@@ -1187,11 +1203,20 @@ Status DBImpl::CompactRangeInternal(const CompactRangeOptions& options,
     if (end != nullptr) {
       end_str.assign(end->data(), end->size());
     }
-    port::Thread compact_range_thread(&DBImpl::CompactRangeNonBlockingThread,
-                                      this, options, cfd, begin_str, end_str,
+    auto job = [this, options, cfd, begin_str, end_str,
+                trim_ts](bool aborted) {
+      if (aborted) {
+        options.async_completion_cb->InternalCompletedCb(
+            Status::ShutdownInProgress());
+      } else {
+        CompactRangeNonBlockingThread(options, cfd, begin_str, end_str,
                                       trim_ts);
-    compact_range_threads_mngr_.AddThread(std::move(compact_range_thread),
-                                          options.async_completion_cb);
+      }
+    };
+    if (!compact_range_threads_mngr_.Schedule(std::move(job),
+                                              options.async_priority)) {
+      return HandleImmediateReturn(Status::ShutdownInProgress());
+    }
     return Status::OK();
   } else {
     return CompactRangeInternalBlocking(options, cfd, begin, end, trim_ts);
@@ -2014,6 +2039,8 @@ Status DBImpl::FlushAllColumnFamilies(const FlushOptions& flush_options,
       status = Status::OK();
     }
     mutex_.Lock();
+  } else if (flush_reason == FlushReason::kShutDown && flush_options.wait) {
+    status = FlushAllColumnFamiliesConcurrently(flush_options, flush_reason);
   } else {
     for (auto cfd : versions_->GetRefedColumnFamilySet()) {
       if (cfd->IsDropped()) {
@@ -2034,6 +2061,61 @@ Status DBImpl::FlushAllColumnFamilies(const FlushOptions& flush_options,
   return status;
 }
 
+Status DBImpl::FlushAllColumnFamiliesConcurrently(
+    const FlushOptions& flush_options, FlushReason flush_reason) {
+  mutex_.AssertHeld();
+  assert(!immutable_db_options_.atomic_flush);
+  assert(flush_options.wait);
+
+  // Schedule the flushes of all the column families before waiting for any of
+  // them, so that they run concurrently in the flush thread pool.
+  FlushOptions no_wait_flush_options = flush_options;
+  no_wait_flush_options.wait = false;
+  Status status;
+  autovector<ColumnFamilyData*> cfds;
+  autovector<uint64_t> memtable_ids;
+  for (auto cfd : versions_->GetRefedColumnFamilySet()) {
+    if (cfd->IsDropped()) {
+      continue;
+    }
+    mutex_.Unlock();
+    status = FlushMemTable(cfd, no_wait_flush_options, flush_reason);
+    if (status.IsTryAgain()) {
+      // Writes are stopped, which only a waiting flush is allowed through
+      status = FlushMemTable(cfd, flush_options, flush_reason);
+    }
+    mutex_.Lock();
+    if (status.IsColumnFamilyDropped()) {
+      status = Status::OK();
+    } else if (!status.ok()) {
+      break;
+    } else if (!cfd->IsDropped() && cfd->imm()->NumNotFlushed() > 0) {
+      cfd->Ref();
+      cfds.push_back(cfd);
+      memtable_ids.push_back(cfd->imm()->GetLatestMemTableID());
+    }
+  }
+  TEST_SYNC_POINT("DBImpl::FlushAllColumnFamiliesConcurrently:Scheduled");
+
+  if (!cfds.empty()) {
+    autovector<const uint64_t*> flush_memtable_ids;
+    for (const auto& memtable_id : memtable_ids) {
+      flush_memtable_ids.push_back(&memtable_id);
+    }
+    mutex_.Unlock();
+    Status wait_status = WaitForFlushMemTables(
+        cfds, flush_memtable_ids, false /* resuming_from_bg_err */);
+    mutex_.Lock();
+    for (auto cfd : cfds) {
+      cfd->UnrefAndTryDelete();
+    }
+    if (status.ok() && !wait_status.IsColumnFamilyDropped()) {
+      status = wait_status;
+    }
+  }
+  return status;
+}
+
 Status DBImpl::Flush(const FlushOptions& flush_options,
                      ColumnFamilyHandle* column_family) {
   auto cfh = static_cast_with_check<ColumnFamilyHandleImpl>(column_family);
@@ -2921,6 +3003,16 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
     return;
   }
 
+  // With a shared scheduler the compactions wait there for a slot (instead of
+  // in the Env) and are admitted by urgency among the dbs sharing it
+  auto* job_scheduler = immutable_db_options_.background_job_scheduler.get();
+  double urgency = 0.0;
+  if (job_scheduler != nullptr &&
+      (bg_compaction_scheduled_ > 0 || unscheduled_compactions_ > 0)) {
+    urgency = GetCompactionUrgency();
+    job_scheduler->UpdateUrgency(job_scheduler_tag_, urgency);
+  }
+
   while (bg_compaction_scheduled_ + bg_bottom_compaction_scheduled_ <
              bg_job_limits.max_compactions &&
          unscheduled_compactions_ > 0) {
@@ -2930,9 +3022,39 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
     ca->prepicked_compaction = nullptr;
     bg_compaction_scheduled_++;
     unscheduled_compactions_--;
-    env_->Schedule(&DBImpl::BGWorkCompaction, ca, Env::Priority::LOW, this,
-                   &DBImpl::UnscheduleCompactionCallback);
+    if (job_scheduler != nullptr) {
+      job_scheduler->Schedule(env_, &DBImpl::BGWorkCompaction, ca,
+                              job_scheduler_tag_, this,
+                              &DBImpl::UnscheduleCompactionCallback, urgency);
+    } else {
+      env_->Schedule(&DBImpl::BGWorkCompaction, ca, Env::Priority::LOW, this,
+                     &DBImpl::UnscheduleCompactionCallback);
+    }
+  }
+}
+
+double DBImpl::GetCompactionUrgency() const {
+  mutex_.AssertHeld();
+  double urgency = 0.0;
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (cfd->IsDropped() || !cfd->initialized()) {
+      continue;
+    }
+    const auto* vstorage = cfd->current()->storage_info();
+    const auto* mutable_cf_options = cfd->GetLatestMutableCFOptions();
+    if (mutable_cf_options->level0_slowdown_writes_trigger > 0) {
+      urgency = std::max(
+          urgency, static_cast<double>(vstorage->l0_delay_trigger_count()) /
+                       mutable_cf_options->level0_slowdown_writes_trigger);
+    }
+    if (mutable_cf_options->soft_pending_compaction_bytes_limit > 0) {
+      urgency = std::max(
+          urgency,
+          static_cast<double>(vstorage->estimated_compaction_needed_bytes()) /
+              mutable_cf_options->soft_pending_compaction_bytes_limit);
+    }
   }
+  return urgency;
 }
 
 DBImpl::BGJobLimits DBImpl::GetBGJobLimits() const {
@@ -171,6 +171,10 @@ void DBImpl::FindObsoleteFiles(JobContext* job_context, bool force,
       versions_->pending_manifest_file_number();
   job_context->log_number = MinLogNumberToKeep();
   job_context->prev_log_number = versions_->prev_log_number();
+  if (shared_wal_ != nullptr) {
+    shared_wal_->SetMinLogNumberToKeep(db_id_, job_context->log_number,
+                                       &job_context->shared_wal_delete_files);
+  }
 
   if (doing_the_full_scan) {
     versions_->AddLiveFiles(&job_context->sst_live, &job_context->blob_live);
@@ -675,6 +679,15 @@ void DBImpl::PurgeObsoleteFiles(JobContext& state, bool schedule_only) {
     }
   }
   wal_manager_.PurgeObsoleteWALFiles();
+  if (!state.shared_wal_delete_files.empty()) {
+    assert(shared_wal_ != nullptr);
+    for (const auto& fname : state.shared_wal_delete_files) {
+      ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                     "[JOB %d] Delete shared WAL file %s\n", state.job_id,
+                     fname.c_str());
+    }
+    shared_wal_->DeleteObsoleteFiles(state.shared_wal_delete_files);
+  }
   LogFlush(immutable_db_options_.info_log);
   InstrumentedMutexLock l(&mutex_);
   --pending_purge_obsolete_files_;
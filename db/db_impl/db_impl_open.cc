@@ -41,6 +41,7 @@
 #include "test_util/sync_point.h"
 #include "util/rate_limiter_impl.h"
 #include "util/udt_util.h"
+#include "util/xxhash.h"
 
 namespace ROCKSDB_NAMESPACE {
 Options SanitizeOptions(const std::string& dbname, const Options& src,
@@ -222,8 +223,26 @@ DBOptions SanitizeOptions(const std::string& dbname, const DBOptions& src,
   // Supported wal compression types
   if (!StreamingCompressionTypeSupported(result.wal_compression)) {
     result.wal_compression = kNoCompression;
+    ROCKS_LOG_WARN(
+        result.info_log,
+        "wal_compression is disabled since only zstd and lz4 are supported");
+  }
+  // The dictionary is written in a single WAL record
+  constexpr size_t kMaxWalCompressionDictBytes = 16 << 10;
+  if (result.wal_compression == kNoCompression) {
+    result.wal_compression_dict_bytes = 0;
+  } else if (result.wal_compression_dict_bytes > kMaxWalCompressionDictBytes) {
+    result.wal_compression_dict_bytes = kMaxWalCompressionDictBytes;
+  }
+
+  if (result.preallocated_wal_ring && result.recycle_log_file_num == 0) {
+    result.preallocated_wal_ring = false;
     ROCKS_LOG_WARN(result.info_log,
-                   "wal_compression is disabled since only zstd is supported");
+                   "preallocated_wal_ring is disabled since the WAL files "
+                   "are not recycled");
+  }
+  if (!result.preallocated_wal_ring) {
+    result.use_direct_io_for_wal = false;
   }
 
   if (!result.paranoid_checks) {
@@ -318,6 +337,29 @@ Status DBImpl::ValidateOptions(const DBOptions& db_options) {
         "writes in direct IO require writable_file_max_buffer_size > 0");
   }
 
+  if (db_options.shared_wal != nullptr &&
+      (db_options.two_write_queues || db_options.unordered_write ||
+       db_options.manual_wal_flush || db_options.use_spdb_writes ||
+       db_options.track_and_verify_wals_in_manifest ||
+       db_options.best_efforts_recovery)) {
+    return Status::NotSupported(
+        "shared_wal is incompatible with two_write_queues, unordered_write, "
+        "manual_wal_flush, use_spdb_writes, track_and_verify_wals_in_manifest "
+        "and best_efforts_recovery");
+  }
+
+  if (db_options.memtable_wal_value_threshold > 0 &&
+      (db_options.manual_wal_flush ||
+       db_options.wal_compression != kNoCompression ||
+       db_options.recycle_log_file_num > 0 || db_options.two_write_queues ||
+       db_options.unordered_write || db_options.use_spdb_writes ||
+       db_options.shared_wal != nullptr)) {
+    return Status::NotSupported(
+        "memtable_wal_value_threshold is incompatible with manual_wal_flush, "
+        "wal_compression, recycle_log_file_num, two_write_queues, "
+        "unordered_write, use_spdb_writes and shared_wal");
+  }
+
   return Status::OK();
 }
 
@@ -771,6 +813,30 @@ Status DBImpl::Recover(
       }
     }
 
+    // With a shared WAL, the records of the db are in the shared log, tagged
+    // with the number of the (empty) WAL file that was current. They are
+    // replayed even if the WAL file itself was lost, as it's never synced.
+    SharedWalImpl::DbRecords shared_wal_records;
+    if (shared_wal_ != nullptr) {
+      // A copy of a db (e.g. a checkpoint) has the same identity, and must
+      // not replay and release the records of the original
+      s = shared_wal_->OpenDb(db_id_);
+      if (!s.ok()) {
+        return s;
+      }
+      shared_wal_db_open_ = true;
+      s = shared_wal_->ReadRecords(db_id_, MinLogNumberToKeep(),
+                                   immutable_db_options_.wal_recovery_mode,
+                                   &shared_wal_records);
+      if (!s.ok()) {
+        return s;
+      }
+      for (const auto& log_records : shared_wal_records) {
+        wal_files.emplace(log_records.first,
+                          LogFileName(wal_dir, log_records.first));
+      }
+    }
+
     if (!wal_files.empty()) {
       // Recover in the order in which the wals were generated
       std::vector<uint64_t> wals;
@@ -781,8 +847,9 @@ Status DBImpl::Recover(
       std::sort(wals.begin(), wals.end());
 
       bool corrupted_wal_found = false;
-      s = RecoverLogFiles(wals, &next_sequence, read_only, &corrupted_wal_found,
-                          recovery_ctx);
+      s = RecoverLogFiles(
+          wals, &next_sequence, read_only, &corrupted_wal_found, recovery_ctx,
+          shared_wal_ != nullptr ? &shared_wal_records : nullptr);
       if (corrupted_wal_found && recovered_seq != nullptr) {
         *recovered_seq = next_sequence;
       }
@@ -1082,7 +1149,8 @@ bool DBImpl::InvokeWalFilterIfNeededOnWalRecord(uint64_t wal_number,
 Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
                                SequenceNumber* next_sequence, bool read_only,
                                bool* corrupted_wal_found,
-                               RecoveryContext* recovery_ctx) {
+                               RecoveryContext* recovery_ctx,
+                               SharedWalImpl::DbRecords* shared_wal_records) {
   struct LogReporter : public log::Reader::Reporter {
     Env* env;
     Logger* info_log;
@@ -1098,6 +1166,9 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
     }
   };
 
+  // Bounds the records read ahead with pipelined_wal_recovery
+  constexpr size_t kMaxPrefetchedWalRecordBytes = 4 << 20;
+
   mutex_.AssertHeld();
   Status status;
   std::unordered_map<int, VersionEdit> version_edits;
@@ -1166,7 +1237,7 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
     }
 
     std::unique_ptr<SequentialFileReader> file_reader;
-    {
+    if (shared_wal_records == nullptr) {
       std::unique_ptr<FSSequentialFile> file;
       status = fs_->NewSequentialFile(
           fname, fs_->OptimizeForLogRead(file_options_), &file, nullptr);
@@ -1201,8 +1272,43 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
     // paranoid_checks==false so that corruptions cause entire commits
     // to be skipped instead of propagating bad information (like overly
     // large sequence numbers).
-    log::Reader reader(immutable_db_options_.info_log, std::move(file_reader),
-                       &reporter, true /*checksum*/, wal_number);
+    // With pipelined_wal_recovery the records are read ahead by a
+    // log::RecordPrefetcher, which reports the corruptions from this thread.
+    std::unique_ptr<log::Reader> reader;
+    std::unique_ptr<log::RecordPrefetcher> prefetcher;
+    // With a shared WAL the records were already read from the shared log
+    const std::vector<std::string>* shared_records = nullptr;
+    size_t next_shared_record = 0;
+    if (shared_wal_records != nullptr) {
+      shared_records = &(*shared_wal_records)[wal_number];
+    } else if (immutable_db_options_.pipelined_wal_recovery) {
+      prefetcher.reset(new log::RecordPrefetcher(
+          immutable_db_options_.info_log, std::move(file_reader), &reporter,
+          true /*checksum*/, wal_number,
+          immutable_db_options_.wal_recovery_mode,
+          kMaxPrefetchedWalRecordBytes));
+    } else {
+      reader.reset(new log::Reader(immutable_db_options_.info_log,
+                                   std::move(file_reader), &reporter,
+                                   true /*checksum*/, wal_number));
+    }
+    auto read_record = [&](Slice* record, std::string* scratch,
+                           uint64_t* record_checksum) {
+      if (shared_records != nullptr) {
+        if (next_shared_record == shared_records->size()) {
+          return false;
+        }
+        *record = (*shared_records)[next_shared_record++];
+        *record_checksum = XXH3_64bits(record->data(), record->size());
+        return true;
+      }
+      if (prefetcher != nullptr) {
+        return prefetcher->ReadRecord(record, record_checksum);
+      }
+      return reader->ReadRecord(record, scratch,
+                                immutable_db_options_.wal_recovery_mode,
+                                record_checksum);
+    };
 
     // Determine if we should tolerate incomplete records at the tail end of the
     // Read all the records and add to a memtable
@@ -1216,10 +1322,7 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
                              /*arg=*/nullptr);
     uint64_t record_checksum;
     while (!stop_replay_by_wal_filter &&
-           reader.ReadRecord(&record, &scratch,
-                             immutable_db_options_.wal_recovery_mode,
-                             &record_checksum) &&
-           status.ok()) {
+           read_record(&record, &scratch, &record_checksum) && status.ok()) {
       if (record.size() < WriteBatchInternal::kHeader) {
         reporter.Corruption(record.size(),
                             Status::Corruption("log record too small"));
@@ -1235,8 +1338,12 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
         return status;
       }
 
+      // The timestamp sizes are not recorded in the shared log, the records
+      // are assumed to match the running column families
       const UnorderedMap<uint32_t, size_t>& record_ts_sz =
-          reader.GetRecordedTimestampSize();
+          shared_records != nullptr ? running_ts_sz
+          : prefetcher != nullptr   ? prefetcher->GetRecordedTimestampSize()
+                                    : reader->GetRecordedTimestampSize();
       status = HandleWriteBatchTimestampSizeDifference(
           &batch, running_ts_sz, record_ts_sz,
           TimestampSizeConsistencyMode::kReconcileInconsistency, &new_batch);
@@ -1454,7 +1561,10 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
         // If flush happened in the middle of recovery (e.g. due to memtable
         // being full), we flush at the end. Otherwise we'll need to record
         // where we were on last flush, which make the logic complicated.
-        if (flushed || !immutable_db_options_.avoid_flush_during_recovery) {
+        // With a shared WAL the records may be gone from the db's own WAL
+        // files, so they can't be kept alive as the WALs of the memtable.
+        if (flushed || !immutable_db_options_.avoid_flush_during_recovery ||
+            shared_wal_records != nullptr) {
           status = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
           if (!status.ok()) {
             // Recovery failed
@@ -1876,9 +1986,150 @@ Status DB::OpenAndTrimHistory(
   return s;
 }
 
+namespace {
+// A file of the preallocated WAL ring written with direct I/O. Its size is
+// kept when the WAL is closed (WritableFileWriter truncates direct I/O files
+// to their data). WritableFileWriter doesn't sync direct I/O files, so every
+// write is synced right away, as if the file was opened with O_DSYNC.
+class DirectWalRingFile : public FSWritableFileOwnerWrapper {
+ public:
+  explicit DirectWalRingFile(std::unique_ptr<FSWritableFile>&& file)
+      : FSWritableFileOwnerWrapper(std::move(file)) {}
+
+  IOStatus PositionedAppend(const Slice& data, uint64_t offset,
+                            const IOOptions& options,
+                            IODebugContext* dbg) override {
+    IOStatus s = target()->PositionedAppend(data, offset, options, dbg);
+    return s.ok() ? target()->Sync(options, dbg) : s;
+  }
+
+  IOStatus PositionedAppend(const Slice& data, uint64_t offset,
+                            const IOOptions& options,
+                            const DataVerificationInfo& verification_info,
+                            IODebugContext* dbg) override {
+    IOStatus s = target()->PositionedAppend(data, offset, options,
+                                            verification_info, dbg);
+    return s.ok() ? target()->Sync(options, dbg) : s;
+  }
+
+  IOStatus Truncate(uint64_t /*size*/, const IOOptions& /*options*/,
+                    IODebugContext* /*dbg*/) override {
+    // Stale data past the end of a recycled WAL is told apart by the log
+    // number of its records
+    return IOStatus::OK();
+  }
+};
+}  // anonymous namespace
+
+IOStatus DBImpl::FillWalRingFile(const std::string& fname,
+                                 uint64_t file_size) {
+  uint64_t size = 0;
+  bool exists = true;
+  IOStatus io_s = fs_->GetFileSize(fname, IOOptions(), &size, nullptr);
+  if (io_s.IsNotFound()) {
+    exists = false;
+    io_s = IOStatus::OK();
+  }
+  if (io_s.ok() && size < file_size) {
+    // Write actual zeros, the blocks only reserved by fallocate() would need
+    // a metadata update when first written
+    FileOptions fill_options(file_options_);
+    fill_options.use_direct_writes = false;
+    fill_options.use_mmap_writes = false;
+    std::unique_ptr<FSWritableFile> file;
+    if (exists) {
+      io_s = fs_->ReopenWritableFile(fname, fill_options, &file, nullptr);
+    } else {
+      io_s = fs_->NewWritableFile(fname, fill_options, &file, nullptr);
+    }
+    const std::string zeros(
+        static_cast<size_t>(std::min<uint64_t>(file_size - size, 1 << 20)),
+        '\0');
+    while (io_s.ok() && size < file_size) {
+      const size_t len = static_cast<size_t>(
+          std::min<uint64_t>(zeros.size(), file_size - size));
+      io_s = file->Append(Slice(zeros.data(), len), IOOptions(), nullptr);
+      size += len;
+    }
+    if (io_s.ok()) {
+      io_s = file->Fsync(IOOptions(), nullptr);
+    }
+    if (file) {
+      IOStatus close_s = file->Close(IOOptions(), nullptr);
+      if (io_s.ok()) {
+        io_s = close_s;
+      }
+    }
+  }
+  return io_s;
+}
+
+IOStatus DBImpl::PreallocateWalRing(size_t file_size) {
+  mutex_.AssertHeld();
+  assert(immutable_db_options_.preallocated_wal_ring);
+  const std::string wal_dir = immutable_db_options_.GetWalDir();
+
+  // Take back the ring files left by the previous run, i.e. the WALs that
+  // were already obsolete (so not recovered) but kept for recycling. The
+  // WALs recovered by this run are only obsolete once the recovery is
+  // persisted, and are deleted as usual.
+  std::vector<std::string> files;
+  IOStatus io_s = fs_->GetChildren(wal_dir, IOOptions(), &files, nullptr);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  std::vector<uint64_t> stale_wal_numbers;
+  const uint64_t min_log_number = MinLogNumberToKeep();
+  for (const auto& file : files) {
+    uint64_t number = 0;
+    FileType type;
+    if (ParseFileName(file, &number, &type) && type == kWalFile &&
+        number < min_log_number) {
+      stale_wal_numbers.push_back(number);
+    }
+  }
+  std::sort(stale_wal_numbers.begin(), stale_wal_numbers.end());
+  for (uint64_t number : stale_wal_numbers) {
+    if (log_recycle_files_.size() >=
+        immutable_db_options_.recycle_log_file_num) {
+      // The rest are deleted as obsolete
+      break;
+    }
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "adding log %" PRIu64 " of the ring to recycle list\n",
+                   number);
+    log_recycle_files_.push_back(number);
+  }
+
+  // Only create the missing ones
+  bool added = false;
+  while (io_s.ok() && log_recycle_files_.size() <
+                          immutable_db_options_.recycle_log_file_num) {
+    // Numbered below the first WAL, so that they are never mistaken for newer
+    // WALs
+    const uint64_t number = versions_->NewFileNumber();
+    TEST_SYNC_POINT("DBImpl::PreallocateWalRing:NewFile");
+    io_s = FillWalRingFile(LogFileName(wal_dir, number), file_size);
+    if (io_s.ok()) {
+      ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                     "adding preallocated log %" PRIu64 " to recycle list\n",
+                     number);
+      log_recycle_files_.push_back(number);
+      added = true;
+    }
+  }
+  if (io_s.ok() && added) {
+    io_s = directories_.GetWalDir()->FsyncWithDirOptions(
+        IOOptions(), nullptr,
+        DirFsyncOptions(DirFsyncOptions::FsyncReason::kNewFileSynced));
+  }
+  return io_s;
+}
+
 IOStatus DBImpl::CreateWAL(uint64_t log_file_num, uint64_t recycle_log_number,
                            size_t preallocate_block_size,
-                           log::Writer** new_log) {
+                           log::Writer** new_log,
+                           const Slice& compression_dict) {
   IOStatus io_s;
   std::unique_ptr<FSWritableFile> lfile;
 
@@ -1889,22 +2140,38 @@ IOStatus DBImpl::CreateWAL(uint64_t log_file_num, uint64_t recycle_log_number,
   std::string wal_dir = immutable_db_options_.GetWalDir();
   std::string log_fname = LogFileName(wal_dir, log_file_num);
 
+  const bool reuse_ring_file =
+      recycle_log_number != 0 && immutable_db_options_.preallocated_wal_ring;
   if (recycle_log_number) {
     ROCKS_LOG_INFO(immutable_db_options_.info_log,
                    "reusing log %" PRIu64 " from recycle list\n",
                    recycle_log_number);
     std::string old_log_fname = LogFileName(wal_dir, recycle_log_number);
+    if (reuse_ring_file) {
+      // A recycled WAL may be shorter, e.g. one created while the ring was
+      // exhausted
+      io_s = FillWalRingFile(old_log_fname, preallocate_block_size);
+      opt_file_options.use_direct_writes =
+          immutable_db_options_.use_direct_io_for_wal;
+    }
     TEST_SYNC_POINT("DBImpl::CreateWAL:BeforeReuseWritableFile1");
     TEST_SYNC_POINT("DBImpl::CreateWAL:BeforeReuseWritableFile2");
-    io_s = fs_->ReuseWritableFile(log_fname, old_log_fname, opt_file_options,
-                                  &lfile, /*dbg=*/nullptr);
+    if (io_s.ok()) {
+      io_s = fs_->ReuseWritableFile(log_fname, old_log_fname, opt_file_options,
+                                    &lfile, /*dbg=*/nullptr);
+    }
   } else {
     io_s = NewWritableFile(fs_.get(), log_fname, &lfile, opt_file_options);
   }
 
   if (io_s.ok()) {
     lfile->SetWriteLifeTimeHint(CalculateWALWriteHint());
-    lfile->SetPreallocationBlockSize(preallocate_block_size);
+    if (!reuse_ring_file) {
+      lfile->SetPreallocationBlockSize(preallocate_block_size);
+    } else if (lfile->use_direct_io()) {
+      // Not preallocating, the file is never truncated
+      lfile.reset(new DirectWalRingFile(std::move(lfile)));
+    }
 
     const auto& listeners = immutable_db_options_.listeners;
     FileTypeSet tmp_set = immutable_db_options_.checksum_handoff_file_types;
@@ -1913,11 +2180,13 @@ IOStatus DBImpl::CreateWAL(uint64_t log_file_num, uint64_t recycle_log_number,
         immutable_db_options_.clock, io_tracer_, nullptr /* stats */, listeners,
         nullptr, tmp_set.Contains(FileType::kWalFile),
         tmp_set.Contains(FileType::kWalFile)));
-    *new_log = new log::Writer(std::move(file_writer), log_file_num,
-                               immutable_db_options_.recycle_log_file_num > 0,
-                               immutable_db_options_.manual_wal_flush,
-                               immutable_db_options_.wal_compression);
-    io_s = (*new_log)->AddCompressionTypeRecord();
+    *new_log = new log::Writer(
+        std::move(file_writer), log_file_num,
+        immutable_db_options_.recycle_log_file_num > 0,
+        immutable_db_options_.manual_wal_flush,
+        immutable_db_options_.wal_compression,
+        immutable_db_options_.wal_compression_dict_bytes);
+    io_s = (*new_log)->AddCompressionTypeRecord(compression_dict);
   }
   return io_s;
 }
@@ -1997,13 +2266,24 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
                     false /* error_if_wal_file_exists */,
                     false /* error_if_data_exists_in_wals */, &recovered_seq,
                     &recovery_ctx);
+  const size_t preallocate_block_size =
+      impl->GetWalPreallocateBlockSize(max_write_buffer_size);
+  uint64_t recycle_log_number = 0;
+  if (s.ok() && impl->immutable_db_options_.preallocated_wal_ring) {
+    s = impl->PreallocateWalRing(preallocate_block_size);
+    if (s.ok()) {
+      // The first WAL is taken from the ring as well
+      recycle_log_number = impl->log_recycle_files_.front();
+    }
+  }
   if (s.ok()) {
     uint64_t new_log_number = impl->versions_->NewFileNumber();
     log::Writer* new_log = nullptr;
-    const size_t preallocate_block_size =
-        impl->GetWalPreallocateBlockSize(max_write_buffer_size);
-    s = impl->CreateWAL(new_log_number, 0 /*recycle_log_number*/,
+    s = impl->CreateWAL(new_log_number, recycle_log_number,
                         preallocate_block_size, &new_log);
+    if (recycle_log_number != 0) {
+      impl->log_recycle_files_.pop_front();
+    }
     if (s.ok()) {
       InstrumentedMutexLock wl(&impl->log_write_mutex_);
       impl->logfile_number_ = new_log_number;
@@ -2043,6 +2323,10 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
           if (s.ok()) {
             s = log_writer->file()->Sync(impl->immutable_db_options_.use_fsync);
           }
+          if (s.ok() && impl->shared_wal_ != nullptr) {
+            s = impl->shared_wal_->Sync(impl->shared_wal_last_record_.load(
+                std::memory_order_acquire));
+          }
         }
       }
     }
@@ -25,6 +25,7 @@
 #include "db/db_impl/db_impl.h"
 #include "db/error_handler.h"
 #include "db/event_helpers.h"
+#include "file/filename.h"
 #include "logging/logging.h"
 #include "monitoring/perf_context_imp.h"
 #include "options/options_helper.h"
@@ -1333,7 +1334,8 @@ IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
                             log::Writer* log_writer, uint64_t* log_used,
                             uint64_t* log_size,
                             Env::IOPriority rate_limiter_priority,
-                            LogFileNumberSize& log_file_number_size) {
+                            LogFileNumberSize& log_file_number_size,
+                            uint64_t* record_offset) {
   assert(log_size != nullptr);
 
   Slice log_entry = WriteBatchInternal::Contents(&merged_batch);
@@ -1354,13 +1356,28 @@ IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
   if (UNLIKELY(needs_locking)) {
     log_write_mutex_.Lock();
   }
-  IOStatus io_s = log_writer->MaybeAddUserDefinedTimestampSizeRecord(
-      versions_->GetColumnFamiliesTimestampSizeForRecord(),
-      rate_limiter_priority);
-  if (!io_s.ok()) {
-    return io_s;
+  IOStatus io_s;
+  if (shared_wal_ != nullptr) {
+    // The record is tagged with the current WAL file, which stays empty, so
+    // that recovery and WAL obsolescence work as if it was written there
+    uint64_t record_seqno = 0;
+    io_s = shared_wal_->AddRecord(db_id_, log_writer->get_log_number(),
+                                  log_entry, &record_seqno);
+    if (io_s.ok()) {
+      shared_wal_last_record_.store(record_seqno, std::memory_order_release);
+    }
+  } else {
+    io_s = log_writer->MaybeAddUserDefinedTimestampSizeRecord(
+        versions_->GetColumnFamiliesTimestampSizeForRecord(),
+        rate_limiter_priority);
+    if (!io_s.ok()) {
+      return io_s;
+    }
+    if (record_offset != nullptr) {
+      *record_offset = log_writer->file()->GetFileSize();
+    }
+    io_s = log_writer->AddRecord(log_entry, rate_limiter_priority);
   }
-  io_s = log_writer->AddRecord(log_entry, rate_limiter_priority);
 
   if (UNLIKELY(needs_locking)) {
     log_write_mutex_.Unlock();
@@ -1403,9 +1420,13 @@ IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
   WriteBatchInternal::SetSequence(merged_batch, sequence);
 
   uint64_t log_size;
+  uint64_t record_offset = 0;
   io_s = WriteToWAL(*merged_batch, log_writer, log_used, &log_size,
                     write_group.leader->rate_limiter_priority,
-                    log_file_number_size);
+                    log_file_number_size, &record_offset);
+  if (io_s.ok() && immutable_db_options_.memtable_wal_value_threshold > 0) {
+    SetWalValueLocations(write_group, merged_batch, log_writer, record_offset);
+  }
   if (to_be_cached_state) {
     cached_recoverable_state_ = *to_be_cached_state;
     cached_recoverable_state_empty_ = false;
@@ -1432,10 +1453,16 @@ IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
       log_write_mutex_.Lock();
     }
 
-    for (auto& log : logs_) {
-      io_s = log.writer->file()->Sync(immutable_db_options_.use_fsync);
-      if (!io_s.ok()) {
-        break;
+    if (shared_wal_ != nullptr) {
+      // Group committed with the syncs of the other dbs sharing the log
+      io_s = shared_wal_->Sync(
+          shared_wal_last_record_.load(std::memory_order_acquire));
+    } else {
+      for (auto& log : logs_) {
+        io_s = log.writer->file()->Sync(immutable_db_options_.use_fsync);
+        if (!io_s.ok()) {
+          break;
+        }
       }
     }
 
@@ -1443,7 +1470,8 @@ IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
       log_write_mutex_.Unlock();
     }
 
-    if (io_s.ok() && need_log_dir_sync) {
+    // The WAL files of the db are empty with a shared WAL
+    if (io_s.ok() && need_log_dir_sync && shared_wal_ == nullptr) {
       // We only sync WAL directory the first time WAL syncing is
       // requested, so that in case users never turn on WAL sync,
       // we can avoid the disk I/O in the write code path.
@@ -1470,6 +1498,64 @@ IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
   return io_s;
 }
 
+void DBImpl::SetWalValueLocations(const WriteThread::WriteGroup& write_group,
+                                  const WriteBatch* merged_batch,
+                                  log::Writer* log_writer,
+                                  uint64_t record_offset) {
+  const uint64_t log_number = log_writer->get_log_number();
+  if (log_number == wal_value_file_open_failed_) {
+    return;
+  }
+  if (wal_value_file_ == nullptr ||
+      wal_value_file_->log_number() != log_number) {
+    // The memtables keep the files of the previous WALs they reference
+    wal_value_file_.reset();
+    const std::string fname =
+        LogFileName(immutable_db_options_.GetWalDir(), log_number);
+    IOStatus io_s =
+        WalValueFile::Open(fs_.get(), file_options_, fname, log_number,
+                           immutable_db_options_.clock, &wal_value_file_);
+    TEST_SYNC_POINT_CALLBACK("DBImpl::SetWalValueLocations:Open", &io_s);
+    if (!io_s.ok()) {
+      // Not a write error: the locations are left unset, so the values stay
+      // in the memtables until the next WAL
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "Failed to open WAL %s to read the values referenced by "
+                     "the memtables, keeping the values in the memtables: %s",
+                     fname.c_str(), io_s.ToString().c_str());
+      wal_value_file_.reset();
+      wal_value_file_open_failed_ = log_number;
+      return;
+    }
+  }
+  if (merged_batch == write_group.leader->batch) {
+    write_group.leader->wal_value_location = {wal_value_file_, record_offset,
+                                              0 /* batch_offset */};
+    return;
+  }
+  // The contents of the batches were appended to merged_batch without their
+  // header, see MergeBatch()
+  uint64_t contents_offset = WriteBatchInternal::kHeader;
+  for (auto* writer : write_group) {
+    if (writer->CallbackFailed()) {
+      continue;
+    }
+    const SavePoint& wal_end = writer->batch->GetWalTerminationPoint();
+    if (wal_end.is_cleared()) {
+      writer->wal_value_location = {
+          wal_value_file_, record_offset,
+          contents_offset - WriteBatchInternal::kHeader};
+      contents_offset +=
+          writer->batch->GetDataSize() - WriteBatchInternal::kHeader;
+    } else {
+      // Only the head of the batch is in the WAL, its values stay in the
+      // memtable
+      contents_offset += wal_end.size - WriteBatchInternal::kHeader;
+    }
+  }
+  assert(contents_offset == merged_batch->GetDataSize());
+}
+
 IOStatus DBImpl::ConcurrentWriteToWAL(
     const WriteThread::WriteGroup& write_group, uint64_t* log_used,
     SequenceNumber* last_sequence, size_t seq_inc) {
@@ -2179,12 +2265,17 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
   int num_imm_unflushed = cfd->imm()->NumNotFlushed();
   const auto preallocate_block_size =
       GetWalPreallocateBlockSize(mutable_cf_options.write_buffer_size);
+  // The new WAL is compressed with a dictionary sampled from the current one
+  std::string wal_compression_dict;
+  if (creating_new_log && !logs_.empty()) {
+    logs_.back().writer->GetCompressionDictSample(&wal_compression_dict);
+  }
   mutex_.Unlock();
   if (creating_new_log) {
     // TODO: Write buffer size passed in should be max of all CF's instead
     // of mutable_cf_options.write_buffer_size.
     io_s = CreateWAL(new_log_number, recycle_log_number, preallocate_block_size,
-                     &new_log);
+                     &new_log, wal_compression_dict);
     if (s.ok()) {
       s = io_s;
     }
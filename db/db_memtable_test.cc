@@ -3,8 +3,10 @@
 //  COPYING file in the root directory) and Apache 2.0 License
 //  (found in the LICENSE.Apache file in the root directory).
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "db/db_test_util.h"
 #include "db/memtable.h"
@@ -12,6 +14,8 @@
 #include "port/stack_trace.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/slice_transform.h"
+#include "util/random.h"
+#include "utilities/merge_operators.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -316,6 +320,53 @@ TEST_F(DBMemTableTest, InsertWithHint) {
   ASSERT_EQ("vvv", Get("NotInPrefixDomain"));
 }
 
+TEST_F(DBMemTableTest, ConcurrentInsertWithThreadLocalHints) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.allow_concurrent_memtable_write = true;
+  options.memtable_factory.reset(
+      new SkipListFactory(0 /* lookahead */,
+                          true /* thread_local_insert_hints */));
+  options.env = env_;
+  Reopen(options);
+
+  // Every writer puts ascending keys of its own, and a few keys of the others
+  const int kWriters = 4;
+  const int kNumKeys = 1000;
+  auto key = [](int writer, int i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "w%d_%06d", writer, i);
+    return std::string(buf);
+  };
+  std::vector<port::Thread> writers;
+  for (int w = 0; w < kWriters; ++w) {
+    writers.emplace_back([&, w]() {
+      for (int i = 0; i < kNumKeys; ++i) {
+        ASSERT_OK(Put(key(w, i), "v" + std::to_string(i)));
+        if (i % 100 == 0) {
+          ASSERT_OK(Put(key((w + 1) % kWriters, i), "v" + std::to_string(i)));
+        }
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  iter->SeekToFirst();
+  for (int w = 0; w < kWriters; ++w) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(key(w, i), iter->key().ToString());
+      ASSERT_EQ("v" + std::to_string(i), iter->value().ToString());
+      iter->Next();
+    }
+  }
+  ASSERT_FALSE(iter->Valid());
+  ASSERT_OK(iter->status());
+}
+
 TEST_F(DBMemTableTest, ColumnFamilyId) {
   // Verifies MemTableRepFactory is told the right column family id.
   Options options;
@@ -335,6 +386,264 @@ TEST_F(DBMemTableTest, ColumnFamilyId) {
   }
 }
 
+TEST_F(DBMemTableTest, WalValueRefs) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.memtable_wal_value_threshold = 1000;
+  options.write_buffer_size = 64 << 20;
+  options.arena_block_size = 16 << 10;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  options.enable_blob_files = true;
+  options.min_blob_size = 1000;
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  size_t value_bytes = 0;
+  int next_key = 0;
+  // Batches of small and large values, the large ones crossing the blocks of
+  // the WAL
+  auto write_batches = [&](int num_batches) {
+    for (int i = 0; i < num_batches; ++i) {
+      WriteBatch batch;
+      for (int j = 0; j < 3; ++j) {
+        const std::string key = Key(next_key++);
+        const std::string value = rnd.RandomString(
+            j == 0 ? 10 : 1000 + static_cast<int>(rnd.Uniform(40000)));
+        ASSERT_OK(batch.Put(key, value));
+        expected[key] = value;
+        value_bytes += value.size();
+      }
+      ASSERT_OK(db_->Write(WriteOptions(), &batch));
+    }
+  };
+  auto verify = [&]() {
+    for (const auto& kv : expected) {
+      ASSERT_EQ(kv.second, Get(kv.first));
+    }
+    std::vector<Slice> keys;
+    for (const auto& kv : expected) {
+      keys.emplace_back(kv.first);
+    }
+    std::vector<std::string> values;
+    std::vector<Status> statuses = db_->MultiGet(ReadOptions(), keys, &values);
+    auto it = expected.begin();
+    for (size_t i = 0; i < keys.size(); ++i, ++it) {
+      ASSERT_OK(statuses[i]);
+      ASSERT_EQ(it->second, values[i]);
+    }
+
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    it = expected.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+      ASSERT_TRUE(it != expected.end());
+      ASSERT_EQ(it->first, iter->key().ToString());
+      ASSERT_EQ(it->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(it == expected.end());
+    auto rit = expected.rbegin();
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev(), ++rit) {
+      ASSERT_TRUE(rit != expected.rend());
+      ASSERT_EQ(rit->first, iter->key().ToString());
+      ASSERT_EQ(rit->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(rit == expected.rend());
+  };
+
+  write_batches(100);
+  // The memtable only holds references to the large values
+  uint64_t mem_size = 0;
+  ASSERT_TRUE(
+      db_->GetIntProperty("rocksdb.cur-size-active-mem-table", &mem_size));
+  ASSERT_LT(mem_size, value_bytes / 4);
+
+  const Snapshot* snapshot = db_->GetSnapshot();
+  const std::string old_value = expected[Key(1)];
+  expected[Key(1)] = rnd.RandomString(5000);
+  ASSERT_OK(Put(Key(1), expected[Key(1)]));
+  ASSERT_OK(Merge(Key(2), "tail"));
+  expected[Key(2)] += ",tail";
+  ASSERT_OK(Delete(Key(4)));
+  expected.erase(Key(4));
+  verify();
+  ASSERT_EQ(old_value, Get(Key(1), snapshot));
+  db_->ReleaseSnapshot(snapshot);
+
+  // The values are recovered from the WAL
+  Reopen(options);
+  verify();
+
+  // Flushed to blob files
+  write_batches(20);
+  ASSERT_OK(Flush());
+  ASSERT_FALSE(GetBlobFileNumbers().empty());
+  verify();
+}
+
+TEST_F(DBMemTableTest, WalValueRefsConcurrentWriters) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.memtable_wal_value_threshold = 1000;
+  options.allow_concurrent_memtable_write = true;
+  for (bool pipelined : {false, true}) {
+    options.enable_pipelined_write = pipelined;
+    DestroyAndReopen(options);
+
+    // Merged in write groups
+    const int kWriters = 4;
+    const int kNumKeys = 50;
+    std::vector<std::vector<std::string>> values(kWriters);
+    std::vector<port::Thread> writers;
+    for (int w = 0; w < kWriters; ++w) {
+      writers.emplace_back([&, w]() {
+        Random rnd(301 + w);
+        for (int i = 0; i < kNumKeys; ++i) {
+          values[w].push_back(
+              rnd.RandomString(1000 + static_cast<int>(rnd.Uniform(20000))));
+          ASSERT_OK(Put("w" + std::to_string(w) + Key(i), values[w].back()));
+        }
+      });
+    }
+    for (auto& writer : writers) {
+      writer.join();
+    }
+
+    // Only the head of this batch is in the WAL
+    WriteBatch batch;
+    Random rnd(302);
+    const std::string head_value = rnd.RandomString(5000);
+    const std::string tail_value = rnd.RandomString(5000);
+    ASSERT_OK(batch.Put("head", head_value));
+    batch.MarkWalTerminationPoint();
+    ASSERT_OK(batch.Put("tail", tail_value));
+    ASSERT_OK(db_->Write(WriteOptions(), &batch));
+
+    for (int i = 0; i < 2; ++i) {
+      for (int w = 0; w < kWriters; ++w) {
+        for (int k = 0; k < kNumKeys; ++k) {
+          ASSERT_EQ(values[w][k], Get("w" + std::to_string(w) + Key(k)));
+        }
+      }
+      ASSERT_EQ(head_value, Get("head"));
+      ASSERT_EQ(tail_value, Get("tail"));
+      ASSERT_OK(Flush());
+    }
+  }
+}
+
+TEST_F(DBMemTableTest, WalValueRefsUnsupportedOptions) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.memtable_wal_value_threshold = 1000;
+  options.manual_wal_flush = true;
+  ASSERT_TRUE(TryReopen(options).IsNotSupported());
+
+  options.manual_wal_flush = false;
+  options.allow_concurrent_memtable_write = false;
+  options.inplace_update_support = true;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+}
+
+TEST_F(DBMemTableTest, WalValueRefsAcrossWals) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.memtable_wal_value_threshold = 1000;
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  Random rnd(301);
+  const std::string value0 = rnd.RandomString(5000);
+  const std::string value1 = rnd.RandomString(5000);
+  ASSERT_OK(Put(0, "key0", value0));
+  ASSERT_OK(Put(1, "key", rnd.RandomString(5000)));
+  // Flushing the other column family switches the WAL, so the memtable of the
+  // default one references two WALs
+  ASSERT_OK(Flush(1));
+  ASSERT_OK(Put(0, "key1", value1));
+  VectorLogPtr wal_files;
+  ASSERT_OK(dbfull()->GetSortedWalFiles(wal_files));
+  ASSERT_EQ(2U, wal_files.size());
+  ASSERT_EQ(value0, Get(0, "key0"));
+  ASSERT_EQ(value1, Get(0, "key1"));
+
+  ASSERT_OK(Flush(0));
+  ASSERT_EQ(value0, Get(0, "key0"));
+  ASSERT_EQ(value1, Get(0, "key1"));
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  ASSERT_EQ(value0, Get(0, "key0"));
+  ASSERT_EQ(value1, Get(0, "key1"));
+}
+
+TEST_F(DBMemTableTest, WalValueRefsCountTowardWriteBufferSize) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.memtable_wal_value_threshold = 1000;
+  options.write_buffer_size = 1 << 20;
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  // The memtables only hold references, but are still flushed as the
+  // referenced values reach write_buffer_size, releasing their WALs
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < 40; ++i) {
+    values.push_back(rnd.RandomString(100 << 10));
+    ASSERT_OK(Put(Key(i), values.back()));
+  }
+  ASSERT_OK(dbfull()->TEST_WaitForFlushMemTable());
+  ASSERT_GE(NumTableFilesAtLevel(0), 3);
+  uint64_t mem_size = 0;
+  ASSERT_TRUE(
+      db_->GetIntProperty("rocksdb.cur-size-active-mem-table", &mem_size));
+  ASSERT_LT(mem_size, 100U << 10);
+  for (int i = 0; i < 40; ++i) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+}
+
+TEST_F(DBMemTableTest, WalValueRefsWalOpenFailure) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.memtable_wal_value_threshold = 1000;
+  DestroyAndReopen(options);
+
+  // The writes succeed, keeping their values in the memtable
+  int num_open_failures = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::SetWalValueLocations:Open", [&](void* arg) {
+        ++num_open_failures;
+        *static_cast<IOStatus*>(arg) = IOStatus::IOError("Too many open files");
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  Random rnd(301);
+  std::vector<std::string> values;
+  size_t value_bytes = 0;
+  for (int i = 0; i < 10; ++i) {
+    values.push_back(rnd.RandomString(10000));
+    value_bytes += values.back().size();
+    ASSERT_OK(Put(Key(i), values.back()));
+  }
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  // Not retried for the same WAL
+  ASSERT_EQ(1, num_open_failures);
+  uint64_t mem_size = 0;
+  ASSERT_TRUE(
+      db_->GetIntProperty("rocksdb.cur-size-active-mem-table", &mem_size));
+  ASSERT_GT(mem_size, value_bytes);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+
+  // The next WAL references its values again
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put(Key(10), rnd.RandomString(100000)));
+  ASSERT_TRUE(
+      db_->GetIntProperty("rocksdb.cur-size-active-mem-table", &mem_size));
+  ASSERT_LT(mem_size, 100000U);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
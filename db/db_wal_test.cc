@@ -1208,6 +1208,75 @@ TEST_F(DBWALTest, DISABLED_FullPurgePreservesLogPendingReuse) {
   }
 }
 
+TEST_F(DBWALTest, PreallocatedWalRing) {
+  for (bool use_direct_io : {false, true}) {
+    if (use_direct_io && !IsDirectIOSupported()) {
+      continue;
+    }
+    Options options = CurrentOptions();
+    options.wal_recovery_mode = WALRecoveryMode::kSkipAnyCorruptedRecords;
+    options.recycle_log_file_num = 2;
+    options.preallocated_wal_ring = true;
+    options.use_direct_io_for_wal = use_direct_io;
+    options.write_buffer_size = 64 << 10;
+    DestroyAndReopen(options);
+
+    // The WAL files are preallocated and never truncated
+    auto check_wal_files = [&]() {
+      std::vector<std::string> files;
+      ASSERT_OK(env_->GetChildren(dbname_, &files));
+      size_t num_wal_files = 0;
+      for (const auto& file : files) {
+        uint64_t number = 0;
+        FileType type = kWalFile;
+        if (ParseFileName(file, &number, &type) && type == kWalFile) {
+          uint64_t size = 0;
+          ASSERT_OK(env_->GetFileSize(dbname_ + "/" + file, &size));
+          ASSERT_GE(size, options.write_buffer_size);
+          ++num_wal_files;
+        }
+      }
+      // The current WAL and at least one more of the ring
+      ASSERT_GE(num_wal_files, 2U);
+    };
+    check_wal_files();
+
+    Random rnd(301);
+    std::vector<std::string> values;
+    for (int round = 0; round < 5; ++round) {
+      for (int i = 0; i < 20; ++i) {
+        values.push_back(rnd.RandomString(1000));
+        WriteOptions write_options;
+        write_options.sync = (i % 2) == 0;
+        ASSERT_OK(db_->Put(write_options, Key(static_cast<int>(values.size())),
+                           values.back()));
+      }
+      if (round % 2 == 0) {
+        // Switch to the next WAL of the ring
+        ASSERT_OK(Flush());
+      }
+      check_wal_files();
+    }
+
+    // The ring files left by the previous run are reused rather than created
+    // again
+    std::atomic<int> num_new_files{0};
+    SyncPoint::GetInstance()->SetCallBack(
+        "DBImpl::PreallocateWalRing:NewFile",
+        [&](void* /* arg */) { ++num_new_files; });
+    SyncPoint::GetInstance()->EnableProcessing();
+    Reopen(options);
+    SyncPoint::GetInstance()->DisableProcessing();
+    SyncPoint::GetInstance()->ClearAllCallBacks();
+    ASSERT_LT(num_new_files.load(),
+              static_cast<int>(options.recycle_log_file_num));
+    check_wal_files();
+    for (size_t i = 0; i < values.size(); ++i) {
+      ASSERT_EQ(values[i], Get(Key(static_cast<int>(i + 1))));
+    }
+  }
+}
+
 TEST_F(DBWALTest, GetSortedWalFiles) {
   do {
     CreateAndReopenWithCF({"pikachu"}, CurrentOptions());
@@ -1735,6 +1804,41 @@ TEST_P(DBWALTestWithParams, kAbsoluteConsistency) {
   ASSERT_NOK(TryReopen(options));
 }
 
+// Test scope:
+// Reading the WAL records ahead recovers the same data as reading them inline,
+// with or without corruptions
+TEST_F(DBWALTest, PipelinedWalRecovery) {
+  Options options = CurrentOptions();
+  options.pipelined_wal_recovery = true;
+  const size_t row_count = RecoveryTestHelper::FillData(this, &options);
+  options.create_if_missing = false;
+  ASSERT_OK(TryReopen(options));
+  ASSERT_EQ(row_count, RecoveryTestHelper::GetData(this));
+
+  for (auto recovery_mode : {WALRecoveryMode::kTolerateCorruptedTailRecords,
+                             WALRecoveryMode::kPointInTimeRecovery,
+                             WALRecoveryMode::kSkipAnyCorruptedRecords}) {
+    const bool trunc =
+        recovery_mode == WALRecoveryMode::kTolerateCorruptedTailRecords;
+    size_t recovered_row_count[2];
+    for (bool pipelined : {false, true}) {
+      options = CurrentOptions();
+      options.pipelined_wal_recovery = pipelined;
+      RecoveryTestHelper::FillData(this, &options);
+      RecoveryTestHelper::CorruptWAL(this, options, /*off=*/.5, /*len%=*/.1,
+                                     RecoveryTestHelper::kWALFileOffset + 4,
+                                     trunc);
+      options.wal_recovery_mode = recovery_mode;
+      options.create_if_missing = false;
+      ASSERT_OK(TryReopen(options));
+      recovered_row_count[pipelined] = RecoveryTestHelper::GetData(this);
+    }
+    ASSERT_GT(recovered_row_count[true], 0U);
+    ASSERT_LT(recovered_row_count[true], row_count);
+    ASSERT_EQ(recovered_row_count[false], recovered_row_count[true]);
+  }
+}
+
 // Test scope:
 // We don't expect the data store to be opened if there is any inconsistency
 // between WAL and SST files
@@ -2649,6 +2753,33 @@ TEST_F(DBWALTest, GetCompressedWalsAfterSync) {
   ASSERT_OK(s);
 }
 
+TEST_F(DBWALTest, WalCompressionWithDictionary) {
+  for (CompressionType compression_type : {kZSTD, kLZ4Compression}) {
+    if (!StreamingCompressionTypeSupported(compression_type)) {
+      continue;
+    }
+    Options options = CurrentOptions();
+    options.avoid_flush_during_recovery = true;
+    options.wal_compression = compression_type;
+    options.wal_compression_dict_bytes = 1024;
+    DestroyAndReopen(options);
+
+    // The first WAL samples the dictionary of the next one
+    for (int i = 0; i < 200; i++) {
+      ASSERT_OK(Put(Key(i), "value" + std::to_string(i)));
+    }
+    ASSERT_OK(dbfull()->TEST_SwitchWAL());
+    for (int i = 200; i < 400; i++) {
+      ASSERT_OK(Put(Key(i), "value" + std::to_string(i)));
+    }
+
+    Reopen(options);
+    for (int i = 0; i < 400; i++) {
+      ASSERT_EQ("value" + std::to_string(i), Get(Key(i)));
+    }
+  }
+}
+
 TEST_F(DBWALTest, EmptyWalReopenTest) {
   Options options = CurrentOptions();
   options.env = env_;
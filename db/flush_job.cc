@@ -25,9 +25,11 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <limits>
 #include <vector>
 
 #include "db/builder.h"
+#include "db/compaction/compaction.h"
 #include "db/db_iter.h"
 #include "db/dbformat.h"
 #include "db/event_helpers.h"
@@ -158,7 +160,10 @@ FlushJob::FlushJob(
   TEST_SYNC_POINT("FlushJob::FlushJob()");
 }
 
-FlushJob::~FlushJob() { ThreadStatusUtil::ResetThreadStatus(); }
+FlushJob::~FlushJob() {
+  assert(output_range_compaction_ == nullptr);
+  ThreadStatusUtil::ResetThreadStatus();
+}
 
 void FlushJob::ReportStartedFlush() {
   ThreadStatusUtil::SetEnableTracking(db_options_.enable_thread_tracking);
@@ -344,6 +349,8 @@ Status FlushJob::Run(LogsWithPrepTracker* prep_tracker, FileMetaData* file_meta,
       }
     }
   }
+  // The flush result is installed, or won't be
+  UnregisterOutputRange();
 
   if (s.ok() && file_meta != nullptr) {
     *file_meta = meta_;
@@ -1042,15 +1049,17 @@ Status FlushJob::WriteLevel0Table() {
   // Note that if file_size is zero, the file has been deleted and
   // should not be added to the manifest.
   const bool has_output = meta_.fd.GetFileSize() > 0;
+  int output_level = 0;
 
   if (s.ok() && has_output) {
     TEST_SYNC_POINT("DBImpl::FlushJob:SSTFileCreated");
-    // if we have more than 1 background thread, then we cannot
-    // insert files directly into higher levels because some other
-    // threads could be concurrently producing compacted files for
-    // that key range.
-    // Add file to L0
-    edit_->AddFile(0 /* level */, meta_.fd.GetNumber(), meta_.fd.GetPathId(),
+    output_level = PickOutputLevel();
+    TEST_SYNC_POINT_CALLBACK("FlushJob::WriteLevel0Table:OutputLevel",
+                             &output_level);
+    if (output_level > 0) {
+      RegisterOutputRange(output_level);
+    }
+    edit_->AddFile(output_level, meta_.fd.GetNumber(), meta_.fd.GetPathId(),
                    meta_.fd.GetFileSize(), meta_.smallest, meta_.largest,
                    meta_.fd.smallest_seqno, meta_.fd.largest_seqno,
                    meta_.marked_for_compaction, meta_.temperature,
@@ -1064,7 +1073,8 @@ Status FlushJob::WriteLevel0Table() {
   // Piggyback FlushJobInfo on the first first flushed memtable.
   mems_[0]->SetFlushJobInfo(GetFlushJobInfo());
 
-  // Note that here we treat flush as level 0 compaction in internal stats
+  // Note that here we treat flush as a compaction to its output level (usually
+  // level 0) in internal stats
   InternalStats::CompactionStats stats(CompactionReason::kFlush, 1);
   const uint64_t micros = clock_->NowMicros() - start_micros;
   const uint64_t cpu_micros = clock_->CPUMicros() - start_cpu_micros;
@@ -1090,7 +1100,7 @@ Status FlushJob::WriteLevel0Table() {
   stats.num_output_files_blob = static_cast<int>(blobs.size());
 
   RecordTimeToHistogram(stats_, FLUSH_TIME, stats.micros);
-  cfd_->internal_stats()->AddCompactionStats(0 /* level */, thread_pri_, stats);
+  cfd_->internal_stats()->AddCompactionStats(output_level, thread_pri_, stats);
   cfd_->internal_stats()->AddCFStats(
       InternalStats::BYTES_FLUSHED,
       stats.bytes_written + stats.bytes_written_blob);
@@ -1099,6 +1109,86 @@ Status FlushJob::WriteLevel0Table() {
   return s;
 }
 
+int FlushJob::PickOutputLevel() const {
+  db_mutex_->AssertHeld();
+  // An atomic flush is installed together with the other column families,
+  // after all of them are flushed
+  if (!mutable_cf_options_.flush_to_non_overlapping_level ||
+      cfd_->ioptions()->compaction_style != kCompactionStyleLevel ||
+      db_options_.atomic_flush || !write_manifest_) {
+    return 0;
+  }
+  // An older memtable whose flush isn't installed yet may hold older versions
+  // of the keys, which must stay below the newer ones
+  uint64_t min_memtable_id = std::numeric_limits<uint64_t>::max();
+  for (const auto* mem : mems_) {
+    min_memtable_id = std::min(min_memtable_id, mem->GetID());
+  }
+  if (cfd_->imm()->GetEarliestMemTableID() < min_memtable_id) {
+    return 0;
+  }
+
+  int max_level = cfd_->NumberLevels() - 1;
+  if (cfd_->ioptions()->allow_ingest_behind ||
+      cfd_->ioptions()->preclude_last_level_data_seconds > 0) {
+    --max_level;
+  }
+  const Slice smallest_user_key = meta_.smallest.user_key();
+  const Slice largest_user_key = meta_.largest.user_key();
+  auto* vstorage = cfd_->current()->storage_info();
+  int output_level = 0;
+  for (int level = 0; level <= max_level; ++level) {
+    if (level > 0 && level < vstorage->base_level()) {
+      continue;
+    }
+    // Like for ingested files, other threads may be producing compacted files
+    // for the key range
+    if (cfd_->RangeOverlapWithCompaction(smallest_user_key, largest_user_key,
+                                         level) ||
+        vstorage->OverlapInLevel(level, &smallest_user_key,
+                                 &largest_user_key)) {
+      break;
+    }
+    output_level = level;
+  }
+  return output_level;
+}
+
+void FlushJob::RegisterOutputRange(int output_level) {
+  db_mutex_->AssertHeld();
+  assert(output_range_compaction_ == nullptr);
+  output_range_meta_ = meta_;
+  CompactionInputFiles input;
+  input.level = 0;
+  input.files.push_back(&output_range_meta_);
+  output_range_compaction_.reset(new Compaction(
+      cfd_->current()->storage_info(), *cfd_->ioptions(), mutable_cf_options_,
+      MutableDBOptions(), {input}, output_level,
+      MaxFileSizeForLevel(mutable_cf_options_, output_level,
+                          cfd_->ioptions()->compaction_style),
+      LLONG_MAX /* max compaction bytes, not applicable */,
+      0 /* output path ID, not applicable */, output_compression_,
+      mutable_cf_options_.compression_opts, Temperature::kUnknown,
+      0 /* max_subcompaction, not applicable */,
+      {} /* grandparents, not applicable */, false /* is manual */,
+      "" /* trim_ts */, -1 /* score, not applicable */,
+      false /* is deletion compaction, not applicable */,
+      false /* l0_files_might_overlap, not applicable */,
+      CompactionReason::kFlush));
+  cfd_->compaction_picker()->RegisterCompaction(
+      output_range_compaction_.get());
+}
+
+void FlushJob::UnregisterOutputRange() {
+  db_mutex_->AssertHeld();
+  if (output_range_compaction_ == nullptr) {
+    return;
+  }
+  cfd_->compaction_picker()->UnregisterCompaction(
+      output_range_compaction_.get());
+  output_range_compaction_.reset();
+}
+
 Env::IOPriority FlushJob::GetRateLimiterPriorityForWrite() {
   if (versions_ && versions_->GetColumnFamilySet() &&
       versions_->GetColumnFamilySet()->write_controller()) {
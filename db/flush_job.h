@@ -68,6 +68,7 @@ class Version;
 class VersionEdit;
 class VersionSet;
 class Arena;
+class Compaction;
 
 class FlushJob {
  public:
@@ -146,6 +147,16 @@ class FlushJob {
   Env::IOPriority GetRateLimiterPriorityForWrite();
   std::unique_ptr<FlushJobInfo> GetFlushJobInfo() const;
 
+  // Returns the level to add the flushed file to, see
+  // flush_to_non_overlapping_level. REQUIRES: db mutex held
+  int PickOutputLevel() const;
+  // Until the flush result is installed, a compaction picked against the
+  // current version could produce files overlapping the flushed one in its
+  // output level. Like file ingestion, register the output range as a running
+  // compaction, so the compaction picker avoids it. REQUIRES: db mutex held
+  void RegisterOutputRange(int output_level);
+  void UnregisterOutputRange();
+
   // Require db_mutex held.
   // Called only when UDT feature is enabled and
   // `persist_user_defined_timestamps` flag is false. Because we will refrain
@@ -216,6 +227,9 @@ class FlushJob {
   VersionEdit* edit_;
   Version* base_;
   bool pick_memtable_called;
+  // Set by RegisterOutputRange() when the flushed file goes below L0
+  FileMetaData output_range_meta_;
+  std::unique_ptr<Compaction> output_range_compaction_;
   Env::Priority thread_pri_;
 
   const std::shared_ptr<IOTracer> io_tracer_;
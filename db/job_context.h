@@ -108,7 +108,8 @@ struct JobContext {
   inline bool HaveSomethingToDelete() const {
     return !(full_scan_candidate_files.empty() && sst_delete_files.empty() &&
              blob_delete_files.empty() && log_delete_files.empty() &&
-             manifest_delete_files.empty());
+             manifest_delete_files.empty() &&
+             shared_wal_delete_files.empty());
   }
 
   inline bool HaveSomethingToClean() const {
@@ -173,6 +174,9 @@ struct JobContext {
   // a list of manifest files that we need to delete
   std::vector<std::string> manifest_delete_files;
 
+  // a list of shared WAL files no db needs anymore (see DBOptions::shared_wal)
+  std::vector<std::string> shared_wal_delete_files;
+
   // a list of memtables to be free
   autovector<MemTable*> memtables_to_free;
 
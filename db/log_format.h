@@ -39,8 +39,12 @@ enum RecordType {
   // User-defined timestamp sizes
   kUserDefinedTimestampSizeType = 10,
   kRecyclableUserDefinedTimestampSizeType = 11,
+
+  // Compression type along with the compression dictionary. A distinct type,
+  // so that readers that don't support dictionaries reject the WAL.
+  kSetCompressionDictType = 12,
 };
-constexpr int kMaxRecordType = kRecyclableUserDefinedTimestampSizeType;
+constexpr int kMaxRecordType = kSetCompressionDictType;
 
 constexpr unsigned int kBlockSize = 32768;
 
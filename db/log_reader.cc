@@ -17,6 +17,7 @@
 #include "test_util/sync_point.h"
 #include "util/coding.h"
 #include "util/crc32c.h"
+#include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 namespace log {
@@ -164,7 +165,8 @@ bool Reader::ReadRecord(Slice* record, std::string* scratch,
         }
         break;
 
-      case kSetCompressionType: {
+      case kSetCompressionType:
+      case kSetCompressionDictType: {
         if (compression_type_record_read_) {
           ReportCorruption(fragment.size(),
                            "read multiple SetCompressionType records");
@@ -178,6 +180,10 @@ bool Reader::ReadRecord(Slice* record, std::string* scratch,
         last_record_offset_ = prospective_record_offset;
         CompressionTypeRecord compression_record(kNoCompression);
         Status s = compression_record.DecodeFrom(&fragment);
+        if (s.ok() && compression_record.GetCompressionDict().empty() !=
+                          (record_type == kSetCompressionType)) {
+          s = Status::Corruption("SetCompressionType dictionary mismatch");
+        }
         if (!s.ok()) {
           ReportCorruption(fragment.size(),
                            "could not decode SetCompressionType record");
@@ -527,6 +533,7 @@ unsigned int Reader::ReadPhysicalRecord(Slice* result, size_t* drop_size,
     buffer_.remove_prefix(header_size + length);
 
     if (!uncompress_ || type == kSetCompressionType ||
+        type == kSetCompressionDictType ||
         type == kUserDefinedTimestampSizeType ||
         type == kRecyclableUserDefinedTimestampSizeType) {
       *result = Slice(header + header_size, length);
@@ -589,7 +596,8 @@ void Reader::InitCompression(const CompressionTypeRecord& compression_record) {
   compression_type_record_read_ = true;
   constexpr uint32_t compression_format_version = 2;
   uncompress_ = StreamingUncompress::Create(
-      compression_type_, compression_format_version, kBlockSize);
+      compression_type_, compression_format_version, kBlockSize,
+      compression_record.GetCompressionDict());
   assert(uncompress_ != nullptr);
   uncompressed_buffer_ = std::unique_ptr<char[]>(new char[kBlockSize]);
   assert(uncompressed_buffer_);
@@ -683,7 +691,8 @@ bool FragmentBufferedReader::ReadRecord(Slice* record, std::string* scratch,
         }
         break;
 
-      case kSetCompressionType: {
+      case kSetCompressionType:
+      case kSetCompressionDictType: {
         if (compression_type_record_read_) {
           ReportCorruption(fragment.size(),
                            "read multiple SetCompressionType records");
@@ -698,6 +707,10 @@ bool FragmentBufferedReader::ReadRecord(Slice* record, std::string* scratch,
         in_fragmented_record_ = false;
         CompressionTypeRecord compression_record(kNoCompression);
         Status s = compression_record.DecodeFrom(&fragment);
+        if (s.ok() && compression_record.GetCompressionDict().empty() !=
+                          (fragment_type_or_err == kSetCompressionType)) {
+          s = Status::Corruption("SetCompressionType dictionary mismatch");
+        }
         if (!s.ok()) {
           ReportCorruption(fragment.size(),
                            "could not decode SetCompressionType record");
@@ -899,6 +912,7 @@ bool FragmentBufferedReader::TryReadFragment(
   buffer_.remove_prefix(header_size + length);
 
   if (!uncompress_ || type == kSetCompressionType ||
+      type == kSetCompressionDictType ||
       type == kUserDefinedTimestampSizeType ||
       type == kRecyclableUserDefinedTimestampSizeType) {
     *fragment = Slice(header + header_size, length);
@@ -930,5 +944,111 @@ bool FragmentBufferedReader::TryReadFragment(
   }
 }
 
+RecordPrefetcher::RecordPrefetcher(std::shared_ptr<Logger> info_log,
+                                   std::unique_ptr<SequentialFileReader>&& file,
+                                   Reader::Reporter* reporter, bool checksum,
+                                   uint64_t log_num,
+                                   WALRecoveryMode wal_recovery_mode,
+                                   size_t max_buffered_bytes)
+    : reporter_(reporter),
+      wal_recovery_mode_(wal_recovery_mode),
+      max_buffered_bytes_(max_buffered_bytes),
+      reader_(std::move(info_log), std::move(file), this, checksum, log_num),
+      cv_(&mutex_) {
+  current_.recorded_cf_to_ts_sz =
+      std::make_shared<UnorderedMap<uint32_t, size_t>>();
+  thread_.reset(new port::Thread(&RecordPrefetcher::ReadAhead, this));
+}
+
+RecordPrefetcher::~RecordPrefetcher() {
+  {
+    MutexLock l(&mutex_);
+    stop_ = true;
+    cv_.SignalAll();
+  }
+  thread_->join();
+}
+
+void RecordPrefetcher::Push(Entry&& entry) {
+  MutexLock l(&mutex_);
+  buffered_bytes_ += entry.record.size();
+  entries_.push_back(std::move(entry));
+  cv_.SignalAll();
+}
+
+void RecordPrefetcher::Corruption(size_t bytes, const Status& status) {
+  Entry entry;
+  entry.is_corruption = true;
+  entry.corrupted_bytes = bytes;
+  entry.corruption = status;
+  Push(std::move(entry));
+}
+
+void RecordPrefetcher::ReadAhead() {
+  std::string scratch;
+  Slice record;
+  std::shared_ptr<const UnorderedMap<uint32_t, size_t>> recorded_cf_to_ts_sz =
+      std::make_shared<UnorderedMap<uint32_t, size_t>>();
+  while (true) {
+    {
+      MutexLock l(&mutex_);
+      while (!stop_ && buffered_bytes_ >= max_buffered_bytes_) {
+        cv_.Wait();
+      }
+      if (stop_) {
+        break;
+      }
+    }
+    Entry entry;
+    if (!reader_.ReadRecord(&record, &scratch, wal_recovery_mode_,
+                            &entry.record_checksum)) {
+      break;
+    }
+    entry.record.assign(record.data(), record.size());
+    // The timestamp sizes rarely change, share them between the records
+    if (reader_.GetRecordedTimestampSize() != *recorded_cf_to_ts_sz) {
+      recorded_cf_to_ts_sz = std::make_shared<UnorderedMap<uint32_t, size_t>>(
+          reader_.GetRecordedTimestampSize());
+    }
+    entry.recorded_cf_to_ts_sz = recorded_cf_to_ts_sz;
+    Push(std::move(entry));
+  }
+
+  MutexLock l(&mutex_);
+  done_ = true;
+  cv_.SignalAll();
+}
+
+bool RecordPrefetcher::ReadRecord(Slice* record, uint64_t* record_checksum) {
+  while (true) {
+    Entry entry;
+    {
+      MutexLock l(&mutex_);
+      while (entries_.empty() && !done_) {
+        cv_.Wait();
+      }
+      if (entries_.empty()) {
+        return false;
+      }
+      entry = std::move(entries_.front());
+      entries_.pop_front();
+      buffered_bytes_ -= entry.record.size();
+      cv_.SignalAll();
+    }
+    if (entry.is_corruption) {
+      if (reporter_ != nullptr) {
+        reporter_->Corruption(entry.corrupted_bytes, entry.corruption);
+      }
+      continue;
+    }
+    current_ = std::move(entry);
+    *record = Slice(current_.record);
+    if (record_checksum != nullptr) {
+      *record_checksum = current_.record_checksum;
+    }
+    return true;
+  }
+}
+
 }  // namespace log
 }  // namespace ROCKSDB_NAMESPACE
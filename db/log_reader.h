@@ -10,12 +10,14 @@
 #pragma once
 #include <stdint.h>
 
+#include <deque>
 #include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include "db/log_format.h"
 #include "file/sequence_file_reader.h"
+#include "port/port.h"
 #include "rocksdb/options.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/status.h"
@@ -238,5 +240,74 @@ class FragmentBufferedReader : public Reader {
   void operator=(const FragmentBufferedReader&);
 };
 
+// RecordPrefetcher reads the records of a log with a Reader in a separate
+// thread, ahead of its consumer, so that reading and checksumming the next
+// records overlaps the processing of the current one (e.g. inserting it into
+// the memtables during the WAL recovery).
+//
+// The corruptions found while reading ahead are reported to the consumer's
+// reporter from the consumer's thread, in the order they were found with
+// respect to the records, as if the consumer read the log itself.
+class RecordPrefetcher : public Reader::Reporter {
+ public:
+  // See Reader::Reader(). Up to max_buffered_bytes of records are read ahead
+  // (at least one record).
+  RecordPrefetcher(std::shared_ptr<Logger> info_log,
+                   std::unique_ptr<SequentialFileReader>&& file,
+                   Reader::Reporter* reporter, bool checksum, uint64_t log_num,
+                   WALRecoveryMode wal_recovery_mode,
+                   size_t max_buffered_bytes);
+  // Stops reading ahead and waits for the read-ahead thread
+  ~RecordPrefetcher() override;
+
+  // No copying allowed
+  RecordPrefetcher(const RecordPrefetcher&) = delete;
+  void operator=(const RecordPrefetcher&) = delete;
+
+  // Like Reader::ReadRecord(). The record is valid until the next call.
+  bool ReadRecord(Slice* record, uint64_t* record_checksum = nullptr);
+
+  // The timestamp sizes recorded in the log up to the last returned record,
+  // see Reader::GetRecordedTimestampSize()
+  const UnorderedMap<uint32_t, size_t>& GetRecordedTimestampSize() const {
+    return *current_.recorded_cf_to_ts_sz;
+  }
+
+  // Called by the reader in the read-ahead thread
+  void Corruption(size_t bytes, const Status& status) override;
+
+ private:
+  // A record or a corruption
+  struct Entry {
+    std::string record;
+    uint64_t record_checksum = 0;
+    std::shared_ptr<const UnorderedMap<uint32_t, size_t>>
+        recorded_cf_to_ts_sz;
+    bool is_corruption = false;
+    size_t corrupted_bytes = 0;
+    Status corruption;
+  };
+
+  void ReadAhead();
+  void Push(Entry&& entry);
+
+  Reader::Reporter* const reporter_;
+  const WALRecoveryMode wal_recovery_mode_;
+  const size_t max_buffered_bytes_;
+  // Only used by the read-ahead thread
+  Reader reader_;
+  // The last returned record, only used by the consumer
+  Entry current_;
+
+  port::Mutex mutex_;
+  port::CondVar cv_;
+  std::deque<Entry> entries_;
+  size_t buffered_bytes_ = 0;
+  // The reader reached the end of the log
+  bool done_ = false;
+  bool stop_ = false;
+  std::unique_ptr<port::Thread> thread_;
+};
+
 }  // namespace log
 }  // namespace ROCKSDB_NAMESPACE
@@ -222,6 +222,8 @@ class LogTest
     dest_contents()[offset] += delta;
   }
 
+  char GetByte(int offset) const { return dest_contents()[offset]; }
+
   void SetByte(int offset, char new_byte) {
     dest_contents()[offset] = new_byte;
   }
@@ -1028,6 +1030,62 @@ TEST_P(CompressionLogTest, ReadWrite) {
   ASSERT_EQ("EOF", Read());  // Make sure reads at eof work
 }
 
+TEST_P(CompressionLogTest, ReadWriteWithDictionary) {
+  CompressionType compression_type = std::get<2>(GetParam());
+  if (!StreamingCompressionTypeSupported(compression_type)) {
+    ROCKSDB_GTEST_SKIP("Test requires support for compression type");
+    return;
+  }
+  const std::string dict = BigString("key-value-", 4096);
+  ASSERT_OK(writer_->AddCompressionTypeRecord(dict));
+  const bool compression_enabled = compression_type != kNoCompression;
+  // The dictionary is only recorded when compressing
+  ASSERT_EQ(compression_enabled ? kHeaderSize + 4 + dict.size() : 0,
+            WrittenBytes());
+  Random rnd(301);
+  std::vector<std::string> records;
+  for (int i = 0; i < 100; i++) {
+    records.push_back("key-value-" + NumberString(i));
+  }
+  records.push_back(rnd.RandomBinaryString(3 * kBlockSize));
+  records.emplace_back("");
+  for (const std::string& record : records) {
+    Write(record);
+  }
+  for (const std::string& record : records) {
+    ASSERT_EQ(record, Read());
+  }
+  ASSERT_EQ("EOF", Read());
+}
+
+TEST_P(CompressionLogTest, DictionaryRecordType) {
+  CompressionType compression_type = std::get<2>(GetParam());
+  if (compression_type == kNoCompression ||
+      !StreamingCompressionTypeSupported(compression_type)) {
+    ROCKSDB_GTEST_SKIP("Test requires support for compression type");
+    return;
+  }
+  // A compression type out of the range of CompressionType is rejected
+  // rather than truncated
+  std::string encoded;
+  PutFixed32(&encoded, 0x100 | compression_type);
+  Slice encoded_slice(encoded);
+  CompressionTypeRecord compression_record(kNoCompression);
+  ASSERT_TRUE(compression_record.DecodeFrom(&encoded_slice).IsCorruption());
+
+  // The dictionary has its own record type, so that readers that don't know
+  // about dictionaries reject the WAL
+  const std::string dict = BigString("key-value-", 1024);
+  ASSERT_OK(writer_->AddCompressionTypeRecord(dict));
+  ASSERT_EQ(static_cast<char>(kSetCompressionDictType), GetByte(6));
+  Write("foo");
+  SetByte(6, static_cast<char>(kSetCompressionType));
+  FixChecksum(0, 4 + static_cast<int>(dict.size()), false /* recyclable */);
+  Read();
+  ASSERT_GT(DroppedBytes(), 0U);
+  ASSERT_EQ("OK", MatchError("could not decode SetCompressionType record"));
+}
+
 TEST_P(CompressionLogTest, ReadWriteWithTimestampSize) {
   CompressionType compression_type = std::get<2>(GetParam());
   if (!StreamingCompressionTypeSupported(compression_type)) {
@@ -1132,7 +1190,8 @@ INSTANTIATE_TEST_CASE_P(
     Compression, CompressionLogTest,
     ::testing::Combine(::testing::Values(0, 1), ::testing::Bool(),
                        ::testing::Values(CompressionType::kNoCompression,
-                                         CompressionType::kZSTD)));
+                                         CompressionType::kZSTD,
+                                         CompressionType::kLZ4Compression)));
 
 class StreamingCompressionTest
     : public ::testing::TestWithParam<std::tuple<int, CompressionType>> {};
@@ -1200,7 +1259,8 @@ INSTANTIATE_TEST_CASE_P(
     StreamingCompression, StreamingCompressionTest,
     ::testing::Combine(::testing::Values(10, 100, 1000, kBlockSize,
                                          kBlockSize * 2),
-                       ::testing::Values(CompressionType::kZSTD)));
+                       ::testing::Values(CompressionType::kZSTD,
+                                         CompressionType::kLZ4Compression)));
 
 }  // namespace log
 }  // namespace ROCKSDB_NAMESPACE
@@ -25,6 +25,8 @@
 
 #include <stdint.h>
 
+#include <algorithm>
+
 #include "file/writable_file_writer.h"
 #include "rocksdb/env.h"
 #include "rocksdb/io_status.h"
@@ -37,14 +39,17 @@ namespace log {
 
 Writer::Writer(std::unique_ptr<WritableFileWriter>&& dest, uint64_t log_number,
                bool recycle_log_files, bool manual_flush,
-               CompressionType compression_type)
+               CompressionType compression_type,
+               size_t compression_dict_sample_bytes)
     : dest_(std::move(dest)),
       block_offset_(0),
       log_number_(log_number),
       recycle_log_files_(recycle_log_files),
       manual_flush_(manual_flush),
       compression_type_(compression_type),
-      compress_(nullptr) {
+      compress_(nullptr),
+      compression_dict_sample_bytes_(compression_dict_sample_bytes),
+      compression_dict_sample_done_(compression_dict_sample_bytes == 0) {
   for (int i = 0; i <= kMaxRecordType; i++) {
     char t = static_cast<char>(i);
     type_crc_[i] = crc32c::Value(&t, 1);
@@ -95,6 +100,9 @@ IOStatus Writer::AddRecord(const Slice& slice,
   if (compress_) {
     compress_->Reset();
     compress_start = true;
+    if (!compression_dict_sample_done_.load(std::memory_order_relaxed)) {
+      SampleForCompressionDict(slice);
+    }
   }
 
   IOStatus s;
@@ -194,7 +202,7 @@ IOStatus Writer::SyncRange(bool use_fsync, uint64_t offset, uint64_t size) {
   return s;
 }
 
-IOStatus Writer::AddCompressionTypeRecord() {
+IOStatus Writer::AddCompressionTypeRecord(const Slice& compression_dict) {
   // Should be the first record
   assert(block_offset_ == 0);
 
@@ -203,11 +211,15 @@ IOStatus Writer::AddCompressionTypeRecord() {
     return IOStatus::OK();
   }
 
-  CompressionTypeRecord record(compression_type_);
+  // The record is not fragmented, the dictionary must fit in a single block
+  assert(compression_dict.size() + sizeof(uint32_t) <=
+         kBlockSize - kRecyclableHeaderSize);
+  CompressionTypeRecord record(compression_type_, compression_dict);
   std::string encode;
   record.EncodeTo(&encode);
-  IOStatus s =
-      EmitPhysicalRecord(kSetCompressionType, encode.data(), encode.size());
+  IOStatus s = EmitPhysicalRecord(
+      compression_dict.empty() ? kSetCompressionType : kSetCompressionDictType,
+      encode.data(), encode.size());
   if (s.ok()) {
     if (!manual_flush_) {
       s = dest_->Flush();
@@ -217,9 +229,9 @@ IOStatus Writer::AddCompressionTypeRecord() {
         kBlockSize - (recycle_log_files_ ? kRecyclableHeaderSize : kHeaderSize);
     CompressionOptions opts;
     constexpr uint32_t compression_format_version = 2;
-    compress_ = StreamingCompress::Create(compression_type_, opts,
-                                          compression_format_version,
-                                          max_output_buffer_len);
+    compress_ = StreamingCompress::Create(
+        compression_type_, opts, compression_format_version,
+        max_output_buffer_len, compression_dict);
     assert(compress_ != nullptr);
     compressed_buffer_ =
         std::unique_ptr<char[]>(new char[max_output_buffer_len]);
@@ -231,6 +243,29 @@ IOStatus Writer::AddCompressionTypeRecord() {
   return s;
 }
 
+void Writer::SampleForCompressionDict(const Slice& record) {
+  // Take the head of several records rather than a single large one
+  const size_t max_bytes_per_record =
+      std::max<size_t>(compression_dict_sample_bytes_ / 8, 1);
+  const size_t sample_bytes =
+      std::min({record.size(), max_bytes_per_record,
+                compression_dict_sample_bytes_ -
+                    compression_dict_sample_.size()});
+  compression_dict_sample_.append(record.data(), sample_bytes);
+  if (compression_dict_sample_.size() == compression_dict_sample_bytes_) {
+    compression_dict_sample_done_.store(true, std::memory_order_release);
+  }
+}
+
+bool Writer::GetCompressionDictSample(std::string* sample) const {
+  if (compression_dict_sample_bytes_ == 0 ||
+      !compression_dict_sample_done_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  *sample = compression_dict_sample_;
+  return true;
+}
+
 IOStatus Writer::MaybeAddUserDefinedTimestampSizeRecord(
     const UnorderedMap<uint32_t, size_t>& cf_to_ts_sz,
     Env::IOPriority rate_limiter_priority) {
@@ -274,7 +309,7 @@ IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n,
 
   uint32_t crc = type_crc_[t];
   if (t < kRecyclableFullType || t == kSetCompressionType ||
-      t == kUserDefinedTimestampSizeType) {
+      t == kUserDefinedTimestampSizeType || t == kSetCompressionDictType) {
     // Legacy record format
     assert(block_offset_ + kHeaderSize + n <= kBlockSize);
     header_size = kHeaderSize;
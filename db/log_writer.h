@@ -22,8 +22,10 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -90,10 +92,14 @@ class Writer {
   // Create a writer that will append data to "*dest".
   // "*dest" must be initially empty.
   // "*dest" must remain live while this Writer is in use.
+  // When compression is enabled and compression_dict_sample_bytes > 0, the
+  // writer samples that many bytes of the first records it writes, see
+  // GetCompressionDictSample().
   explicit Writer(std::unique_ptr<WritableFileWriter>&& dest,
                   uint64_t log_number, bool recycle_log_files,
                   bool manual_flush = false,
-                  CompressionType compressionType = kNoCompression);
+                  CompressionType compressionType = kNoCompression,
+                  size_t compression_dict_sample_bytes = 0);
   // No copying allowed
   Writer(const Writer&) = delete;
   void operator=(const Writer&) = delete;
@@ -109,7 +115,14 @@ class Writer {
       uint64_t* size = nullptr);
 
   IOStatus SyncRange(bool use_fsync, uint64_t offset, uint64_t size);
-  IOStatus AddCompressionTypeRecord();
+  // Must be called before any other record is added. The following records
+  // are compressed with compression_dict, if not empty.
+  IOStatus AddCompressionTypeRecord(const Slice& compression_dict = Slice());
+
+  // Once the sample of the written records is complete, copies it to *sample
+  // and returns true. The sample is meant to be the (raw content) compression
+  // dictionary of the next WAL. Thread safe against AddRecord().
+  bool GetCompressionDictSample(std::string* sample) const;
 
   // If there are column families in `cf_to_ts_sz` not included in
   // `recorded_cf_to_ts_sz_` and its user-defined timestamp size is non-zero,
@@ -155,6 +168,13 @@ class Writer {
   StreamingCompress* compress_;
   // Reusable compressed output buffer
   std::unique_ptr<char[]> compressed_buffer_;
+  // Prefixes of the first records written, immutable once
+  // compression_dict_sample_done_ is set
+  const size_t compression_dict_sample_bytes_;
+  std::string compression_dict_sample_;
+  std::atomic<bool> compression_dict_sample_done_;
+
+  void SampleForCompressionDict(const Slice& record);
 
   // The recorded user-defined timestamp size that have been written so far.
   // Since the user-defined timestamp size cannot be changed while the DB is
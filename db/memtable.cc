@@ -35,6 +35,7 @@
 #include "db/pinned_iterators_manager.h"
 #include "db/range_tombstone_fragmenter.h"
 #include "db/read_callback.h"
+#include "db/wal_value_file.h"
 #include "db/wide/wide_column_serialization.h"
 #include "logging/logging.h"
 #include "memory/arena.h"
@@ -80,7 +81,8 @@ ImmutableMemTableOptions::ImmutableMemTableOptions(
       info_log(ioptions.logger),
       allow_data_in_errors(ioptions.allow_data_in_errors),
       protection_bytes_per_key(
-          mutable_cf_options.memtable_protection_bytes_per_key) {}
+          mutable_cf_options.memtable_protection_bytes_per_key),
+      wal_value_threshold(ioptions.memtable_wal_value_threshold) {}
 
 MemTable::MemTable(const InternalKeyComparator& cmp,
                    const ImmutableOptions& ioptions,
@@ -98,7 +100,11 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                write_buffer_manager->cost_to_cache()))
                  ? &mem_tracker_
                  : nullptr,
-             mutable_cf_options.memtable_huge_page_size),
+             mutable_cf_options.memtable_huge_page_size,
+             write_buffer_manager != nullptr
+                 ? write_buffer_manager->arena_block_pool()
+                 : nullptr,
+             mutable_cf_options.memtable_numa_local_allocation),
       table_(ioptions.memtable_factory->CreateMemTableRep(
           comparator_, &arena_, mutable_cf_options.prefix_extractor.get(),
           ioptions.logger, column_family_id)),
@@ -131,7 +137,9 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
       atomic_flush_seqno_(kMaxSequenceNumber),
       approximate_memory_usage_(0),
       memtable_max_range_deletions_(
-          mutable_cf_options.memtable_max_range_deletions) {
+          mutable_cf_options.memtable_max_range_deletions),
+      last_wal_value_log_number_(0),
+      wal_value_bytes_(0) {
   UpdateFlushState();
   // something went wrong if we need to flush before inserting anything
   assert(!ShouldScheduleFlush());
@@ -216,6 +224,10 @@ bool MemTable::ShouldFlushNow() {
 
   approximate_memory_usage_.store(allocated_memory, std::memory_order_relaxed);
 
+  // The values referenced in the WAL count as if they were in the memtable, so
+  // that the WAL is not held longer than without references
+  allocated_memory += wal_value_bytes_.load(std::memory_order_relaxed);
+
   // if we can still allocate one more block without exceeding the
   // over-allocation ratio, then we should not flush.
   if (allocated_memory + kArenaBlockSize <
@@ -334,6 +346,50 @@ Status MemTable::VerifyEntryChecksum(const char* entry,
   return Status::OK();
 }
 
+void MemTable::AddWalValueRef(const std::shared_ptr<WalValueFile>& file,
+                              size_t value_size) {
+  wal_value_bytes_.fetch_add(value_size, std::memory_order_relaxed);
+  const uint64_t log_number = file->log_number();
+  if (last_wal_value_log_number_.load(std::memory_order_acquire) ==
+      log_number) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(wal_value_files_mutex_);
+  for (const auto& f : wal_value_files_) {
+    if (f->log_number() == log_number) {
+      return;
+    }
+  }
+  wal_value_files_.push_back(file);
+  last_wal_value_log_number_.store(log_number, std::memory_order_release);
+}
+
+Status MemTable::ReadWalValue(const Slice& ref, std::string* value) const {
+  uint64_t log_number = 0;
+  uint64_t offset = 0;
+  uint64_t size = 0;
+  Status s = WalValueFile::DecodeRef(ref, &log_number, &offset, &size);
+  if (!s.ok()) {
+    return s;
+  }
+  // The files are kept as long as the memtable
+  const WalValueFile* file = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(wal_value_files_mutex_);
+    for (const auto& f : wal_value_files_) {
+      if (f->log_number() == log_number) {
+        file = f.get();
+        break;
+      }
+    }
+  }
+  if (file == nullptr) {
+    return Status::Corruption("Memtable references an unknown WAL file " +
+                              std::to_string(log_number));
+  }
+  return file->Read(offset, static_cast<size_t>(size), value);
+}
+
 int MemTable::KeyComparator::operator()(const char* prefix_len_key1,
                                         const char* prefix_len_key2) const {
   // Internal keys are encoded as length-prefixed strings.
@@ -388,7 +444,11 @@ class MemTableIterator : public InternalIterator {
         protection_bytes_per_key_(mem.moptions_.protection_bytes_per_key),
         status_(Status::OK()),
         logger_(mem.moptions_.info_log),
-        ts_sz_(mem.ts_sz_) {
+        ts_sz_(mem.ts_sz_),
+        mem_(&mem),
+        may_have_wal_value_refs_(!use_range_del_table &&
+                                 mem.moptions_.wal_value_threshold > 0),
+        wal_value_resolved_(false) {
     if (use_range_del_table) {
       iter_ = mem.range_del_table_->GetIterator(arena);
     } else if (prefix_extractor_ != nullptr && !read_options.total_order_seek &&
@@ -421,12 +481,10 @@ class MemTableIterator : public InternalIterator {
     }
   }
 
-#ifndef NDEBUG
   void SetPinnedItersMgr(PinnedIteratorsManager* pinned_iters_mgr) override {
     pinned_iters_mgr_ = pinned_iters_mgr;
   }
   PinnedIteratorsManager* pinned_iters_mgr_ = nullptr;
-#endif
 
   bool Valid() const override { return valid_ && status_.ok(); }
 
@@ -450,6 +508,7 @@ class MemTableIterator : public InternalIterator {
     iter_->Seek(k, nullptr);
     valid_ = iter_->Valid();
     VerifyEntryChecksum();
+    ResolveWalValueRef();
   }
   void SeekForPrev(const Slice& k) override {
     PERF_TIMER_GUARD(seek_on_memtable_time);
@@ -470,6 +529,7 @@ class MemTableIterator : public InternalIterator {
     iter_->Seek(k, nullptr);
     valid_ = iter_->Valid();
     VerifyEntryChecksum();
+    ResolveWalValueRef();
     if (!Valid() && status().ok()) {
       SeekToLast();
     }
@@ -481,11 +541,13 @@ class MemTableIterator : public InternalIterator {
     iter_->SeekToFirst();
     valid_ = iter_->Valid();
     VerifyEntryChecksum();
+    ResolveWalValueRef();
   }
   void SeekToLast() override {
     iter_->SeekToLast();
     valid_ = iter_->Valid();
     VerifyEntryChecksum();
+    ResolveWalValueRef();
   }
   void Next() override {
     PERF_COUNTER_ADD(next_on_memtable_count, 1);
@@ -494,6 +556,7 @@ class MemTableIterator : public InternalIterator {
     TEST_SYNC_POINT_CALLBACK("MemTableIterator::Next:0", iter_);
     valid_ = iter_->Valid();
     VerifyEntryChecksum();
+    ResolveWalValueRef();
   }
   bool NextAndGetResult(IterateResult* result) override {
     Next();
@@ -511,13 +574,20 @@ class MemTableIterator : public InternalIterator {
     iter_->Prev();
     valid_ = iter_->Valid();
     VerifyEntryChecksum();
+    ResolveWalValueRef();
   }
   Slice key() const override {
     assert(Valid());
+    if (wal_value_resolved_) {
+      return wal_value_key_;
+    }
     return GetLengthPrefixedSlice(iter_->key());
   }
   Slice value() const override {
     assert(Valid());
+    if (wal_value_resolved_) {
+      return wal_value_value_;
+    }
     Slice key_slice = GetLengthPrefixedSlice(iter_->key());
     return GetLengthPrefixedSlice(key_slice.data() + key_slice.size());
   }
@@ -525,13 +595,14 @@ class MemTableIterator : public InternalIterator {
   Status status() const override { return status_; }
 
   bool IsKeyPinned() const override {
-    // memtable data is always pinned
-    return true;
+    // memtable data is always pinned, and so are the entries whose value is
+    // read from the WAL while pinning is enabled
+    return !wal_value_resolved_ || PinWalValueEntry();
   }
 
   bool IsValuePinned() const override {
     // memtable value is always pinned, except if we allow inplace update.
-    return value_pinned_;
+    return value_pinned_ && (!wal_value_resolved_ || PinWalValueEntry());
   }
 
  private:
@@ -546,6 +617,19 @@ class MemTableIterator : public InternalIterator {
   Status status_;
   Logger* logger_;
   size_t ts_sz_;
+  const MemTable* mem_;
+  bool may_have_wal_value_refs_;
+  // Whether the current entry references its value in the WAL. It is then
+  // presented as a kTypeValue entry with the value read from the WAL.
+  bool wal_value_resolved_;
+  struct WalValueEntry {
+    std::string key;
+    std::string value;
+  };
+  // The resolved entry, unless it was handed over to pinned_iters_mgr_
+  mutable std::unique_ptr<WalValueEntry> wal_value_entry_;
+  Slice wal_value_key_;
+  Slice wal_value_value_;
 
   void VerifyEntryChecksum() {
     if (protection_bytes_per_key_ > 0 && Valid()) {
@@ -556,6 +640,53 @@ class MemTableIterator : public InternalIterator {
       }
     }
   }
+
+  void ResolveWalValueRef() {
+    wal_value_resolved_ = false;
+    if (!may_have_wal_value_refs_ || !Valid()) {
+      return;
+    }
+    Slice ikey = GetLengthPrefixedSlice(iter_->key());
+    if (ExtractValueType(ikey) != kTypeWalValueRef) {
+      return;
+    }
+    if (wal_value_entry_ == nullptr) {
+      wal_value_entry_.reset(new WalValueEntry());
+    }
+    status_ = mem_->ReadWalValue(
+        GetLengthPrefixedSlice(ikey.data() + ikey.size()),
+        &wal_value_entry_->value);
+    if (!status_.ok()) {
+      ROCKS_LOG_ERROR(logger_, "In MemtableIterator: %s", status_.getState());
+      return;
+    }
+    std::string* key = &wal_value_entry_->key;
+    key->assign(ikey.data(), ikey.size());
+    UpdateInternalKey(key, ExtractInternalKeyFooter(ikey) >> 8, kTypeValue);
+    wal_value_key_ = *key;
+    wal_value_value_ = wal_value_entry_->value;
+    wal_value_resolved_ = true;
+  }
+
+  // Hands the resolved entry over to pinned_iters_mgr_ if pinning is enabled,
+  // as the iterator may have been positioned on it before pinning started.
+  // The entry is not moved, so key() and value() stay valid. Returns whether
+  // the entry is pinned.
+  bool PinWalValueEntry() const {
+    if (wal_value_entry_ == nullptr) {
+      return true;
+    }
+    if (pinned_iters_mgr_ == nullptr || !pinned_iters_mgr_->PinningEnabled()) {
+      return false;
+    }
+    pinned_iters_mgr_->PinPtr(wal_value_entry_.release(),
+                              &MemTableIterator::ReleaseWalValueEntry);
+    return true;
+  }
+
+  static void ReleaseWalValueEntry(void* entry) {
+    delete static_cast<WalValueEntry*>(entry);
+  }
 };
 
 InternalIterator* MemTable::NewIterator(const ReadOptions& read_options,
@@ -831,13 +962,14 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
       post_process_info->num_deletes++;
     }
 
+    // The bloom filter is updated for the whole batch in BatchPostProcess()
     if (bloom_filter_ && prefix_extractor_ &&
         prefix_extractor_->InDomain(key_without_ts)) {
-      bloom_filter_->AddConcurrently(
-          prefix_extractor_->Transform(key_without_ts));
+      post_process_info->bloom_hashes.push_back(
+          BloomHash(prefix_extractor_->Transform(key_without_ts)));
     }
     if (bloom_filter_ && moptions_.memtable_whole_key_filtering) {
-      bloom_filter_->AddConcurrently(key_without_ts);
+      post_process_info->bloom_hashes.push_back(BloomHash(key_without_ts));
     }
 
     // atomically update first_seqno_ and earliest_seqno_.
@@ -1001,7 +1133,8 @@ static bool SaveValue(void* arg, const char* entry) {
 
     if ((type == kTypeValue || type == kTypeMerge || type == kTypeBlobIndex ||
          type == kTypeWideColumnEntity || type == kTypeDeletion ||
-         type == kTypeSingleDeletion || type == kTypeDeletionWithTimestamp) &&
+         type == kTypeSingleDeletion || type == kTypeDeletionWithTimestamp ||
+         type == kTypeWalValueRef) &&
         max_covering_tombstone_seq > seq) {
       type = kTypeRangeDeletion;
     }
@@ -1053,7 +1186,8 @@ static bool SaveValue(void* arg, const char* entry) {
 
         return false;
       }
-      case kTypeValue: {
+      case kTypeValue:
+      case kTypeWalValueRef: {
         if (s->inplace_update_support) {
           s->mem->GetLock(s->key->user_key())->ReadLock();
         }
@@ -1062,6 +1196,18 @@ static bool SaveValue(void* arg, const char* entry) {
 
         *(s->status) = Status::OK();
 
+        std::string wal_value;
+        if (type == kTypeWalValueRef) {
+          // Not with inplace_update_support, so no lock to release
+          assert(!s->inplace_update_support);
+          *(s->status) = s->mem->ReadWalValue(v, &wal_value);
+          if (!s->status->ok()) {
+            *(s->found_final_value) = true;
+            return false;
+          }
+          v = wal_value;
+        }
+
         if (!s->do_merge) {
           // Preserve the value with the goal of returning it as part of
           // raw merge operands to the user
@@ -1069,7 +1215,8 @@ static bool SaveValue(void* arg, const char* entry) {
           // can also be retained.
 
           merge_context->PushOperand(
-              v, s->inplace_update_support == false /* operand_pinned */);
+              v, s->inplace_update_support == false &&
+                     type == kTypeValue /* operand_pinned */);
         } else if (*(s->merge_in_progress)) {
           assert(s->do_merge);
 
@@ -26,6 +26,7 @@
 #include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -53,6 +54,7 @@ class Mutex;
 class MemTableIterator;
 class MergeContext;
 class SystemClock;
+class WalValueFile;
 
 struct ImmutableMemTableOptions {
   explicit ImmutableMemTableOptions(const ImmutableOptions& ioptions,
@@ -73,6 +75,7 @@ struct ImmutableMemTableOptions {
   Logger* info_log;
   bool allow_data_in_errors;
   uint32_t protection_bytes_per_key;
+  size_t wal_value_threshold;
 };
 
 // Batched counters to updated when inserting keys in one write batch.
@@ -83,6 +86,9 @@ struct MemTablePostProcessInfo {
   uint64_t num_entries = 0;
   uint64_t num_deletes = 0;
   uint64_t num_range_deletes = 0;
+  // The hashes of the keys and prefixes to add to the memtable bloom filter,
+  // added as a batch by MemTable::BatchPostProcess()
+  std::vector<uint32_t> bloom_hashes;
 };
 
 using MultiGetRange = MultiGetContext::Range;
@@ -337,9 +343,15 @@ class MemTable {
   // key in the memtable.
   size_t CountSuccessiveMergeEntries(const LookupKey& key);
 
-  // Update counters and flush status after inserting a whole write batch
-  // Used in concurrent memtable inserts.
+  // Update counters, bloom filter and flush status after inserting a whole
+  // write batch. Used in concurrent memtable inserts, where it must be called
+  // before the sequence numbers of the batch become visible to readers.
   void BatchPostProcess(const MemTablePostProcessInfo& update_counters) {
+    if (!update_counters.bloom_hashes.empty()) {
+      assert(bloom_filter_);
+      bloom_filter_->AddHashesConcurrently(update_counters.bloom_hashes.data(),
+                                           update_counters.bloom_hashes.size());
+    }
     num_entries_.fetch_add(update_counters.num_entries,
                            std::memory_order_relaxed);
     data_size_.fetch_add(update_counters.data_size, std::memory_order_relaxed);
@@ -588,6 +600,17 @@ class MemTable {
                                     uint32_t protection_bytes_per_key,
                                     bool allow_data_in_errors = false);
 
+  // Keeps file open for the kTypeWalValueRef entry that references a value of
+  // value_size bytes in it, and counts the value toward write_buffer_size (see
+  // ShouldFlushNow()). Must be called before adding the entry.
+  // Thread-safe.
+  void AddWalValueRef(const std::shared_ptr<WalValueFile>& file,
+                      size_t value_size);
+
+  // Reads the value referenced by ref, the value of a kTypeWalValueRef entry.
+  // Thread-safe.
+  Status ReadWalValue(const Slice& ref, std::string* value) const;
+
  private:
   enum FlushStateEnum { FLUSH_NOT_REQUESTED, FLUSH_REQUESTED, FLUSH_SCHEDULED };
 
@@ -684,6 +707,14 @@ class MemTable {
   // Whether to persist user-defined timestamps
   bool persist_user_defined_timestamps_;
 
+  // The WAL files referenced by the kTypeWalValueRef entries, and the number of
+  // the last one added
+  mutable std::mutex wal_value_files_mutex_;
+  std::vector<std::shared_ptr<WalValueFile>> wal_value_files_;
+  std::atomic<uint64_t> last_wal_value_log_number_;
+  // The total size of the values referenced by the kTypeWalValueRef entries
+  std::atomic<uint64_t> wal_value_bytes_;
+
   // Newest user-defined timestamp contained in this MemTable. For ts1, and ts2
   // if Comparator::CompareTimestamp(ts1, ts2) > 0, ts1 is considered newer than
   // ts2. We track this field for a MemTable if its column family has UDT
@@ -20,6 +20,9 @@
 
 #include "db/periodic_task_scheduler.h"
 
+#include <algorithm>
+
+#include "port/port.h"
 #include "rocksdb/system_clock.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -29,7 +32,7 @@ namespace ROCKSDB_NAMESPACE {
 //     they are currently not implemented in a thread-safe way; and
 // (2) to ensure the `Timer::Add()`s and `Timer::Start()` run atomically, and
 //     the `Timer::Cancel()`s and `Timer::Shutdown()` run atomically.
-// (3) protect tasks_map_ in PeriodicTaskScheduler
+// (3) protect tasks_map_ in PeriodicTaskScheduler and the task batches
 // Note: It's not efficient to have a static global mutex, for
 // PeriodicTaskScheduler it should be okay, as the operations are called
 // infrequently.
@@ -51,6 +54,74 @@ static const std::map<PeriodicTaskType, std::string> kPeriodicTaskTypeNames = {
     {PeriodicTaskType::kRefreshOptions, "refresh_options"},
 };
 
+// The tasks of one type and period, starting in the same slot of the period.
+// The task list has its own mutex, as it's read by the timer thread without
+// the global `timer_mutex` (which is held while waiting for the timer).
+struct PeriodicTaskScheduler::TaskBatch {
+  TaskBatch(TaskBatchKey _key, std::string _name)
+      : key(std::move(_key)), name(std::move(_name)), cv(&mutex) {}
+
+  // Runs the tasks one after the other, the ones added meanwhile wait for the
+  // next round
+  void Run() {
+    MutexLock l(&mutex);
+    if (tasks.empty()) {
+      return;
+    }
+    const uint64_t last_id = tasks.rbegin()->first;
+    auto it = tasks.begin();
+    while (it != tasks.end() && it->first <= last_id) {
+      const uint64_t id = it->first;
+      PeriodicTaskFunc fn = it->second;
+      running = true;
+      running_id = id;
+      mutex.Unlock();
+      fn();
+      mutex.Lock();
+      running = false;
+      cv.SignalAll();
+      it = tasks.upper_bound(id);
+    }
+  }
+
+  void Add(uint64_t id, const PeriodicTaskFunc& fn) {
+    MutexLock l(&mutex);
+    tasks.emplace(id, fn);
+  }
+
+  // Waits for the task to complete if it's running
+  void Remove(uint64_t id) {
+    MutexLock l(&mutex);
+    tasks.erase(id);
+    while (running && running_id == id) {
+      cv.Wait();
+    }
+  }
+
+  size_t NumTasks() {
+    MutexLock l(&mutex);
+    return tasks.size();
+  }
+
+  const TaskBatchKey key;
+  // Name of the timer function
+  const std::string name;
+
+  port::Mutex mutex;
+  port::CondVar cv;
+  std::map<uint64_t, PeriodicTaskFunc> tasks;
+  bool running = false;
+  uint64_t running_id = 0;
+};
+
+std::map<PeriodicTaskScheduler::TaskBatchKey,
+         std::shared_ptr<PeriodicTaskScheduler::TaskBatch>>&
+PeriodicTaskScheduler::TaskBatches() {
+  static auto* batches =
+      new std::map<TaskBatchKey, std::shared_ptr<TaskBatch>>();
+  return *batches;
+}
+
 Status PeriodicTaskScheduler::Register(PeriodicTaskType task_type,
                                        const PeriodicTaskFunc& fn) {
   return Register(task_type, fn, kDefaultPeriodSeconds.at(task_type));
@@ -72,35 +143,56 @@ Status PeriodicTaskScheduler::Register(PeriodicTaskType task_type,
       return Status::OK();
     }
     // cancel the existing one before register new one
-    timer_->Cancel(it->second.name);
+    RemoveTask(it->second);
     tasks_map_.erase(it);
   }
 
   timer_->Start();
-  // put task type name as prefix, for easy debug
-  std::string unique_id =
-      kPeriodicTaskTypeNames.at(task_type) + std::to_string(id_++);
-
-  bool succeeded = timer_->Add(
-      fn, unique_id,
-      (initial_delay.fetch_add(1) % repeat_period_seconds) * kMicrosInSecond,
-      repeat_period_seconds * kMicrosInSecond);
-  if (!succeeded) {
-    return Status::Aborted("Failed to register periodic task");
+  const uint64_t num_slots = std::min(repeat_period_seconds, kNumSlotsPerPeriod);
+  const uint64_t slot = initial_delay.fetch_add(1) % num_slots;
+  TaskBatchKey key{timer_, task_type, repeat_period_seconds, slot};
+  auto& batches = TaskBatches();
+  auto batch_it = batches.find(key);
+  if (batch_it == batches.end()) {
+    // put task type name as prefix, for easy debug
+    auto batch = std::make_shared<TaskBatch>(
+        key, kPeriodicTaskTypeNames.at(task_type) + std::to_string(id_++));
+    bool succeeded = timer_->Add(
+        [batch]() { batch->Run(); }, batch->name,
+        slot * repeat_period_seconds / num_slots * kMicrosInSecond,
+        repeat_period_seconds * kMicrosInSecond);
+    if (!succeeded) {
+      return Status::Aborted("Failed to register periodic task");
+    }
+    batch_it = batches.emplace(key, std::move(batch)).first;
   }
+
+  const uint64_t task_id = id_++;
   auto result = tasks_map_.try_emplace(
-      task_type, TaskInfo{unique_id, repeat_period_seconds});
+      task_type, TaskInfo{batch_it->second, task_id, repeat_period_seconds});
   if (!result.second) {
     return Status::Aborted("Failed to add periodic task");
   };
+  batch_it->second->Add(task_id, fn);
   return Status::OK();
 }
 
+void PeriodicTaskScheduler::RemoveTask(const TaskInfo& task_info) {
+  timer_mutex.AssertHeld();
+  const auto& batch = task_info.batch;
+  batch->Remove(task_info.id);
+  if (batch->NumTasks() == 0U) {
+    Timer* timer = std::get<0>(batch->key);
+    timer->Cancel(batch->name);
+    TaskBatches().erase(batch->key);
+  }
+}
+
 Status PeriodicTaskScheduler::Unregister(PeriodicTaskType task_type) {
   MutexLock l(&timer_mutex);
   auto it = tasks_map_.find(task_type);
   if (it != tasks_map_.end()) {
-    timer_->Cancel(it->second.name);
+    RemoveTask(it->second);
     tasks_map_.erase(it);
   }
   if (!timer_->HasPendingTask()) {
@@ -121,6 +213,17 @@ void PeriodicTaskScheduler::TEST_OverrideTimer(SystemClock* clock) {
   MutexLock l(&timer_mutex);
   timer_ = &test_timer;
 }
+
+size_t PeriodicTaskScheduler::TEST_GetValidTaskNum() const {
+  MutexLock l(&timer_mutex);
+  size_t num_tasks = 0;
+  for (const auto& batch : TaskBatches()) {
+    if (std::get<0>(batch.first) == timer_) {
+      num_tasks += batch.second->NumTasks();
+    }
+  }
+  return num_tasks;
+}
 #endif  // NDEBUG
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -21,6 +21,11 @@
 #pragma once
 
 
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+
 #include "util/timer.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -48,6 +53,12 @@ enum class PeriodicTaskType : uint8_t {
 // Internally, it uses a global single threaded timer object to run the periodic
 // task functions. Timer thread will always be started since the info log
 // flushing cannot be disabled.
+//
+// To keep the timer small with many DB instances, the tasks of the same type
+// and period are batched: each period is split into up to kNumSlotsPerPeriod
+// start slots, the tasks are spread over the slots round-robin (so the DBs
+// opened together don't all run at once), and all the tasks of a slot run
+// from a single timer function, one after the other.
 class PeriodicTaskScheduler {
  public:
   explicit PeriodicTaskScheduler() = default;
@@ -79,8 +90,11 @@ class PeriodicTaskScheduler {
     }
   }
 
-  // Get global valid task number in the Timer
-  size_t TEST_GetValidTaskNum() const {
+  // Get global valid task number, of all the DB instances using the Timer
+  size_t TEST_GetValidTaskNum() const;
+
+  // Get the number of functions (task batches) in the Timer
+  size_t TEST_GetTimerTaskNum() const {
     if (timer_ != nullptr) {
       return timer_->TEST_GetPendingTaskNum();
     }
@@ -98,14 +112,32 @@ class PeriodicTaskScheduler {
   // default global Timer instance
   static Timer* Default();
 
+  // The tasks sharing a timer function, defined in the .cc file
+  struct TaskBatch;
+  // A batch is identified by its timer, task type, period and start slot
+  using TaskBatchKey =
+      std::tuple<Timer*, PeriodicTaskType, uint64_t, uint64_t>;
+
+  // The task batches of all the schedulers, protected by `timer_mutex`
+  static std::map<TaskBatchKey, std::shared_ptr<TaskBatch>>& TaskBatches();
+
   // Internal structure to store task information
   struct TaskInfo {
-    TaskInfo(std::string _name, uint64_t _repeat_every_sec)
-        : name(std::move(_name)), repeat_every_sec(_repeat_every_sec) {}
-    std::string name;
+    TaskInfo(std::shared_ptr<TaskBatch> _batch, uint64_t _id,
+             uint64_t _repeat_every_sec)
+        : batch(std::move(_batch)),
+          id(_id),
+          repeat_every_sec(_repeat_every_sec) {}
+    std::shared_ptr<TaskBatch> batch;
+    // The id of the task in its batch
+    uint64_t id;
     uint64_t repeat_every_sec;
   };
 
+  // Removes the task from its batch, and the batch from the timer once it's
+  // empty. Must be called with the global `timer_mutex` held.
+  void RemoveTask(const TaskInfo& task_info);
+
   // Internal tasks map
   std::map<PeriodicTaskType, TaskInfo> tasks_map_;
 
@@ -117,6 +149,7 @@ class PeriodicTaskScheduler {
   inline static uint64_t id_;
 
   static constexpr uint64_t kMicrosInSecond = 1000U * 1000U;
+  static constexpr uint64_t kNumSlotsPerPeriod = 8U;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -206,6 +206,108 @@ TEST_F(PeriodicTaskSchedulerTest, MultiInstances) {
   }
 }
 
+TEST_F(PeriodicTaskSchedulerTest, BatchedTasks) {
+  constexpr int kPeriodSec = 5;
+  const int kInstanceNum = 20;
+
+  Close();
+  Options options;
+  options.stats_dump_period_sec = kPeriodSec;
+  options.stats_persist_period_sec = kPeriodSec;
+  options.refresh_options_sec = 0;
+  options.create_if_missing = true;
+  options.env = mock_env_.get();
+
+  int dump_st_counter = 0;
+  SyncPoint::GetInstance()->SetCallBack("DBImpl::DumpStats:2",
+                                        [&](void*) { dump_st_counter++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  auto dbs = std::vector<DB*>(kInstanceNum);
+  for (int i = 0; i < kInstanceNum; i++) {
+    ASSERT_OK(
+        DB::Open(options, test::PerThreadDBPath(std::to_string(i)), &(dbs[i])));
+  }
+
+  auto dbi = static_cast_with_check<DBImpl>(dbs[kInstanceNum - 1]);
+  const PeriodicTaskScheduler& scheduler = dbi->TEST_GetPeriodicTaskScheduler();
+  ASSERT_EQ(kInstanceNum * 3, scheduler.TEST_GetValidTaskNum());
+  // The tasks of a type and period share at most one timer function per slot
+  // (the info log is flushed every 10 seconds)
+  ASSERT_LE(scheduler.TEST_GetTimerTaskNum(),
+            static_cast<size_t>(2 * kPeriodSec + 8));
+
+  dbi->TEST_WaitForPeriodicTaskRun(
+      [&] { mock_clock_->MockSleepForSeconds(kPeriodSec - 1); });
+  ASSERT_EQ(kInstanceNum, dump_st_counter);
+
+  // The remaining tasks keep running once half of the dbs are closed
+  int half = kInstanceNum / 2;
+  for (int i = 0; i < half; i++) {
+    ASSERT_OK(dbs[i]->Close());
+    delete dbs[i];
+  }
+  ASSERT_EQ((kInstanceNum - half) * 3, scheduler.TEST_GetValidTaskNum());
+
+  dbi->TEST_WaitForPeriodicTaskRun(
+      [&] { mock_clock_->MockSleepForSeconds(kPeriodSec); });
+  ASSERT_EQ(kInstanceNum + kInstanceNum - half, dump_st_counter);
+
+  // The empty batches are removed from the timer
+  for (int i = half; i < kInstanceNum - 1; i++) {
+    ASSERT_OK(dbs[i]->Close());
+    delete dbs[i];
+  }
+  ASSERT_EQ(3, scheduler.TEST_GetValidTaskNum());
+  ASSERT_EQ(3, scheduler.TEST_GetTimerTaskNum());
+
+  ASSERT_OK(dbi->Close());
+  delete dbi;
+}
+
+TEST_F(PeriodicTaskSchedulerTest, SkipIdleInfoLogFlush) {
+  constexpr int kPeriodSec = 10;  // the info log flush period
+  Close();
+  Options options;
+  options.stats_dump_period_sec = 0;
+  options.stats_persist_period_sec = 0;
+  options.refresh_options_sec = 0;
+  options.create_if_missing = true;
+  options.env = mock_env_.get();
+
+  int flush_info_log_counter = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::FlushInfoLog:StartRunning",
+      [&](void*) { flush_info_log_counter++; });
+  int skip_counter = 0;
+  SyncPoint::GetInstance()->SetCallBack("DBImpl::FlushInfoLog:Skip",
+                                        [&](void*) { skip_counter++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  Reopen(options);
+
+  dbfull()->TEST_WaitForPeriodicTaskRun(
+      [&] { mock_clock_->MockSleepForSeconds(kPeriodSec - 1); });
+  ASSERT_EQ(1, flush_info_log_counter);
+  ASSERT_EQ(0, skip_counter);
+
+  // Nothing was logged
+  dbfull()->TEST_WaitForPeriodicTaskRun(
+      [&] { mock_clock_->MockSleepForSeconds(kPeriodSec); });
+  ASSERT_EQ(2, flush_info_log_counter);
+  ASSERT_EQ(1, skip_counter);
+
+  // The flush is logged
+  ASSERT_OK(Put("foo", "bar"));
+  ASSERT_OK(Flush());
+  dbfull()->TEST_WaitForPeriodicTaskRun(
+      [&] { mock_clock_->MockSleepForSeconds(kPeriodSec); });
+  ASSERT_EQ(3, flush_info_log_counter);
+  ASSERT_EQ(1, skip_counter);
+
+  Close();
+}
+
 TEST_F(PeriodicTaskSchedulerTest, MultiEnv) {
   constexpr int kDumpPeriodSec = 5;
   constexpr int kPersistPeriodSec = 10;
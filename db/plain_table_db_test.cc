@@ -1257,6 +1257,50 @@ static std::string Key(int i) {
   return std::string(buf);
 }
 
+TEST_P(PlainTableDBTest, MultiGet) {
+  for (int total_order = 0; total_order <= 1; total_order++) {
+    for (int bloom_bits = 0; bloom_bits <= 10; bloom_bits += 10) {
+      Options options = CurrentOptions();
+      options.create_if_missing = true;
+      PlainTableOptions plain_table_options;
+      plain_table_options.user_key_len = 16;
+      plain_table_options.bloom_bits_per_key = bloom_bits;
+      plain_table_options.hash_table_ratio = total_order ? 0 : 0.75;
+      plain_table_options.index_sparseness = 2;
+      if (total_order) {
+        options.prefix_extractor.reset();
+      }
+      options.table_factory.reset(NewPlainTableFactory(plain_table_options));
+      DestroyAndReopen(&options);
+
+      for (int i = 0; i < 100; i++) {
+        ASSERT_OK(Put(Key(i * 2), "v" + std::to_string(i)));
+      }
+      ASSERT_OK(dbfull()->TEST_FlushMemTable());
+
+      std::vector<std::string> key_strs;
+      for (int i = 0; i < 60; i++) {
+        // Odd keys were never written
+        key_strs.push_back(Key(i * 3));
+      }
+      std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+      std::vector<PinnableSlice> values(keys.size());
+      std::vector<Status> statuses(keys.size());
+      dbfull()->MultiGet(ReadOptions(), dbfull()->DefaultColumnFamily(),
+                         keys.size(), keys.data(), values.data(),
+                         statuses.data());
+      for (size_t i = 0; i < keys.size(); i++) {
+        if (i % 2 == 0) {
+          ASSERT_OK(statuses[i]);
+          ASSERT_EQ("v" + std::to_string(i * 3 / 2), values[i].ToString());
+        } else {
+          ASSERT_TRUE(statuses[i].IsNotFound());
+        }
+      }
+    }
+  }
+}
+
 TEST_P(PlainTableDBTest, CompactionTrigger) {
   Options options = CurrentOptions();
   options.write_buffer_size = 120 << 10;  // 120KB
@@ -1338,6 +1382,76 @@ TEST_P(PlainTableDBTest, AdaptiveTable) {
   ASSERT_NE("v5", Get("3000000000000bar"));
 }
 
+TEST_P(PlainTableDBTest, AdaptiveTablePerLevelWriter) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  std::shared_ptr<TableFactory> block_based_factory(
+      NewBlockBasedTableFactory());
+  std::shared_ptr<TableFactory> plain_table_factory(NewPlainTableFactory());
+  // Write plain tables to L0 and block based tables everywhere else.
+  options.table_factory.reset(NewAdaptiveTableFactory(
+      block_based_factory, block_based_factory, plain_table_factory,
+      nullptr /* cuckoo_table_factory */,
+      {plain_table_factory, block_based_factory}));
+  DestroyAndReopen(&options);
+
+  auto is_plain_table = [](const std::shared_ptr<const TableProperties>& tp) {
+    return tp->user_collected_properties.count(
+               PlainTablePropertyNames::kEncodingType) > 0;
+  };
+
+  ASSERT_OK(Put("1000000000000foo", "v1"));
+  ASSERT_OK(Put("0000000000000bar", "v2"));
+  ASSERT_OK(dbfull()->TEST_FlushMemTable());
+  ASSERT_EQ("1", FilesPerLevel());
+
+  TablePropertiesCollection ptc;
+  ASSERT_OK(dbfull()->GetPropertiesOfAllTables(&ptc));
+  ASSERT_EQ(1U, ptc.size());
+  ASSERT_TRUE(is_plain_table(ptc.begin()->second));
+
+  ASSERT_OK(dbfull()->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("v1", Get("1000000000000foo"));
+  ASSERT_EQ("v2", Get("0000000000000bar"));
+
+  ptc.clear();
+  ASSERT_OK(dbfull()->GetPropertiesOfAllTables(&ptc));
+  ASSERT_EQ(1U, ptc.size());
+  ASSERT_FALSE(is_plain_table(ptc.begin()->second));
+
+  Reopen(&options);
+  ASSERT_EQ("v1", Get("1000000000000foo"));
+  ASSERT_EQ("v2", Get("0000000000000bar"));
+}
+
+TEST_P(PlainTableDBTest, AdaptiveTableValidatesWriters) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.prefix_extractor.reset();
+  // A hash index needs a prefix extractor
+  BlockBasedTableOptions table_options;
+  table_options.index_type = BlockBasedTableOptions::kHashSearch;
+  std::shared_ptr<TableFactory> hash_index_factory(
+      NewBlockBasedTableFactory(table_options));
+
+  options.table_factory.reset(NewAdaptiveTableFactory(
+      nullptr /* table_factory_to_write */,
+      nullptr /* block_based_table_factory */,
+      nullptr /* plain_table_factory */, nullptr /* cuckoo_table_factory */,
+      {nullptr, hash_index_factory}));
+  ASSERT_TRUE(TryReopen(&options).IsInvalidArgument());
+
+  options.table_factory.reset(NewAdaptiveTableFactory(
+      nullptr /* table_factory_to_write */,
+      nullptr /* block_based_table_factory */,
+      nullptr /* plain_table_factory */, nullptr /* cuckoo_table_factory */,
+      {} /* table_factory_to_write_per_level */, hash_index_factory));
+  ASSERT_TRUE(TryReopen(&options).IsInvalidArgument());
+
+  options.table_factory.reset(NewAdaptiveTableFactory());
+  ASSERT_OK(TryReopen(&options));
+}
+
 INSTANTIATE_TEST_CASE_P(PlainTableDBTest, PlainTableDBTest, ::testing::Bool());
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,462 @@
+// Copyright (C) 2023 Speedb Ltd. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "db/shared_wal_impl.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include "db/log_reader.h"
+#include "file/filename.h"
+#include "file/sequence_file_reader.h"
+#include "file/writable_file_writer.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+Status SharedWal::Open(const SharedWalOptions& options, const std::string& dir,
+                       std::shared_ptr<SharedWal>* result) {
+  assert(result != nullptr);
+  auto shared_wal = std::make_shared<SharedWalImpl>(options, dir);
+  Status s = shared_wal->Init();
+  if (s.ok()) {
+    *result = std::move(shared_wal);
+  }
+  return s;
+}
+
+SharedWalImpl::SharedWalImpl(const SharedWalOptions& options,
+                             const std::string& dir)
+    : options_(options),
+      dir_(dir),
+      fs_(options.env->GetFileSystem()),
+      file_options_(EnvOptions()) {}
+
+SharedWalImpl::~SharedWalImpl() {
+  if (writer_ != nullptr) {
+    if (error_.ok()) {
+      writer_->file()->Sync(options_.use_fsync).PermitUncheckedError();
+    }
+    writer_->Close().PermitUncheckedError();
+  }
+  error_.PermitUncheckedError();
+}
+
+Status SharedWalImpl::Init() {
+  IOStatus s = fs_->CreateDirIfMissing(dir_, IOOptions(), nullptr);
+  if (s.ok()) {
+    s = fs_->NewDirectory(dir_, IOOptions(), &dir_obj_, nullptr);
+  }
+  std::vector<std::string> children;
+  if (s.ok()) {
+    s = fs_->GetChildren(dir_, IOOptions(), &children, nullptr);
+  }
+  if (!s.ok()) {
+    return static_cast<Status>(s);
+  }
+
+  std::vector<uint64_t> file_numbers;
+  for (const auto& child : children) {
+    uint64_t number;
+    FileType type;
+    if (ParseFileName(child, &number, &type) && type == kWalFile) {
+      file_numbers.push_back(number);
+    }
+  }
+  std::sort(file_numbers.begin(), file_numbers.end());
+
+  // The existing files are not written anymore, so they can be read without
+  // holding the mutex. They are read once, keeping the records of every db in
+  // memory until it's opened, rather than read again by every db.
+  uint64_t position = 0;
+  for (uint64_t file_number : file_numbers) {
+    auto& file_info = files_[file_number];
+    Status read_s = ReadFile(
+        file_number,
+        [&](const Slice& db_id, uint64_t log_number, const Slice& record) {
+          std::string db_id_str = db_id.ToString();
+          auto& max_log_number = file_info.max_log_numbers[db_id_str];
+          max_log_number = std::max(max_log_number, log_number);
+          indexed_records_[db_id_str].push_back(IndexedRecord{
+              file_number, position++, log_number, record.ToString()});
+        },
+        [&](const Status& corruption) {
+          if (corruption_.ok()) {
+            corruption_ = corruption;
+            corruption_file_number_ = file_number;
+            corruption_position_ = position;
+          }
+          // Keep indexing, the records after the corruption are still used
+          // with kSkipAnyCorruptedRecords
+          return true;
+        });
+    if (!read_s.ok()) {
+      return read_s;
+    }
+    current_file_number_ = file_number;
+  }
+  last_indexed_file_number_ = current_file_number_;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<Status>(NewFile());
+}
+
+void SharedWalImpl::ForgetDb(const std::string& db_id) {
+  std::vector<std::string> obsolete_files;
+  SetMinLogNumberToKeep(db_id, std::numeric_limits<uint64_t>::max(),
+                        &obsolete_files);
+  DeleteObsoleteFiles(obsolete_files);
+}
+
+uint64_t SharedWalImpl::GetNumSyncs() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_syncs_;
+}
+
+uint64_t SharedWalImpl::GetNumLiveFiles() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return files_.size();
+}
+
+IOStatus SharedWalImpl::AddRecord(const std::string& db_id,
+                                  uint64_t log_number, const Slice& record,
+                                  uint64_t* record_seqno) {
+  assert(record_seqno != nullptr);
+  std::string shared_record;
+  shared_record.reserve(db_id.size() + 2 * kMaxVarint64Length + record.size());
+  PutLengthPrefixedSlice(&shared_record, db_id);
+  PutVarint64(&shared_record, log_number);
+  shared_record.append(record.data(), record.size());
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!error_.ok()) {
+    return error_;
+  }
+  IOStatus s;
+  if (writer_->file()->GetFileSize() >= options_.max_file_size) {
+    s = SwitchFile(&lock);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  s = writer_->AddRecord(shared_record);
+  if (!s.ok()) {
+    error_ = s;
+    return s;
+  }
+  auto& max_log_number = files_[current_file_number_].max_log_numbers[db_id];
+  max_log_number = std::max(max_log_number, log_number);
+  *record_seqno = ++num_records_;
+  return s;
+}
+
+IOStatus SharedWalImpl::Sync(uint64_t record_seqno) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (num_synced_records_ < record_seqno) {
+    if (!error_.ok()) {
+      return error_;
+    }
+    if (syncing_) {
+      // The leader may not cover record_seqno, check again once it's done
+      sync_cv_.wait(lock);
+      continue;
+    }
+
+    // Become the leader and sync the records of all the dbs appended so far
+    syncing_ = true;
+    const uint64_t num_records = num_records_;
+    WritableFileWriter* file = writer_->file();
+    IOStatus s;
+    if (file->writable_file()->IsSyncThreadSafe()) {
+      // The records are flushed by AddRecord(), so the other dbs may keep
+      // appending during the sync
+      lock.unlock();
+      s = file->SyncWithoutFlush(options_.use_fsync);
+      lock.lock();
+    } else {
+      s = file->Sync(options_.use_fsync);
+    }
+    syncing_ = false;
+    ++num_syncs_;
+    if (s.ok()) {
+      num_synced_records_ = std::max(num_synced_records_, num_records);
+    } else {
+      error_ = s;
+    }
+    sync_cv_.notify_all();
+  }
+  return IOStatus::OK();
+}
+
+Status SharedWalImpl::OpenDb(const std::string& db_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!open_dbs_.insert(db_id).second) {
+    return Status::InvalidArgument(
+        "A db with the same identity already uses the shared WAL", db_id);
+  }
+  return Status::OK();
+}
+
+void SharedWalImpl::CloseDb(const std::string& db_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  open_dbs_.erase(db_id);
+}
+
+Status SharedWalImpl::ReadRecords(const std::string& db_id,
+                                  uint64_t min_log_number,
+                                  WALRecoveryMode recovery_mode,
+                                  DbRecords* records) {
+  assert(records != nullptr);
+  std::vector<uint64_t> file_numbers;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Status s =
+        GetIndexedRecords(db_id, min_log_number, recovery_mode, records);
+    if (!s.ok()) {
+      return s;
+    }
+    // Reached when a db is reopened by the process that wrote its records.
+    // Start a new file so that all the files to read are immutable.
+    auto& current_file_info = files_[current_file_number_];
+    if (current_file_info.max_log_numbers.count(db_id) > 0) {
+      if (!error_.ok()) {
+        return static_cast<Status>(error_);
+      }
+      IOStatus io_s = SwitchFile(&lock);
+      if (!io_s.ok()) {
+        return static_cast<Status>(io_s);
+      }
+    }
+    for (auto iter = files_.upper_bound(last_indexed_file_number_);
+         iter != files_.end(); ++iter) {
+      auto db_iter = iter->second.max_log_numbers.find(db_id);
+      if (db_iter != iter->second.max_log_numbers.end() &&
+          db_iter->second >= min_log_number) {
+        file_numbers.push_back(iter->first);
+      }
+    }
+  }
+
+  // The files written by this process since Init(). They are not deleted
+  // while read: they hold records of db_id that it did not release yet.
+  bool stopped = false;
+  for (uint64_t file_number : file_numbers) {
+    Status corruption;
+    Status s = ReadFile(
+        file_number,
+        [&](const Slice& record_db_id, uint64_t log_number,
+            const Slice& record) {
+          if (record_db_id == db_id && log_number >= min_log_number) {
+            (*records)[log_number].emplace_back(record.ToString());
+          }
+        },
+        [&](const Status& file_corruption) {
+          if (recovery_mode == WALRecoveryMode::kSkipAnyCorruptedRecords) {
+            return true;
+          }
+          corruption = file_corruption;
+          return false;
+        });
+    if (s.ok() && !corruption.ok()) {
+      if (recovery_mode == WALRecoveryMode::kPointInTimeRecovery) {
+        // Stop the replay at the first corruption
+        stopped = true;
+      } else {
+        s = corruption;
+      }
+    }
+    if (!s.ok() || stopped) {
+      return s;
+    }
+  }
+  return Status::OK();
+}
+
+void SharedWalImpl::SetMinLogNumberToKeep(
+    const std::string& db_id, uint64_t min_log_number,
+    std::vector<std::string>* obsolete_files) {
+  assert(obsolete_files != nullptr);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& db_min_log_number = min_log_numbers_[db_id];
+  if (min_log_number <= db_min_log_number) {
+    return;
+  }
+  db_min_log_number = min_log_number;
+  auto iter = indexed_records_.find(db_id);
+  if (iter != indexed_records_.end()) {
+    auto& db_records = iter->second;
+    db_records.erase(
+        std::remove_if(db_records.begin(), db_records.end(),
+                       [min_log_number](const IndexedRecord& indexed_record) {
+                         return indexed_record.log_number < min_log_number;
+                       }),
+        db_records.end());
+    if (db_records.empty()) {
+      indexed_records_.erase(iter);
+    }
+  }
+  RemoveObsoleteFiles(obsolete_files);
+}
+
+void SharedWalImpl::DeleteObsoleteFiles(
+    const std::vector<std::string>& obsolete_files) {
+  for (const auto& fname : obsolete_files) {
+    fs_->DeleteFile(fname, IOOptions(), nullptr).PermitUncheckedError();
+  }
+}
+
+Status SharedWalImpl::ReadFile(
+    uint64_t file_number, const RecordHandler& handler,
+    const CorruptionHandler& corruption_handler) const {
+  struct LogReporter : public log::Reader::Reporter {
+    const CorruptionHandler* handler;
+    bool stop = false;
+    void Corruption(size_t /*bytes*/, const Status& s) override {
+      if (!stop && !(*handler)(s)) {
+        stop = true;
+      }
+    }
+  };
+
+  const std::string fname = LogFileName(dir_, file_number);
+  std::unique_ptr<FSSequentialFile> file;
+  Status s = fs_->NewSequentialFile(
+      fname, fs_->OptimizeForLogRead(file_options_), &file, nullptr);
+  if (!s.ok()) {
+    return s;
+  }
+  std::unique_ptr<SequentialFileReader> file_reader(
+      new SequentialFileReader(std::move(file), fname));
+
+  LogReporter reporter;
+  reporter.handler = &corruption_handler;
+  log::Reader reader(nullptr /* info_log */, std::move(file_reader), &reporter,
+                     true /* checksum */, file_number);
+  // Only the last file of a crashed process may have a torn tail, as the
+  // other files were synced before starting the next one. The other
+  // corruptions are reported, and the reader skips them.
+  std::string scratch;
+  Slice shared_record;
+  while (reader.ReadRecord(&shared_record, &scratch,
+                           WALRecoveryMode::kTolerateCorruptedTailRecords) &&
+         !reporter.stop) {
+    Slice db_id;
+    uint64_t log_number;
+    if (!GetLengthPrefixedSlice(&shared_record, &db_id) ||
+        !GetVarint64(&shared_record, &log_number)) {
+      reporter.Corruption(shared_record.size(),
+                          Status::Corruption("Bad shared WAL record", fname));
+      continue;
+    }
+    handler(db_id, log_number, shared_record);
+  }
+  return Status::OK();
+}
+
+Status SharedWalImpl::GetIndexedRecords(const std::string& db_id,
+                                        uint64_t min_log_number,
+                                        WALRecoveryMode recovery_mode,
+                                        DbRecords* records) const {
+  auto iter = indexed_records_.find(db_id);
+  if (iter == indexed_records_.end()) {
+    return Status::OK();
+  }
+  for (const auto& indexed_record : iter->second) {
+    if (!corruption_.ok()) {
+      if (recovery_mode == WALRecoveryMode::kPointInTimeRecovery &&
+          indexed_record.position >= corruption_position_) {
+        // The corrupted record may be one of the db, so the following ones
+        // are not replayed
+        break;
+      }
+      if ((recovery_mode == WALRecoveryMode::kTolerateCorruptedTailRecords ||
+           recovery_mode == WALRecoveryMode::kAbsoluteConsistency) &&
+          indexed_record.file_number >= corruption_file_number_) {
+        return corruption_;
+      }
+    }
+    if (indexed_record.log_number >= min_log_number) {
+      (*records)[indexed_record.log_number].push_back(indexed_record.record);
+    }
+  }
+  return Status::OK();
+}
+
+IOStatus SharedWalImpl::NewFile() {
+  const uint64_t file_number = current_file_number_ + 1;
+  const std::string fname = LogFileName(dir_, file_number);
+  std::unique_ptr<FSWritableFile> file;
+  IOStatus s = fs_->NewWritableFile(
+      fname, fs_->OptimizeForLogWrite(file_options_, DBOptions()), &file,
+      nullptr);
+  if (s.ok()) {
+    s = dir_obj_->FsyncWithDirOptions(
+        IOOptions(), nullptr,
+        DirFsyncOptions(DirFsyncOptions::FsyncReason::kNewFileSynced));
+  }
+  if (!s.ok()) {
+    error_ = s;
+    return s;
+  }
+  std::unique_ptr<WritableFileWriter> file_writer(
+      new WritableFileWriter(std::move(file), fname, file_options_));
+  writer_.reset(new log::Writer(std::move(file_writer), file_number,
+                                false /* recycle_log_files */));
+  current_file_number_ = file_number;
+  files_[file_number];
+  return s;
+}
+
+IOStatus SharedWalImpl::SwitchFile(std::unique_lock<std::mutex>* lock) {
+  // A leader syncing outside the mutex still uses the current file
+  sync_cv_.wait(*lock, [this] { return !syncing_; });
+  IOStatus s = writer_->file()->Sync(options_.use_fsync);
+  if (s.ok()) {
+    s = writer_->Close();
+  }
+  if (!s.ok()) {
+    error_ = s;
+    return s;
+  }
+  num_synced_records_ = num_records_;
+  sync_cv_.notify_all();
+  return NewFile();
+}
+
+bool SharedWalImpl::IsObsolete(const FileInfo& file_info) const {
+  for (const auto& db_entry : file_info.max_log_numbers) {
+    // The records of a db that did not report yet (e.g. not opened yet) are
+    // kept
+    auto iter = min_log_numbers_.find(db_entry.first);
+    if (iter == min_log_numbers_.end() || iter->second <= db_entry.second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void SharedWalImpl::RemoveObsoleteFiles(
+    std::vector<std::string>* obsolete_files) {
+  for (auto iter = files_.begin(); iter != files_.end();) {
+    if (iter->first != current_file_number_ && IsObsolete(iter->second)) {
+      obsolete_files->push_back(LogFileName(dir_, iter->first));
+      iter = files_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
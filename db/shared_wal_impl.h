@@ -0,0 +1,174 @@
+// Copyright (C) 2023 Speedb Ltd. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "db/log_writer.h"
+#include "rocksdb/file_system.h"
+#include "rocksdb/options.h"
+#include "rocksdb/shared_wal.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A shared log record is the identity of the db (length prefixed), the number
+// of the db's WAL file it was written with (varint64) and the db's WAL record.
+// All SharedWalImpl public functions are thread-safe.
+class SharedWalImpl : public SharedWal {
+ public:
+  // The WAL records of a db, by the number of the db's WAL file they were
+  // written with, in write order
+  using DbRecords = std::map<uint64_t, std::vector<std::string>>;
+
+  SharedWalImpl(const SharedWalOptions& options, const std::string& dir);
+  ~SharedWalImpl() override;
+
+  // No copying allowed
+  SharedWalImpl(const SharedWalImpl&) = delete;
+  SharedWalImpl& operator=(const SharedWalImpl&) = delete;
+
+  // Scans the existing shared log files, indexing their records by db, and
+  // starts a new one
+  Status Init();
+
+  void ForgetDb(const std::string& db_id) override;
+  uint64_t GetNumSyncs() const override;
+  uint64_t GetNumLiveFiles() const override;
+
+  // Appends a WAL record of db_id written with its WAL file log_number.
+  // *record_seqno is set to the position of the record, to be passed to
+  // Sync().
+  IOStatus AddRecord(const std::string& db_id, uint64_t log_number,
+                     const Slice& record, uint64_t* record_seqno);
+
+  // Returns once the records up to record_seqno are synced. A single caller
+  // (the leader) syncs the records appended by all the dbs so far, while the
+  // others wait for it.
+  IOStatus Sync(uint64_t record_seqno);
+
+  // Registers db_id as opened by a db. Fails with InvalidArgument if another
+  // open db has the same identity (e.g. a copy of a db), as both would replay
+  // and release the same records.
+  Status OpenDb(const std::string& db_id);
+  // Undoes a successful OpenDb()
+  void CloseDb(const std::string& db_id);
+
+  // Reads the records of db_id written with WAL files >= min_log_number.
+  // The shared log is a single stream, so a corrupted record may belong to
+  // any db:
+  // - kPointInTimeRecovery stops at the first corruption of the stream.
+  // - kTolerateCorruptedTailRecords and kAbsoluteConsistency fail if the db
+  //   has records in or after the corrupted file.
+  // - kSkipAnyCorruptedRecords skips the corrupted records.
+  // The torn tail of the last file written by a crashed process is never a
+  // corruption, as the records of all the dbs share it.
+  Status ReadRecords(const std::string& db_id, uint64_t min_log_number,
+                     WALRecoveryMode recovery_mode, DbRecords* records);
+
+  // Records that db_id no longer needs its records written with WAL files
+  // older than min_log_number. The shared log files no db needs anymore are
+  // appended to obsolete_files and must be deleted by the caller with
+  // DeleteObsoleteFiles().
+  void SetMinLogNumberToKeep(const std::string& db_id, uint64_t min_log_number,
+                             std::vector<std::string>* obsolete_files);
+
+  void DeleteObsoleteFiles(const std::vector<std::string>& obsolete_files);
+
+ private:
+  struct FileInfo {
+    // The highest WAL file number of every db with records in the file
+    std::unordered_map<std::string, uint64_t> max_log_numbers;
+  };
+
+  // A record found by Init()
+  struct IndexedRecord {
+    uint64_t file_number;
+    // Position of the record in the scanned files
+    uint64_t position;
+    uint64_t log_number;
+    std::string record;
+  };
+
+  using RecordHandler = std::function<void(
+      const Slice& db_id, uint64_t log_number, const Slice& record)>;
+  // Returns whether to keep reading after the corruption
+  using CorruptionHandler = std::function<bool(const Status& s)>;
+
+  // Reads the records of a file, calling corruption_handler for every
+  // corruption but its torn tail
+  Status ReadFile(uint64_t file_number, const RecordHandler& handler,
+                  const CorruptionHandler& corruption_handler) const;
+
+  // Must be called with mutex_ held
+  IOStatus NewFile();
+  // Syncs and closes the current file and starts a new one. Must be called
+  // with mutex_ held through lock.
+  IOStatus SwitchFile(std::unique_lock<std::mutex>* lock);
+  // Must be called with mutex_ held
+  bool IsObsolete(const FileInfo& file_info) const;
+  // Must be called with mutex_ held
+  void RemoveObsoleteFiles(std::vector<std::string>* obsolete_files);
+  // Must be called with mutex_ held
+  Status GetIndexedRecords(const std::string& db_id, uint64_t min_log_number,
+                           WALRecoveryMode recovery_mode,
+                           DbRecords* records) const;
+
+  const SharedWalOptions options_;
+  const std::string dir_;
+  const std::shared_ptr<FileSystem> fs_;
+  const FileOptions file_options_;
+  std::unique_ptr<FSDirectory> dir_obj_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable sync_cv_;
+  // All the shared log files, including the current one
+  std::map<uint64_t, FileInfo> files_;
+  uint64_t current_file_number_ = 0;
+  std::unique_ptr<log::Writer> writer_;
+  uint64_t num_records_ = 0;
+  uint64_t num_synced_records_ = 0;
+  bool syncing_ = false;
+  uint64_t num_syncs_ = 0;
+  // Once an append or a sync fails, the shared log stops accepting writes
+  IOStatus error_;
+  // The min WAL file number reported by every db, see SetMinLogNumberToKeep()
+  std::unordered_map<std::string, uint64_t> min_log_numbers_;
+  // The dbs registered with OpenDb()
+  std::unordered_set<std::string> open_dbs_;
+
+  // The records of the files scanned by Init(), by db, so that every db reads
+  // them from memory rather than scanning all the files again. The records a
+  // db released with SetMinLogNumberToKeep() are dropped.
+  std::unordered_map<std::string, std::vector<IndexedRecord>>
+      indexed_records_;
+  // The last file scanned by Init(), the files after it are written by this
+  // process
+  uint64_t last_indexed_file_number_ = 0;
+  // The first corruption found by Init(), in corruption_file_number_ before
+  // the record at corruption_position_
+  Status corruption_;
+  uint64_t corruption_file_number_ = 0;
+  uint64_t corruption_position_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,377 @@
+// Copyright (C) 2023 Speedb Ltd. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rocksdb/shared_wal.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "db/db_impl/db_impl.h"
+#include "db/shared_wal_impl.h"
+#include "file/file_util.h"
+#include "file/filename.h"
+#include "rocksdb/db.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class SharedWalTest : public testing::Test {
+ public:
+  SharedWalTest()
+      : env_(Env::Default()),
+        shared_wal_dir_(test::PerThreadDBPath("shared_wal_test_log")) {
+    EXPECT_OK(DestroyDir(env_, shared_wal_dir_));
+    for (int i = 0; i < 3; ++i) {
+      dbnames_.push_back(
+          test::PerThreadDBPath("shared_wal_test" + std::to_string(i)));
+    }
+  }
+
+  ~SharedWalTest() override {
+    CloseDbs();
+    Options options;
+    for (const auto& dbname : dbnames_) {
+      EXPECT_OK(DestroyDB(dbname, options));
+    }
+    shared_wal_.reset();
+    EXPECT_OK(DestroyDir(env_, shared_wal_dir_));
+  }
+
+  void OpenSharedWal(uint64_t max_file_size = 64 << 20) {
+    SharedWalOptions shared_wal_options;
+    shared_wal_options.env = env_;
+    shared_wal_options.max_file_size = max_file_size;
+    ASSERT_OK(
+        SharedWal::Open(shared_wal_options, shared_wal_dir_, &shared_wal_));
+  }
+
+  SharedWalImpl* shared_wal_impl() {
+    return static_cast_with_check<SharedWalImpl>(shared_wal_.get());
+  }
+
+  Options GetOptions() {
+    Options options;
+    options.create_if_missing = true;
+    options.env = env_;
+    options.shared_wal = shared_wal_;
+    // Keep the records in the memtables on close, so that they are recovered
+    // from the shared log
+    options.avoid_flush_during_shutdown = true;
+    return options;
+  }
+
+  void OpenDbs() {
+    Options options = GetOptions();
+    for (const auto& dbname : dbnames_) {
+      DB* db = nullptr;
+      ASSERT_OK(DB::Open(options, dbname, &db));
+      dbs_.emplace_back(db);
+    }
+  }
+
+  void CloseDbs() {
+    for (auto& db : dbs_) {
+      EXPECT_OK(db->Close());
+    }
+    dbs_.clear();
+  }
+
+  // Writes keys [from, to) to every db
+  void Put(int from, int to, bool sync) {
+    WriteOptions write_options;
+    write_options.sync = sync;
+    for (int key = from; key < to; ++key) {
+      for (size_t i = 0; i < dbs_.size(); ++i) {
+        ASSERT_OK(dbs_[i]->Put(write_options, "key" + std::to_string(key),
+                               "val" + std::to_string(i)));
+      }
+    }
+  }
+
+  // Flushes the db and waits for the obsolete files to be found
+  void Flush(DB* db) {
+    ASSERT_OK(db->Flush(FlushOptions()));
+    ASSERT_OK(static_cast_with_check<DBImpl>(db)->TEST_WaitForBackgroundWork());
+  }
+
+  void Verify(int from, int to) {
+    for (size_t i = 0; i < dbs_.size(); ++i) {
+      for (int key = from; key < to; ++key) {
+        std::string value;
+        ASSERT_OK(
+            dbs_[i]->Get(ReadOptions(), "key" + std::to_string(key), &value));
+        ASSERT_EQ("val" + std::to_string(i), value);
+      }
+    }
+  }
+
+  uint64_t GetWalBytesOfDb(const std::string& dbname) {
+    std::vector<std::string> children;
+    EXPECT_OK(env_->GetChildren(dbname, &children));
+    uint64_t total_size = 0;
+    for (const auto& child : children) {
+      uint64_t number;
+      FileType type;
+      if (ParseFileName(child, &number, &type) && type == kWalFile) {
+        uint64_t size = 0;
+        EXPECT_OK(env_->GetFileSize(dbname + "/" + child, &size));
+        total_size += size;
+      }
+    }
+    return total_size;
+  }
+
+  Env* env_;
+  const std::string shared_wal_dir_;
+  std::vector<std::string> dbnames_;
+  std::shared_ptr<SharedWal> shared_wal_;
+  std::vector<std::unique_ptr<DB>> dbs_;
+};
+
+TEST_F(SharedWalTest, RecordsPerDb) {
+  OpenSharedWal();
+  auto* shared_wal = shared_wal_impl();
+  uint64_t record_seqno = 0;
+  ASSERT_OK(shared_wal->AddRecord("db0", 5, "a", &record_seqno));
+  ASSERT_OK(shared_wal->AddRecord("db1", 3, "b", &record_seqno));
+  ASSERT_OK(shared_wal->AddRecord("db0", 6, "c", &record_seqno));
+  ASSERT_OK(shared_wal->AddRecord("db0", 6, "d", &record_seqno));
+  ASSERT_EQ(4U, record_seqno);
+  ASSERT_OK(shared_wal->Sync(record_seqno));
+  ASSERT_EQ(1U, shared_wal->GetNumSyncs());
+  // Already synced
+  ASSERT_OK(shared_wal->Sync(2));
+  ASSERT_EQ(1U, shared_wal->GetNumSyncs());
+
+  SharedWalImpl::DbRecords records;
+  ASSERT_OK(shared_wal->ReadRecords(
+      "db0", 6, WALRecoveryMode::kPointInTimeRecovery, &records));
+  ASSERT_EQ(1U, records.size());
+  ASSERT_EQ(std::vector<std::string>({"c", "d"}), records[6]);
+  // Reading the records of a db in the current file started a new one
+  ASSERT_EQ(2U, shared_wal->GetNumLiveFiles());
+
+  // Reopening scans the existing files
+  shared_wal_.reset();
+  OpenSharedWal();
+  shared_wal = shared_wal_impl();
+  ASSERT_EQ(3U, shared_wal->GetNumLiveFiles());
+  records.clear();
+  ASSERT_OK(shared_wal->ReadRecords(
+      "db1", 0, WALRecoveryMode::kPointInTimeRecovery, &records));
+  ASSERT_EQ(1U, records.size());
+  ASSERT_EQ(std::vector<std::string>({"b"}), records[3]);
+
+  // The first file is kept until both dbs release their records, the second
+  // one is empty
+  std::vector<std::string> obsolete_files;
+  shared_wal->SetMinLogNumberToKeep("db0", 7, &obsolete_files);
+  ASSERT_EQ(1U, obsolete_files.size());
+  shared_wal->SetMinLogNumberToKeep("db1", 3, &obsolete_files);
+  ASSERT_EQ(1U, obsolete_files.size());
+  shared_wal->SetMinLogNumberToKeep("db1", 4, &obsolete_files);
+  // The current file is never obsolete
+  ASSERT_EQ(2U, obsolete_files.size());
+  shared_wal->DeleteObsoleteFiles(obsolete_files);
+  ASSERT_EQ(1U, shared_wal->GetNumLiveFiles());
+}
+
+TEST_F(SharedWalTest, CorruptedRecord) {
+  OpenSharedWal();
+  auto* shared_wal = shared_wal_impl();
+  uint64_t record_seqno = 0;
+  const std::string record_a(100, 'a');
+  ASSERT_OK(shared_wal->AddRecord("db0", 5, record_a, &record_seqno));
+  ASSERT_OK(shared_wal->AddRecord("db1", 3, std::string(100, 'b'),
+                                  &record_seqno));
+  const std::string record_c(100, 'c');
+  ASSERT_OK(shared_wal->AddRecord("db0", 6, record_c, &record_seqno));
+  shared_wal_.reset();
+
+  // Corrupt the record of db1: every physical record has a 7 bytes header,
+  // and the first one is 105 bytes long (the length prefixed db identity, the
+  // varint log number and the record)
+  ASSERT_OK(test::CorruptFile(env_, LogFileName(shared_wal_dir_, 1),
+                              112 + 7 + 50, 1, false /* verify_checksum */));
+  OpenSharedWal();
+  shared_wal = shared_wal_impl();
+
+  // The corrupted record may have been one of db0, so the replay stops there
+  SharedWalImpl::DbRecords records;
+  ASSERT_OK(shared_wal->ReadRecords(
+      "db0", 0, WALRecoveryMode::kPointInTimeRecovery, &records));
+  ASSERT_EQ(1U, records.size());
+  ASSERT_EQ(std::vector<std::string>({record_a}), records[5]);
+
+  records.clear();
+  ASSERT_OK(shared_wal->ReadRecords(
+      "db0", 0, WALRecoveryMode::kSkipAnyCorruptedRecords, &records));
+  ASSERT_EQ(2U, records.size());
+  ASSERT_EQ(std::vector<std::string>({record_c}), records[6]);
+
+  records.clear();
+  ASSERT_TRUE(shared_wal
+                  ->ReadRecords("db0", 0,
+                                WALRecoveryMode::kTolerateCorruptedTailRecords,
+                                &records)
+                  .IsCorruption());
+  ASSERT_TRUE(
+      shared_wal
+          ->ReadRecords("db0", 0, WALRecoveryMode::kAbsoluteConsistency,
+                        &records)
+          .IsCorruption());
+
+  // The records a db released are no longer read
+  std::vector<std::string> obsolete_files;
+  shared_wal->SetMinLogNumberToKeep("db0", 6, &obsolete_files);
+  records.clear();
+  ASSERT_OK(shared_wal->ReadRecords(
+      "db0", 0, WALRecoveryMode::kSkipAnyCorruptedRecords, &records));
+  ASSERT_EQ(1U, records.size());
+  ASSERT_EQ(1U, records.count(6));
+}
+
+TEST_F(SharedWalTest, SameDbIdentity) {
+  OpenSharedWal();
+  OpenDbs();
+  Put(0, 10, false /* sync */);
+
+  // A copy of a db has the same identity
+  const std::string copy_dbname = test::PerThreadDBPath("shared_wal_test_copy");
+  ASSERT_OK(DestroyDB(copy_dbname, Options()));
+  std::string db_id;
+  ASSERT_OK(dbs_[0]->GetDbIdentity(db_id));
+  Options options = GetOptions();
+  options.shared_wal.reset();
+  {
+    DB* copy_db = nullptr;
+    ASSERT_OK(DB::Open(options, copy_dbname, &copy_db));
+    delete copy_db;
+  }
+  ASSERT_OK(WriteStringToFile(env_, db_id + "\n",
+                              IdentityFileName(copy_dbname), true /* sync */));
+  options.shared_wal = shared_wal_;
+  options.create_if_missing = false;
+  DB* db = nullptr;
+  ASSERT_TRUE(DB::Open(options, copy_dbname, &db).IsInvalidArgument());
+  ASSERT_EQ(nullptr, db);
+
+  // The failed open did not release the identity of the original db
+  ASSERT_TRUE(shared_wal_impl()->OpenDb(db_id).IsInvalidArgument());
+  CloseDbs();
+  ASSERT_OK(shared_wal_impl()->OpenDb(db_id));
+  shared_wal_impl()->CloseDb(db_id);
+  OpenDbs();
+  Verify(0, 10);
+  ASSERT_OK(DestroyDB(copy_dbname, Options()));
+}
+
+TEST_F(SharedWalTest, RecoverDbs) {
+  OpenSharedWal();
+  OpenDbs();
+  Put(0, 100, false /* sync */);
+  Put(100, 200, true /* sync */);
+  ASSERT_GT(shared_wal_impl()->GetNumSyncs(), 0U);
+  CloseDbs();
+  for (const auto& dbname : dbnames_) {
+    ASSERT_EQ(0U, GetWalBytesOfDb(dbname));
+  }
+
+  // Reopened by the same process
+  OpenDbs();
+  Verify(0, 200);
+  Put(200, 300, false /* sync */);
+  CloseDbs();
+
+  // Reopened by a new process
+  shared_wal_.reset();
+  OpenSharedWal();
+  OpenDbs();
+  Verify(0, 300);
+}
+
+TEST_F(SharedWalTest, DeleteObsoleteFiles) {
+  // Every record starts a new file
+  OpenSharedWal(1 /* max_file_size */);
+  OpenDbs();
+  Put(0, 10, false /* sync */);
+  ASSERT_GT(shared_wal_->GetNumLiveFiles(), 10U);
+
+  // A file is deleted once its db flushed the record
+  for (size_t i = 0; i + 1 < dbs_.size(); ++i) {
+    Flush(dbs_[i].get());
+  }
+  ASSERT_GE(shared_wal_->GetNumLiveFiles(), 10U);
+  Flush(dbs_.back().get());
+  ASSERT_EQ(1U, shared_wal_->GetNumLiveFiles());
+  Verify(0, 10);
+
+  // A db that is not open keeps its records
+  Put(10, 20, false /* sync */);
+  std::string db_id;
+  ASSERT_OK(dbs_.back()->GetDbIdentity(db_id));
+  ASSERT_OK(dbs_.back()->Close());
+  dbs_.pop_back();
+  for (auto& db : dbs_) {
+    Flush(db.get());
+  }
+  ASSERT_GE(shared_wal_->GetNumLiveFiles(), 10U);
+  shared_wal_->ForgetDb(db_id);
+  ASSERT_EQ(1U, shared_wal_->GetNumLiveFiles());
+}
+
+TEST_F(SharedWalTest, ConcurrentSyncWrites) {
+  OpenSharedWal();
+  OpenDbs();
+  constexpr int kNumWrites = 100;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < dbs_.size(); ++i) {
+    threads.emplace_back([this, i]() {
+      WriteOptions write_options;
+      write_options.sync = true;
+      for (int key = 0; key < kNumWrites; ++key) {
+        ASSERT_OK(dbs_[i]->Put(write_options, "key" + std::to_string(key),
+                               "val" + std::to_string(i)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // Every sync write waits for at most one sync
+  ASSERT_LE(shared_wal_->GetNumSyncs(), dbs_.size() * kNumWrites);
+  Verify(0, kNumWrites);
+
+  CloseDbs();
+  OpenDbs();
+  Verify(0, kNumWrites);
+}
+
+TEST_F(SharedWalTest, IncompatibleOptions) {
+  OpenSharedWal();
+  Options options = GetOptions();
+  options.manual_wal_flush = true;
+  DB* db = nullptr;
+  ASSERT_TRUE(DB::Open(options, dbnames_[0], &db).IsNotSupported());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
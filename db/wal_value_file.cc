@@ -0,0 +1,149 @@
+// Copyright (C) 2023 Speedb Ltd. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "db/wal_value_file.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "db/log_format.h"
+#include "file/random_access_file_reader.h"
+#include "test_util/sync_point.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+WalValueFile::WalValueFile(
+    uint64_t log_number, std::unique_ptr<RandomAccessFileReader>&& file_reader)
+    : log_number_(log_number), file_reader_(std::move(file_reader)) {}
+
+WalValueFile::~WalValueFile() = default;
+
+IOStatus WalValueFile::Open(FileSystem* fs, const FileOptions& file_options,
+                            const std::string& fname, uint64_t log_number,
+                            SystemClock* clock,
+                            std::shared_ptr<WalValueFile>* file) {
+  // The file grows while it is read, and its data is read from the page cache
+  // right after it is written
+  FileOptions read_options(file_options);
+  read_options.use_mmap_reads = false;
+  read_options.use_direct_reads = false;
+  std::unique_ptr<FSRandomAccessFile> raf;
+  IOStatus io_s = fs->NewRandomAccessFile(fname, read_options, &raf, nullptr);
+  if (io_s.ok()) {
+    file->reset(new WalValueFile(
+        log_number,
+        std::make_unique<RandomAccessFileReader>(std::move(raf), fname, clock)));
+  }
+  return io_s;
+}
+
+Status WalValueFile::Read(uint64_t offset, size_t size,
+                          std::string* value) const {
+  // The span of the value in the file, including the headers of the blocks
+  // that it crosses
+  size_t span = 0;
+  size_t left = size;
+  size_t block_offset = static_cast<size_t>(offset % log::kBlockSize);
+  while (true) {
+    const size_t n = std::min(left, log::kBlockSize - block_offset);
+    span += n;
+    left -= n;
+    if (left == 0) {
+      break;
+    }
+    span += log::kHeaderSize;
+    block_offset = log::kHeaderSize;
+  }
+
+  value->resize(span);
+  Slice result;
+  IOStatus io_s = file_reader_->Read(IOOptions(), offset, span, &result,
+                                     &(*value)[0], nullptr /* aligned_buf */);
+  TEST_SYNC_POINT_CALLBACK("WalValueFile::Read:Result", &result);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  if (result.size() != span) {
+    return Status::Corruption("Truncated WAL value in " +
+                              file_reader_->file_name());
+  }
+  if (result.data() != value->data()) {
+    memcpy(&(*value)[0], result.data(), span);
+  }
+
+  // Drop the block headers
+  if (span != size) {
+    char* dst = &(*value)[0];
+    const char* src = dst;
+    left = size;
+    block_offset = static_cast<size_t>(offset % log::kBlockSize);
+    while (true) {
+      const size_t n = std::min(left, log::kBlockSize - block_offset);
+      memmove(dst, src, n);
+      dst += n;
+      src += n;
+      left -= n;
+      if (left == 0) {
+        break;
+      }
+      src += log::kHeaderSize;
+      block_offset = log::kHeaderSize;
+    }
+    value->resize(size);
+  }
+  return Status::OK();
+}
+
+uint64_t WalValueFile::PhysicalOffset(uint64_t record_offset,
+                                      uint64_t payload_offset) {
+  // Follows log::Writer::AddRecord(): a block with no room for a header is
+  // padded, and every fragment starts with a header
+  uint64_t offset = record_offset;
+  uint64_t block_offset = offset % log::kBlockSize;
+  if (log::kBlockSize - block_offset < log::kHeaderSize) {
+    offset += log::kBlockSize - block_offset;
+    block_offset = 0;
+  }
+  offset += log::kHeaderSize;
+  block_offset += log::kHeaderSize;
+  const uint64_t avail = log::kBlockSize - block_offset;
+  if (payload_offset < avail) {
+    return offset + payload_offset;
+  }
+  // The rest is in the following blocks, after their header
+  payload_offset -= avail;
+  offset += avail;
+  const uint64_t block_payload = log::kBlockSize - log::kHeaderSize;
+  return offset + (payload_offset / block_payload) * log::kBlockSize +
+         log::kHeaderSize + payload_offset % block_payload;
+}
+
+void WalValueFile::EncodeRef(uint64_t log_number, uint64_t offset,
+                             uint64_t size, std::string* ref) {
+  ref->clear();
+  PutVarint64Varint64(ref, log_number, offset);
+  PutVarint64(ref, size);
+}
+
+Status WalValueFile::DecodeRef(Slice ref, uint64_t* log_number,
+                               uint64_t* offset, uint64_t* size) {
+  if (!GetVarint64(&ref, log_number) || !GetVarint64(&ref, offset) ||
+      !GetVarint64(&ref, size) || !ref.empty()) {
+    return Status::Corruption("Invalid WAL value reference");
+  }
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
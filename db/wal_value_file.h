@@ -0,0 +1,86 @@
+// Copyright (C) 2023 Speedb Ltd. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// With DBOptions::memtable_wal_value_threshold, the memtable entries of large
+// values don't hold a copy of the value but a reference to it in the WAL
+// record of its write batch (kTypeWalValueRef). WalValueFile reads these
+// values back from a WAL file that is still being written.
+//
+// A reference is the number of the WAL file (varint64), the file offset of the
+// value (varint64) and its size (varint64). Since the WAL records are split in
+// blocks of log::kBlockSize bytes, each starting with a fragment header, a
+// value may be split by the headers of the blocks it crosses.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "rocksdb/file_system.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class RandomAccessFileReader;
+
+class WalValueFile {
+ public:
+  WalValueFile(uint64_t log_number,
+               std::unique_ptr<RandomAccessFileReader>&& file_reader);
+  ~WalValueFile();
+
+  // No copying allowed
+  WalValueFile(const WalValueFile&) = delete;
+  void operator=(const WalValueFile&) = delete;
+
+  // Opens the WAL file fname, numbered log_number, for reading while it is
+  // written. The log writer must not use recyclable records, nor compression.
+  static IOStatus Open(FileSystem* fs, const FileOptions& file_options,
+                       const std::string& fname, uint64_t log_number,
+                       SystemClock* clock, std::shared_ptr<WalValueFile>* file);
+
+  uint64_t log_number() const { return log_number_; }
+
+  // Reads the size bytes of the value at offset into value
+  Status Read(uint64_t offset, size_t size, std::string* value) const;
+
+  // Returns the file offset of the byte at payload_offset in the payload of
+  // the record that was added to the WAL when its file size was record_offset
+  static uint64_t PhysicalOffset(uint64_t record_offset,
+                                 uint64_t payload_offset);
+
+  static void EncodeRef(uint64_t log_number, uint64_t offset, uint64_t size,
+                        std::string* ref);
+  static Status DecodeRef(Slice ref, uint64_t* log_number, uint64_t* offset,
+                          uint64_t* size);
+
+ private:
+  const uint64_t log_number_;
+  const std::unique_ptr<RandomAccessFileReader> file_reader_;
+};
+
+// Where the payload of a writer's batch went in the WAL, set by the write
+// group leader after a successful WAL write. The value at offset i of the
+// batch's data is at offset batch_offset + i of the payload of the WAL record
+// added at record_offset. file is null if the values of the batch may not be
+// referenced.
+struct WalValueLocation {
+  std::shared_ptr<WalValueFile> file;
+  uint64_t record_offset = 0;
+  uint64_t batch_offset = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
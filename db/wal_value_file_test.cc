@@ -0,0 +1,184 @@
+// Copyright (C) 2023 Speedb Ltd. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "db/wal_value_file.h"
+
+#include <memory>
+#include <string>
+
+#include "db/log_format.h"
+#include "db/log_writer.h"
+#include "file/writable_file_writer.h"
+#include "rocksdb/file_system.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class WalValueFileTest : public testing::Test {
+ public:
+  WalValueFileTest()
+      : fs_(FileSystem::Default()),
+        fname_(test::PerThreadDBPath("wal_value_file_test.log")),
+        rnd_(301) {
+    std::unique_ptr<FSWritableFile> file;
+    EXPECT_OK(fs_->NewWritableFile(fname_, FileOptions(), &file, nullptr));
+    std::unique_ptr<WritableFileWriter> file_writer(
+        new WritableFileWriter(std::move(file), fname_, FileOptions()));
+    writer_.reset(new log::Writer(std::move(file_writer), kLogNumber,
+                                  false /* recycle_log_files */));
+    EXPECT_OK(WalValueFile::Open(fs_.get(), FileOptions(), fname_, kLogNumber,
+                                 SystemClock::Default().get(), &file_));
+  }
+
+  ~WalValueFileTest() override {
+    EXPECT_OK(writer_->Close());
+    EXPECT_OK(fs_->DeleteFile(fname_, IOOptions(), nullptr));
+  }
+
+  // Adds a record of size random bytes, returning the file offset it was added
+  // at
+  uint64_t AddRecord(size_t size, std::string* payload) {
+    *payload = rnd_.RandomString(static_cast<int>(size));
+    const uint64_t record_offset = writer_->file()->GetFileSize();
+    EXPECT_OK(writer_->AddRecord(*payload));
+    return record_offset;
+  }
+
+  // Pads the file with records so that the next one is added at block_offset
+  // in its block
+  void PadTo(size_t block_offset) {
+    ASSERT_TRUE(block_offset == 0 || block_offset >= log::kHeaderSize);
+    const size_t current =
+        static_cast<size_t>(writer_->file()->GetFileSize() % log::kBlockSize);
+    if (current == block_offset) {
+      return;
+    }
+    std::string payload;
+    if (log::kBlockSize - current >= log::kHeaderSize) {
+      // Fill the current block
+      AddRecord(log::kBlockSize - current - log::kHeaderSize, &payload);
+    } else if (block_offset == 0) {
+      // The writer pads the current block, fill the next one
+      AddRecord(log::kBlockSize - log::kHeaderSize, &payload);
+    }
+    if (block_offset > 0) {
+      AddRecord(block_offset - log::kHeaderSize, &payload);
+    }
+    ASSERT_EQ(block_offset, writer_->file()->GetFileSize() % log::kBlockSize);
+  }
+
+  // Reads the size bytes at payload_offset in the payload of the record added
+  // at record_offset
+  void CheckValue(uint64_t record_offset, const std::string& payload,
+                  size_t payload_offset, size_t size) {
+    std::string value;
+    ASSERT_OK(file_->Read(
+        WalValueFile::PhysicalOffset(record_offset, payload_offset), size,
+        &value));
+    ASSERT_EQ(payload.substr(payload_offset, size), value);
+  }
+
+  static constexpr uint64_t kLogNumber = 7;
+
+  const std::shared_ptr<FileSystem> fs_;
+  const std::string fname_;
+  Random rnd_;
+  std::unique_ptr<log::Writer> writer_;
+  std::shared_ptr<WalValueFile> file_;
+};
+
+TEST_F(WalValueFileTest, RecordAtBlockEnd) {
+  // A block with just enough room for a header holds an empty fragment, the
+  // payload starts in the next block
+  PadTo(log::kBlockSize - log::kHeaderSize);
+  std::string payload;
+  uint64_t record_offset = AddRecord(1000, &payload);
+  ASSERT_EQ(record_offset + 2 * log::kHeaderSize,
+            WalValueFile::PhysicalOffset(record_offset, 0));
+  CheckValue(record_offset, payload, 0, payload.size());
+  CheckValue(record_offset, payload, 10, 100);
+
+  // A block with no room for a header is padded
+  PadTo(log::kBlockSize - log::kHeaderSize + 1);
+  record_offset = AddRecord(1000, &payload);
+  ASSERT_EQ(record_offset + log::kHeaderSize - 1 + log::kHeaderSize,
+            WalValueFile::PhysicalOffset(record_offset, 0));
+  CheckValue(record_offset, payload, 0, payload.size());
+}
+
+TEST_F(WalValueFileTest, ValueAtBlockEdges) {
+  PadTo(0);
+  std::string payload;
+  const uint64_t record_offset = AddRecord(3 * log::kBlockSize, &payload);
+  const size_t first_payload = log::kBlockSize - log::kHeaderSize;
+  // Ends exactly at the end of the first block
+  CheckValue(record_offset, payload, 100, first_payload - 100);
+  // Starts exactly at the start of the payload of the second block
+  CheckValue(record_offset, payload, first_payload, 100);
+  CheckValue(record_offset, payload, first_payload, first_payload);
+  // Crosses one block edge, and two
+  CheckValue(record_offset, payload, first_payload - 1, 2);
+  CheckValue(record_offset, payload, 100, first_payload + 100);
+  CheckValue(record_offset, payload, 100, 2 * first_payload);
+  // The last byte of the record
+  CheckValue(record_offset, payload, payload.size() - 1, 1);
+}
+
+TEST_F(WalValueFileTest, RandomValues) {
+  for (int i = 0; i < 200; ++i) {
+    std::string payload;
+    const uint64_t record_offset =
+        AddRecord(1 + rnd_.Uniform(3 * log::kBlockSize), &payload);
+    const size_t payload_offset =
+        rnd_.Uniform(static_cast<int>(payload.size()));
+    const size_t size =
+        1 + rnd_.Uniform(static_cast<int>(payload.size() - payload_offset));
+    CheckValue(record_offset, payload, payload_offset, size);
+  }
+}
+
+TEST_F(WalValueFileTest, TruncatedValue) {
+  std::string payload;
+  const uint64_t record_offset = AddRecord(1000, &payload);
+  std::string value;
+  ASSERT_TRUE(file_
+                  ->Read(WalValueFile::PhysicalOffset(record_offset, 0),
+                         payload.size() + 1, &value)
+                  .IsCorruption());
+}
+
+TEST_F(WalValueFileTest, EncodeDecodeRef) {
+  std::string ref;
+  WalValueFile::EncodeRef(kLogNumber, 1ULL << 40, 12345, &ref);
+  uint64_t log_number = 0;
+  uint64_t offset = 0;
+  uint64_t size = 0;
+  ASSERT_OK(WalValueFile::DecodeRef(ref, &log_number, &offset, &size));
+  ASSERT_EQ(kLogNumber, log_number);
+  ASSERT_EQ(1ULL << 40, offset);
+  ASSERT_EQ(12345U, size);
+  ref.push_back('x');
+  ASSERT_TRUE(
+      WalValueFile::DecodeRef(ref, &log_number, &offset, &size).IsCorruption());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -56,6 +56,7 @@
 #include "db/merge_context.h"
 #include "db/snapshot_impl.h"
 #include "db/trim_history_scheduler.h"
+#include "db/wal_value_file.h"
 #include "db/wide/wide_column_serialization.h"
 #include "db/write_batch_internal.h"
 #include "monitoring/perf_context_imp.h"
@@ -1768,6 +1769,10 @@ class MemTableInserter : public WriteBatch::Handler {
   bool post_info_created_;
   const WriteBatch::ProtectionInfo* prot_info_;
   size_t prot_info_idx_;
+  // Where the batch being inserted is in the WAL, if its large values are to
+  // be referenced there
+  const WalValueLocation* wal_value_location_;
+  const WriteBatch* wal_value_batch_;
 
   bool* has_valid_writes_;
   // On some (!) platforms just default creating
@@ -1882,6 +1887,8 @@ class MemTableInserter : public WriteBatch::Handler {
         post_info_created_(false),
         prot_info_(prot_info),
         prot_info_idx_(0),
+        wal_value_location_(nullptr),
+        wal_value_batch_(nullptr),
         has_valid_writes_(has_valid_writes),
         rebuilding_trx_(nullptr),
         rebuilding_trx_seq_(0),
@@ -1942,6 +1949,11 @@ class MemTableInserter : public WriteBatch::Handler {
     prot_info_ = prot_info;
     prot_info_idx_ = 0;
   }
+  void set_wal_value_location(const WalValueLocation* location,
+                              const WriteBatch* batch) {
+    wal_value_location_ = location->file != nullptr ? location : nullptr;
+    wal_value_batch_ = batch;
+  }
 
   SequenceNumber sequence() const { return sequence_; }
 
@@ -1995,6 +2007,26 @@ class MemTableInserter : public WriteBatch::Handler {
     return true;
   }
 
+  // Sets ref to the reference of value, a value of the batch being inserted,
+  // in the WAL. Returns false if the value is not in the WAL record.
+  bool GetWalValueRef(const Slice& value, std::string* ref) const {
+    assert(wal_value_location_ != nullptr);
+    const Slice contents = WriteBatchInternal::Contents(wal_value_batch_);
+    if (value.data() < contents.data() ||
+        value.data() + value.size() > contents.data() + contents.size()) {
+      return false;
+    }
+    const uint64_t payload_offset =
+        wal_value_location_->batch_offset +
+        static_cast<uint64_t>(value.data() - contents.data());
+    WalValueFile::EncodeRef(
+        wal_value_location_->file->log_number(),
+        WalValueFile::PhysicalOffset(wal_value_location_->record_offset,
+                                     payload_offset),
+        value.size(), ref);
+    return true;
+  }
+
   Status PutCFImpl(uint32_t column_family_id, const Slice& key,
                    const Slice& value, ValueType value_type,
                    const ProtectionInfoKVOS64* kv_prot_info) {
@@ -2031,10 +2063,34 @@ class MemTableInserter : public WriteBatch::Handler {
     // any kind of transactions including the ones that use seq_per_batch
     assert(!seq_per_batch_ || !moptions->inplace_update_support);
     if (!moptions->inplace_update_support) {
-      ret_status =
-          mem->Add(sequence_, value_type, key, value, kv_prot_info,
-                   concurrent_memtable_writes_, get_post_process_info(mem),
-                   hint_per_batch_ ? &GetHintMap()[mem] : nullptr);
+      std::string wal_value_ref;
+      if (wal_value_location_ != nullptr && value_type == kTypeValue &&
+          value.size() >= moptions->wal_value_threshold &&
+          GetWalValueRef(value, &wal_value_ref)) {
+        // The value is read from the WAL when needed
+        mem->AddWalValueRef(wal_value_location_->file, value.size());
+        if (kv_prot_info != nullptr) {
+          ProtectionInfoKVOS64 updated_kv_prot_info(*kv_prot_info);
+          updated_kv_prot_info.UpdateV(value, wal_value_ref);
+          updated_kv_prot_info.UpdateO(kTypeValue, kTypeWalValueRef);
+          ret_status = mem->Add(sequence_, kTypeWalValueRef, key,
+                                wal_value_ref, &updated_kv_prot_info,
+                                concurrent_memtable_writes_,
+                                get_post_process_info(mem),
+                                hint_per_batch_ ? &GetHintMap()[mem] : nullptr);
+        } else {
+          ret_status = mem->Add(sequence_, kTypeWalValueRef, key,
+                                wal_value_ref, nullptr /* kv_prot_info */,
+                                concurrent_memtable_writes_,
+                                get_post_process_info(mem),
+                                hint_per_batch_ ? &GetHintMap()[mem] : nullptr);
+        }
+      } else {
+        ret_status =
+            mem->Add(sequence_, value_type, key, value, kv_prot_info,
+                     concurrent_memtable_writes_, get_post_process_info(mem),
+                     hint_per_batch_ ? &GetHintMap()[mem] : nullptr);
+      }
     } else if (moptions->inplace_callback == nullptr ||
                value_type != kTypeValue) {
       assert(!concurrent_memtable_writes_);
@@ -2908,6 +2964,7 @@ Status WriteBatchInternal::InsertInto(
     SetSequence(w->batch, inserter.sequence());
     inserter.set_log_number_ref(w->log_ref);
     inserter.set_prot_info(w->batch->prot_info_.get());
+    inserter.set_wal_value_location(&w->wal_value_location, w->batch);
     w->status = w->batch->Iterate(&inserter);
     if (!w->status.ok()) {
       return w->status;
@@ -2938,6 +2995,7 @@ Status WriteBatchInternal::InsertInto(
   SetSequence(writer->batch, sequence);
   inserter.set_log_number_ref(writer->log_ref);
   inserter.set_prot_info(writer->batch->prot_info_.get());
+  inserter.set_wal_value_location(&writer->wal_value_location, writer->batch);
   Status s = writer->batch->Iterate(&inserter);
   assert(!seq_per_batch || batch_cnt != 0);
   assert(!seq_per_batch || inserter.sequence() - sequence == batch_cnt);
@@ -27,6 +27,7 @@
 #include "db/dbformat.h"
 #include "db/post_memtable_callback.h"
 #include "db/pre_release_callback.h"
+#include "db/wal_value_file.h"
 #include "db/write_callback.h"
 #include "monitoring/instrumented_mutex.h"
 #include "rocksdb/options.h"
@@ -136,6 +137,9 @@ class WriteThread {
     PostMemTableCallback* post_memtable_callback;
     uint64_t log_used;  // log number that this batch was inserted into
     uint64_t log_ref;   // log number that memtable insert should reference
+    // where the batch went in the WAL, for the memtable entries to reference
+    // its large values (see DBOptions::memtable_wal_value_threshold)
+    WalValueLocation wal_value_location;
     WriteCallback* callback;
     bool made_waitable;          // records lazy construction of mutex and cv
     std::atomic<uint8_t> state;  // write under StateMutex() or pre-link
@@ -373,6 +373,11 @@ class CompositeEnvWrapper : public CompositeEnv {
     return target_.env->LowerThreadPoolCPUPriority(pool, pri);
   }
 
+  Status SetThreadPoolCpuAffinity(Priority pool,
+                                  const std::vector<int>& cpus) override {
+    return target_.env->SetThreadPoolCpuAffinity(pool, cpus);
+  }
+
   Status GetThreadList(std::vector<ThreadStatus>* thread_list) override {
     return target_.env->GetThreadList(thread_list);
   }
@@ -407,6 +407,19 @@ class PosixEnv : public CompositeEnv {
     return Status::OK();
   }
 
+  Status SetThreadPoolCpuAffinity(Priority pool,
+                                  const std::vector<int>& cpus) override {
+    assert(pool >= Priority::BOTTOM && pool <= Priority::HIGH);
+#ifdef OS_LINUX
+    return thread_pools_[pool].SetCpuAffinity(cpus);
+#else
+    (void)pool;
+    (void)cpus;
+    return Status::NotSupported(
+        "SetThreadPoolCpuAffinity() is only supported on Linux");
+#endif
+  }
+
  private:
   friend Env* Env::Default();
   // Constructs the default Env, a singleton
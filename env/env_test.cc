@@ -35,6 +35,7 @@
 #include <atomic>
 #include <list>
 #include <mutex>
+#include <set>
 #include <unordered_set>
 
 #ifdef OS_LINUX
@@ -325,6 +326,76 @@ TEST_F(EnvPosixTest, LowerThreadPoolCpuPriority) {
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
 }
+
+TEST_F(EnvPosixTest, ThreadPoolCpuAffinity) {
+  env_->SetBackgroundThreads(1, Env::BOTTOM);
+
+  // Returns the CPUs the pool thread was allowed to run on while running a
+  // job, or an empty set if the job did not run in time.
+  auto RunTask = [&]() {
+    struct Arg {
+      std::atomic<bool> called{false};
+      cpu_set_t cpu_set;
+    } arg;
+    env_->Schedule(
+        [](void* ptr) {
+          auto* a = reinterpret_cast<Arg*>(ptr);
+          CPU_ZERO(&a->cpu_set);
+          EXPECT_EQ(0, sched_getaffinity(0, sizeof(a->cpu_set), &a->cpu_set));
+          a->called.store(true);
+        },
+        &arg, Env::Priority::BOTTOM);
+    for (int i = 0; i < kDelayMicros && !arg.called.load(); i++) {
+      Env::Default()->SleepForMicroseconds(1);
+    }
+    std::set<int> cpus;
+    if (arg.called.load()) {
+      for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &arg.cpu_set)) {
+          cpus.insert(cpu);
+        }
+      }
+    }
+    return cpus;
+  };
+
+  cpu_set_t process_cpu_set;
+  CPU_ZERO(&process_cpu_set);
+  ASSERT_EQ(0,
+            sched_getaffinity(0, sizeof(process_cpu_set), &process_cpu_set));
+  std::set<int> process_cpus;
+  int disallowed_cpu = -1;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &process_cpu_set)) {
+      process_cpus.insert(cpu);
+    } else if (disallowed_cpu < 0) {
+      disallowed_cpu = cpu;
+    }
+  }
+  ASSERT_FALSE(process_cpus.empty());
+
+  // Pin the pool to one of the CPUs the process may run on.
+  const int cpu = *process_cpus.rbegin();
+  ASSERT_OK(env_->SetThreadPoolCpuAffinity(Env::Priority::BOTTOM, {cpu}));
+  ASSERT_EQ(std::set<int>({cpu}), RunTask());
+
+  // CPUs outside of the process's set are rejected and keep the pinning.
+  ASSERT_TRUE(env_->SetThreadPoolCpuAffinity(Env::Priority::BOTTOM, {-1})
+                  .IsInvalidArgument());
+  ASSERT_TRUE(
+      env_->SetThreadPoolCpuAffinity(Env::Priority::BOTTOM, {cpu, CPU_SETSIZE})
+          .IsInvalidArgument());
+  if (disallowed_cpu >= 0) {
+    ASSERT_TRUE(
+        env_->SetThreadPoolCpuAffinity(Env::Priority::BOTTOM, {disallowed_cpu})
+            .IsInvalidArgument());
+  }
+  ASSERT_EQ(std::set<int>({cpu}), RunTask());
+
+  // Lift the restriction again; the pool runs on the CPUs of the process.
+  ASSERT_OK(env_->SetThreadPoolCpuAffinity(Env::Priority::BOTTOM, {}));
+  ASSERT_EQ(process_cpus, RunTask());
+}
 #endif
 
 TEST_F(EnvPosixTest, MemoryMappedFileBuffer) {
@@ -6,6 +6,7 @@
 
 #include "file/delete_scheduler.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <thread>
 #include <vector>
@@ -15,6 +16,7 @@
 #include "port/port.h"
 #include "rocksdb/env.h"
 #include "rocksdb/file_system.h"
+#include "rocksdb/rate_limiter.h"
 #include "rocksdb/system_clock.h"
 #include "test_util/sync_point.h"
 #include "util/mutexlock.h"
@@ -30,6 +32,7 @@ DeleteScheduler::DeleteScheduler(SystemClock* clock, FileSystem* fs,
       fs_(fs),
       total_trash_size_(0),
       rate_bytes_per_sec_(rate_bytes_per_sec),
+      has_rate_limiter_(false),
       pending_files_(0),
       bytes_max_delete_chunk_(bytes_max_delete_chunk),
       closing_(false),
@@ -60,7 +63,7 @@ DeleteScheduler::~DeleteScheduler() {
 Status DeleteScheduler::DeleteFile(const std::string& file_path,
                                    const std::string& dir_to_sync,
                                    const bool force_bg) {
-  if (rate_bytes_per_sec_.load() <= 0 ||
+  if (!IsRateLimitingEnabled() ||
       (!force_bg &&
        total_trash_size_.load() >
            sst_file_manager_->GetTotalSize() * max_trash_db_ratio_.load())) {
@@ -298,6 +301,27 @@ void DeleteScheduler::BackgroundEmptyTrash() {
   }
 }
 
+void DeleteScheduler::RequestDeleteBytes(RateLimiter* rate_limiter,
+                                         uint64_t bytes) {
+  if (!rate_limiter->IsRateLimited(RateLimiter::OpType::kWrite)) {
+    return;
+  }
+  while (bytes > 0) {
+    {
+      InstrumentedMutexLock l(&mu_);
+      if (closing_) {
+        return;
+      }
+    }
+    const uint64_t burst_bytes = static_cast<uint64_t>(
+        std::max<int64_t>(rate_limiter->GetSingleBurstBytes(), 1));
+    const uint64_t request_bytes = std::min(bytes, burst_bytes);
+    rate_limiter->Request(static_cast<int64_t>(request_bytes), Env::IO_LOW,
+                          nullptr /* stats */, RateLimiter::OpType::kWrite);
+    bytes -= request_bytes;
+  }
+}
+
 Status DeleteScheduler::DeleteTrashFile(const std::string& path_in_trash,
                                         const std::string& dir_to_sync,
                                         uint64_t* deleted_bytes,
@@ -306,6 +330,11 @@ Status DeleteScheduler::DeleteTrashFile(const std::string& path_in_trash,
   Status s = fs_->GetFileSize(path_in_trash, IOOptions(), &file_size, nullptr);
   *is_complete = true;
   TEST_SYNC_POINT("DeleteScheduler::DeleteTrashFile:DeleteFile");
+  std::shared_ptr<RateLimiter> rate_limiter;
+  {
+    InstrumentedMutexLock l(&mu_);
+    rate_limiter = rate_limiter_;
+  }
   if (s.ok()) {
     bool need_full_delete = true;
     if (bytes_max_delete_chunk_ != 0 && file_size > bytes_max_delete_chunk_) {
@@ -322,6 +351,11 @@ Status DeleteScheduler::DeleteTrashFile(const std::string& path_in_trash,
           my_status = fs_->ReopenWritableFile(path_in_trash, FileOptions(), &wf,
                                               nullptr);
           if (my_status.ok()) {
+            // Releasing the extents of a slice (and issuing their discards)
+            // competes with the flush and compaction writes
+            if (rate_limiter != nullptr) {
+              RequestDeleteBytes(rate_limiter.get(), bytes_max_delete_chunk_);
+            }
             my_status = wf->Truncate(file_size - bytes_max_delete_chunk_,
                                      IOOptions(), nullptr);
             if (my_status.ok()) {
@@ -333,6 +367,11 @@ Status DeleteScheduler::DeleteTrashFile(const std::string& path_in_trash,
             *deleted_bytes = bytes_max_delete_chunk_;
             need_full_delete = false;
             *is_complete = false;
+            // The space of the slice is released, keep the total size of the
+            // tracked files accurate
+            sst_file_manager_
+                ->OnAddFile(path_in_trash, file_size - bytes_max_delete_chunk_)
+                .PermitUncheckedError();
           } else {
             ROCKS_LOG_WARN(info_log_,
                            "Failed to partially delete %s from trash -- %s",
@@ -355,6 +394,9 @@ Status DeleteScheduler::DeleteTrashFile(const std::string& path_in_trash,
     }
 
     if (need_full_delete) {
+      if (rate_limiter != nullptr) {
+        RequestDeleteBytes(rate_limiter.get(), file_size);
+      }
       s = fs_->DeleteFile(path_in_trash, IOOptions(), nullptr);
       if (!dir_to_sync.empty()) {
         std::unique_ptr<FSDirectory> dir_obj;
@@ -396,7 +438,7 @@ void DeleteScheduler::WaitForEmptyTrash() {
 }
 
 void DeleteScheduler::MaybeCreateBackgroundThread() {
-  if (bg_thread_ == nullptr && rate_bytes_per_sec_.load() > 0) {
+  if (bg_thread_ == nullptr && IsRateLimitingEnabled()) {
     bg_thread_.reset(
         new port::Thread(&DeleteScheduler::BackgroundEmptyTrash, this));
     ROCKS_LOG_INFO(info_log_,
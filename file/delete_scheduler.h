@@ -20,6 +20,7 @@ namespace ROCKSDB_NAMESPACE {
 class Env;
 class FileSystem;
 class Logger;
+class RateLimiter;
 class SstFileManagerImpl;
 class SystemClock;
 
@@ -30,6 +31,9 @@ class SystemClock;
 //
 // Rate limiting can be turned off by setting rate_bytes_per_sec = 0, In this
 // case DeleteScheduler will delete files immediately.
+//
+// A RateLimiter may be set as well (see SetRateLimiter()), in which case every
+// slice of a trash file is also charged to it before being released.
 class DeleteScheduler {
  public:
   DeleteScheduler(SystemClock* clock, FileSystem* fs,
@@ -48,6 +52,19 @@ class DeleteScheduler {
     MaybeCreateBackgroundThread();
   }
 
+  // Charge the deleted bytes to rate_limiter (typically the one shared with
+  // the flush and compaction writes), at Env::IO_LOW priority. Files are
+  // deleted in the background while a rate limiter is set, even if
+  // rate_bytes_per_sec is 0. nullptr stops charging.
+  void SetRateLimiter(const std::shared_ptr<RateLimiter>& rate_limiter) {
+    {
+      InstrumentedMutexLock l(&mu_);
+      rate_limiter_ = rate_limiter;
+      has_rate_limiter_.store(rate_limiter != nullptr);
+    }
+    MaybeCreateBackgroundThread();
+  }
+
   // Mark file as trash directory and schedule its deletion. If force_bg is
   // set, it forces the file to always be deleted in the background thread,
   // except when rate limiting is disabled
@@ -64,6 +81,12 @@ class DeleteScheduler {
 
   uint64_t GetTotalTrashSize() { return total_trash_size_.load(); }
 
+  // Return the number of trash files waiting to be (fully) deleted
+  uint64_t GetNumPendingTrashFiles() {
+    InstrumentedMutexLock l(&mu_);
+    return static_cast<uint64_t>(pending_files_);
+  }
+
   // Return trash/DB size ratio where new files will be deleted immediately
   double GetMaxTrashDBRatio() { return max_trash_db_ratio_.load(); }
 
@@ -97,6 +120,13 @@ class DeleteScheduler {
 
   void MaybeCreateBackgroundThread();
 
+  bool IsRateLimitingEnabled() {
+    return rate_bytes_per_sec_.load() > 0 || has_rate_limiter_.load();
+  }
+
+  // Blocks until rate_limiter grants bytes, or the scheduler is closing
+  void RequestDeleteBytes(RateLimiter* rate_limiter, uint64_t bytes);
+
   SystemClock* clock_;
   FileSystem* fs_;
 
@@ -104,8 +134,11 @@ class DeleteScheduler {
   std::atomic<uint64_t> total_trash_size_;
   // Maximum number of bytes that should be deleted per second
   std::atomic<int64_t> rate_bytes_per_sec_;
-  // Mutex to protect queue_, pending_files_, bg_errors_, closing_, stats_
+  // Mutex to protect queue_, pending_files_, bg_errors_, closing_, stats_,
+  // rate_limiter_
   InstrumentedMutex mu_;
+  std::shared_ptr<RateLimiter> rate_limiter_;
+  std::atomic<bool> has_rate_limiter_;
 
   struct FileAndDir {
     FileAndDir(const std::string& f, const std::string& d) : fname(f), dir(d) {}
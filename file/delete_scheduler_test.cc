@@ -14,6 +14,7 @@
 #include "file/sst_file_manager_impl.h"
 #include "rocksdb/env.h"
 #include "rocksdb/options.h"
+#include "rocksdb/rate_limiter.h"
 #include "test_util/sync_point.h"
 #include "test_util/testharness.h"
 #include "util/string_util.h"
@@ -549,6 +550,48 @@ TEST_F(DeleteSchedulerTest, NoPartialDeleteWithLink) {
 }
 #endif
 
+// Deletions charged to a rate limiter are done in the background in slices,
+// even without a delete rate, and every slice is reflected in the backlog
+// metrics and the total size of the tracked files
+TEST_F(DeleteSchedulerTest, RateLimiterSlices) {
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->LoadDependency({
+      {"DeleteSchedulerTest::RateLimiterSlices:1",
+       "DeleteScheduler::BackgroundEmptyTrash"},
+  });
+  std::vector<uint64_t> total_sizes;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DeleteScheduler::DeleteTrashFile:DeleteFile",
+      [&](void*) { total_sizes.push_back(sst_file_mgr_->GetTotalSize()); });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  rate_bytes_per_sec_ = 0;
+  NewDeleteScheduler();
+  std::shared_ptr<RateLimiter> rate_limiter(
+      NewGenericRateLimiter(100 * 1024 * 1024 /* rate_bytes_per_sec */));
+  sst_file_mgr_->SetDeleteRateLimiter(rate_limiter);
+
+  ASSERT_OK(
+      delete_scheduler_->DeleteFile(NewDummyFile("data_1", 500 * 1024), ""));
+  ASSERT_EQ(1, CountTrashFiles());
+  ASSERT_EQ(1U, sst_file_mgr_->GetNumPendingTrashFiles());
+  ASSERT_EQ(500 * 1024U, sst_file_mgr_->GetTotalTrashSize());
+
+  TEST_SYNC_POINT("DeleteSchedulerTest::RateLimiterSlices:1");
+  delete_scheduler_->WaitForEmptyTrash();
+
+  auto bg_errors = delete_scheduler_->GetBackgroundErrors();
+  ASSERT_EQ(bg_errors.size(), 0);
+  ASSERT_EQ(0, CountTrashFiles());
+  ASSERT_EQ(0U, sst_file_mgr_->GetNumPendingTrashFiles());
+  ASSERT_EQ(0U, sst_file_mgr_->GetTotalTrashSize());
+  ASSERT_EQ(0U, sst_file_mgr_->GetTotalSize());
+  // 3 slices of 128KB, then the remaining 116KB
+  ASSERT_EQ(total_sizes, std::vector<uint64_t>({500 * 1024, 372 * 1024,
+                                                244 * 1024, 116 * 1024}));
+  ASSERT_EQ(500 * 1024, rate_limiter->GetTotalBytesThrough(Env::IO_LOW));
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+}
+
 // 1- Create a DeleteScheduler with very slow rate limit (1 Byte / sec)
 // 2- Delete 100 files using DeleteScheduler
 // 3- Delete the DeleteScheduler (call the destructor while queue is not empty)
@@ -240,6 +240,15 @@ uint64_t SstFileManagerImpl::GetTotalTrashSize() {
   return delete_scheduler_.GetTotalTrashSize();
 }
 
+uint64_t SstFileManagerImpl::GetNumPendingTrashFiles() {
+  return delete_scheduler_.GetNumPendingTrashFiles();
+}
+
+void SstFileManagerImpl::SetDeleteRateLimiter(
+    const std::shared_ptr<RateLimiter>& rate_limiter) {
+  delete_scheduler_.SetRateLimiter(rate_limiter);
+}
+
 void SstFileManagerImpl::ReserveDiskBuffer(uint64_t size,
                                            const std::string& path) {
   MutexLock l(&mu_);
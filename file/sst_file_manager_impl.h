@@ -102,6 +102,11 @@ class SstFileManagerImpl : public SstFileManager {
   // Return the total size of trash files
   uint64_t GetTotalTrashSize() override;
 
+  uint64_t GetNumPendingTrashFiles() override;
+
+  void SetDeleteRateLimiter(
+      const std::shared_ptr<RateLimiter>& rate_limiter) override;
+
   // Called by each DB instance using this sst file manager to reserve
   // disk buffer space for recovery from out of space errors
   void ReserveDiskBuffer(uint64_t buffer, const std::string& path);
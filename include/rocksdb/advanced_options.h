@@ -498,6 +498,17 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   size_t memtable_huge_page_size = 0;
 
+  // If true, and the process may run on more than one NUMA node, the small
+  // allocations of the concurrent memtable writers
+  // (allow_concurrent_memtable_write) are served from an arena per NUMA node,
+  // chosen by the cpu of the writer, so that the memtable entries inserted on
+  // a node are mostly placed in the memory of that node. The nodes are only
+  // detected in a build with NUMA support (e.g. cmake -DWITH_NUMA=ON);
+  // otherwise this option has no effect.
+  //
+  // Dynamically changeable through SetOptions() API
+  bool memtable_numa_local_allocation = false;
+
   // If non-nullptr, memtable will use the specified function to extract
   // prefixes for keys, and for each prefix maintain a hint of insert location
   // to reduce CPU usage for inserting keys with the prefix. Keys out of
@@ -595,6 +606,22 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   int level0_stop_writes_trigger = 36;
 
+  // If true, a flush whose output doesn't overlap any file in L0 (nor any
+  // running compaction) is added to the deepest level where it overlaps no
+  // file of that level or the levels above it, rather than to L0, like a
+  // trivial move. With sequential or time-series keys, this saves moving every
+  // flushed file down the levels, and rewriting it where the move can't be
+  // trivial (e.g. the levels use different compression). With mixed keys, the
+  // deep files may be rewritten more often. The file is still built with the
+  // options of L0 (e.g. compression). Only for level compaction and
+  // without atomic_flush; the last level is skipped when it's reserved
+  // (allow_ingest_behind, preclude_last_level_data_seconds).
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool flush_to_non_overlapping_level = false;
+
   // Target file size for compaction.
   // target_file_size_base is per-file size for level-1.
   // Target file size for level L can be calculated by
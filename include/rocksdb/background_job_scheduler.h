@@ -0,0 +1,131 @@
+// Copyright (C) 2023 Speedb Ltd. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/env.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// BackgroundJobScheduler admits the automatic compactions of all the dbs
+// where it's passed (see DBOptions::background_job_scheduler) into the LOW
+// priority thread pool of their Env, so that dbs sharing a process (and
+// usually an Env) get the pool according to how urgent their compactions are
+// rather than in the order they were requested.
+//
+// Every db keeps scheduling compactions up to its own background job limits,
+// but instead of being queued in the Env thread pool, the compactions wait in
+// the scheduler until one of its max_running_jobs slots is free. A free slot
+// goes to the waiting db with:
+// 1. The highest urgency, among dbs with urgency >= 1. The urgency of a db is
+//    the highest ratio of any of its column families between the number of L0
+//    files and level0_slowdown_writes_trigger, or between the estimated
+//    pending compaction bytes and soft_pending_compaction_bytes_limit, so dbs
+//    at or past a write slowdown are served first.
+// 2. Otherwise, the fewest running compactions and then the least recently
+//    served one.
+// To bound the wait of the non-urgent dbs, every fairness_interval-th slot goes
+// to the least recently served waiting db regardless of the urgency
+// (0 disables this).
+//
+// Flushes and manual compactions are not managed by the scheduler.
+//
+// The scheduler must be owned by a std::shared_ptr.
+class BackgroundJobScheduler
+    : public std::enable_shared_from_this<BackgroundJobScheduler> {
+ public:
+  explicit BackgroundJobScheduler(int max_running_jobs,
+                                  int fairness_interval = 4);
+  ~BackgroundJobScheduler();
+
+  // No copying allowed
+  BackgroundJobScheduler(const BackgroundJobScheduler&) = delete;
+  BackgroundJobScheduler& operator=(const BackgroundJobScheduler&) = delete;
+
+  // Values below 1 are treated as 1
+  void SetMaxRunningJobs(int max_running_jobs);
+  int GetMaxRunningJobs() const;
+
+  // Number of jobs handed to the Env thread pool and not completed yet
+  uint64_t GetNumRunningJobs() const;
+  // Number of jobs waiting for a free slot
+  uint64_t GetNumQueuedJobs() const;
+
+  // The methods below are used internally by the dbs sharing the scheduler.
+  //
+  // Returns a tag that identifies a db in the scheduler. Tags are never
+  // reused, so the jobs of a closed db still running cannot be mistaken for
+  // the jobs of a db opened later at the same address.
+  uint64_t NewTag();
+
+  // Queues function(arg) to be scheduled in env's LOW priority pool with
+  // env_tag (see Env::Schedule()) once the db with the given tag gets a slot.
+  // urgency replaces the current urgency of the tag. unschedFunction(arg) is
+  // called instead of function(arg) if the job is dropped by UnSchedule()
+  // (or by Env::UnSchedule() on env_tag once dispatched).
+  void Schedule(Env* env, void (*function)(void* arg), void* arg,
+                uint64_t tag, void* env_tag, void (*unschedFunction)(void* arg),
+                double urgency);
+
+  // Updates the urgency of a tag that has queued or running jobs
+  void UpdateUrgency(uint64_t tag, double urgency);
+
+  // Drops the queued (not dispatched yet) jobs of a tag, calling their
+  // unschedFunction. Returns the number of dropped jobs.
+  int UnSchedule(uint64_t tag);
+
+ private:
+  struct Job;
+
+  struct TagInfo {
+    std::deque<Job*> queued_jobs;
+    double urgency = 0.0;
+    uint64_t num_running = 0U;
+    // The dispatch number of the last job of this tag, 0 if none
+    uint64_t last_dispatch = 0U;
+  };
+
+  static void RunJob(void* arg);
+  static void UnscheduleJob(void* arg);
+
+  void OnJobDone(uint64_t tag);
+  bool IsPreferred(const TagInfo& lhs, const TagInfo& rhs,
+                   bool fairness_turn) const;
+  // Must be called with mutex_ held. Removes from the queues the jobs that
+  // may be dispatched now.
+  void PickJobsToDispatch(std::vector<Job*>* jobs);
+  // Must be called without holding mutex_
+  void Dispatch(const std::vector<Job*>& jobs);
+
+  const int fairness_interval_;
+
+  mutable std::mutex mutex_;
+  int max_running_jobs_;
+  uint64_t num_running_ = 0U;
+  uint64_t num_queued_ = 0U;
+  uint64_t num_dispatched_ = 0U;
+  uint64_t next_job_seqno_ = 0U;
+  uint64_t next_tag_ = 0U;
+  std::unordered_map<uint64_t, TagInfo> tags_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -25,6 +25,8 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <string>
@@ -354,6 +356,14 @@ class DB {
   // (rather than aborting and potentially redoing some work on re-open)
   virtual Status Close() { return Status::NotSupported(); }
 
+  // Like Close(), but closes the DB in a new thread and returns right away.
+  // The returned future gets the status returned by Close() and must be
+  // waited on before the DB is freed; its destructor waits for (joins) the
+  // closing thread. The DB must not be used once CloseAsync() is called.
+  // When many DBs are closed, e.g. on a process restart, closing them with
+  // CloseAsync() lets them flush and release their resources concurrently.
+  virtual std::future<Status> CloseAsync();
+
   // ListColumnFamilies will open the DB specified by argument name
   // and return the list of all column families in that DB
   // through column_families argument. The ordering of
@@ -1043,6 +1053,11 @@ class DB {
     //      running compactions.
     static const std::string kNumRunningCompactions;
 
+    //  "rocksdb.num-queued-non-blocking-compact-range" - returns the number of
+    //      non-blocking CompactRange() requests waiting for a free internal
+    //      thread (see DBOptions::max_non_blocking_compact_range_threads).
+    static const std::string kNumQueuedNonBlockingCompactRange;
+
     //  "rocksdb.background-errors" - returns accumulated number of background
     //      errors.
     static const std::string kBackgroundErrors;
@@ -1283,6 +1298,7 @@ class DB {
   //  "rocksdb.base-level"
   //  "rocksdb.estimate-pending-compaction-bytes"
   //  "rocksdb.num-running-compactions"
+  //  "rocksdb.num-queued-non-blocking-compact-range"
   //  "rocksdb.num-running-flushes"
   //  "rocksdb.actual-delayed-write-rate"
   //  "rocksdb.is-write-stopped"
@@ -595,6 +595,19 @@ class Env : public Customizable {
   // Lower CPU priority for threads from the specified pool.
   virtual void LowerThreadPoolCPUPriority(Priority /*pool*/ = LOW) {}
 
+  // Restrict threads from the specified pool to run only on the given CPUs,
+  // e.g. to keep background work off the cores serving foreground requests
+  // or on the NUMA node that owns the data. An empty `cpus` restores the
+  // CPUs the process was allowed to run on. Returns InvalidArgument if a CPU
+  // is outside of that set, and the error of the OS if the threads could not
+  // be moved.
+  virtual Status SetThreadPoolCpuAffinity(Priority /*pool*/,
+                                          const std::vector<int>& /*cpus*/) {
+    return Status::NotSupported(
+        "Env::SetThreadPoolCpuAffinity(Priority, std::vector<int>) not "
+        "supported");
+  }
+
   // Converts seconds-since-Jan-01-1970 to a printable string
   virtual std::string TimeToString(uint64_t time) = 0;
 
@@ -1638,6 +1651,11 @@ class EnvWrapper : public Env {
     return target_.env->LowerThreadPoolCPUPriority(pool, pri);
   }
 
+  Status SetThreadPoolCpuAffinity(Priority pool,
+                                  const std::vector<int>& cpus) override {
+    return target_.env->SetThreadPoolCpuAffinity(pool, cpus);
+  }
+
   std::string TimeToString(uint64_t time) override {
     return target_.env->TimeToString(time);
   }
@@ -452,9 +452,15 @@ class MemTableRepFactory : public Customizable {
 //     search from the previously visited record (doing at most 'lookahead'
 //     steps). This is an optimization for the access pattern including many
 //     seeks with consecutive keys.
+//   thread_local_insert_hints: If true, a concurrent insert (see
+//     allow_concurrent_memtable_write) first tries the position right after
+//     the previous insert of the same thread, which makes the inserts O(1)
+//     when every writer thread inserts ascending keys (e.g. a time series
+//     per writer). A miss costs a couple of key comparisons.
 class SkipListFactory : public MemTableRepFactory {
  public:
-  explicit SkipListFactory(size_t lookahead = 0);
+  explicit SkipListFactory(size_t lookahead = 0,
+                           bool thread_local_insert_hints = false);
 
   // Methods for Configurable/Customizable class overrides
   static const char* kClassName() { return "SkipListFactory"; }
@@ -475,6 +481,7 @@ class SkipListFactory : public MemTableRepFactory {
 
  private:
   size_t lookahead_;
+  bool thread_local_insert_hints_;
 };
 
 // This creates MemTableReps that are backed by an std::vector. On iteration,
@@ -541,4 +548,9 @@ extern MemTableRepFactory* NewHashLinkListRepFactory(
 extern MemTableRepFactory* NewHashSpdbRepFactory(size_t bucket_count = 1000000,
                                                  bool use_merge = true);
 
+// The factory is to create memtables based on a B+tree whose leaves hold
+// arrays of entry pointers, which suits scan heavy workloads. It supports
+// concurrent inserts, and insert hints that make sequential inserts O(1).
+extern MemTableRepFactory* NewBPlusTreeRepFactory();
+
 }  // namespace ROCKSDB_NAMESPACE
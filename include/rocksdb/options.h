@@ -71,6 +71,8 @@ class InternalKeyComparator;
 class WalFilter;
 class WriteBufferManager;
 class WriteController;
+class BackgroundJobScheduler;
+class SharedWal;
 class FileSystem;
 class SharedOptions;
 class TablePinningPolicy;
@@ -843,6 +845,29 @@ struct DBOptions {
   // Default: 0
   size_t recycle_log_file_num = 0;
 
+  // If true (and recycle_log_file_num > 0), the recycled log files form a
+  // ring of fully allocated files. DB::Open() tops up the recycle list to
+  // recycle_log_file_num, reusing the files of the ring of the previous run
+  // and creating zero-filled files of the WAL preallocation size (see
+  // max_total_wal_size and write_buffer_size) for the missing ones. A
+  // recycled file shorter than that is zero-filled before reuse, and the
+  // files of the ring are never truncated. Writing a WAL then doesn't change the size of its file,
+  // so the WAL syncs don't involve file metadata.
+  // Note that WAL recycling requires
+  // wal_recovery_mode == kSkipAnyCorruptedRecords.
+  // Default: false
+  bool preallocated_wal_ring = false;
+
+  // If true, the WALs reused from the ring of preallocated_wal_ring are
+  // written with direct I/O (O_DIRECT), in aligned blocks with a zero-padded
+  // tail, bypassing the page cache. Every WAL write is then synced (with
+  // fdatasync, like a file opened with O_DSYNC), whether or not
+  // WriteOptions::sync is set, since an O_DIRECT write alone may still sit
+  // in the volatile cache of the device. Ignored unless preallocated_wal_ring
+  // is enabled.
+  // Default: false
+  bool use_direct_io_for_wal = false;
+
   // manifest file is rolled over on reaching this limit.
   // The older manifest file be deleted.
   // The default value is 1GB so that the manifest file can grow, but not
@@ -992,6 +1017,20 @@ struct DBOptions {
   // Default: null
   std::shared_ptr<WriteController> write_controller = nullptr;
 
+  // This object admits the automatic compactions of all the dbs where it's
+  // passed into the LOW priority thread pool by urgency, so that dbs sharing
+  // a process get the pool fairly (see BackgroundJobScheduler).
+  //
+  // Default: null (every db schedules its compactions directly in the Env)
+  std::shared_ptr<BackgroundJobScheduler> background_job_scheduler = nullptr;
+
+  // If not null, the WAL records of all the dbs where this object is passed
+  // are written to a single log, and their syncs are group committed across
+  // the dbs (see SharedWal for the limitations).
+  //
+  // Default: null (every db writes and syncs its own WAL files)
+  std::shared_ptr<SharedWal> shared_wal = nullptr;
+
   // DEPRECATED
   // This flag has no effect on the behavior of compaction and we plan to delete
   // it in the future.
@@ -1328,10 +1367,41 @@ struct DBOptions {
 
   // This feature is WORK IN PROGRESS
   // If enabled WAL records will be compressed before they are written.
-  // Only zstd is supported. Compressed WAL records will be read in supported
-  // versions regardless of the wal_compression settings.
+  // Only zstd and lz4 are supported. Compressed WAL records will be read in
+  // supported versions regardless of the wal_compression settings.
   CompressionType wal_compression = kNoCompression;
 
+  // If non-zero and wal_compression is enabled, the first
+  // wal_compression_dict_bytes of the records written to a WAL (taken from
+  // the head of several records) are used as the compression dictionary of
+  // the next WAL, which helps the many small records that compress poorly on
+  // their own. The dictionary is stored at the start of the WAL it applies
+  // to; such WALs can't be read by versions that predate this option.
+  // Values above 16KB are reduced to 16KB.
+  //
+  // Default: 0 (no dictionary)
+  size_t wal_compression_dict_bytes = 0;
+
+  // If non-zero, the memtable entries of the values of at least this size
+  // (written with Put) don't hold a copy of the value, but a reference to it
+  // in the WAL record of its write. This saves memtable memory and a copy of
+  // the value per write for workloads with large values. The values are read
+  // from the WAL when they are read from the memtable, including by flush, so
+  // with enable_blob_files they are written from the WAL straight to blob
+  // files.
+  // Writes with disableWAL keep their values in the memtable, and the values
+  // recovered from the WAL on DB::Open() are copied to the memtable.
+  // The referenced values still count toward write_buffer_size, so that the
+  // memtables are flushed, and their WALs released, as often as without
+  // references. Only the memory of the memtables (e.g. as charged to the
+  // write buffer manager) is saved.
+  // Not supported with manual_wal_flush, wal_compression, recycled WAL files
+  // (recycle_log_file_num), two_write_queues, unordered_write,
+  // use_spdb_writes, shared_wal nor inplace_update_support.
+  //
+  // Default: 0 (disabled)
+  size_t memtable_wal_value_threshold = 0;
+
   // If true, RocksDB supports flushing multiple column families and committing
   // their results atomically to MANIFEST. Note that it is not
   // necessary to set atomic_flush to true if WAL is always enabled since WAL
@@ -1498,6 +1568,24 @@ struct DBOptions {
   // inconsistency, e.g. deleted old data become visible again, etc.
   bool enforce_single_del_contracts = true;
 
+  // Maximum number of internal threads used to run non-blocking
+  // CompactRange() requests (see CompactRangeOptions::async_completion_cb).
+  // Threads are created on demand and requests beyond this limit are queued.
+  // The number of queued requests is reported by the
+  // "rocksdb.num-queued-non-blocking-compact-range" property.
+  // Values below 1 are treated as 1.
+  //
+  // Default: 4
+  int max_non_blocking_compact_range_threads = 4;
+
+  // If true, the WAL recovery at DB::Open() reads and checksums the records of
+  // each WAL in a separate thread, ahead of their insertion into the
+  // memtables, which overlaps the two. The records are still inserted in
+  // order, by a single thread.
+  //
+  // Default: false
+  bool pipelined_wal_recovery = false;
+
   // If non-zero, a task will be started to check for a new
   // "refresh_options_file" If found, the refresh task will update the mutable
   // options from the settings in this file
@@ -2071,6 +2159,14 @@ struct CompactRangeOptions {
   // An optional completion callback to allow for non-blocking (async) operation
   // Default: Empty (Blocking)
   std::shared_ptr<CompactRangeCompletedCbIf> async_completion_cb;
+
+  // The priority of a non-blocking (async) request while it waits to be
+  // executed (see DBOptions::max_non_blocking_compact_range_threads). Queued
+  // requests with higher values are started first, requests with equal
+  // priorities are started in their submission order.
+  // Ignored for blocking requests.
+  // Default: 0
+  int async_priority = 0;
 };
 
 // IngestExternalFileOptions is used by IngestExternalFile()
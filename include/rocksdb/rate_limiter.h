@@ -9,6 +9,9 @@
 
 #pragma once
 
+#include <array>
+#include <memory>
+
 #include "rocksdb/env.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
@@ -156,4 +159,78 @@ extern RateLimiter* NewGenericRateLimiter(
     RateLimiter::Mode mode = RateLimiter::Mode::kWritesOnly,
     bool auto_tuned = false);
 
+struct LatencyAwareRateLimiterOptions {
+  // The statistics of the db whose foreground latency is protected (i.e., its
+  // DBOptions::statistics). Must be created by CreateDBStatistics().
+  std::shared_ptr<Statistics> statistics;
+
+  // The latency histogram of the foreground operations (e.g. DB_GET,
+  // DB_MULTIGET or DB_SEEK) and the percentile of it to keep below
+  // target_latency_micros.
+  uint32_t histogram = DB_GET;
+  double percentile = 99.0;
+
+  // REQUIRED: > 0
+  uint64_t target_latency_micros = 0;
+
+  // The rate is never lowered below it. 0 means 1/20 of the max rate.
+  int64_t min_bytes_per_sec = 0;
+
+  // The percentile is measured over, and the rate adjusted after, every
+  // period.
+  uint64_t tune_period_us = 1000 * 1000;
+
+  // A period with fewer foreground operations is considered idle, and the
+  // rate is raised.
+  uint64_t min_samples = 100;
+};
+
+// Creates a rate limiter whose rate is tuned to keep a latency percentile of
+// the foreground operations (by default, the p99 of Get()) in the statistics
+// of a db below a target. The rate starts at max_bytes_per_sec. After every
+// tune period where the percentile measured over the period is above the
+// target, the rate is lowered by 25% (down to min_bytes_per_sec). Once it's
+// back below 90% of the target, or there is no foreground load, the rate is
+// raised by 10% of max_bytes_per_sec per period until it's fully released.
+//
+// With the default mode (RateLimiter::Mode::kWritesOnly), this throttles the
+// flush and compaction writes only while they hurt the foreground reads.
+extern RateLimiter* NewLatencyAwareRateLimiter(
+    int64_t max_bytes_per_sec, const LatencyAwareRateLimiterOptions& options,
+    int64_t refill_period_us = 100 * 1000, int32_t fairness = 10,
+    RateLimiter::Mode mode = RateLimiter::Mode::kWritesOnly);
+
+struct TenantRateLimiterOptions {
+  // The share of the parent's rate (in (0, 1]) reserved for the tenant.
+  double share = 1.0;
+
+  // Splits the reserved rate of the tenant between the I/O priorities, which
+  // identify the activity issuing the I/O (Env::IO_HIGH for flushes,
+  // Env::IO_LOW for compactions, Env::IO_USER for user operations, ...).
+  // Indexed by Env::IOPriority. An activity with weight 0 has no reserved rate
+  // and is only limited by the parent.
+  std::array<int, Env::IO_TOTAL> priority_weights = {{1, 1, 1, 1}};
+
+  // If true, a request beyond the reserved rate of its activity is passed to
+  // the parent right away when the parent has no pending requests, so unused
+  // capacity of other tenants is borrowed. Otherwise it waits for the reserved
+  // rate.
+  bool borrow_unused = true;
+};
+
+// Creates a rate limiter for one tenant (e.g. a db, through
+// DBOptions::rate_limiter, or a backup engine) of the budget of the parent
+// limiter, which is shared by all its tenants. Every request is granted by the
+// parent, after being admitted by the tenant according to the reserved rate
+// of its activity (see TenantRateLimiterOptions), so a noisy tenant or
+// activity cannot take over the whole parent budget while others compete for
+// it. The parent may itself be a tenant rate limiter, to build a hierarchy.
+//
+// The mode (the op types that are rate limited), the burst size and auto
+// tuning are those of the parent. SetBytesPerSecond() changes the reserved
+// rate of the tenant (i.e., its share of the parent's rate).
+extern RateLimiter* NewTenantRateLimiter(
+    std::shared_ptr<RateLimiter> parent,
+    const TenantRateLimiterOptions& options = TenantRateLimiterOptions());
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,97 @@
+// Copyright (C) 2023 Speedb Ltd. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/env.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct SharedWalOptions {
+  // Used to access the shared log files
+  Env* env = Env::Default();
+
+  // A new shared log file is started once the current one reaches this size.
+  // A file is deleted once none of the dbs that wrote to it needs its records.
+  uint64_t max_file_size = 64 << 20;
+
+  // Use fsync() instead of fdatasync() to sync the shared log files
+  bool use_fsync = false;
+};
+
+// SharedWal is a write-ahead log shared by all the dbs where it's passed (see
+// DBOptions::shared_wal), so that a process with many dbs writes one log
+// stream instead of one per db. Every record is tagged with the identity of
+// the db that wrote it (see DB::GetDbIdentity()), and syncs are group
+// committed: a write asking for a sync waits for a single leader that syncs
+// the records of all the dbs appended so far, rather than syncing a log file
+// of its own.
+//
+// Each db still creates and rotates its own WAL files, but they stay empty:
+// the records are tagged with the number of the db's current WAL file, so
+// that recovery replays the db's records exactly as if they had been read from
+// its own files, and a db releases the shared log files holding its records
+// once its own WAL files become obsolete.
+//
+// The shared log is a single stream, so a corrupted record may belong to any
+// db. With kPointInTimeRecovery every db stops its replay at the first
+// corruption, with kTolerateCorruptedTailRecords and kAbsoluteConsistency the
+// dbs with records in or after the corrupted file fail to open, and
+// kSkipAnyCorruptedRecords skips the corrupted records.
+//
+// Limitations:
+// - The dbs must have distinct identities: a copy of a db (e.g. a checkpoint
+//   or a restored backup) keeps the identity of the original, and fails to
+//   open while the original is open with the same SharedWal.
+// - The records of the existing shared log files are kept in memory by Open()
+//   until the dbs that wrote them flush them.
+// - A db that is not opened in the process keeps all the shared log files
+//   with its records alive. Use ForgetDb() for dbs that were destroyed.
+// - GetUpdatesSince(), checkpoints, backups and read-only or secondary
+//   instances only see the empty WAL files of the db, so they miss the
+//   records that are not flushed yet.
+// - Not supported with two_write_queues, unordered_write, manual_wal_flush,
+//   use_spdb_writes, track_and_verify_wals_in_manifest or
+//   best_efforts_recovery.
+//
+// The shared log directory must not be used by anything else, and by a single
+// SharedWal at a time.
+class SharedWal {
+ public:
+  // Opens the shared log in dir, creating dir if missing. The existing shared
+  // log files are scanned to find which dbs they hold records of, and a new
+  // file is started.
+  static Status Open(const SharedWalOptions& options, const std::string& dir,
+                     std::shared_ptr<SharedWal>* result);
+
+  virtual ~SharedWal() {}
+
+  // Releases the records of a db that will not be opened again (e.g. it was
+  // destroyed), so they no longer keep the shared log files alive.
+  virtual void ForgetDb(const std::string& db_id) = 0;
+
+  // Number of syncs of the shared log files
+  virtual uint64_t GetNumSyncs() const = 0;
+
+  // Number of shared log files, including the current one
+  virtual uint64_t GetNumLiveFiles() const = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -18,6 +18,7 @@ namespace ROCKSDB_NAMESPACE {
 
 class Env;
 class Logger;
+class RateLimiter;
 
 // SstFileManager is used to track SST and blob files in the DB and control
 // their deletion rate. All SstFileManager public functions are thread-safe.
@@ -82,6 +83,24 @@ class SstFileManager {
   // thread-safe
   virtual uint64_t GetTotalTrashSize() = 0;
 
+  // Return the number of trash files waiting to be deleted. Together with
+  // GetTotalTrashSize(), the backlog of the delete scheduler.
+  // thread-safe
+  virtual uint64_t GetNumPendingTrashFiles() { return 0; }
+
+  // Charge the deletion of trash files to rate_limiter, at Env::IO_LOW
+  // priority, before releasing their space. Setting the DBOptions::rate_limiter
+  // of the dbs coordinates the deletions with the flush and compaction writes.
+  // Files larger than bytes_max_delete_chunk are truncated in slices of
+  // bytes_max_delete_chunk, each charged separately, so that a large deletion
+  // is spread over time instead of releasing all its extents at once, and
+  // GetTotalSize() drops with every slice. While a rate limiter is set, files
+  // are deleted in the background even if the delete rate is 0.
+  // nullptr stops charging the deletions. Ignored by default.
+  // thread-safe
+  virtual void SetDeleteRateLimiter(
+      const std::shared_ptr<RateLimiter>& /*rate_limiter*/) {}
+
   // Set the statistics ptr to dump the stat information
   virtual void SetStatisticsPtr(const std::shared_ptr<Statistics>& stats) = 0;
 };
@@ -35,6 +35,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "rocksdb/cache.h"
 #include "rocksdb/customizable.h"
@@ -814,6 +815,10 @@ struct CuckooTablePropertyNames {
   static const std::string kUseModuleHash;
   // Fixed user key length
   static const std::string kUserKeyLength;
+  // File offset of the sorted index: the ids of all non-empty buckets, as
+  // fixed32 values, in user key order. Used by iterators to seek and scan
+  // without sorting the table. Absent in files written by older versions.
+  static const std::string kSortedIndexOffset;
 };
 
 struct CuckooTableOptions {
@@ -941,11 +946,26 @@ class TableFactory : public Customizable {
 // @plain_table_factory: plain table factory to use. If NULL, use a default one.
 // @cuckoo_table_factory: cuckoo table factory to use. If NULL, use a default
 // one.
+// @table_factory_to_write_per_level: optional per-level override of
+//   table_factory_to_write for flush and compaction outputs. Entry i is used
+//   for files written to level i, and the last entry is used for all deeper
+//   levels. A NULL entry falls back to table_factory_to_write. Files whose
+//   output level is unknown (e.g. SstFileWriter) always use
+//   table_factory_to_write. Plain and cuckoo writers should be the same
+//   factories passed as plain_table_factory / cuckoo_table_factory, so the
+//   files are read back with matching options. A flush builds its file with
+//   the writer of level 0, and keeps that format if the file is added to a
+//   deeper level (flush_to_non_overlapping_level).
+// @bottommost_table_factory_to_write: if not NULL, used for files written to
+//   the bottommost level, taking precedence over the per-level override.
 extern TableFactory* NewAdaptiveTableFactory(
     std::shared_ptr<TableFactory> table_factory_to_write = nullptr,
     std::shared_ptr<TableFactory> block_based_table_factory = nullptr,
     std::shared_ptr<TableFactory> plain_table_factory = nullptr,
-    std::shared_ptr<TableFactory> cuckoo_table_factory = nullptr);
+    std::shared_ptr<TableFactory> cuckoo_table_factory = nullptr,
+    std::vector<std::shared_ptr<TableFactory>>
+        table_factory_to_write_per_level = {},
+    std::shared_ptr<TableFactory> bottommost_table_factory_to_write = nullptr);
 
 
 }  // namespace ROCKSDB_NAMESPACE
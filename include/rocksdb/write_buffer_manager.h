@@ -43,6 +43,7 @@
 
 namespace ROCKSDB_NAMESPACE {
 struct Options;
+class ArenaBlockPool;
 class CacheReservationManager;
 class InstrumentedMutex;
 class InstrumentedCondVar;
@@ -88,6 +89,22 @@ class WriteBufferManager final {
     size_t max_num_parallel_flushes = kDfltMaxNumParallelFlushes;
   };
 
+  struct ArenaBlockPoolOptions {
+    ArenaBlockPoolOptions() {}
+
+    ArenaBlockPoolOptions(size_t _capacity, bool _prefault = false)
+        : capacity(_capacity), prefault(_prefault) {}
+
+    // The max bytes of memtable arena blocks kept for reuse once their
+    // memtables are freed. 0 disables the pool.
+    size_t capacity = 0U;
+
+    // Touch every page of a block when it's allocated, so that the memtable
+    // inserts don't take page faults. Blocks reused from the pool are already
+    // faulted in.
+    bool prefault = false;
+  };
+
   static constexpr bool kDfltAllowStall = false;
   static constexpr bool kDfltInitiateFlushes = true;
 
@@ -116,13 +133,24 @@ class WriteBufferManager final {
   // call ShouldFlush() and the WBM will indicate if current memory usage merits
   // a flush. Currently the ShouldFlush() mechanism is used only in the
   // write-path of a DB.
+  //
+  // arena_block_pool_options: if the capacity is set, the arena blocks of the
+  // memtables of all the DB-s sharing the WBM are kept in a pool once the
+  // memtables are freed, and reused by new memtables, rather than freed and
+  // allocated again (which is expensive for large blocks, and for huge page
+  // blocks in particular). The pool never keeps more blocks than fit under
+  // buffer_size along with memory_usage(): blocks are only pooled if they
+  // fit, and pooled blocks are freed as memory_usage() grows. The pooled
+  // bytes are charged to the cache (if any) along with memory_usage().
   explicit WriteBufferManager(
       size_t _buffer_size, std::shared_ptr<Cache> cache = {},
       bool allow_stall = kDfltAllowStall,
       bool initiate_flushes = kDfltInitiateFlushes,
       const FlushInitiationOptions& flush_initiation_options =
           FlushInitiationOptions(),
-      uint16_t start_delay_percent = kDfltStartDelayPercentThreshold);
+      uint16_t start_delay_percent = kDfltStartDelayPercentThreshold,
+      const ArenaBlockPoolOptions& arena_block_pool_options =
+          ArenaBlockPoolOptions());
 
   // No copying allowed
   WriteBufferManager(const WriteBufferManager&) = delete;
@@ -164,6 +192,10 @@ class WriteBufferManager final {
 
   size_t dummy_entries_in_cache_usage() const;
 
+  // Returns the bytes of the arena blocks kept for reuse by new memtables (see
+  // ArenaBlockPoolOptions). Not included in memory_usage().
+  size_t arena_block_pool_usage() const;
+
   // Returns the buffer_size.
   size_t buffer_size() const {
     return buffer_size_.load(std::memory_order_relaxed);
@@ -274,6 +306,13 @@ class WriteBufferManager final {
 
   void RemoveDBFromQueue(StallInterface* wbm_stall);
 
+  // Returns the pool of arena blocks for the memtables, or nullptr if it's
+  // disabled
+  ArenaBlockPool* arena_block_pool() const { return arena_block_pool_.get(); }
+
+  // Called by the arena block pool when its usage changed
+  void ArenaBlockPoolUsageChanged();
+
   std::string GetPrintableOptions() const;
 
  public:
@@ -402,6 +441,7 @@ class WriteBufferManager final {
   std::shared_ptr<CacheReservationManager> cache_res_mgr_;
   // Protects cache_res_mgr_
   std::mutex cache_res_mgr_mu_;
+  std::unique_ptr<ArenaBlockPool> arena_block_pool_;
 
   std::list<StallInterface*> queue_;
   // Protects the queue_ and stall_active_.
@@ -28,6 +28,7 @@
 #include <utility>
 
 #include "logging/logging.h"
+#include "memory/arena_block_pool.h"
 #include "port/malloc.h"
 #include "port/port.h"
 #include "rocksdb/env.h"
@@ -48,8 +49,11 @@ size_t Arena::OptimizeBlockSize(size_t block_size) {
   return block_size;
 }
 
-Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size)
-    : kBlockSize(OptimizeBlockSize(block_size)), tracker_(tracker) {
+Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size,
+             ArenaBlockPool* block_pool)
+    : kBlockSize(OptimizeBlockSize(block_size)),
+      tracker_(tracker),
+      block_pool_(block_pool) {
   assert(kBlockSize >= kMinBlockSize && kBlockSize <= kMaxBlockSize &&
          kBlockSize % kAlignUnit == 0);
   TEST_SYNC_POINT_CALLBACK("Arena::Arena:0", const_cast<size_t*>(&kBlockSize));
@@ -81,11 +85,28 @@ Arena::~Arena() {
     arena_tracker_.arena_stats[itr.second.first].second.fetch_sub(block_size);
     arena_tracker_.total.fetch_sub(block_size);
   }
+  for (const auto& itr : pool_blocks_) {
+    size_t block_size = malloc_usable_size(itr.first);
+    arena_tracker_.arena_stats[itr.second].second.fetch_sub(block_size);
+    arena_tracker_.total.fetch_sub(block_size);
+  }
 #endif
   if (tracker_ != nullptr) {
     assert(tracker_->IsMemoryFreed());
     tracker_->FreeMem();
   }
+  if (block_pool_ != nullptr) {
+    for (const auto& itr : pool_blocks_) {
+      block_pool_->ReleaseBlock(itr.first, kBlockSize);
+    }
+    for (auto& itr : huge_blocks_) {
+#ifdef MEMORY_REPORTING
+      block_pool_->ReleaseHugeBlock(std::move(itr.first));
+#else
+      block_pool_->ReleaseHugeBlock(std::move(itr));
+#endif
+    }
+  }
 }
 
 char* Arena::AllocateFallback(size_t bytes, bool aligned, uint8_t caller_name) {
@@ -122,7 +143,9 @@ char* Arena::AllocateFallback(size_t bytes, bool aligned, uint8_t caller_name) {
 
 char* Arena::AllocateFromHugePage(size_t bytes,
                                   [[maybe_unused]] uint8_t caller_name) {
-  MemMapping mm = MemMapping::AllocateHuge(bytes);
+  MemMapping mm = (block_pool_ != nullptr)
+                      ? block_pool_->AllocateHugeBlock(bytes)
+                      : MemMapping::AllocateHuge(bytes);
 #ifdef MEMORY_REPORTING
   arena_tracker_.arena_stats[caller_name].second.fetch_add(bytes);
   arena_tracker_.total.fetch_add(bytes);
@@ -182,18 +205,26 @@ char* Arena::AllocateAligned(size_t bytes, uint8_t caller_name,
 
 char* Arena::AllocateNewBlock(size_t block_bytes,
                               [[maybe_unused]] uint8_t caller_name) {
-  // NOTE: std::make_unique zero-initializes the block so is not appropriate
-  // here
-  char* block = new char[block_bytes];
+  char* block;
+  if (block_pool_ != nullptr && block_bytes == kBlockSize) {
+    block = block_pool_->AllocateBlock(block_bytes);
+    pool_blocks_.emplace_back(block, caller_name);
+  } else {
+    // NOTE: std::make_unique zero-initializes the block so is not appropriate
+    // here
+    block = new char[block_bytes];
+#ifdef MEMORY_REPORTING
+    blocks_.push_back(
+        std::make_pair(std::unique_ptr<char[]>(block), caller_name));
+#else
+    blocks_.push_back(std::unique_ptr<char[]>(block));
+#endif
+  }
   size_t allocated_size;
 #ifdef MEMORY_REPORTING
   allocated_size = malloc_usable_size(block);
   arena_tracker_.arena_stats[caller_name].second.fetch_add(allocated_size);
   arena_tracker_.total.fetch_add(allocated_size);
-  blocks_.push_back(
-      std::make_pair(std::unique_ptr<char[]>(block), caller_name));
-#else
-  blocks_.push_back(std::unique_ptr<char[]>(block));
 #endif
 
 #ifdef ROCKSDB_MALLOC_USABLE_SIZE
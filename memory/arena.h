@@ -39,6 +39,8 @@
 #include "rocksdb/env.h"
 
 namespace ROCKSDB_NAMESPACE {
+class ArenaBlockPool;
+
 struct ArenaTracker {
   // Count must be the last item of the enum
   enum ArenaStats {
@@ -61,6 +63,8 @@ struct ArenaTracker {
     HashSkipListDynamicIterator,
     HashSpdb,
     HashSpdbIterator,
+    BPlusTree,
+    BPlusTreeIterator,
     InlineSkipList,
     SkipList,
     SkipListIterator,
@@ -107,6 +111,8 @@ struct ArenaTracker {
                             "HashSkipListDynamicIterator",
                             "HashSpdb",
                             "HashSpdbIterator",
+                            "BPlusTree",
+                            "BPlusTreeIterator",
                             "InlineSkipList",
                             "SkipList",
                             "SkipListIterator",
@@ -153,8 +159,11 @@ class Arena : public Allocator {
   // huge_page_size: if 0, don't use huge page TLB. If > 0 (should set to the
   // supported hugepage size of the system), block allocation will try huge
   // page TLB first. If allocation fails, will fall back to normal case.
+  // block_pool: if not nullptr, the blocks of block_size bytes and the huge
+  // page blocks are taken from it, and handed back to it on destruction.
   explicit Arena(size_t block_size = kMinBlockSize,
-                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0);
+                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0,
+                 ArenaBlockPool* block_pool = nullptr);
   ~Arena();
 
   char* Allocate(size_t bytes, uint8_t caller_name) override;
@@ -179,7 +188,8 @@ class Arena : public Allocator {
   // by the arena (exclude the space allocated but not yet used for future
   // allocations).
   size_t ApproximateMemoryUsage() const {
-    return blocks_memory_ + blocks_.size() * sizeof(char*) -
+    return blocks_memory_ +
+           (blocks_.size() + pool_blocks_.size()) * sizeof(char*) -
            alloc_bytes_remaining_;
   }
 
@@ -194,7 +204,7 @@ class Arena : public Allocator {
   size_t BlockSize() const override { return kBlockSize; }
 
   bool IsInInlineBlock() const {
-    return blocks_.empty() && huge_blocks_.empty();
+    return blocks_.empty() && pool_blocks_.empty() && huge_blocks_.empty();
   }
 
   // check and adjust the block_size so that the return value is
@@ -217,6 +227,9 @@ class Arena : public Allocator {
   // Huge page allocations
   std::deque<MemMapping> huge_blocks_;
 #endif
+  // Blocks of kBlockSize bytes taken from block_pool_ (with the caller of
+  // their allocation, for MEMORY_REPORTING), handed back on destruction
+  std::deque<std::pair<char*, uint8_t>> pool_blocks_;
   size_t irregular_block_num = 0;
 
   // Stats for current active block.
@@ -239,6 +252,7 @@ class Arena : public Allocator {
   size_t blocks_memory_ = 0;
   // Non-owned
   AllocTracker* tracker_;
+  ArenaBlockPool* const block_pool_;
 };
 
 inline char* Arena::Allocate(size_t bytes, uint8_t caller_name) {
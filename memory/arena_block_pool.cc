@@ -0,0 +1,173 @@
+// Copyright (C) 2023 Speedb Ltd. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "memory/arena_block_pool.h"
+
+#include <utility>
+
+#include "port/port.h"
+#include "test_util/sync_point.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+ArenaBlockPool::ArenaBlockPool(
+    WriteBufferManager* write_buffer_manager,
+    const WriteBufferManager::ArenaBlockPoolOptions& options)
+    : write_buffer_manager_(write_buffer_manager), options_(options) {
+  assert(write_buffer_manager_ != nullptr);
+}
+
+ArenaBlockPool::~ArenaBlockPool() {
+  for (auto& size_and_blocks : blocks_) {
+    for (char* block : size_and_blocks.second) {
+      delete[] block;
+    }
+  }
+}
+
+char* ArenaBlockPool::AllocateBlock(size_t block_size) {
+  char* block = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = blocks_.find(block_size);
+    if (it != blocks_.end() && !it->second.empty()) {
+      block = it->second.back();
+      it->second.pop_back();
+      usage_.fetch_sub(block_size, std::memory_order_relaxed);
+    }
+  }
+  if (block != nullptr) {
+    TEST_SYNC_POINT("ArenaBlockPool::AllocateBlock:Reused");
+    UsageChanged();
+    return block;
+  }
+  // NOTE: std::make_unique zero-initializes the block so is not appropriate
+  // here
+  block = new char[block_size];
+  if (options_.prefault) {
+    Prefault(block, block_size);
+  }
+  return block;
+}
+
+MemMapping ArenaBlockPool::AllocateHugeBlock(size_t size) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = huge_blocks_.find(size);
+    if (it != huge_blocks_.end() && !it->second.empty()) {
+      MemMapping block = std::move(it->second.back());
+      it->second.pop_back();
+      usage_.fetch_sub(size, std::memory_order_relaxed);
+      lock.unlock();
+      TEST_SYNC_POINT("ArenaBlockPool::AllocateHugeBlock:Reused");
+      UsageChanged();
+      return block;
+    }
+  }
+  MemMapping block = MemMapping::AllocateHuge(size);
+  if (options_.prefault && block.Get() != nullptr) {
+    Prefault(static_cast<char*>(block.Get()), size);
+  }
+  return block;
+}
+
+void ArenaBlockPool::ReleaseBlock(char* block, size_t block_size) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (HasRoomFor(block_size)) {
+      blocks_[block_size].push_back(block);
+      usage_.fetch_add(block_size, std::memory_order_relaxed);
+      block = nullptr;
+    }
+  }
+  if (block == nullptr) {
+    UsageChanged();
+  } else {
+    delete[] block;
+  }
+}
+
+void ArenaBlockPool::ReleaseHugeBlock(MemMapping block) {
+  const size_t size = block.Length();
+  bool pooled = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (size > 0 && HasRoomFor(size)) {
+      huge_blocks_[size].push_back(std::move(block));
+      usage_.fetch_add(size, std::memory_order_relaxed);
+      pooled = true;
+    }
+  }
+  // Otherwise the mapping is released on return
+  if (pooled) {
+    UsageChanged();
+  }
+}
+
+void ArenaBlockPool::Evict(size_t max_usage) {
+  std::vector<char*> evicted_blocks;
+  std::vector<MemMapping> evicted_huge_blocks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& size_and_blocks : blocks_) {
+      auto& blocks = size_and_blocks.second;
+      while (!blocks.empty() &&
+             usage_.load(std::memory_order_relaxed) > max_usage) {
+        evicted_blocks.push_back(blocks.back());
+        blocks.pop_back();
+        usage_.fetch_sub(size_and_blocks.first, std::memory_order_relaxed);
+      }
+    }
+    for (auto& size_and_blocks : huge_blocks_) {
+      auto& blocks = size_and_blocks.second;
+      while (!blocks.empty() &&
+             usage_.load(std::memory_order_relaxed) > max_usage) {
+        evicted_huge_blocks.push_back(std::move(blocks.back()));
+        blocks.pop_back();
+        usage_.fetch_sub(size_and_blocks.first, std::memory_order_relaxed);
+      }
+    }
+  }
+  if (evicted_blocks.empty() && evicted_huge_blocks.empty()) {
+    return;
+  }
+  // Free the blocks outside the mutex, the mappings are released on return
+  for (char* block : evicted_blocks) {
+    delete[] block;
+  }
+  TEST_SYNC_POINT("ArenaBlockPool::Evict:Evicted");
+  UsageChanged();
+}
+
+bool ArenaBlockPool::HasRoomFor(size_t size) const {
+  const size_t usage = usage_.load(std::memory_order_relaxed);
+  if (usage + size > options_.capacity) {
+    return false;
+  }
+  return !write_buffer_manager_->enabled() ||
+         write_buffer_manager_->memory_usage() + usage + size <=
+             write_buffer_manager_->buffer_size();
+}
+
+void ArenaBlockPool::Prefault(char* block, size_t size) {
+  for (size_t offset = 0; offset < size; offset += port::kPageSize) {
+    block[offset] = 0;
+  }
+}
+
+void ArenaBlockPool::UsageChanged() {
+  write_buffer_manager_->ArenaBlockPoolUsageChanged();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
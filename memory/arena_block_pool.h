@@ -0,0 +1,94 @@
+// Copyright (C) 2023 Speedb Ltd. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// ArenaBlockPool keeps the blocks of destroyed arenas (i.e. the memtables of
+// a WriteBufferManager, once flushed) for reuse by new arenas, so that a new
+// memtable writes to memory that is already mapped and faulted in, instead of
+// allocating fresh blocks while the blocks of the flushed memtable are handed
+// back to the allocator (or unmapped, for huge pages).
+//
+// Regular blocks and huge page blocks are pooled separately, by size. The
+// pooled bytes are bounded by the capacity of the pool, and by the room left
+// under the buffer size of the WriteBufferManager (when enabled), so that the
+// memtables and the pool together don't use more memory than the memtables
+// alone are allowed to. The WriteBufferManager evicts pooled blocks as the
+// memtables grow into that room. The pooled bytes are charged to the block cache of the
+// WriteBufferManager, if it has one.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "port/mmap.h"
+#include "rocksdb/write_buffer_manager.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class ArenaBlockPool {
+ public:
+  // write_buffer_manager is not owned, and must outlive the pool
+  ArenaBlockPool(WriteBufferManager* write_buffer_manager,
+                 const WriteBufferManager::ArenaBlockPoolOptions& options);
+  ~ArenaBlockPool();
+
+  // No copying allowed
+  ArenaBlockPool(const ArenaBlockPool&) = delete;
+  void operator=(const ArenaBlockPool&) = delete;
+
+  // Returns a pooled block of block_size bytes, or a newly allocated one
+  // (with new[]) if there is none.
+  char* AllocateBlock(size_t block_size);
+
+  // Returns a pooled huge page mapping of size bytes, or a new one if there is
+  // none. The returned mapping is empty if the allocation failed.
+  MemMapping AllocateHugeBlock(size_t size);
+
+  // Takes back a block returned by AllocateBlock(block_size), which is kept
+  // for reuse if there is room for it, and deleted otherwise.
+  void ReleaseBlock(char* block, size_t block_size);
+
+  // Like ReleaseBlock, for a mapping returned by AllocateHugeBlock
+  void ReleaseHugeBlock(MemMapping block);
+
+  // Frees pooled blocks until the pool keeps at most max_usage bytes
+  void Evict(size_t max_usage);
+
+  // Returns the bytes of the blocks kept in the pool
+  size_t GetUsage() const { return usage_.load(std::memory_order_relaxed); }
+
+  size_t GetCapacity() const { return options_.capacity; }
+
+ private:
+  // Returns true if size more bytes may be kept in the pool
+  bool HasRoomFor(size_t size) const;
+  // Touches every page of the size bytes at block
+  static void Prefault(char* block, size_t size);
+  // Called after usage_ changed, without holding mutex_
+  void UsageChanged();
+
+  WriteBufferManager* const write_buffer_manager_;
+  const WriteBufferManager::ArenaBlockPoolOptions options_;
+
+  std::mutex mutex_;
+  // Pooled blocks by size, protected by mutex_
+  std::unordered_map<size_t, std::vector<char*>> blocks_;
+  std::unordered_map<size_t, std::vector<MemMapping>> huge_blocks_;
+  std::atomic<size_t> usage_{0};
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -30,7 +30,17 @@
 #ifndef OS_WIN
 #include <sys/resource.h>
 #endif
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "memory/arena_block_pool.h"
+#include "memory/concurrent_arena.h"
 #include "port/port.h"
+#include "rocksdb/write_buffer_manager.h"
+#include "test_util/sync_point.h"
 #include "test_util/testharness.h"
 #include "util/random.h"
 
@@ -313,6 +323,258 @@ TEST_F(ArenaTest, UnmappedAllocation) {
   }
 }
 
+namespace {
+// Allocates num_blocks blocks of block_size bytes in arena, and returns them
+std::vector<char*> AllocateBlocks(Arena* arena, size_t block_size,
+                                  size_t num_blocks) {
+  std::vector<char*> blocks;
+  // Fill the inline block first, so that the allocations below take a new
+  // block each
+  arena->Allocate(Arena::kInlineSize, ArenaTracker::ArenaStats::arena_test);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    // The first aligned allocation of a block is at its head
+    blocks.push_back(arena->AllocateAligned(
+        block_size / 4, ArenaTracker::ArenaStats::arena_test));
+    for (int j = 0; j < 3; ++j) {
+      arena->AllocateAligned(block_size / 4,
+                             ArenaTracker::ArenaStats::arena_test);
+    }
+  }
+  return blocks;
+}
+}  // namespace
+
+TEST_F(ArenaTest, BlockPoolReusesBlocks) {
+  constexpr size_t kBlockSize = 64U << 10;
+  WriteBufferManager wbm(0 /* buffer_size */, {} /* cache */,
+                         false /* allow_stall */, false /* initiate_flushes */,
+                         WriteBufferManager::FlushInitiationOptions(),
+                         WriteBufferManager::kDfltStartDelayPercentThreshold,
+                         WriteBufferManager::ArenaBlockPoolOptions(
+                             8 * kBlockSize, true /* prefault */));
+  ArenaBlockPool* pool = wbm.arena_block_pool();
+  ASSERT_NE(pool, nullptr);
+  ASSERT_EQ(pool->GetCapacity(), 8 * kBlockSize);
+  ASSERT_EQ(wbm.arena_block_pool_usage(), 0U);
+
+  std::vector<char*> first_blocks;
+  {
+    Arena arena(kBlockSize, nullptr /* tracker */, 0 /* huge_page_size */,
+                pool);
+    first_blocks = AllocateBlocks(&arena, kBlockSize, 4);
+    ASSERT_EQ(wbm.arena_block_pool_usage(), 0U);
+  }
+  ASSERT_EQ(wbm.arena_block_pool_usage(), 4 * kBlockSize);
+
+  {
+    Arena arena(kBlockSize, nullptr /* tracker */, 0 /* huge_page_size */,
+                pool);
+    std::vector<char*> blocks = AllocateBlocks(&arena, kBlockSize, 3);
+    ASSERT_EQ(wbm.arena_block_pool_usage(), kBlockSize);
+    // All the blocks came from the pool
+    for (char* block : blocks) {
+      ASSERT_NE(std::find(first_blocks.begin(), first_blocks.end(), block),
+                first_blocks.end());
+    }
+  }
+  ASSERT_EQ(wbm.arena_block_pool_usage(), 4 * kBlockSize);
+
+  // Blocks of another size are pooled separately
+  {
+    Arena arena(2 * kBlockSize, nullptr /* tracker */, 0 /* huge_page_size */,
+                pool);
+    AllocateBlocks(&arena, 2 * kBlockSize, 2);
+    ASSERT_EQ(wbm.arena_block_pool_usage(), 4 * kBlockSize);
+  }
+  ASSERT_EQ(wbm.arena_block_pool_usage(), 8 * kBlockSize);
+}
+
+TEST_F(ArenaTest, BlockPoolCapacity) {
+  constexpr size_t kBlockSize = 64U << 10;
+  WriteBufferManager wbm(
+      0 /* buffer_size */, {} /* cache */, false /* allow_stall */,
+      false /* initiate_flushes */,
+      WriteBufferManager::FlushInitiationOptions(),
+      WriteBufferManager::kDfltStartDelayPercentThreshold,
+      WriteBufferManager::ArenaBlockPoolOptions(2 * kBlockSize));
+  {
+    Arena arena(kBlockSize, nullptr /* tracker */, 0 /* huge_page_size */,
+                wbm.arena_block_pool());
+    AllocateBlocks(&arena, kBlockSize, 5);
+  }
+  ASSERT_EQ(wbm.arena_block_pool_usage(), 2 * kBlockSize);
+}
+
+TEST_F(ArenaTest, BlockPoolBoundedByBufferSize) {
+  constexpr size_t kBlockSize = 64U << 10;
+  WriteBufferManager wbm(
+      4 * kBlockSize, {} /* cache */, false /* allow_stall */,
+      false /* initiate_flushes */,
+      WriteBufferManager::FlushInitiationOptions(),
+      WriteBufferManager::kDfltStartDelayPercentThreshold,
+      WriteBufferManager::ArenaBlockPoolOptions(16 * kBlockSize));
+  // The memtables use 3 of the 4 blocks allowed
+  wbm.ReserveMem(3 * kBlockSize);
+  {
+    Arena arena(kBlockSize, nullptr /* tracker */, 0 /* huge_page_size */,
+                wbm.arena_block_pool());
+    AllocateBlocks(&arena, kBlockSize, 3);
+  }
+  ASSERT_EQ(wbm.arena_block_pool_usage(), kBlockSize);
+  // Pooled blocks are not memtable memory
+  ASSERT_EQ(wbm.memory_usage(), 3 * kBlockSize);
+  wbm.ScheduleFreeMem(3 * kBlockSize);
+  wbm.FreeMemBegin(3 * kBlockSize);
+  wbm.FreeMem(3 * kBlockSize);
+  ASSERT_EQ(wbm.memory_usage(), 0U);
+
+  // Fill the pool, then grow the memtables into its room
+  {
+    Arena arena(kBlockSize, nullptr /* tracker */, 0 /* huge_page_size */,
+                wbm.arena_block_pool());
+    AllocateBlocks(&arena, kBlockSize, 4);
+  }
+  ASSERT_EQ(wbm.arena_block_pool_usage(), 4 * kBlockSize);
+  wbm.ReserveMem(kBlockSize / 2);
+  ASSERT_EQ(wbm.arena_block_pool_usage(), 3 * kBlockSize);
+  wbm.ReserveMem(2 * kBlockSize);
+  ASSERT_EQ(wbm.arena_block_pool_usage(), kBlockSize);
+  wbm.ReserveMem(2 * kBlockSize);
+  ASSERT_EQ(wbm.arena_block_pool_usage(), 0U);
+  wbm.ScheduleFreeMem(wbm.memory_usage());
+  wbm.FreeMemBegin(wbm.memory_usage());
+  wbm.FreeMem(wbm.memory_usage());
+}
+
+TEST_F(ArenaTest, ConcurrentArenaNumaLocal) {
+  constexpr size_t kBlockSize = 64U << 10;
+  constexpr int kNumThreads = 8;
+  constexpr int kNumAllocations = 4096;
+  constexpr size_t kAllocationSize = 40;
+
+  // Pretend that the cpus alternate between 2 NUMA nodes
+  SyncPoint::GetInstance()->SetCallBack(
+      "ConcurrentArena::ConcurrentArena:CpuNodes", [](void* arg) {
+        auto* cpu_nodes = static_cast<std::vector<int>*>(arg);
+        cpu_nodes->clear();
+        for (int cpu = 0; cpu < 1024; ++cpu) {
+          cpu_nodes->push_back(cpu % 2);
+        }
+      });
+  std::atomic<int> num_node_refills{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "ConcurrentArena::AllocateFromNodeArena",
+      [&](void* /* arg */) { ++num_node_refills; });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ConcurrentArena arena(kBlockSize, nullptr /* tracker */,
+                        0 /* huge_page_size */, nullptr /* block_pool */,
+                        true /* numa_local */);
+  ASSERT_EQ(arena.NumNodeArenas(), 2U);
+
+  // Every thread fills its allocations with its index, so that overlapping
+  // allocations are detected
+  std::vector<std::vector<char*>> allocations(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumAllocations; ++i) {
+        char* p = (i % 2 == 0)
+                      ? arena.AllocateAligned(
+                            kAllocationSize,
+                            ArenaTracker::ArenaStats::arena_test)
+                      : arena.Allocate(kAllocationSize - 1,
+                                       ArenaTracker::ArenaStats::arena_test);
+        memset(p, t, kAllocationSize - 1);
+        allocations[t].push_back(p);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  // The small allocations are served by the shards, refilled from the node
+  // arenas
+  ASSERT_GT(num_node_refills.load(), 0);
+  for (int t = 0; t < kNumThreads; ++t) {
+    for (char* p : allocations[t]) {
+      for (size_t j = 0; j < kAllocationSize - 1; ++j) {
+        ASSERT_EQ(p[j], static_cast<char>(t));
+      }
+    }
+  }
+
+  const size_t allocated_bytes =
+      kNumThreads * kNumAllocations * (kAllocationSize - 1);
+  ASSERT_GE(arena.MemoryAllocatedBytes(), allocated_bytes);
+  ASSERT_GE(arena.ApproximateMemoryUsage(), allocated_bytes);
+  ASSERT_LE(arena.ApproximateMemoryUsage(), arena.MemoryAllocatedBytes());
+  ASSERT_LE(arena.AllocatedAndUnused(), arena.MemoryAllocatedBytes());
+}
+
+TEST_F(ArenaTest, ConcurrentArenaNumaLocalSkipsBlockPool) {
+  constexpr size_t kBlockSize = 64U << 10;
+  WriteBufferManager wbm(0 /* buffer_size */, {} /* cache */,
+                         false /* allow_stall */, false /* initiate_flushes */,
+                         WriteBufferManager::FlushInitiationOptions(),
+                         WriteBufferManager::kDfltStartDelayPercentThreshold,
+                         WriteBufferManager::ArenaBlockPoolOptions(
+                             8 * kBlockSize));
+  {
+    Arena arena(kBlockSize, nullptr /* tracker */, 0 /* huge_page_size */,
+                wbm.arena_block_pool());
+    AllocateBlocks(&arena, kBlockSize, 4);
+  }
+  ASSERT_EQ(wbm.arena_block_pool_usage(), 4 * kBlockSize);
+
+  SyncPoint::GetInstance()->SetCallBack(
+      "ConcurrentArena::ConcurrentArena:CpuNodes", [](void* arg) {
+        auto* cpu_nodes = static_cast<std::vector<int>*>(arg);
+        cpu_nodes->clear();
+        for (int cpu = 0; cpu < 1024; ++cpu) {
+          cpu_nodes->push_back(cpu % 2);
+        }
+      });
+  std::atomic<int> num_node_refills{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "ConcurrentArena::AllocateFromNodeArena",
+      [&](void* /* arg */) { ++num_node_refills; });
+  SyncPoint::GetInstance()->EnableProcessing();
+  {
+    ConcurrentArena arena(kBlockSize, nullptr /* tracker */,
+                          0 /* huge_page_size */, wbm.arena_block_pool(),
+                          true /* numa_local */);
+    ASSERT_EQ(arena.NumNodeArenas(), 2U);
+    for (int i = 0; i < 1024; ++i) {
+      arena.Allocate(100, ArenaTracker::ArenaStats::arena_test);
+    }
+    ASSERT_GT(num_node_refills.load(), 0);
+    // The pooled blocks may have been faulted in on another node
+    ASSERT_EQ(wbm.arena_block_pool_usage(), 4 * kBlockSize);
+  }
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  // Nor are the blocks of the node arenas pooled
+  ASSERT_EQ(wbm.arena_block_pool_usage(), 4 * kBlockSize);
+}
+
+TEST_F(ArenaTest, ConcurrentArenaNumaLocalSingleNode) {
+  SyncPoint::GetInstance()->SetCallBack(
+      "ConcurrentArena::ConcurrentArena:CpuNodes", [](void* arg) {
+        auto* cpu_nodes = static_cast<std::vector<int>*>(arg);
+        cpu_nodes->assign(4, 0);
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ConcurrentArena arena(Arena::kMinBlockSize, nullptr /* tracker */,
+                        0 /* huge_page_size */, nullptr /* block_pool */,
+                        true /* numa_local */);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  // Nothing to gain from a single node arena
+  ASSERT_EQ(arena.NumNodeArenas(), 0U);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -9,9 +9,15 @@
 
 #include "memory/concurrent_arena.h"
 
+#ifdef NUMA
+#include <numa.h>
+#endif
+
+#include <algorithm>
 #include <thread>
 
 #include "port/port.h"
+#include "test_util/sync_point.h"
 #include "util/random.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -24,14 +30,55 @@ namespace {
 // 1MB, 64 cores will quickly allocate 64MB, and may quickly trigger a
 // flush. Cap the size instead.
 const size_t kMaxShardBlockSize = size_t{128 * 1024};
+
+// Returns the NUMA node of every cpu, or an empty vector if the process may
+// only run on one node. Computed once, as libnuma reads it from sysfs.
+const std::vector<int>& GetCpuNodes() {
+  static const std::vector<int> cpu_nodes = []() {
+    std::vector<int> nodes;
+#ifdef NUMA
+    if (numa_available() != -1 && numa_max_node() > 0) {
+      const int num_cpus = numa_num_configured_cpus();
+      for (int cpu = 0; cpu < num_cpus; ++cpu) {
+        nodes.push_back(std::max(numa_node_of_cpu(cpu), 0));
+      }
+    }
+#endif
+    return nodes;
+  }();
+  return cpu_nodes;
+}
 }  // namespace
 
 ConcurrentArena::ConcurrentArena(size_t block_size, AllocTracker* tracker,
-                                 size_t huge_page_size)
+                                 size_t huge_page_size,
+                                 ArenaBlockPool* block_pool, bool numa_local)
     : shard_block_size_(std::min(kMaxShardBlockSize, block_size / 8)),
       shards_(),
-      arena_(block_size, tracker, huge_page_size) {
+      arena_(block_size, tracker, huge_page_size, block_pool) {
   Fixup();
+
+  if (numa_local) {
+    cpu_nodes_ = GetCpuNodes();
+    TEST_SYNC_POINT_CALLBACK("ConcurrentArena::ConcurrentArena:CpuNodes",
+                             &cpu_nodes_);
+    const int num_nodes =
+        cpu_nodes_.empty()
+            ? 0
+            : *std::max_element(cpu_nodes_.begin(), cpu_nodes_.end()) + 1;
+    if (num_nodes > 1) {
+      // Every node arena holds at most one partially used block, so they use
+      // blocks of a few shard blocks rather than of block_size
+      const size_t node_block_size =
+          std::min(block_size, shard_block_size_ * 8);
+      for (int node = 0; node < num_nodes; ++node) {
+        node_arenas_.emplace_back(
+            new NodeArena(node_block_size, tracker, huge_page_size));
+      }
+    } else {
+      cpu_nodes_.clear();
+    }
+  }
 }
 
 ConcurrentArena::Shard* ConcurrentArena::Repick() {
@@ -42,4 +89,32 @@ ConcurrentArena::Shard* ConcurrentArena::Repick() {
   return shard_and_index.first;
 }
 
+ConcurrentArena::NodeArena* ConcurrentArena::CurrentNodeArena() {
+  const int cpu = port::PhysicalCoreID();
+  if (cpu < 0 || static_cast<size_t>(cpu) >= cpu_nodes_.size()) {
+    return nullptr;
+  }
+  return node_arenas_[cpu_nodes_[cpu]].get();
+}
+
+char* ConcurrentArena::AllocateFromNodeArena(NodeArena* node_arena,
+                                             size_t* avail,
+                                             uint8_t caller_name) {
+  TEST_SYNC_POINT_CALLBACK("ConcurrentArena::AllocateFromNodeArena",
+                           node_arena);
+  std::lock_guard<SpinMutex> lock(node_arena->mutex);
+  Arena& arena = node_arena->arena;
+  // As for arena_, use up the current block if it's about the right size
+  const size_t exact = arena.AllocatedAndUnused();
+  *avail = exact >= shard_block_size_ / 2 && exact < shard_block_size_ * 2
+               ? exact
+               : shard_block_size_;
+  char* rv = arena.AllocateAligned(*avail, caller_name);
+  node_arena->allocated_and_unused.store(arena.AllocatedAndUnused(),
+                                         std::memory_order_relaxed);
+  node_arena->memory_allocated_bytes.store(arena.MemoryAllocatedBytes(),
+                                           std::memory_order_relaxed);
+  return rv;
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -29,6 +29,7 @@
 #include <atomic>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "memory/allocator.h"
 #include "memory/arena.h"
@@ -57,15 +58,28 @@ class Logger;
 // only if ConcurrentArena actually notices concurrent use, and they
 // adjust their size so that there is no fragmentation waste when the
 // shard blocks are allocated from the underlying main arena.
+//
+// Optionally, the shards are refilled from an arena per NUMA node instead,
+// so that the memory handed out by the shards of the cores of a node is
+// only ever written by threads running on that node.
 class ConcurrentArena : public Allocator {
  public:
-  // block_size and huge_page_size are the same as for Arena (and are
-  // in fact just passed to the constructor of arena_.  The core-local
+  // block_size, huge_page_size and block_pool are the same as for Arena (and
+  // are in fact just passed to the constructor of arena_.  The core-local
   // shards compute their shard_block_size as a fraction of block_size
   // that varies according to the hardware concurrency level.
+  // numa_local: if true, and the process may run on more than one NUMA node
+  // (only detected in a build with NUMA support), the shards are refilled
+  // from an arena per node, chosen by the cpu of the refilling thread. The
+  // pages of the blocks of a node arena are thus first touched on that node,
+  // and placed in its memory by the default (local) policy of the kernel.
+  // The node arenas allocate their own blocks rather than take them from
+  // block_pool.
   explicit ConcurrentArena(size_t block_size = Arena::kMinBlockSize,
                            AllocTracker* tracker = nullptr,
-                           size_t huge_page_size = 0);
+                           size_t huge_page_size = 0,
+                           ArenaBlockPool* block_pool = nullptr,
+                           bool numa_local = false);
 
   char* Allocate(size_t bytes, uint8_t caller_name) override {
     return AllocateImpl(
@@ -93,20 +107,38 @@ class ConcurrentArena : public Allocator {
   }
 
   size_t ApproximateMemoryUsage() const {
+    size_t usage = 0;
+    for (const auto& node_arena : node_arenas_) {
+      std::lock_guard<SpinMutex> lock(node_arena->mutex);
+      usage += node_arena->arena.ApproximateMemoryUsage();
+    }
     std::unique_lock<SpinMutex> lock(arena_mutex_, std::defer_lock);
     lock.lock();
-    return arena_.ApproximateMemoryUsage() - ShardAllocatedAndUnused();
+    return usage + arena_.ApproximateMemoryUsage() - ShardAllocatedAndUnused();
   }
 
   size_t MemoryAllocatedBytes() const {
-    return memory_allocated_bytes_.load(std::memory_order_relaxed);
+    size_t total = memory_allocated_bytes_.load(std::memory_order_relaxed);
+    for (const auto& node_arena : node_arenas_) {
+      total +=
+          node_arena->memory_allocated_bytes.load(std::memory_order_relaxed);
+    }
+    return total;
   }
 
   size_t AllocatedAndUnused() const {
-    return arena_allocated_and_unused_.load(std::memory_order_relaxed) +
-           ShardAllocatedAndUnused();
+    size_t total = arena_allocated_and_unused_.load(std::memory_order_relaxed);
+    for (const auto& node_arena : node_arenas_) {
+      total +=
+          node_arena->allocated_and_unused.load(std::memory_order_relaxed);
+    }
+    return total + ShardAllocatedAndUnused();
   }
 
+  // Returns the number of NUMA node arenas (0 unless numa_local is set and
+  // more than one node was detected)
+  size_t NumNodeArenas() const { return node_arenas_.size(); }
+
   size_t IrregularBlockNum() const {
     return irregular_block_num_.load(std::memory_order_relaxed);
   }
@@ -123,6 +155,22 @@ class ConcurrentArena : public Allocator {
     Shard() : free_begin_(nullptr), allocated_and_unused_(0) {}
   };
 
+  // The arena of a NUMA node, from which the shards are refilled by the
+  // threads running on the node (see numa_local)
+  struct NodeArena {
+    // No block pool, its blocks may have been faulted in on another node
+    NodeArena(size_t block_size, AllocTracker* tracker, size_t huge_page_size)
+        : arena(block_size, tracker, huge_page_size, nullptr /* block_pool */),
+          allocated_and_unused(0),
+          memory_allocated_bytes(0) {}
+
+    mutable SpinMutex mutex;
+    Arena arena;
+    // Copies of the stats of arena, which is protected by mutex
+    std::atomic<size_t> allocated_and_unused;
+    std::atomic<size_t> memory_allocated_bytes;
+  };
+
   static thread_local size_t tls_cpuid;
 
   char padding0[56] ROCKSDB_FIELD_UNUSED;
@@ -139,8 +187,22 @@ class ConcurrentArena : public Allocator {
 
   char padding1[56] ROCKSDB_FIELD_UNUSED;
 
+  // Indexed by NUMA node, empty unless numa_local is set and there is more
+  // than one node
+  std::vector<std::unique_ptr<NodeArena>> node_arenas_;
+  // The NUMA node of every cpu, if node_arenas_ is not empty
+  std::vector<int> cpu_nodes_;
+
   Shard* Repick();
 
+  // Returns the arena of the NUMA node of the calling thread, or nullptr if
+  // there are no node arenas or the node is unknown
+  NodeArena* CurrentNodeArena();
+
+  // Allocates avail bytes from node_arena for a shard
+  char* AllocateFromNodeArena(NodeArena* node_arena, size_t* avail,
+                              uint8_t caller_name);
+
   size_t ShardAllocatedAndUnused() const {
     size_t total = 0;
     for (size_t i = 0; i < shards_.Size(); ++i) {
@@ -159,9 +221,11 @@ class ConcurrentArena : public Allocator {
     // we've never needed to Repick() and the arena mutex is available
     // with no waiting.  This keeps the fragmentation penalty of
     // concurrency zero unless it might actually confer an advantage.
+    // With node arenas, small allocations always go through the shards, so
+    // that they are served from the memory of the node of the caller.
     std::unique_lock<SpinMutex> arena_lock(arena_mutex_, std::defer_lock);
     if (bytes > shard_block_size_ / 4 || force_arena ||
-        ((cpu = tls_cpuid) == 0 &&
+        ((cpu = tls_cpuid) == 0 && node_arenas_.empty() &&
          !shards_.AccessAtCore(0)->allocated_and_unused_.load(
              std::memory_order_relaxed) &&
          arena_lock.try_lock())) {
@@ -173,8 +237,11 @@ class ConcurrentArena : public Allocator {
       return rv;
     }
 
-    // pick a shard from which to allocate
-    Shard* s = shards_.AccessAtCore(cpu & (shards_.Size() - 1));
+    // pick a shard from which to allocate (the shard of the current core if
+    // we've never picked one, with node arenas)
+    Shard* s = (cpu == 0 && !node_arenas_.empty())
+                   ? Repick()
+                   : shards_.AccessAtCore(cpu & (shards_.Size() - 1));
     if (!s->mutex.try_lock()) {
       s = Repick();
       s->mutex.lock();
@@ -184,7 +251,7 @@ class ConcurrentArena : public Allocator {
     size_t avail = s->allocated_and_unused_.load(std::memory_order_relaxed);
     if (avail < bytes) {
       // reload
-      std::lock_guard<SpinMutex> reload_lock(arena_mutex_);
+      std::unique_lock<SpinMutex> reload_lock(arena_mutex_);
 
       // If the arena's current block is within a factor of 2 of the right
       // size, we adjust our request to avoid arena waste.
@@ -205,11 +272,18 @@ class ConcurrentArena : public Allocator {
         return rv;
       }
 
-      avail = exact >= shard_block_size_ / 2 && exact < shard_block_size_ * 2
-                  ? exact
-                  : shard_block_size_;
-      s->free_begin_ = arena_.AllocateAligned(avail, caller_name);
-      Fixup();
+      NodeArena* node_arena =
+          node_arenas_.empty() ? nullptr : CurrentNodeArena();
+      if (node_arena != nullptr) {
+        reload_lock.unlock();
+        s->free_begin_ = AllocateFromNodeArena(node_arena, &avail, caller_name);
+      } else {
+        avail = exact >= shard_block_size_ / 2 && exact < shard_block_size_ * 2
+                    ? exact
+                    : shard_block_size_;
+        s->free_begin_ = arena_.AllocateAligned(avail, caller_name);
+        Fixup();
+      }
     }
     s->allocated_and_unused_.store(avail - bytes, std::memory_order_relaxed);
 
@@ -0,0 +1,763 @@
+// Copyright (C) 2023 Speedb Ltd. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// BPlusTree is an ordered set of keys, kept in a B+tree whose nodes are
+// allocated through an Allocator. The keys themselves are allocated and
+// filled in by the caller (e.g. memtable entries), and the tree only stores
+// pointers to them. A leaf holds the pointers to up to kLeafCapacity
+// consecutive keys and is linked to the next leaf, so that a scan reads
+// consecutive slots of a few cache lines instead of chasing a pointer per key
+// as a skip list does.
+//
+// Thread safety -------------
+//
+// Inserts can be called concurrently with each other and with reads. Every
+// node has a version lock (optimistic lock coupling): a writer locks the
+// nodes it modifies, which bumps their version, while readers never write
+// shared memory and retry when the version of a node they read changed in
+// the meantime. Reads require a guarantee that the BPlusTree will not be
+// destroyed while the read is in progress.
+//
+// Invariants:
+//
+// (1) Nodes are never deleted until the BPlusTree is destroyed, so a reader
+// holding a stale node pointer always reads valid memory.
+//
+// (2) A split moves the upper keys of a node to a new right sibling, and the
+// separator added to the parent is the first key of the sibling. As keys are
+// never removed, the first key of a node that is not the leftmost of its
+// level is the separator bounding it in its ancestors, and never changes.
+
+#pragma once
+#include <assert.h>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+#include "memory/allocator.h"
+#include "memory/arena.h"
+#include "port/likely.h"
+#include "port/port.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+template <class Comparator>
+class BPlusTree {
+ private:
+  struct Node;
+  struct InnerNode;
+  struct LeafNode;
+
+ public:
+  static constexpr int kLeafCapacity = 32;
+  static constexpr int kInnerCapacity = 32;
+
+  // Create a new BPlusTree object that will use "cmp" for comparing keys, and
+  // will allocate its nodes using "*allocator". Objects allocated in the
+  // allocator must remain allocated for the lifetime of the tree object.
+  explicit BPlusTree(Comparator cmp, Allocator* allocator);
+  // No copying allowed
+  BPlusTree(const BPlusTree&) = delete;
+  BPlusTree& operator=(const BPlusTree&) = delete;
+
+  // Inserts key, which must remain valid and unchanged for the lifetime of
+  // the tree. Returns false, without inserting it, if a key that compares
+  // equal is already in the tree.
+  bool Insert(const char* key);
+
+  // Like Insert, but first tries the leaf of the previous insert with the same
+  // hint, which makes sequential inserts O(1). *hint must be nullptr before
+  // the first use, and is updated to the leaf of key.
+  //
+  // REQUIRES: no concurrent calls that use the same hint
+  bool InsertWithHint(const char* key, void** hint);
+
+  // Returns true iff an entry that compares equal to key is in the tree.
+  bool Contains(const char* key) const;
+
+  // Validate the structure and the order of the tree.
+  // REQUIRES: no concurrent inserts
+  void TEST_Validate() const;
+
+  // Iteration over the contents of a tree. An iterator sees the keys that
+  // were inserted before it was positioned, and may see the keys inserted
+  // concurrently with its use.
+  class Iterator {
+   public:
+    // Initialize an iterator over the specified tree.
+    // The returned iterator is not valid.
+    explicit Iterator(const BPlusTree* tree);
+
+    // Returns true iff the iterator is positioned at a valid key.
+    bool Valid() const { return key_ != nullptr; }
+
+    // Returns the key at the current position.
+    // REQUIRES: Valid()
+    const char* key() const {
+      assert(Valid());
+      return key_;
+    }
+
+    // Advances to the next position.
+    // REQUIRES: Valid()
+    void Next();
+
+    // Advances to the previous position.
+    // REQUIRES: Valid()
+    void Prev();
+
+    // Advance to the first entry with a key >= target
+    void Seek(const char* target) { SeekForward(target, false /* after */); }
+
+    // Retreat to the last entry with a key <= target
+    void SeekForPrev(const char* target) {
+      SeekBackward(target, true /* inclusive */);
+    }
+
+    // Position at the first entry in tree.
+    // Final state of iterator is Valid() iff tree is not empty.
+    void SeekToFirst();
+
+    // Position at the last entry in tree.
+    // Final state of iterator is Valid() iff tree is not empty.
+    void SeekToLast();
+
+   private:
+    // Positions at the first key > target if after, >= target otherwise
+    void SeekForward(const char* target, bool after);
+    // Positions at the last key <= target if inclusive, < target otherwise
+    void SeekBackward(const char* target, bool inclusive);
+    // Positions at the key at index of leaf, or at the first key of the next
+    // leaves if index is past the end of leaf. Returns false if a node
+    // changed meanwhile, in which case the caller must search again.
+    bool SettleForward(LeafNode* leaf, uint64_t version, int index);
+    void Invalidate() {
+      leaf_ = nullptr;
+      key_ = nullptr;
+    }
+
+    const BPlusTree* tree_;
+    LeafNode* leaf_;
+    // The version of leaf_ when the iterator was positioned. As long as it
+    // doesn't change, the neighbours of key_ are at index_ +/- 1.
+    uint64_t leaf_version_;
+    int index_;
+    const char* key_;
+    // Intentionally copyable
+  };
+
+ private:
+  enum InsertResult { kInserted, kDuplicate, kRetry };
+
+  Allocator* const allocator_;  // Allocator used for allocations of nodes
+  // Immutable after construction
+  Comparator const compare_;
+  std::atomic<Node*> root_;
+
+  LeafNode* NewLeaf();
+  InnerNode* NewInner();
+
+  static int NumKeys(const Node* node) {
+    int count = static_cast<int>(node->count_.load(std::memory_order_relaxed));
+    return std::min(count, node->is_leaf_ ? kLeafCapacity : kInnerCapacity);
+  }
+
+  // Returns the number of the first n keys of node that are less than key,
+  // or less than or equal to key if upper. Returns -1 if node was changing
+  // under the reader.
+  template <typename NodeType>
+  int Search(const NodeType* node, int n, const char* key, bool upper) const;
+
+  // Returns the leaf reached from the root by choosing at every inner node the
+  // child at index choose(inner, num_keys), and sets *version to the version
+  // of the leaf. choose() returns -1 if the node was changing.
+  template <typename ChooseChild>
+  LeafNode* FindLeaf(const ChooseChild& choose, uint64_t* version) const;
+
+  InsertResult TryInsert(const char* key, void** hint);
+
+  // Inserts key into leaf, which must be locked and have room for it
+  InsertResult InsertIntoLeaf(LeafNode* leaf, const char* key);
+
+  // Splits node, which must be locked and full, into node and a new right
+  // sibling added to parent. parent must be locked, or nullptr if node is the
+  // root. key is the key being inserted.
+  void Split(InnerNode* parent, Node* node, const char* key);
+
+  void ValidateNode(const Node* node, const char* lower,
+                    const char* upper) const;
+};
+
+// Implementation details follow
+
+template <class Comparator>
+struct BPlusTree<Comparator>::Node {
+  explicit Node(bool is_leaf) : is_leaf_(is_leaf) {}
+
+  // Returns the version of the node, waiting for it to be unlocked
+  uint64_t StableVersion() const {
+    uint64_t version = version_.load(std::memory_order_acquire);
+    while (UNLIKELY(version & 1)) {
+      port::AsmVolatilePause();
+      version = version_.load(std::memory_order_acquire);
+    }
+    return version;
+  }
+
+  // Returns true if the node didn't change since it had version. Everything
+  // read from the node before is then consistent.
+  bool Validate(uint64_t version) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
+  // Locks the node, only if it didn't change since it had version
+  bool TryLock(uint64_t version) {
+    if (!version_.compare_exchange_strong(version, version + 1,
+                                          std::memory_order_acquire)) {
+      return false;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+  }
+
+  void Lock() {
+    while (!TryLock(StableVersion())) {
+    }
+  }
+
+  void Unlock() { version_.fetch_add(1, std::memory_order_release); }
+
+  // Odd while the node is locked
+  std::atomic<uint64_t> version_{0};
+  std::atomic<uint32_t> count_{0};
+  const bool is_leaf_;
+};
+
+template <class Comparator>
+struct BPlusTree<Comparator>::LeafNode : public Node {
+  LeafNode() : Node(true /* is_leaf */) {}
+
+  std::atomic<LeafNode*> next_{nullptr};
+  std::atomic<const char*> keys_[kLeafCapacity] = {};
+};
+
+template <class Comparator>
+struct BPlusTree<Comparator>::InnerNode : public Node {
+  InnerNode() : Node(false /* is_leaf */) {}
+
+  // keys_[i] is the first key of children_[i + 1]
+  std::atomic<const char*> keys_[kInnerCapacity] = {};
+  std::atomic<Node*> children_[kInnerCapacity + 1] = {};
+};
+
+template <class Comparator>
+BPlusTree<Comparator>::BPlusTree(const Comparator cmp, Allocator* allocator)
+    : allocator_(allocator), compare_(cmp), root_(NewLeaf()) {}
+
+template <class Comparator>
+typename BPlusTree<Comparator>::LeafNode* BPlusTree<Comparator>::NewLeaf() {
+  char* mem = allocator_->AllocateAligned(sizeof(LeafNode),
+                                          ArenaTracker::ArenaStats::BPlusTree);
+  return new (mem) LeafNode();
+}
+
+template <class Comparator>
+typename BPlusTree<Comparator>::InnerNode* BPlusTree<Comparator>::NewInner() {
+  char* mem = allocator_->AllocateAligned(sizeof(InnerNode),
+                                          ArenaTracker::ArenaStats::BPlusTree);
+  return new (mem) InnerNode();
+}
+
+template <class Comparator>
+template <typename NodeType>
+int BPlusTree<Comparator>::Search(const NodeType* node, int n,
+                                  const char* key, bool upper) const {
+  int low = 0;
+  int high = n;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    const char* mid_key = node->keys_[mid].load(std::memory_order_acquire);
+    if (UNLIKELY(mid_key == nullptr)) {
+      return -1;
+    }
+    int cmp = compare_(mid_key, key);
+    if (cmp < 0 || (upper && cmp == 0)) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+template <class Comparator>
+template <typename ChooseChild>
+typename BPlusTree<Comparator>::LeafNode* BPlusTree<Comparator>::FindLeaf(
+    const ChooseChild& choose, uint64_t* version) const {
+  for (;;) {
+    Node* node = root_.load(std::memory_order_acquire);
+    uint64_t node_version = node->StableVersion();
+    if (node != root_.load(std::memory_order_acquire)) {
+      continue;
+    }
+    while (!node->is_leaf_) {
+      auto* inner = static_cast<InnerNode*>(node);
+      int index = choose(inner, NumKeys(inner));
+      Node* child = index < 0 ? nullptr
+                              : inner->children_[index].load(
+                                    std::memory_order_acquire);
+      if (child == nullptr || !inner->Validate(node_version)) {
+        break;
+      }
+      uint64_t child_version = child->StableVersion();
+      // The child may have been split before its version was read
+      if (!inner->Validate(node_version)) {
+        break;
+      }
+      node = child;
+      node_version = child_version;
+    }
+    if (node->is_leaf_) {
+      *version = node_version;
+      return static_cast<LeafNode*>(node);
+    }
+  }
+}
+
+template <class Comparator>
+bool BPlusTree<Comparator>::Insert(const char* key) {
+  for (;;) {
+    InsertResult result = TryInsert(key, nullptr);
+    if (result != kRetry) {
+      return result == kInserted;
+    }
+  }
+}
+
+template <class Comparator>
+bool BPlusTree<Comparator>::InsertWithHint(const char* key, void** hint) {
+  auto* leaf = static_cast<LeafNode*>(*hint);
+  if (leaf != nullptr) {
+    // key belongs to the leaf if it is after the first key of the leaf and
+    // before the first key of the next one, which never changes (see
+    // invariant (2)). The next leaf can't change while the leaf is locked.
+    leaf->Lock();
+    int n = NumKeys(leaf);
+    LeafNode* next = leaf->next_.load(std::memory_order_acquire);
+    if (n > 0 && n < kLeafCapacity &&
+        compare_(leaf->keys_[0].load(std::memory_order_relaxed), key) < 0 &&
+        (next == nullptr ||
+         compare_(key, next->keys_[0].load(std::memory_order_acquire)) < 0)) {
+      InsertResult result = InsertIntoLeaf(leaf, key);
+      leaf->Unlock();
+      return result == kInserted;
+    }
+    leaf->Unlock();
+  }
+  for (;;) {
+    InsertResult result = TryInsert(key, hint);
+    if (result != kRetry) {
+      return result == kInserted;
+    }
+  }
+}
+
+template <class Comparator>
+typename BPlusTree<Comparator>::InsertResult BPlusTree<Comparator>::TryInsert(
+    const char* key, void** hint) {
+  Node* node = root_.load(std::memory_order_acquire);
+  uint64_t version = node->StableVersion();
+  if (node != root_.load(std::memory_order_acquire)) {
+    return kRetry;
+  }
+  InnerNode* parent = nullptr;
+  uint64_t parent_version = 0;
+  for (;;) {
+    if (NumKeys(node) == (node->is_leaf_ ? kLeafCapacity : kInnerCapacity)) {
+      // Full nodes are split on the way down, so that the parent of a node
+      // always has room for a new child
+      if (parent != nullptr && !parent->TryLock(parent_version)) {
+        return kRetry;
+      }
+      if (!node->TryLock(version)) {
+        if (parent != nullptr) {
+          parent->Unlock();
+        }
+        return kRetry;
+      }
+      assert(parent != nullptr || node == root_.load());
+      Split(parent, node, key);
+      node->Unlock();
+      if (parent != nullptr) {
+        parent->Unlock();
+      }
+      return kRetry;
+    }
+    if (node->is_leaf_) {
+      break;
+    }
+    auto* inner = static_cast<InnerNode*>(node);
+    int index = Search(inner, NumKeys(inner), key, true /* upper */);
+    Node* child =
+        index < 0 ? nullptr
+                  : inner->children_[index].load(std::memory_order_acquire);
+    if (child == nullptr || !inner->Validate(version)) {
+      return kRetry;
+    }
+    uint64_t child_version = child->StableVersion();
+    if (!inner->Validate(version)) {
+      return kRetry;
+    }
+    parent = inner;
+    parent_version = version;
+    node = child;
+    version = child_version;
+  }
+
+  // The range of keys of a leaf only changes when the leaf is split, so the
+  // leaf is still the right one if it didn't change since it was reached
+  auto* leaf = static_cast<LeafNode*>(node);
+  if (!leaf->TryLock(version)) {
+    return kRetry;
+  }
+  InsertResult result = InsertIntoLeaf(leaf, key);
+  leaf->Unlock();
+  if (hint != nullptr) {
+    *hint = leaf;
+  }
+  return result;
+}
+
+template <class Comparator>
+typename BPlusTree<Comparator>::InsertResult
+BPlusTree<Comparator>::InsertIntoLeaf(LeafNode* leaf, const char* key) {
+  int n = NumKeys(leaf);
+  assert(n < kLeafCapacity);
+  int index;
+  if (n == 0 ||
+      compare_(leaf->keys_[n - 1].load(std::memory_order_relaxed), key) < 0) {
+    // Fast path for sequential inserts
+    index = n;
+  } else {
+    index = Search(leaf, n, key, false /* upper */);
+    assert(index >= 0);
+    if (index < n &&
+        compare_(leaf->keys_[index].load(std::memory_order_relaxed), key) ==
+            0) {
+      return kDuplicate;
+    }
+  }
+  for (int i = n; i > index; --i) {
+    leaf->keys_[i].store(leaf->keys_[i - 1].load(std::memory_order_relaxed),
+                         std::memory_order_release);
+  }
+  leaf->keys_[index].store(key, std::memory_order_release);
+  leaf->count_.store(n + 1, std::memory_order_relaxed);
+  return kInserted;
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::Split(InnerNode* parent, Node* node,
+                                  const char* key) {
+  const int n = NumKeys(node);
+  const char* separator;
+  Node* right;
+  if (node->is_leaf_) {
+    auto* leaf = static_cast<LeafNode*>(node);
+    auto* right_leaf = NewLeaf();
+    // When appending to the rightmost leaf, move only the last key, rather
+    // than leaving half empty leaves behind sequential inserts
+    int mid = n / 2;
+    LeafNode* next = leaf->next_.load(std::memory_order_relaxed);
+    if (next == nullptr &&
+        compare_(leaf->keys_[n - 1].load(std::memory_order_relaxed), key) < 0) {
+      mid = n - 1;
+    }
+    for (int i = mid; i < n; ++i) {
+      right_leaf->keys_[i - mid].store(
+          leaf->keys_[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    right_leaf->count_.store(n - mid, std::memory_order_relaxed);
+    right_leaf->next_.store(next, std::memory_order_relaxed);
+    separator = right_leaf->keys_[0].load(std::memory_order_relaxed);
+    // Publishes the initialized right leaf
+    leaf->next_.store(right_leaf, std::memory_order_release);
+    leaf->count_.store(mid, std::memory_order_relaxed);
+    right = right_leaf;
+  } else {
+    auto* inner = static_cast<InnerNode*>(node);
+    auto* right_inner = NewInner();
+    // The middle key moves up to the parent
+    int mid = n / 2;
+    separator = inner->keys_[mid].load(std::memory_order_relaxed);
+    for (int i = mid + 1; i < n; ++i) {
+      right_inner->keys_[i - mid - 1].store(
+          inner->keys_[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    for (int i = mid + 1; i <= n; ++i) {
+      right_inner->children_[i - mid - 1].store(
+          inner->children_[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    right_inner->count_.store(n - mid - 1, std::memory_order_relaxed);
+    inner->count_.store(mid, std::memory_order_relaxed);
+    right = right_inner;
+  }
+
+  if (parent == nullptr) {
+    InnerNode* root = NewInner();
+    root->keys_[0].store(separator, std::memory_order_relaxed);
+    root->children_[0].store(node, std::memory_order_relaxed);
+    root->children_[1].store(right, std::memory_order_relaxed);
+    root->count_.store(1, std::memory_order_relaxed);
+    root_.store(root, std::memory_order_release);
+    return;
+  }
+  int parent_n = NumKeys(parent);
+  assert(parent_n < kInnerCapacity);
+  int index = Search(parent, parent_n, separator, true /* upper */);
+  assert(index >= 0);
+  for (int i = parent_n; i > index; --i) {
+    parent->keys_[i].store(parent->keys_[i - 1].load(std::memory_order_relaxed),
+                           std::memory_order_release);
+    parent->children_[i + 1].store(
+        parent->children_[i].load(std::memory_order_relaxed),
+        std::memory_order_release);
+  }
+  parent->keys_[index].store(separator, std::memory_order_release);
+  parent->children_[index + 1].store(right, std::memory_order_release);
+  parent->count_.store(parent_n + 1, std::memory_order_relaxed);
+}
+
+template <class Comparator>
+bool BPlusTree<Comparator>::Contains(const char* key) const {
+  for (;;) {
+    uint64_t version;
+    LeafNode* leaf = FindLeaf(
+        [this, key](const InnerNode* inner, int n) {
+          return Search(inner, n, key, true /* upper */);
+        },
+        &version);
+    int n = NumKeys(leaf);
+    int index = Search(leaf, n, key, false /* upper */);
+    if (index < 0) {
+      continue;
+    }
+    const char* found = index < n ? leaf->keys_[index].load(
+                                        std::memory_order_acquire)
+                                  : nullptr;
+    bool equal = found != nullptr && compare_(found, key) == 0;
+    if (leaf->Validate(version)) {
+      return equal;
+    }
+  }
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::TEST_Validate() const {
+  ValidateNode(root_.load(), nullptr, nullptr);
+  // The leaves are linked in order
+  Iterator iter(this);
+  iter.SeekToFirst();
+  const char* prev = nullptr;
+  for (; iter.Valid(); iter.Next()) {
+    assert(prev == nullptr || compare_(prev, iter.key()) < 0);
+    prev = iter.key();
+  }
+  (void)prev;
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::ValidateNode(const Node* node, const char* lower,
+                                         const char* upper) const {
+  const int n = NumKeys(node);
+  const auto* keys = node->is_leaf_
+                         ? static_cast<const LeafNode*>(node)->keys_
+                         : static_cast<const InnerNode*>(node)->keys_;
+  for (int i = 0; i < n; ++i) {
+    const char* key = keys[i].load();
+    assert(key != nullptr);
+    assert(i == 0 || compare_(keys[i - 1].load(), key) < 0);
+    assert(lower == nullptr || compare_(lower, key) <= 0);
+    assert(upper == nullptr || compare_(key, upper) < 0);
+    (void)key;
+  }
+  if (node->is_leaf_) {
+    // See invariant (2)
+    assert(lower == nullptr || (n > 0 && compare_(keys[0].load(), lower) == 0));
+    return;
+  }
+  const auto* inner = static_cast<const InnerNode*>(node);
+  for (int i = 0; i <= n; ++i) {
+    ValidateNode(inner->children_[i].load(),
+                 i == 0 ? lower : inner->keys_[i - 1].load(),
+                 i == n ? upper : inner->keys_[i].load());
+  }
+}
+
+template <class Comparator>
+BPlusTree<Comparator>::Iterator::Iterator(const BPlusTree* tree)
+    : tree_(tree), leaf_(nullptr), leaf_version_(0), index_(0),
+      key_(nullptr) {}
+
+template <class Comparator>
+bool BPlusTree<Comparator>::Iterator::SettleForward(LeafNode* leaf,
+                                                     uint64_t version,
+                                                     int index) {
+  for (;;) {
+    int n = NumKeys(leaf);
+    if (index < n) {
+      const char* key = leaf->keys_[index].load(std::memory_order_acquire);
+      if (key == nullptr || !leaf->Validate(version)) {
+        return false;
+      }
+      leaf_ = leaf;
+      leaf_version_ = version;
+      index_ = index;
+      key_ = key;
+      return true;
+    }
+    LeafNode* next = leaf->next_.load(std::memory_order_acquire);
+    if (!leaf->Validate(version)) {
+      return false;
+    }
+    if (next == nullptr) {
+      Invalidate();
+      return true;
+    }
+    // The keys that may move from leaf to a new leaf before next from now on
+    // were all passed already, or are inserted concurrently
+    version = next->StableVersion();
+    leaf = next;
+    index = 0;
+  }
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::Iterator::SeekForward(const char* target,
+                                                  bool after) {
+  for (;;) {
+    uint64_t version;
+    LeafNode* leaf = tree_->FindLeaf(
+        [this, target](const InnerNode* inner, int n) {
+          return tree_->Search(inner, n, target, true /* upper */);
+        },
+        &version);
+    int index = tree_->Search(leaf, NumKeys(leaf), target, after);
+    if (index >= 0 && SettleForward(leaf, version, index)) {
+      return;
+    }
+  }
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::Iterator::SeekBackward(const char* target,
+                                                   bool inclusive) {
+  // The leaf reached holds the last key before target if there is one: by
+  // invariant (2), the first key of a child other than the first one of its
+  // parent is the separator before it, which is before target.
+  for (;;) {
+    uint64_t version;
+    LeafNode* leaf = tree_->FindLeaf(
+        [this, target, inclusive](const InnerNode* inner, int n) {
+          return tree_->Search(inner, n, target, inclusive);
+        },
+        &version);
+    int index = tree_->Search(leaf, NumKeys(leaf), target, inclusive);
+    if (index < 0) {
+      continue;
+    }
+    const char* key =
+        index > 0 ? leaf->keys_[index - 1].load(std::memory_order_acquire)
+                  : nullptr;
+    if ((index > 0 && key == nullptr) || !leaf->Validate(version)) {
+      continue;
+    }
+    if (index == 0) {
+      Invalidate();
+    } else {
+      leaf_ = leaf;
+      leaf_version_ = version;
+      index_ = index - 1;
+      key_ = key;
+    }
+    return;
+  }
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::Iterator::Next() {
+  assert(Valid());
+  // Fails if the leaf changed, e.g. a key was inserted before key_
+  if (!SettleForward(leaf_, leaf_version_, index_ + 1)) {
+    SeekForward(key_, true /* after */);
+  }
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::Iterator::Prev() {
+  assert(Valid());
+  if (index_ > 0) {
+    const char* key = leaf_->keys_[index_ - 1].load(std::memory_order_acquire);
+    if (key != nullptr && leaf_->Validate(leaf_version_)) {
+      --index_;
+      key_ = key;
+      return;
+    }
+  }
+  SeekBackward(key_, false /* inclusive */);
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::Iterator::SeekToFirst() {
+  for (;;) {
+    uint64_t version;
+    LeafNode* leaf = tree_->FindLeaf(
+        [](const InnerNode* /*inner*/, int /*n*/) { return 0; }, &version);
+    if (SettleForward(leaf, version, 0)) {
+      return;
+    }
+  }
+}
+
+template <class Comparator>
+void BPlusTree<Comparator>::Iterator::SeekToLast() {
+  for (;;) {
+    uint64_t version;
+    LeafNode* leaf = tree_->FindLeaf(
+        [](const InnerNode* /*inner*/, int n) { return n; }, &version);
+    int n = NumKeys(leaf);
+    const char* key =
+        n > 0 ? leaf->keys_[n - 1].load(std::memory_order_acquire) : nullptr;
+    if ((n > 0 && key == nullptr) || !leaf->Validate(version)) {
+      continue;
+    }
+    if (n == 0) {
+      // Only the root leaf of an empty tree has no keys
+      Invalidate();
+    } else {
+      leaf_ = leaf;
+      leaf_version_ = version;
+      index_ = n - 1;
+      key_ = key;
+    }
+    return;
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
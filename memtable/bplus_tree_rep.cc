@@ -0,0 +1,162 @@
+// Copyright (C) 2023 Speedb Ltd. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <new>
+
+#include "db/memtable.h"
+#include "memory/arena.h"
+#include "memtable/bplus_tree.h"
+#include "rocksdb/memtablerep.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+using MemTableBPlusTree = BPlusTree<const MemTableRep::KeyComparator&>;
+
+class BPlusTreeRep : public MemTableRep {
+ public:
+  BPlusTreeRep(const MemTableRep::KeyComparator& compare, Allocator* allocator)
+      : MemTableRep(allocator), tree_(compare, allocator) {}
+
+  void Insert(KeyHandle handle) override {
+    tree_.Insert(static_cast<char*>(handle));
+  }
+
+  bool InsertKey(KeyHandle handle) override {
+    return tree_.Insert(static_cast<char*>(handle));
+  }
+
+  void InsertWithHint(KeyHandle handle, void** hint) override {
+    tree_.InsertWithHint(static_cast<char*>(handle), hint);
+  }
+
+  bool InsertKeyWithHint(KeyHandle handle, void** hint) override {
+    return tree_.InsertWithHint(static_cast<char*>(handle), hint);
+  }
+
+  void InsertWithHintConcurrently(KeyHandle handle, void** hint) override {
+    InsertKeyWithHintConcurrently(handle, hint);
+  }
+
+  bool InsertKeyWithHintConcurrently(KeyHandle handle, void** hint) override {
+    // The hint of a concurrent insert is owned by the caller, who deletes it
+    // as a char array
+    if (*hint == nullptr) {
+      *hint = new (new char[sizeof(void*)]) void*(nullptr);
+    }
+    return tree_.InsertWithHint(static_cast<char*>(handle),
+                                static_cast<void**>(*hint));
+  }
+
+  void InsertConcurrently(KeyHandle handle) override {
+    tree_.Insert(static_cast<char*>(handle));
+  }
+
+  bool InsertKeyConcurrently(KeyHandle handle) override {
+    return tree_.Insert(static_cast<char*>(handle));
+  }
+
+  bool Contains(const char* key) const override { return tree_.Contains(key); }
+
+  size_t ApproximateMemoryUsage() override {
+    // All memory is allocated through allocator; nothing to report here
+    return 0;
+  }
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override {
+    MemTableBPlusTree::Iterator iter(&tree_);
+    for (iter.Seek(k.memtable_key().data());
+         iter.Valid() && callback_func(callback_args, iter.key());
+         iter.Next()) {
+    }
+  }
+
+  // Iteration over the contents of the tree. It sees the entries added to
+  // the memtable after its creation, so it supports Refresh().
+  class Iterator : public MemTableRep::Iterator {
+   public:
+    explicit Iterator(const MemTableBPlusTree* tree) : iter_(tree) {}
+
+    bool Valid() const override { return iter_.Valid(); }
+
+    const char* key() const override { return iter_.key(); }
+
+    void Next() override { iter_.Next(); }
+
+    void Prev() override { iter_.Prev(); }
+
+    void Seek(const Slice& user_key, const char* memtable_key) override {
+      if (memtable_key != nullptr) {
+        iter_.Seek(memtable_key);
+      } else {
+        iter_.Seek(EncodeKey(&tmp_, user_key));
+      }
+    }
+
+    void SeekForPrev(const Slice& user_key, const char* memtable_key) override {
+      if (memtable_key != nullptr) {
+        iter_.SeekForPrev(memtable_key);
+      } else {
+        iter_.SeekForPrev(EncodeKey(&tmp_, user_key));
+      }
+    }
+
+    void SeekToFirst() override { iter_.SeekToFirst(); }
+
+    void SeekToLast() override { iter_.SeekToLast(); }
+
+   private:
+    MemTableBPlusTree::Iterator iter_;
+    std::string tmp_;  // For passing to EncodeKey
+  };
+
+  MemTableRep::Iterator* GetIterator(Arena* arena,
+                                     bool /*part_of_flush*/) override {
+    void* mem = arena ? arena->AllocateAligned(
+                            sizeof(BPlusTreeRep::Iterator),
+                            ArenaTracker::ArenaStats::BPlusTreeIterator)
+                      : operator new(sizeof(BPlusTreeRep::Iterator));
+    return new (mem) BPlusTreeRep::Iterator(&tree_);
+  }
+
+ private:
+  MemTableBPlusTree tree_;
+};
+
+class BPlusTreeRepFactory : public MemTableRepFactory {
+ public:
+  using MemTableRepFactory::CreateMemTableRep;
+  MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator& compare,
+                                 Allocator* allocator,
+                                 const SliceTransform* /*transform*/,
+                                 Logger* /*logger*/) override {
+    return new BPlusTreeRep(compare, allocator);
+  }
+
+  bool IsInsertConcurrentlySupported() const override { return true; }
+  bool CanHandleDuplicatedKey() const override { return true; }
+
+  static const char* kClassName() { return "BPlusTreeRepFactory"; }
+  static const char* kNickName() { return "bplus_tree"; }
+  const char* Name() const override { return kClassName(); }
+  const char* NickName() const override { return kNickName(); }
+};
+
+}  // namespace
+
+MemTableRepFactory* NewBPlusTreeRepFactory() {
+  return new BPlusTreeRepFactory();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
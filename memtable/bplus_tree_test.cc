@@ -0,0 +1,408 @@
+// Copyright (C) 2023 Speedb Ltd. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "memtable/bplus_tree.h"
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "memory/concurrent_arena.h"
+#include "rocksdb/convenience.h"
+#include "rocksdb/memtablerep.h"
+#include "test_util/testharness.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Our test tree stores 8-byte unsigned integers
+using Key = uint64_t;
+
+static const char* Encode(const uint64_t* key) {
+  return reinterpret_cast<const char*>(key);
+}
+
+static Key Decode(const char* key) {
+  Key rv;
+  memcpy(&rv, key, sizeof(Key));
+  return rv;
+}
+
+struct TestComparator {
+  int operator()(const char* a, const char* b) const {
+    if (Decode(a) < Decode(b)) {
+      return -1;
+    } else if (Decode(a) > Decode(b)) {
+      return +1;
+    } else {
+      return 0;
+    }
+  }
+};
+
+using TestBPlusTree = BPlusTree<TestComparator>;
+
+static const char* NewKey(Allocator* allocator, Key key) {
+  char* buf = allocator->AllocateAligned(sizeof(Key),
+                                         ArenaTracker::ArenaStats::BPlusTree);
+  memcpy(buf, &key, sizeof(Key));
+  return buf;
+}
+
+class BPlusTreeTest : public testing::Test {
+ public:
+  void Validate(const TestBPlusTree& tree, const std::set<Key>& keys) {
+    tree.TEST_Validate();
+    TestBPlusTree::Iterator iter(&tree);
+    iter.SeekToFirst();
+    for (Key key : keys) {
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(key, Decode(iter.key()));
+      iter.Next();
+    }
+    ASSERT_FALSE(iter.Valid());
+  }
+};
+
+TEST_F(BPlusTreeTest, Empty) {
+  Arena arena;
+  TestBPlusTree tree(TestComparator(), &arena);
+  Key key = 10;
+  ASSERT_FALSE(tree.Contains(Encode(&key)));
+  tree.TEST_Validate();
+
+  TestBPlusTree::Iterator iter(&tree);
+  ASSERT_FALSE(iter.Valid());
+  iter.SeekToFirst();
+  ASSERT_FALSE(iter.Valid());
+  iter.Seek(Encode(&key));
+  ASSERT_FALSE(iter.Valid());
+  iter.SeekForPrev(Encode(&key));
+  ASSERT_FALSE(iter.Valid());
+  iter.SeekToLast();
+  ASSERT_FALSE(iter.Valid());
+}
+
+TEST_F(BPlusTreeTest, InsertAndLookup) {
+  const int N = 2000;
+  const int R = 5000;
+  Random rnd(1000);
+  std::set<Key> keys;
+  Arena arena;
+  TestBPlusTree tree(TestComparator(), &arena);
+  for (int i = 0; i < N; i++) {
+    Key key = rnd.Next() % R;
+    ASSERT_EQ(keys.insert(key).second, tree.Insert(NewKey(&arena, key)));
+  }
+  Validate(tree, keys);
+
+  for (Key i = 0; i < R; i++) {
+    ASSERT_EQ(keys.count(i) == 1, tree.Contains(Encode(&i)));
+  }
+
+  // Simple iterator tests
+  {
+    TestBPlusTree::Iterator iter(&tree);
+    ASSERT_FALSE(iter.Valid());
+
+    uint64_t zero = 0;
+    iter.Seek(Encode(&zero));
+    ASSERT_TRUE(iter.Valid());
+    ASSERT_EQ(*(keys.begin()), Decode(iter.key()));
+
+    uint64_t max_key = R - 1;
+    iter.SeekForPrev(Encode(&max_key));
+    ASSERT_TRUE(iter.Valid());
+    ASSERT_EQ(*(keys.rbegin()), Decode(iter.key()));
+
+    iter.SeekToFirst();
+    ASSERT_TRUE(iter.Valid());
+    ASSERT_EQ(*(keys.begin()), Decode(iter.key()));
+    iter.Prev();
+    ASSERT_FALSE(iter.Valid());
+
+    iter.SeekToLast();
+    ASSERT_TRUE(iter.Valid());
+    ASSERT_EQ(*(keys.rbegin()), Decode(iter.key()));
+    iter.Next();
+    ASSERT_FALSE(iter.Valid());
+  }
+
+  // Forward iteration test
+  for (Key i = 0; i < R; i++) {
+    TestBPlusTree::Iterator iter(&tree);
+    iter.Seek(Encode(&i));
+
+    // Compare against model iterator
+    std::set<Key>::iterator model_iter = keys.lower_bound(i);
+    for (int j = 0; j < 3; j++) {
+      if (model_iter == keys.end()) {
+        ASSERT_FALSE(iter.Valid());
+        break;
+      } else {
+        ASSERT_TRUE(iter.Valid());
+        ASSERT_EQ(*model_iter, Decode(iter.key()));
+        ++model_iter;
+        iter.Next();
+      }
+    }
+  }
+
+  // Backward iteration test
+  for (Key i = 0; i < R; i++) {
+    TestBPlusTree::Iterator iter(&tree);
+    iter.SeekForPrev(Encode(&i));
+
+    // Compare against model iterator
+    std::set<Key>::iterator model_iter = keys.upper_bound(i);
+    for (int j = 0; j < 3; j++) {
+      if (model_iter == keys.begin()) {
+        ASSERT_FALSE(iter.Valid());
+        break;
+      } else {
+        ASSERT_TRUE(iter.Valid());
+        ASSERT_EQ(*--model_iter, Decode(iter.key()));
+        iter.Prev();
+      }
+    }
+  }
+
+  // Full backward scan
+  {
+    TestBPlusTree::Iterator iter(&tree);
+    iter.SeekToLast();
+    for (auto it = keys.rbegin(); it != keys.rend(); ++it) {
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(*it, Decode(iter.key()));
+      iter.Prev();
+    }
+    ASSERT_FALSE(iter.Valid());
+  }
+}
+
+TEST_F(BPlusTreeTest, InsertWithHint_Sequential) {
+  const int N = 100000;
+  Arena arena;
+  TestBPlusTree tree(TestComparator(), &arena);
+  std::set<Key> keys;
+  void* hint = nullptr;
+  for (int i = 0; i < N; i++) {
+    Key key = i;
+    keys.insert(key);
+    ASSERT_TRUE(tree.InsertWithHint(NewKey(&arena, key), &hint));
+  }
+  // Duplicates are rejected through the hinted leaf as well
+  ASSERT_FALSE(tree.InsertWithHint(NewKey(&arena, N - 1), &hint));
+  Validate(tree, keys);
+}
+
+TEST_F(BPlusTreeTest, InsertWithHint_MultipleHints) {
+  const int N = 100000;
+  const int S = 100;
+  Random rnd(534);
+  Arena arena;
+  TestBPlusTree tree(TestComparator(), &arena);
+  std::set<Key> keys;
+  void* hints[S];
+  Key last_key[S];
+  for (int i = 0; i < S; i++) {
+    hints[i] = nullptr;
+    last_key[i] = 0;
+  }
+  for (int i = 0; i < N; i++) {
+    Key s = rnd.Uniform(S);
+    Key key = (s << 32) + (++last_key[s]);
+    keys.insert(key);
+    ASSERT_TRUE(tree.InsertWithHint(NewKey(&arena, key), &hints[s]));
+  }
+  Validate(tree, keys);
+}
+
+TEST_F(BPlusTreeTest, InsertWithHint_CompatibleWithInsertWithoutHint) {
+  const int N = 100000;
+  const int S1 = 100;
+  const int S2 = 100;
+  Random rnd(534);
+  Arena arena;
+  TestBPlusTree tree(TestComparator(), &arena);
+  std::set<Key> keys;
+  void* hints[S1];
+  for (int i = 0; i < S1; i++) {
+    hints[i] = nullptr;
+  }
+  for (int i = 0; i < N; i++) {
+    Key s1 = rnd.Uniform(S1 + S2);
+    Key key = (s1 << 32) + rnd.Next();
+    if (!keys.insert(key).second) {
+      continue;
+    }
+    if (s1 < S1) {
+      ASSERT_TRUE(tree.InsertWithHint(NewKey(&arena, key), &hints[s1]));
+    } else {
+      ASSERT_TRUE(tree.Insert(NewKey(&arena, key)));
+    }
+  }
+  Validate(tree, keys);
+}
+
+TEST_F(BPlusTreeTest, IteratorSeesNewKeys) {
+  Arena arena;
+  TestBPlusTree tree(TestComparator(), &arena);
+  for (Key key = 0; key < 1000; key += 2) {
+    ASSERT_TRUE(tree.Insert(NewKey(&arena, key)));
+  }
+  TestBPlusTree::Iterator iter(&tree);
+  Key target = 500;
+  iter.Seek(Encode(&target));
+  ASSERT_TRUE(iter.Valid());
+  ASSERT_EQ(500U, Decode(iter.key()));
+
+  // Splits the leaf of the iterator a few times
+  for (Key key = 1; key < 1000; key += 2) {
+    ASSERT_TRUE(tree.Insert(NewKey(&arena, key)));
+  }
+  iter.Next();
+  ASSERT_TRUE(iter.Valid());
+  ASSERT_EQ(501U, Decode(iter.key()));
+  iter.Prev();
+  iter.Prev();
+  ASSERT_TRUE(iter.Valid());
+  ASSERT_EQ(499U, Decode(iter.key()));
+}
+
+// Several writers insert interleaved ranges of keys while a reader checks that
+// every scan returns sorted keys and sees all the keys published before it
+// started.
+static void RunConcurrentInsert(bool use_hint, int write_parallelism) {
+  const Key kKeysPerWriter = 20000;
+  ConcurrentArena arena;
+  TestBPlusTree tree(TestComparator(), &arena);
+  std::atomic<bool> quit{false};
+  std::vector<std::atomic<Key>> published(write_parallelism);
+  for (auto& p : published) {
+    p.store(0);
+  }
+
+  std::thread reader([&]() {
+    while (!quit.load(std::memory_order_acquire)) {
+      std::vector<Key> min_published;
+      for (auto& p : published) {
+        min_published.push_back(p.load(std::memory_order_acquire));
+      }
+      TestBPlusTree::Iterator iter(&tree);
+      Key prev = 0;
+      bool first = true;
+      std::vector<Key> seen(write_parallelism, 0);
+      for (iter.SeekToFirst(); iter.Valid(); iter.Next()) {
+        Key key = Decode(iter.key());
+        ASSERT_TRUE(first || prev < key);
+        first = false;
+        prev = key;
+        Key writer = key % write_parallelism;
+        seen[writer] = std::max(seen[writer], key / write_parallelism + 1);
+      }
+      for (int p = 0; p < write_parallelism; ++p) {
+        ASSERT_GE(seen[p], min_published[p]);
+      }
+    }
+  });
+
+  std::vector<std::thread> writers;
+  for (int p = 0; p < write_parallelism; ++p) {
+    writers.emplace_back([&, p]() {
+      void* hint = nullptr;
+      for (Key i = 0; i < kKeysPerWriter; ++i) {
+        Key key = i * write_parallelism + p;
+        if (use_hint) {
+          ASSERT_TRUE(tree.InsertWithHint(NewKey(&arena, key), &hint));
+        } else {
+          ASSERT_TRUE(tree.Insert(NewKey(&arena, key)));
+        }
+        published[p].store(i + 1, std::memory_order_release);
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  quit.store(true, std::memory_order_release);
+  reader.join();
+
+  std::set<Key> keys;
+  for (Key i = 0; i < kKeysPerWriter * write_parallelism; ++i) {
+    keys.insert(i);
+  }
+  tree.TEST_Validate();
+  TestBPlusTree::Iterator iter(&tree);
+  iter.SeekToFirst();
+  for (Key key : keys) {
+    ASSERT_TRUE(iter.Valid());
+    ASSERT_EQ(key, Decode(iter.key()));
+    iter.Next();
+  }
+  ASSERT_FALSE(iter.Valid());
+}
+
+TEST_F(BPlusTreeTest, ConcurrentInsert) {
+  RunConcurrentInsert(false /* use_hint */, 4);
+}
+
+TEST_F(BPlusTreeTest, ConcurrentInsertWithHint) {
+  RunConcurrentInsert(true /* use_hint */, 4);
+}
+
+TEST_F(BPlusTreeTest, ConcurrentInsertDuplicates) {
+  // All the writers insert the same keys, and exactly one insert of each wins
+  const int kWriters = 4;
+  const Key kKeys = 20000;
+  ConcurrentArena arena;
+  TestBPlusTree tree(TestComparator(), &arena);
+  std::atomic<Key> inserted{0};
+  std::vector<std::thread> writers;
+  for (int p = 0; p < kWriters; ++p) {
+    writers.emplace_back([&]() {
+      for (Key key = 0; key < kKeys; ++key) {
+        if (tree.Insert(NewKey(&arena, key))) {
+          inserted.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  ASSERT_EQ(kKeys, inserted.load());
+  tree.TEST_Validate();
+}
+
+TEST_F(BPlusTreeTest, CreateFromString) {
+  ConfigOptions config_options;
+  std::unique_ptr<MemTableRepFactory> factory;
+  ASSERT_OK(MemTableRepFactory::CreateFromString(config_options, "bplus_tree",
+                                                 &factory));
+  ASSERT_NE(factory, nullptr);
+  ASSERT_STREQ(factory->Name(), "BPlusTreeRepFactory");
+  ASSERT_TRUE(factory->IsInsertConcurrentlySupported());
+  ASSERT_TRUE(factory->CanHandleDuplicatedKey());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
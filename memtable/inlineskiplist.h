@@ -135,6 +135,22 @@ class InlineSkipList {
   // REQUIRES: no concurrent calls that use same hint
   bool InsertWithHintConcurrently(const char* key, void** hint);
 
+  // Like InsertWithHintConcurrently, but the hint is only used when key goes
+  // right after the key of the previous insert with it, as when every hint
+  // is used for an ascending sequence of keys. Otherwise the hint costs a
+  // couple of comparisons and the key is inserted from the head of the list,
+  // rather than searched from the hint.
+  //
+  // REQUIRES: nothing that compares equal to key is currently in the list.
+  // REQUIRES: no concurrent calls that use same hint
+  bool InsertWithSequentialHintConcurrently(const char* key, void** hint);
+
+  // Releases a hint allocated by InsertWithHintConcurrently or
+  // InsertWithSequentialHintConcurrently.
+  static void DeleteConcurrentHint(void* hint) {
+    delete[] reinterpret_cast<char*>(hint);
+  }
+
   // Like Insert, but external synchronization is not required.
   bool InsertConcurrently(const char* key);
 
@@ -779,6 +795,18 @@ bool InlineSkipList<Comparator>::InsertWithHintConcurrently(const char* key,
   return Insert<true>(key, splice, true);
 }
 
+template <class Comparator>
+bool InlineSkipList<Comparator>::InsertWithSequentialHintConcurrently(
+    const char* key, void** hint) {
+  assert(hint != nullptr);
+  Splice* splice = reinterpret_cast<Splice*>(*hint);
+  if (splice == nullptr) {
+    splice = AllocateSpliceOnHeap();
+    *hint = reinterpret_cast<void*>(splice);
+  }
+  return Insert<true>(key, splice, false);
+}
+
 template <class Comparator>
 template <bool prefetch_before>
 void InlineSkipList<Comparator>::FindSpliceForLevel(const DecodedKey& key,
@@ -23,8 +23,11 @@
 
 #include "memtable/inlineskiplist.h"
 
+#include <atomic>
 #include <set>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
 #include "memory/concurrent_arena.h"
 #include "rocksdb/env.h"
@@ -323,6 +326,64 @@ TEST_F(InlineSkipTest, InsertWithHint_CompatibleWithInsertWithoutHint) {
   Validate(&list);
 }
 
+TEST_F(InlineSkipTest, InsertWithSequentialHintConcurrently) {
+  // Every writer inserts ascending keys of its own with a hint, and some
+  // keys of other writers and out of order keys without one
+  const int kWriters = 4;
+  const Key kKeysPerWriter = 20000;
+  ConcurrentArena arena;
+  TestComparator cmp;
+  TestInlineSkipList list(cmp, &arena);
+  std::atomic<Key> num_ascending{0};
+  std::vector<std::thread> writers;
+  for (int w = 0; w < kWriters; ++w) {
+    writers.emplace_back([&, w]() {
+      Random rnd(301 + w);
+      void* hint = nullptr;
+      for (Key i = 0; i < kKeysPerWriter; ++i) {
+        Key key = (static_cast<Key>(w) << 32) + i * 2;
+        void* random_hint = nullptr;
+        if (rnd.OneIn(100)) {
+          // Out of order key, so the hint misses
+          key = (static_cast<Key>(rnd.Uniform(kWriters)) << 32) +
+                rnd.Uniform(kKeysPerWriter) * 2 + 1;
+        }
+        char* buf = list.AllocateKey(sizeof(Key));
+        memcpy(buf, &key, sizeof(Key));
+        if (key & 1) {
+          // Duplicates of the odd keys are expected
+          list.InsertWithSequentialHintConcurrently(buf, &random_hint);
+          TestInlineSkipList::DeleteConcurrentHint(random_hint);
+        } else {
+          ASSERT_TRUE(list.InsertWithSequentialHintConcurrently(buf, &hint));
+          num_ascending.fetch_add(1);
+        }
+      }
+      TestInlineSkipList::DeleteConcurrentHint(hint);
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+
+  list.TEST_Validate();
+  TestInlineSkipList::Iterator iter(&list);
+  Key num_even = 0;
+  bool first = true;
+  Key prev = 0;
+  for (iter.SeekToFirst(); iter.Valid(); iter.Next()) {
+    Key key = Decode(iter.key());
+    ASSERT_TRUE(first || prev < key);
+    first = false;
+    prev = key;
+    if ((key & 1) == 0) {
+      ASSERT_TRUE(list.Contains(Encode(&key)));
+      ++num_even;
+    }
+  }
+  ASSERT_EQ(num_ascending.load(), num_even);
+}
+
 #if !defined(ROCKSDB_VALGRIND_RUN) || defined(ROCKSDB_FULL_VALGRIND_RUN)
 // We want to make sure that with a single writer and multiple
 // concurrent readers (with no synchronization other than when a
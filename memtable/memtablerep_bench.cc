@@ -78,6 +78,7 @@ DEFINE_string(memtablerep, "skiplist",
               "\thashskiplist        -- backed by a hash skip list\n"
               "\thashlinklist        -- backed by a hash linked list\n"
               "\thashspdb            -- backed by a hash spdb\n"
+              "\tbplus_tree          -- backed by a B+tree\n"
               "\tcuckoo              -- backed by a cuckoo hash table");
 
 DEFINE_int64(bucket_count, 1000000,
@@ -612,6 +613,8 @@ int main(int argc, char** argv) {
         ROCKSDB_NAMESPACE::NewFixedPrefixTransform(FLAGS_prefix_length));
   } else if (FLAGS_memtablerep == "hashspdb") {
     factory.reset(ROCKSDB_NAMESPACE::NewHashSpdbRepFactory(FLAGS_bucket_count));
+  } else if (FLAGS_memtablerep == "bplus_tree") {
+    factory.reset(ROCKSDB_NAMESPACE::NewBPlusTreeRepFactory());
   } else {
     ROCKSDB_NAMESPACE::ConfigOptions config_options;
     config_options.ignore_unsupported_options = false;
@@ -29,26 +29,37 @@
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/utilities/options_type.h"
 #include "util/string_util.h"
+#include "util/thread_local.h"
 
 namespace ROCKSDB_NAMESPACE {
 namespace {
 class SkipListRep : public MemTableRep {
-  InlineSkipList<const MemTableRep::KeyComparator&> skip_list_;
+  using MemTableSkipList = InlineSkipList<const MemTableRep::KeyComparator&>;
+
+  MemTableSkipList skip_list_;
   const MemTableRep::KeyComparator& cmp_;
   const SliceTransform* transform_;
   const size_t lookahead_;
+  // The hint of the last concurrent insert of every thread, if enabled (see
+  // SkipListFactory)
+  std::unique_ptr<ThreadLocalPtr> thread_local_hints_;
 
   friend class LookaheadIterator;
 
  public:
   explicit SkipListRep(const MemTableRep::KeyComparator& compare,
                        Allocator* allocator, const SliceTransform* transform,
-                       const size_t lookahead)
+                       const size_t lookahead, bool thread_local_insert_hints)
       : MemTableRep(allocator),
         skip_list_(compare, allocator),
         cmp_(compare),
         transform_(transform),
-        lookahead_(lookahead) {}
+        lookahead_(lookahead) {
+    if (thread_local_insert_hints) {
+      thread_local_hints_.reset(
+          new ThreadLocalPtr(&MemTableSkipList::DeleteConcurrentHint));
+    }
+  }
 
   KeyHandle Allocate(const size_t len, char** buf) override {
     *buf = skip_list_.AllocateKey(len);
@@ -83,11 +94,23 @@ class SkipListRep : public MemTableRep {
   }
 
   void InsertConcurrently(KeyHandle handle) override {
-    skip_list_.InsertConcurrently(static_cast<char*>(handle));
+    InsertKeyConcurrently(handle);
   }
 
   bool InsertKeyConcurrently(KeyHandle handle) override {
-    return skip_list_.InsertConcurrently(static_cast<char*>(handle));
+    if (thread_local_hints_ == nullptr) {
+      return skip_list_.InsertConcurrently(static_cast<char*>(handle));
+    }
+    // A writer that inserts ascending keys (e.g. a time series) finds its
+    // position right after its previous insert, without a search
+    void* hint = thread_local_hints_->Get();
+    const bool new_hint = hint == nullptr;
+    bool res = skip_list_.InsertWithSequentialHintConcurrently(
+        static_cast<char*>(handle), &hint);
+    if (UNLIKELY(new_hint)) {
+      thread_local_hints_->Reset(hint);
+    }
+    return res;
   }
 
   // Returns true iff an entry that compares equal to key is in the list.
@@ -372,9 +395,21 @@ static std::unordered_map<std::string, OptionTypeInfo> skiplist_factory_info = {
       OptionTypeFlags::kDontSerialize /*Since it is part of the ID*/}},
 };
 
-SkipListFactory::SkipListFactory(size_t lookahead) : lookahead_(lookahead) {
+static std::unordered_map<std::string, OptionTypeInfo>
+    skiplist_factory_hints_info = {
+        {"thread_local_insert_hints",
+         {0, OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+};
+
+SkipListFactory::SkipListFactory(size_t lookahead,
+                                 bool thread_local_insert_hints)
+    : lookahead_(lookahead),
+      thread_local_insert_hints_(thread_local_insert_hints) {
   RegisterOptions("SkipListFactoryOptions", &lookahead_,
                   &skiplist_factory_info);
+  RegisterOptions("SkipListFactoryHintsOptions", &thread_local_insert_hints_,
+                  &skiplist_factory_hints_info);
 }
 
 std::string SkipListFactory::GetId() const {
@@ -388,7 +423,8 @@ std::string SkipListFactory::GetId() const {
 MemTableRep* SkipListFactory::CreateMemTableRep(
     const MemTableRep::KeyComparator& compare, Allocator* allocator,
     const SliceTransform* transform, Logger* /*logger*/) {
-  return new SkipListRep(compare, allocator, transform, lookahead_);
+  return new SkipListRep(compare, allocator, transform, lookahead_,
+                         thread_local_insert_hints_);
 }
 
 }  // namespace ROCKSDB_NAMESPACE
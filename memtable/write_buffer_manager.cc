@@ -30,6 +30,7 @@
 #include "cache/cache_reservation_manager.h"
 #include "db/db_impl/db_impl.h"
 #include "logging/logging.h"
+#include "memory/arena_block_pool.h"
 #include "monitoring/instrumented_mutex.h"
 #include "rocksdb/status.h"
 #include "rocksdb/write_controller.h"
@@ -52,7 +53,8 @@ WriteBufferManager::WriteBufferManager(
     size_t _buffer_size, std::shared_ptr<Cache> cache, bool allow_stall,
     bool initiate_flushes,
     const FlushInitiationOptions& flush_initiation_options,
-    uint16_t start_delay_percent)
+    uint16_t start_delay_percent,
+    const ArenaBlockPoolOptions& arena_block_pool_options)
     : buffer_size_(_buffer_size),
       mutable_limit_(buffer_size_ * 7 / 8),
       memory_used_(0),
@@ -75,6 +77,10 @@ WriteBufferManager::WriteBufferManager(
         CacheReservationManagerImpl<CacheEntryRole::kWriteBuffer>>(
         cache, true /* delayed_decrease */);
   }
+  if (arena_block_pool_options.capacity > 0U) {
+    arena_block_pool_.reset(
+        new ArenaBlockPool(this, arena_block_pool_options));
+  }
 
   if (initiate_flushes_) {
     InitFlushInitiationVars(buffer_size());
@@ -101,6 +107,21 @@ std::size_t WriteBufferManager::dummy_entries_in_cache_usage() const {
   }
 }
 
+size_t WriteBufferManager::arena_block_pool_usage() const {
+  return (arena_block_pool_ != nullptr) ? arena_block_pool_->GetUsage() : 0U;
+}
+
+void WriteBufferManager::ArenaBlockPoolUsageChanged() {
+  if (cache_res_mgr_ == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(cache_res_mgr_mu_);
+  Status s = cache_res_mgr_->UpdateCacheReservation(
+      memory_used_.load(std::memory_order_relaxed) + arena_block_pool_usage());
+  // Absorbed like the errors of ReserveMemWithCache()
+  s.PermitUncheckedError();
+}
+
 void WriteBufferManager::ReserveMem(size_t mem) {
   auto is_enabled = enabled();
   size_t new_memory_used = 0U;
@@ -113,7 +134,18 @@ void WriteBufferManager::ReserveMem(size_t mem) {
     new_memory_used = old_memory_used + mem;
   }
   if (is_enabled) {
-    UpdateUsageState(new_memory_used, static_cast<int64_t>(mem), buffer_size());
+    const size_t buffer_limit = buffer_size();
+    // The pool only keeps blocks that fit under buffer_size() along with the
+    // memtables, so make room for the memory just reserved
+    if (arena_block_pool_ != nullptr) {
+      const size_t pool_usage = arena_block_pool_->GetUsage();
+      if (pool_usage > 0U && new_memory_used + pool_usage > buffer_limit) {
+        arena_block_pool_->Evict(new_memory_used < buffer_limit
+                                     ? buffer_limit - new_memory_used
+                                     : 0U);
+      }
+    }
+    UpdateUsageState(new_memory_used, static_cast<int64_t>(mem), buffer_limit);
     // Checking outside the locks is not reliable, but avoids locking
     // unnecessarily which is expensive
     if (UNLIKELY(ShouldInitiateAnotherFlushMemOnly(new_memory_used))) {
@@ -131,7 +163,8 @@ size_t WriteBufferManager::ReserveMemWithCache(size_t mem) {
 
   size_t new_mem_used = memory_used_.load(std::memory_order_relaxed) + mem;
   memory_used_.store(new_mem_used, std::memory_order_relaxed);
-  Status s = cache_res_mgr_->UpdateCacheReservation(new_mem_used);
+  Status s = cache_res_mgr_->UpdateCacheReservation(new_mem_used +
+                                                    arena_block_pool_usage());
 
   // We absorb the error since WriteBufferManager is not able to handle
   // this failure properly. Ideallly we should prevent this allocation
@@ -213,7 +246,8 @@ size_t WriteBufferManager::FreeMemWithCache(size_t mem) {
   assert(old_mem_used >= mem);
   size_t new_mem_used = old_mem_used - mem;
   memory_used_.store(new_mem_used, std::memory_order_relaxed);
-  Status s = cache_res_mgr_->UpdateCacheReservation(new_mem_used);
+  Status s = cache_res_mgr_->UpdateCacheReservation(new_mem_used +
+                                                    arena_block_pool_usage());
 
   // We absorb the error since WriteBufferManager is not able to handle
   // this failure properly.
@@ -326,6 +360,12 @@ std::string WriteBufferManager::GetPrintableOptions() const {
            "wbm.initiate_flushes", IsInitiatingFlushes());
   ret.append(buffer);
 
+  snprintf(buffer, kBufferSize, "%*s: %" ROCKSDB_PRIszt "\n", field_width,
+           "wbm.arena_block_pool_capacity",
+           (arena_block_pool_ != nullptr) ? arena_block_pool_->GetCapacity()
+                                          : 0U);
+  ret.append(buffer);
+
   return ret;
 }
 
@@ -0,0 +1,87 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+// Micro-benchmark for varint decoding, as done for every block entry, block
+// handle, WriteBatch record and MANIFEST edit.
+#include <algorithm>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "util/coding.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// benchmark arguments:
+// 0. maximum number of significant bits of the encoded values
+// 1. number of encoded values
+static void CustomArguments(benchmark::internal::Benchmark *b) {
+  for (int max_bits : {7, 14, 32, 64}) {
+    for (int64_t value_num : {1 << 10, 1 << 16}) {
+      b->Args({max_bits, value_num});
+    }
+  }
+  b->ArgNames({"max_bits", "value_num"});
+}
+
+static std::string EncodeValues(int max_bits, int64_t value_num, bool is_64) {
+  Random64 rnd(301);
+  std::string encoded;
+  for (int64_t i = 0; i < value_num; i++) {
+    // Vary the encoded length between 1 byte and max_bits
+    const int bits = 1 + static_cast<int>(rnd.Uniform(max_bits));
+    const uint64_t v = rnd.Next() >> (64 - bits);
+    if (is_64) {
+      PutVarint64(&encoded, v);
+    } else {
+      PutVarint32(&encoded, static_cast<uint32_t>(v));
+    }
+  }
+  return encoded;
+}
+
+static void DecodeVarint32(benchmark::State &state) {
+  const int max_bits = std::min(32, static_cast<int>(state.range(0)));
+  const int64_t kValueNum = state.range(1);
+  const std::string encoded = EncodeValues(max_bits, kValueNum, false);
+  const char *limit = encoded.data() + encoded.size();
+
+  for (auto _ : state) {
+    const char *p = encoded.data();
+    uint32_t sum = 0;
+    while (p != nullptr && p < limit) {
+      uint32_t v;
+      p = GetVarint32Ptr(p, limit, &v);
+      sum += v;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kValueNum);
+}
+BENCHMARK(DecodeVarint32)->Apply(CustomArguments);
+
+static void DecodeVarint64(benchmark::State &state) {
+  const int max_bits = static_cast<int>(state.range(0));
+  const int64_t kValueNum = state.range(1);
+  const std::string encoded = EncodeValues(max_bits, kValueNum, true);
+  const char *limit = encoded.data() + encoded.size();
+
+  for (auto _ : state) {
+    const char *p = encoded.data();
+    uint64_t sum = 0;
+    while (p != nullptr && p < limit) {
+      uint64_t v;
+      p = GetVarint64Ptr(p, limit, &v);
+      sum += v;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kValueNum);
+}
+BENCHMARK(DecodeVarint64)->Apply(CustomArguments);
+
+}  // namespace ROCKSDB_NAMESPACE
+
+BENCHMARK_MAIN();
@@ -125,6 +125,21 @@ void HistogramStat::Merge(const HistogramStat& other) {
   }
 }
 
+void HistogramStat::Subtract(const HistogramStat& earlier) {
+  // Clamped, in case the histogram was cleared after the copy was taken
+  auto subtract = [](std::atomic_uint_fast64_t* value, uint64_t other) {
+    const uint64_t cur = value->load(std::memory_order_relaxed);
+    value->store(cur - std::min<uint64_t>(cur, other),
+                 std::memory_order_relaxed);
+  };
+  subtract(&num_, earlier.num());
+  subtract(&sum_, earlier.sum());
+  subtract(&sum_squares_, earlier.sum_squares());
+  for (unsigned int b = 0; b < num_buckets_; b++) {
+    subtract(&buckets_[b], earlier.bucket_at(b));
+  }
+}
+
 double HistogramStat::Median() const { return Percentile(50.0); }
 
 double HistogramStat::Percentile(double p) const {
@@ -251,6 +266,11 @@ void HistogramImpl::Merge(const HistogramImpl& other) {
   stats_.Merge(other.stats_);
 }
 
+void HistogramImpl::Subtract(const HistogramImpl& earlier) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.Subtract(earlier.stats_);
+}
+
 double HistogramImpl::Median() const { return stats_.Median(); }
 
 double HistogramImpl::Percentile(double p) const {
@@ -68,6 +68,9 @@ struct HistogramStat {
   bool Empty() const;
   void Add(uint64_t value);
   void Merge(const HistogramStat& other);
+  // Removes the values of an earlier copy of this histogram, leaving the
+  // values added since. min() and max() are kept, as they still bound them.
+  void Subtract(const HistogramStat& earlier);
 
   inline uint64_t min() const { return min_.load(std::memory_order_relaxed); }
   inline uint64_t max() const { return max_.load(std::memory_order_relaxed); }
@@ -134,6 +137,7 @@ class HistogramImpl : public Histogram {
   virtual void Add(uint64_t value) override;
   virtual void Merge(const Histogram& other) override;
   void Merge(const HistogramImpl& other);
+  void Subtract(const HistogramImpl& earlier);
 
   virtual std::string ToString() const override;
   virtual const char* Name() const override { return "HistogramImpl"; }
@@ -413,6 +413,12 @@ void StatisticsImpl::histogramData(uint32_t histogramType,
   getHistogramImplLocked(histogramType)->Data(data);
 }
 
+std::unique_ptr<HistogramImpl> StatisticsImpl::getHistogramImpl(
+    uint32_t histogramType) const {
+  MutexLock lock(&aggregate_lock_);
+  return getHistogramImplLocked(histogramType);
+}
+
 std::unique_ptr<HistogramImpl> StatisticsImpl::getHistogramImplLocked(
     uint32_t histogramType) const {
   assert(histogramType < HISTOGRAM_ENUM_MAX);
@@ -71,6 +71,12 @@ class StatisticsImpl : public Statistics {
 
   const Customizable* Inner() const override { return stats_.get(); }
 
+  // Returns a copy of a histogram, merged from all the cores. The values added
+  // in an interval are those of a copy taken at its end minus (see
+  // HistogramImpl::Subtract()) a copy taken at its start.
+  std::unique_ptr<HistogramImpl> getHistogramImpl(
+      uint32_t histogram_type) const;
+
  private:
   // If non-nullptr, forwards updates to the object pointed to by `stats_`.
   std::shared_ptr<Statistics> stats_;
@@ -330,6 +330,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, level0_stop_writes_trigger),
           OptionType::kInt, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"flush_to_non_overlapping_level",
+         {offsetof(struct MutableCFOptions, flush_to_non_overlapping_level),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"max_grandparent_overlap_factor",
          {0, OptionType::kInt, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kMutable}},
@@ -360,6 +364,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, memtable_huge_page_size),
           OptionType::kSizeT, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"memtable_numa_local_allocation",
+         {offsetof(struct MutableCFOptions, memtable_numa_local_allocation),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"memtable_prefix_bloom_huge_page_tlb_size",
          {0, OptionType::kSizeT, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kMutable}},
@@ -1078,6 +1086,8 @@ void MutableCFOptions::Dump(Logger* log) const {
   ROCKS_LOG_INFO(log,
                  "                  memtable_huge_page_size: %" ROCKSDB_PRIszt,
                  memtable_huge_page_size);
+  ROCKS_LOG_INFO(log, "           memtable_numa_local_allocation: %d",
+                 memtable_numa_local_allocation);
   ROCKS_LOG_INFO(log,
                  "                    max_successive_merges: %" ROCKSDB_PRIszt,
                  max_successive_merges);
@@ -1100,6 +1110,8 @@ void MutableCFOptions::Dump(Logger* log) const {
                  level0_slowdown_writes_trigger);
   ROCKS_LOG_INFO(log, "               level0_stop_writes_trigger: %d",
                  level0_stop_writes_trigger);
+  ROCKS_LOG_INFO(log, "           flush_to_non_overlapping_level: %d",
+                 flush_to_non_overlapping_level);
   ROCKS_LOG_INFO(log, "                     max_compaction_bytes: %" PRIu64,
                  max_compaction_bytes);
   ROCKS_LOG_INFO(log, "    ignore_max_compaction_bytes_for_input: %s",
@@ -133,6 +133,7 @@ struct MutableCFOptions {
             options.memtable_prefix_bloom_size_ratio),
         memtable_whole_key_filtering(options.memtable_whole_key_filtering),
         memtable_huge_page_size(options.memtable_huge_page_size),
+        memtable_numa_local_allocation(options.memtable_numa_local_allocation),
         max_successive_merges(options.max_successive_merges),
         inplace_update_num_locks(options.inplace_update_num_locks),
         prefix_extractor(options.prefix_extractor),
@@ -147,6 +148,7 @@ struct MutableCFOptions {
             options.level0_file_num_compaction_trigger),
         level0_slowdown_writes_trigger(options.level0_slowdown_writes_trigger),
         level0_stop_writes_trigger(options.level0_stop_writes_trigger),
+        flush_to_non_overlapping_level(options.flush_to_non_overlapping_level),
         max_compaction_bytes(options.max_compaction_bytes),
         ignore_max_compaction_bytes_for_input(
             options.ignore_max_compaction_bytes_for_input),
@@ -205,6 +207,7 @@ struct MutableCFOptions {
         memtable_prefix_bloom_size_ratio(0),
         memtable_whole_key_filtering(false),
         memtable_huge_page_size(0),
+        memtable_numa_local_allocation(false),
         max_successive_merges(0),
         inplace_update_num_locks(0),
         prefix_extractor(nullptr),
@@ -215,6 +218,7 @@ struct MutableCFOptions {
         level0_file_num_compaction_trigger(0),
         level0_slowdown_writes_trigger(0),
         level0_stop_writes_trigger(0),
+        flush_to_non_overlapping_level(false),
         max_compaction_bytes(0),
         ignore_max_compaction_bytes_for_input(true),
         target_file_size_base(0),
@@ -272,6 +276,7 @@ struct MutableCFOptions {
   double memtable_prefix_bloom_size_ratio;
   bool memtable_whole_key_filtering;
   size_t memtable_huge_page_size;
+  bool memtable_numa_local_allocation;
   size_t max_successive_merges;
   size_t inplace_update_num_locks;
 
@@ -300,6 +305,7 @@ struct MutableCFOptions {
   int level0_file_num_compaction_trigger;
   int level0_slowdown_writes_trigger;
   int level0_stop_writes_trigger;
+  bool flush_to_non_overlapping_level;
   uint64_t max_compaction_bytes;
   bool ignore_max_compaction_bytes_for_input;
   uint64_t target_file_size_base;
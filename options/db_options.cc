@@ -304,6 +304,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, recycle_log_file_num),
           OptionType::kSizeT, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"preallocated_wal_ring",
+         {offsetof(struct ImmutableDBOptions, preallocated_wal_ring),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"use_direct_io_for_wal",
+         {offsetof(struct ImmutableDBOptions, use_direct_io_for_wal),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"log_file_time_to_roll",
          {offsetof(struct ImmutableDBOptions, log_file_time_to_roll),
           OptionType::kSizeT, OptionVerificationType::kNormal,
@@ -418,6 +426,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, wal_compression),
           OptionType::kCompressionType, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"wal_compression_dict_bytes",
+         {offsetof(struct ImmutableDBOptions, wal_compression_dict_bytes),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"memtable_wal_value_threshold",
+         {offsetof(struct ImmutableDBOptions, memtable_wal_value_threshold),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"seq_per_batch",
          {0, OptionType::kBoolean, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kNone}},
@@ -584,6 +600,15 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, use_dynamic_delay),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"max_non_blocking_compact_range_threads",
+         {offsetof(struct ImmutableDBOptions,
+                   max_non_blocking_compact_range_threads),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"pipelined_wal_recovery",
+         {offsetof(struct ImmutableDBOptions, pipelined_wal_recovery),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
 };
 
 const std::string OptionsHelper::kDBOptionsName = "DBOptions";
@@ -725,6 +750,8 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       log_file_time_to_roll(options.log_file_time_to_roll),
       keep_log_file_num(options.keep_log_file_num),
       recycle_log_file_num(options.recycle_log_file_num),
+      preallocated_wal_ring(options.preallocated_wal_ring),
+      use_direct_io_for_wal(options.use_direct_io_for_wal),
       max_manifest_file_size(options.max_manifest_file_size),
       table_cache_numshardbits(options.table_cache_numshardbits),
       WAL_ttl_seconds(options.WAL_ttl_seconds),
@@ -743,6 +770,8 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       db_write_buffer_size(options.db_write_buffer_size),
       write_buffer_manager(options.write_buffer_manager),
       write_controller(options.write_controller),
+      background_job_scheduler(options.background_job_scheduler),
+      shared_wal(options.shared_wal),
       access_hint_on_compaction_start(options.access_hint_on_compaction_start),
       random_access_max_buffer_size(options.random_access_max_buffer_size),
       use_adaptive_mutex(options.use_adaptive_mutex),
@@ -770,6 +799,8 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       two_write_queues(options.two_write_queues),
       manual_wal_flush(options.manual_wal_flush),
       wal_compression(options.wal_compression),
+      wal_compression_dict_bytes(options.wal_compression_dict_bytes),
+      memtable_wal_value_threshold(options.memtable_wal_value_threshold),
       atomic_flush(options.atomic_flush),
       avoid_unnecessary_blocking_io(options.avoid_unnecessary_blocking_io),
       persist_stats_to_disk(options.persist_stats_to_disk),
@@ -785,7 +816,10 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       lowest_used_cache_tier(options.lowest_used_cache_tier),
       compaction_service(options.compaction_service),
       use_dynamic_delay(options.use_dynamic_delay),
-      enforce_single_del_contracts(options.enforce_single_del_contracts) {
+      enforce_single_del_contracts(options.enforce_single_del_contracts),
+      max_non_blocking_compact_range_threads(
+          options.max_non_blocking_compact_range_threads),
+      pipelined_wal_recovery(options.pipelined_wal_recovery) {
   fs = env->GetFileSystem();
   clock = env->GetSystemClock().get();
   logger = info_log.get();
@@ -836,6 +870,10 @@ void ImmutableDBOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(
       log, "                   Options.recycle_log_file_num: %" ROCKSDB_PRIszt,
       recycle_log_file_num);
+  ROCKS_LOG_HEADER(log, "                  Options.preallocated_wal_ring: %d",
+                   preallocated_wal_ring);
+  ROCKS_LOG_HEADER(log, "                  Options.use_direct_io_for_wal: %d",
+                   use_direct_io_for_wal);
   ROCKS_LOG_HEADER(log, "                        Options.allow_fallocate: %d",
                    allow_fallocate);
   ROCKS_LOG_HEADER(log, "                       Options.allow_mmap_reads: %d",
@@ -877,6 +915,10 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    use_dynamic_delay);
   ROCKS_LOG_HEADER(log, "                   Options.write_controller: %p",
                    write_controller.get());
+  ROCKS_LOG_HEADER(log, "           Options.background_job_scheduler: %p",
+                   background_job_scheduler.get());
+  ROCKS_LOG_HEADER(log, "                         Options.shared_wal: %p",
+                   shared_wal.get());
   ROCKS_LOG_HEADER(
       log, "                   Options.db_write_buffer_size: %" ROCKSDB_PRIszt,
       db_write_buffer_size);
@@ -939,6 +981,12 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    manual_wal_flush);
   ROCKS_LOG_HEADER(log, "            Options.wal_compression: %d",
                    wal_compression);
+  ROCKS_LOG_HEADER(
+      log, " Options.wal_compression_dict_bytes: %" ROCKSDB_PRIszt,
+      wal_compression_dict_bytes);
+  ROCKS_LOG_HEADER(
+      log, " Options.memtable_wal_value_threshold: %" ROCKSDB_PRIszt,
+      memtable_wal_value_threshold);
   ROCKS_LOG_HEADER(log, "            Options.atomic_flush: %d", atomic_flush);
   ROCKS_LOG_HEADER(log,
                    "            Options.avoid_unnecessary_blocking_io: %d",
@@ -966,6 +1014,10 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    db_host_id.c_str());
   ROCKS_LOG_HEADER(log, "            Options.enforce_single_del_contracts: %s",
                    enforce_single_del_contracts ? "true" : "false");
+  ROCKS_LOG_HEADER(log, "  Options.max_non_blocking_compact_range_threads: %d",
+                   max_non_blocking_compact_range_threads);
+  ROCKS_LOG_HEADER(log, "                  Options.pipelined_wal_recovery: %d",
+                   pipelined_wal_recovery);
 }
 
 bool ImmutableDBOptions::IsWalDirSameAsDBPath() const {
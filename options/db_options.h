@@ -60,6 +60,8 @@ struct ImmutableDBOptions {
   size_t log_file_time_to_roll;
   size_t keep_log_file_num;
   size_t recycle_log_file_num;
+  bool preallocated_wal_ring;
+  bool use_direct_io_for_wal;
   uint64_t max_manifest_file_size;
   int table_cache_numshardbits;
   uint64_t WAL_ttl_seconds;
@@ -76,6 +78,8 @@ struct ImmutableDBOptions {
   size_t db_write_buffer_size;
   std::shared_ptr<WriteBufferManager> write_buffer_manager;
   std::shared_ptr<WriteController> write_controller;
+  std::shared_ptr<BackgroundJobScheduler> background_job_scheduler;
+  std::shared_ptr<SharedWal> shared_wal;
   DBOptions::AccessHint access_hint_on_compaction_start;
   size_t random_access_max_buffer_size;
   bool use_adaptive_mutex;
@@ -101,6 +105,8 @@ struct ImmutableDBOptions {
   bool two_write_queues;
   bool manual_wal_flush;
   CompressionType wal_compression;
+  size_t wal_compression_dict_bytes;
+  size_t memtable_wal_value_threshold;
   bool atomic_flush;
   bool avoid_unnecessary_blocking_io;
   bool persist_stats_to_disk;
@@ -122,6 +128,8 @@ struct ImmutableDBOptions {
   std::shared_ptr<CompactionService> compaction_service;
   bool use_dynamic_delay;
   bool enforce_single_del_contracts;
+  int max_non_blocking_compact_range_threads;
+  bool pipelined_wal_recovery;
 
   bool IsWalDirSameAsDBPath() const;
   bool IsWalDirSameAsDBPath(const std::string& path) const;
@@ -73,6 +73,7 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
           options.memtable_prefix_bloom_size_ratio),
       memtable_whole_key_filtering(options.memtable_whole_key_filtering),
       memtable_huge_page_size(options.memtable_huge_page_size),
+      memtable_numa_local_allocation(options.memtable_numa_local_allocation),
       memtable_insert_with_hint_prefix_extractor(
           options.memtable_insert_with_hint_prefix_extractor),
       bloom_locality(options.bloom_locality),
@@ -81,6 +82,7 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
       num_levels(options.num_levels),
       level0_slowdown_writes_trigger(options.level0_slowdown_writes_trigger),
       level0_stop_writes_trigger(options.level0_stop_writes_trigger),
+      flush_to_non_overlapping_level(options.flush_to_non_overlapping_level),
       target_file_size_base(options.target_file_size_base),
       target_file_size_multiplier(options.target_file_size_multiplier),
       level_compaction_dynamic_level_bytes(
@@ -283,6 +285,8 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                      level0_slowdown_writes_trigger);
     ROCKS_LOG_HEADER(log, "             Options.level0_stop_writes_trigger: %d",
                      level0_stop_writes_trigger);
+    ROCKS_LOG_HEADER(log, "         Options.flush_to_non_overlapping_level: %d",
+                     flush_to_non_overlapping_level);
     ROCKS_LOG_HEADER(
         log, "                  Options.target_file_size_base: %" PRIu64,
         target_file_size_base);
@@ -409,6 +413,8 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
 
     ROCKS_LOG_HEADER(log, "  Options.memtable_huge_page_size: %" ROCKSDB_PRIszt,
                      memtable_huge_page_size);
+    ROCKS_LOG_HEADER(log, "  Options.memtable_numa_local_allocation: %d",
+                     memtable_numa_local_allocation);
     ROCKS_LOG_HEADER(log,
                      "                          Options.bloom_locality: %d",
                      bloom_locality);
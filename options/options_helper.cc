@@ -147,6 +147,8 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.log_file_time_to_roll = immutable_db_options.log_file_time_to_roll;
   options.keep_log_file_num = immutable_db_options.keep_log_file_num;
   options.recycle_log_file_num = immutable_db_options.recycle_log_file_num;
+  options.preallocated_wal_ring = immutable_db_options.preallocated_wal_ring;
+  options.use_direct_io_for_wal = immutable_db_options.use_direct_io_for_wal;
   options.max_manifest_file_size = immutable_db_options.max_manifest_file_size;
   options.table_cache_numshardbits =
       immutable_db_options.table_cache_numshardbits;
@@ -171,6 +173,9 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.db_write_buffer_size = immutable_db_options.db_write_buffer_size;
   options.write_buffer_manager = immutable_db_options.write_buffer_manager;
   options.write_controller = immutable_db_options.write_controller;
+  options.background_job_scheduler =
+      immutable_db_options.background_job_scheduler;
+  options.shared_wal = immutable_db_options.shared_wal;
   options.access_hint_on_compaction_start =
       immutable_db_options.access_hint_on_compaction_start;
   options.compaction_readahead_size =
@@ -184,6 +189,9 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.enable_thread_tracking = immutable_db_options.enable_thread_tracking;
   options.delayed_write_rate = mutable_db_options.delayed_write_rate;
   options.use_dynamic_delay = immutable_db_options.use_dynamic_delay;
+  options.max_non_blocking_compact_range_threads =
+      immutable_db_options.max_non_blocking_compact_range_threads;
+  options.pipelined_wal_recovery = immutable_db_options.pipelined_wal_recovery;
   options.enable_pipelined_write = immutable_db_options.enable_pipelined_write;
   options.unordered_write = immutable_db_options.unordered_write;
   options.allow_concurrent_memtable_write =
@@ -215,6 +223,10 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.two_write_queues = immutable_db_options.two_write_queues;
   options.manual_wal_flush = immutable_db_options.manual_wal_flush;
   options.wal_compression = immutable_db_options.wal_compression;
+  options.wal_compression_dict_bytes =
+      immutable_db_options.wal_compression_dict_bytes;
+  options.memtable_wal_value_threshold =
+      immutable_db_options.memtable_wal_value_threshold;
   options.atomic_flush = immutable_db_options.atomic_flush;
   options.avoid_unnecessary_blocking_io =
       immutable_db_options.avoid_unnecessary_blocking_io;
@@ -258,6 +270,8 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
       moptions.memtable_prefix_bloom_size_ratio;
   cf_opts->memtable_whole_key_filtering = moptions.memtable_whole_key_filtering;
   cf_opts->memtable_huge_page_size = moptions.memtable_huge_page_size;
+  cf_opts->memtable_numa_local_allocation =
+      moptions.memtable_numa_local_allocation;
   cf_opts->max_successive_merges = moptions.max_successive_merges;
   cf_opts->inplace_update_num_locks = moptions.inplace_update_num_locks;
   cf_opts->prefix_extractor = moptions.prefix_extractor;
@@ -281,6 +295,8 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
   cf_opts->level0_slowdown_writes_trigger =
       moptions.level0_slowdown_writes_trigger;
   cf_opts->level0_stop_writes_trigger = moptions.level0_stop_writes_trigger;
+  cf_opts->flush_to_non_overlapping_level =
+      moptions.flush_to_non_overlapping_level;
   cf_opts->max_compaction_bytes = moptions.max_compaction_bytes;
   cf_opts->ignore_max_compaction_bytes_for_input =
       moptions.ignore_max_compaction_bytes_for_input;
@@ -260,6 +260,10 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
        sizeof(std::shared_ptr<WriteBufferManager>)},
       {offsetof(struct DBOptions, write_controller),
        sizeof(std::shared_ptr<WriteController>)},
+      {offsetof(struct DBOptions, background_job_scheduler),
+       sizeof(std::shared_ptr<BackgroundJobScheduler>)},
+      {offsetof(struct DBOptions, shared_wal),
+       sizeof(std::shared_ptr<SharedWal>)},
       {offsetof(struct DBOptions, listeners),
        sizeof(std::vector<std::shared_ptr<EventListener>>)},
       {offsetof(struct DBOptions, row_cache), sizeof(std::shared_ptr<Cache>)},
@@ -339,6 +343,8 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "strict_bytes_per_sync=true;"
                              "enable_thread_tracking=false;"
                              "recycle_log_file_num=0;"
+                             "preallocated_wal_ring=true;"
+                             "use_direct_io_for_wal=true;"
                              "create_missing_column_families=true;"
                              "log_file_time_to_roll=3097;"
                              "max_background_flushes=35;"
@@ -377,6 +383,8 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "two_write_queues=false;"
                              "manual_wal_flush=false;"
                              "wal_compression=kZSTD;"
+                             "wal_compression_dict_bytes=4096;"
+                             "memtable_wal_value_threshold=8192;"
                              "seq_per_batch=false;"
                              "atomic_flush=false;"
                              "avoid_unnecessary_blocking_io=false;"
@@ -389,6 +397,8 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "lowest_used_cache_tier=kNonVolatileBlockTier;"
                              "allow_data_in_errors=false;"
                              "enforce_single_del_contracts=false;"
+                             "max_non_blocking_compact_range_threads=2;"
+                             "pipelined_wal_recovery=true;"
                              "refresh_options_sec=0;"
                              "refresh_options_file=Options.new;"
                              "use_dynamic_delay=true",
@@ -538,6 +548,7 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "per_kb=876;checksum=true};"
       "bottommost_compression=kDisableCompressionOption;"
       "level0_stop_writes_trigger=33;"
+      "flush_to_non_overlapping_level=true;"
       "num_levels=99;"
       "level0_slowdown_writes_trigger=22;"
       "level0_file_num_compaction_trigger=14;"
@@ -548,6 +559,7 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "merge_operator=aabcxehazrMergeOperator;"
       "memtable_prefix_bloom_size_ratio=0.4642;"
       "memtable_whole_key_filtering=true;"
+      "memtable_numa_local_allocation=true;"
       "memtable_insert_with_hint_prefix_extractor=rocksdb.CappedPrefix.13;"
       "check_flush_compaction_key_order=false;"
       "paranoid_file_checks=true;"
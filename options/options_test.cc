@@ -132,6 +132,7 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
       {"memtable_prefix_bloom_size_ratio", "0.26"},
       {"memtable_whole_key_filtering", "true"},
       {"memtable_huge_page_size", "28"},
+      {"memtable_numa_local_allocation", "true"},
       {"bloom_locality", "29"},
       {"max_successive_merges", "30"},
       {"min_partial_merge_operands", "31"},
@@ -286,6 +287,7 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.memtable_prefix_bloom_size_ratio, 0.26);
   ASSERT_EQ(new_cf_opt.memtable_whole_key_filtering, true);
   ASSERT_EQ(new_cf_opt.memtable_huge_page_size, 28U);
+  ASSERT_EQ(new_cf_opt.memtable_numa_local_allocation, true);
   ASSERT_EQ(new_cf_opt.bloom_locality, 29U);
   ASSERT_EQ(new_cf_opt.max_successive_merges, 30U);
   ASSERT_TRUE(new_cf_opt.prefix_extractor != nullptr);
@@ -1295,6 +1297,14 @@ TEST_F(OptionsTest, MemTableRepFactoryCreateFromString) {
 
   ASSERT_OK(MemTableRepFactory::CreateFromString(
       config_options, "id=skip_list; lookahead=32", &new_mem_factory));
+  ASSERT_OK(MemTableRepFactory::CreateFromString(
+      config_options, "id=skip_list; thread_local_insert_hints=true",
+      &new_mem_factory));
+  std::string thread_local_insert_hints;
+  ASSERT_OK(new_mem_factory->GetOption(config_options,
+                                       "thread_local_insert_hints",
+                                       &thread_local_insert_hints));
+  ASSERT_EQ(thread_local_insert_hints, "true");
   ASSERT_OK(MemTableRepFactory::CreateFromString(config_options, "prefix_hash",
                                                  &new_mem_factory));
   ASSERT_OK(MemTableRepFactory::CreateFromString(
@@ -2552,6 +2562,7 @@ TEST_F(OptionsOldApiTest, GetOptionsFromMapTest) {
       {"memtable_prefix_bloom_size_ratio", "0.26"},
       {"memtable_whole_key_filtering", "true"},
       {"memtable_huge_page_size", "28"},
+      {"memtable_numa_local_allocation", "true"},
       {"bloom_locality", "29"},
       {"max_successive_merges", "30"},
       {"min_partial_merge_operands", "31"},
@@ -2704,6 +2715,7 @@ TEST_F(OptionsOldApiTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.memtable_prefix_bloom_size_ratio, 0.26);
   ASSERT_EQ(new_cf_opt.memtable_whole_key_filtering, true);
   ASSERT_EQ(new_cf_opt.memtable_huge_page_size, 28U);
+  ASSERT_EQ(new_cf_opt.memtable_numa_local_allocation, true);
   ASSERT_EQ(new_cf_opt.bloom_locality, 29U);
   ASSERT_EQ(new_cf_opt.max_successive_merges, 30U);
   ASSERT_TRUE(new_cf_opt.prefix_extractor != nullptr);
@@ -13,6 +13,7 @@ LIB_SOURCES =                                                   \
   cache/secondary_cache_adapter.cc                              \
   cache/sharded_cache.cc                                        \
   db/arena_wrapped_db_iter.cc                                   \
+  db/background_job_scheduler.cc                                \
   db/blob/blob_contents.cc                                      \
   db/blob/blob_fetcher.cc                                       \
   db/blob/blob_file_addition.cc                                 \
@@ -83,6 +84,7 @@ LIB_SOURCES =                                                   \
   db/range_tombstone_fragmenter.cc                              \
   db/repair.cc                                                  \
   db/seqno_to_time_mapping.cc                                   \
+  db/shared_wal_impl.cc                                         \
   db/snapshot_impl.cc                                           \
   db/table_cache.cc                                             \
   db/table_properties_collector.cc                              \
@@ -94,6 +96,7 @@ LIB_SOURCES =                                                   \
   db/version_set.cc                                             \
   db/wal_edit.cc                                                \
   db/wal_manager.cc                                             \
+  db/wal_value_file.cc                                          \
   db/wide/wide_column_serialization.cc                          \
   db/wide/wide_columns.cc                                       \
   db/write_batch.cc                                             \
@@ -128,11 +131,13 @@ LIB_SOURCES =                                                   \
   logging/event_logger.cc                                       \
   logging/log_buffer.cc                                         \
   memory/arena.cc                                               \
+  memory/arena_block_pool.cc                                    \
   memory/concurrent_arena.cc                                    \
   memory/jemalloc_nodump_allocator.cc                           \
   memory/memkind_kmem_allocator.cc                              \
   memory/memory_allocator.cc                                    \
   memtable/alloc_tracker.cc                                     \
+  memtable/bplus_tree_rep.cc                                    \
   memtable/hash_linklist_rep.cc                                 \
   memtable/hash_spdb_rep.cc                                     \
   memtable/hash_skiplist_rep.cc                                 \
@@ -531,12 +536,15 @@ TEST_MAIN_SOURCES =                                                     \
   db/version_edit_test.cc                                               \
   db/version_set_test.cc                                                \
   db/wal_manager_test.cc                                                \
+  db/wal_value_file_test.cc                                             \
   db/wide/db_wide_basic_test.cc                                         \
   db/wide/wide_column_serialization_test.cc                             \
   db/write_batch_test.cc                                                \
   db/write_callback_test.cc                                             \
   db/write_controller_test.cc                                           \
   db/global_write_controller_test.cc                                    \
+  db/background_job_scheduler_test.cc                                   \
+  db/shared_wal_test.cc                                                 \
   env/env_basic_test.cc                                                 \
   env/env_test.cc                                                       \
   env/io_posix_test.cc                                                  \
@@ -549,6 +557,7 @@ TEST_MAIN_SOURCES =                                                     \
   logging/event_logger_test.cc                                          \
   memory/arena_test.cc                                                  \
   memory/memory_allocator_test.cc                                       \
+  memtable/bplus_tree_test.cc                                           \
   memtable/inlineskiplist_test.cc                                       \
   memtable/skiplist_test.cc                                             \
   memtable/write_buffer_manager_test.cc                                 \
@@ -640,6 +649,7 @@ TEST_MAIN_SOURCES_C = \
 MICROBENCH_SOURCES =                                          \
   microbench/ribbon_bench.cc                                  \
   microbench/db_basic_bench.cc                                  \
+  microbench/coding_bench.cc                                  \
 
 JNI_NATIVE_SOURCES =                                          \
   java/rocksjni/backupenginejni.cc                            \
@@ -5,6 +5,8 @@
 
 #include "table/adaptive/adaptive_table_factory.h"
 
+#include <algorithm>
+
 #include "port/port.h"
 #include "table/format.h"
 #include "table/table_builder.h"
@@ -15,8 +17,13 @@ AdaptiveTableFactory::AdaptiveTableFactory(
     std::shared_ptr<TableFactory> table_factory_to_write,
     std::shared_ptr<TableFactory> block_based_table_factory,
     std::shared_ptr<TableFactory> plain_table_factory,
-    std::shared_ptr<TableFactory> cuckoo_table_factory)
+    std::shared_ptr<TableFactory> cuckoo_table_factory,
+    std::vector<std::shared_ptr<TableFactory>> table_factory_to_write_per_level,
+    std::shared_ptr<TableFactory> bottommost_table_factory_to_write)
     : table_factory_to_write_(table_factory_to_write),
+      table_factory_to_write_per_level_(
+          std::move(table_factory_to_write_per_level)),
+      bottommost_table_factory_to_write_(bottommost_table_factory_to_write),
       block_based_table_factory_(block_based_table_factory),
       plain_table_factory_(plain_table_factory),
       cuckoo_table_factory_(cuckoo_table_factory) {
@@ -32,6 +39,11 @@ AdaptiveTableFactory::AdaptiveTableFactory(
   if (!table_factory_to_write_) {
     table_factory_to_write_ = block_based_table_factory_;
   }
+  for (auto& factory : table_factory_to_write_per_level_) {
+    if (!factory) {
+      factory = table_factory_to_write_;
+    }
+  }
 }
 
 extern const uint64_t kPlainTableMagicNumber;
@@ -70,10 +82,49 @@ Status AdaptiveTableFactory::NewTableReader(
   }
 }
 
+const std::shared_ptr<TableFactory>&
+AdaptiveTableFactory::GetTableFactoryToWrite(
+    const TableBuilderOptions& table_builder_options) const {
+  const int level = table_builder_options.level_at_creation;
+  if (level < 0) {
+    // Output level is unknown, e.g. for SstFileWriter.
+    return table_factory_to_write_;
+  }
+  if (bottommost_table_factory_to_write_ &&
+      table_builder_options.is_bottommost) {
+    return bottommost_table_factory_to_write_;
+  }
+  if (table_factory_to_write_per_level_.empty()) {
+    return table_factory_to_write_;
+  }
+  const size_t idx = std::min(static_cast<size_t>(level),
+                              table_factory_to_write_per_level_.size() - 1);
+  return table_factory_to_write_per_level_[idx];
+}
+
 TableBuilder* AdaptiveTableFactory::NewTableBuilder(
     const TableBuilderOptions& table_builder_options,
     WritableFileWriter* file) const {
-  return table_factory_to_write_->NewTableBuilder(table_builder_options, file);
+  return GetTableFactoryToWrite(table_builder_options)
+      ->NewTableBuilder(table_builder_options, file);
+}
+
+Status AdaptiveTableFactory::ValidateOptions(
+    const DBOptions& db_opts, const ColumnFamilyOptions& cf_opts) const {
+  Status s = TableFactory::ValidateOptions(db_opts, cf_opts);
+  if (s.ok()) {
+    s = table_factory_to_write_->ValidateOptions(db_opts, cf_opts);
+  }
+  for (const auto& factory : table_factory_to_write_per_level_) {
+    if (!s.ok()) {
+      break;
+    }
+    s = factory->ValidateOptions(db_opts, cf_opts);
+  }
+  if (s.ok() && bottommost_table_factory_to_write_) {
+    s = bottommost_table_factory_to_write_->ValidateOptions(db_opts, cf_opts);
+  }
+  return s;
 }
 
 std::string AdaptiveTableFactory::GetPrintableOptions() const {
@@ -89,6 +140,24 @@ std::string AdaptiveTableFactory::GetPrintableOptions() const {
              table_factory_to_write_->GetPrintableOptions().c_str());
     ret.append(buffer);
   }
+  for (size_t level = 0; level < table_factory_to_write_per_level_.size();
+       ++level) {
+    const auto& factory = table_factory_to_write_per_level_[level];
+    snprintf(buffer, kBufferSize, "  write factory for level %s%" ROCKSDB_PRIszt
+             ": %s\n",
+             level + 1 == table_factory_to_write_per_level_.size() ? ">=" : "",
+             level, factory->Name() ? factory->Name() : "");
+    ret.append(buffer);
+  }
+  if (bottommost_table_factory_to_write_) {
+    snprintf(buffer, kBufferSize,
+             "  bottommost write factory (%s) options:\n%s\n",
+             (bottommost_table_factory_to_write_->Name()
+                  ? bottommost_table_factory_to_write_->Name()
+                  : ""),
+             bottommost_table_factory_to_write_->GetPrintableOptions().c_str());
+    ret.append(buffer);
+  }
   if (plain_table_factory_) {
     snprintf(buffer, kBufferSize, "  %s options:\n%s\n",
              plain_table_factory_->Name() ? plain_table_factory_->Name() : "",
@@ -116,10 +185,13 @@ extern TableFactory* NewAdaptiveTableFactory(
     std::shared_ptr<TableFactory> table_factory_to_write,
     std::shared_ptr<TableFactory> block_based_table_factory,
     std::shared_ptr<TableFactory> plain_table_factory,
-    std::shared_ptr<TableFactory> cuckoo_table_factory) {
-  return new AdaptiveTableFactory(table_factory_to_write,
-                                  block_based_table_factory,
-                                  plain_table_factory, cuckoo_table_factory);
+    std::shared_ptr<TableFactory> cuckoo_table_factory,
+    std::vector<std::shared_ptr<TableFactory>> table_factory_to_write_per_level,
+    std::shared_ptr<TableFactory> bottommost_table_factory_to_write) {
+  return new AdaptiveTableFactory(
+      table_factory_to_write, block_based_table_factory, plain_table_factory,
+      cuckoo_table_factory, std::move(table_factory_to_write_per_level),
+      bottommost_table_factory_to_write);
 }
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -7,6 +7,7 @@
 
 
 #include <string>
+#include <vector>
 
 #include "rocksdb/options.h"
 #include "rocksdb/table.h"
@@ -29,7 +30,10 @@ class AdaptiveTableFactory : public TableFactory {
       std::shared_ptr<TableFactory> table_factory_to_write,
       std::shared_ptr<TableFactory> block_based_table_factory,
       std::shared_ptr<TableFactory> plain_table_factory,
-      std::shared_ptr<TableFactory> cuckoo_table_factory);
+      std::shared_ptr<TableFactory> cuckoo_table_factory,
+      std::vector<std::shared_ptr<TableFactory>>
+          table_factory_to_write_per_level = {},
+      std::shared_ptr<TableFactory> bottommost_table_factory_to_write = nullptr);
 
   const char* Name() const override { return "AdaptiveTableFactory"; }
 
@@ -44,10 +48,20 @@ class AdaptiveTableFactory : public TableFactory {
       const TableBuilderOptions& table_builder_options,
       WritableFileWriter* file) const override;
 
+  // Validates the options of the factories used to write new files
+  Status ValidateOptions(const DBOptions& db_opts,
+                         const ColumnFamilyOptions& cf_opts) const override;
+
   std::string GetPrintableOptions() const override;
 
  private:
+  // Returns the factory used to build a new file for `table_builder_options`.
+  const std::shared_ptr<TableFactory>& GetTableFactoryToWrite(
+      const TableBuilderOptions& table_builder_options) const;
+
   std::shared_ptr<TableFactory> table_factory_to_write_;
+  std::vector<std::shared_ptr<TableFactory>> table_factory_to_write_per_level_;
+  std::shared_ptr<TableFactory> bottommost_table_factory_to_write_;
   std::shared_ptr<TableFactory> block_based_table_factory_;
   std::shared_ptr<TableFactory> plain_table_factory_;
   std::shared_ptr<TableFactory> cuckoo_table_factory_;
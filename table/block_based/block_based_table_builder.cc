@@ -1899,6 +1899,7 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
     }
 
     auto& data_block = r->data_block_buffers[i];
+    const size_t data_block_size = data_block.size();
     if (r->IsParallelCompressionEnabled()) {
       Slice first_key_in_next_block;
       const Slice* first_key_in_next_block_ptr = &first_key_in_next_block;
@@ -1944,6 +1945,22 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
       }
     }
     std::swap(iter, next_block_iter);
+    // The block has been handed off (or written), so its buffer is no longer
+    // referenced by any iterator. Release it right away instead of holding
+    // the whole buffered range until the replay completes, and shrink the
+    // cache charge accordingly.
+    next_block_iter.reset();
+    std::string().swap(data_block);
+    r->data_begin_offset -= std::min(r->data_begin_offset, data_block_size);
+    if (r->compression_dict_buffer_cache_res_mgr != nullptr) {
+      Status s =
+          r->compression_dict_buffer_cache_res_mgr->UpdateCacheReservation(
+              r->data_begin_offset);
+      s.PermitUncheckedError();
+    }
+    TEST_SYNC_POINT_CALLBACK(
+        "BlockBasedTableBuilder::EnterUnbuffered:BlockReleased",
+        &r->data_begin_offset);
   }
   r->data_block_buffers.clear();
   r->data_begin_offset = 0;
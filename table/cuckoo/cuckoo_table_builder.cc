@@ -20,7 +20,9 @@
 #include "table/cuckoo/cuckoo_table_factory.h"
 #include "table/format.h"
 #include "table/meta_blocks.h"
+#include "test_util/sync_point.h"
 #include "util/autovector.h"
+#include "util/coding.h"
 #include "util/random.h"
 #include "util/string_util.h"
 
@@ -43,6 +45,8 @@ const std::string CuckooTablePropertyNames::kUseModuleHash =
     "rocksdb.cuckoo.hash.usemodule";
 const std::string CuckooTablePropertyNames::kUserKeyLength =
     "rocksdb.cuckoo.hash.userkeylength";
+const std::string CuckooTablePropertyNames::kSortedIndexOffset =
+    "rocksdb.cuckoo.sorted.index.offset";
 
 // Obtained by running echo rocksdb.table.cuckoo | sha1sum
 extern const uint64_t kCuckooTableMagicNumber = 0x926789d0c5f17873ull;
@@ -342,6 +346,47 @@ Status CuckooTableBuilder::Finish() {
 
   uint64_t offset = buckets.size() * bucket_size;
   properties_.data_size = offset;
+
+  // Write the ids of the non-empty buckets in user key order, so that
+  // iterators do not have to load and sort all keys when they are created.
+  bool write_sorted_index = true;
+  TEST_SYNC_POINT_CALLBACK("CuckooTableBuilder::Finish:WriteSortedIndex",
+                           &write_sorted_index);
+  if (write_sorted_index) {
+    std::vector<uint32_t> sorted_bucket_ids;
+    sorted_bucket_ids.reserve(num_added);
+    for (uint32_t bucket_id = 0; bucket_id < buckets.size(); ++bucket_id) {
+      if (buckets[bucket_id].vector_idx != kMaxVectorIdx) {
+        sorted_bucket_ids.push_back(bucket_id);
+      }
+    }
+    std::sort(sorted_bucket_ids.begin(), sorted_bucket_ids.end(),
+              [this, &buckets](uint32_t first, uint32_t second) {
+                return ucomp_->Compare(
+                           GetUserKey(buckets[first].vector_idx),
+                           GetUserKey(buckets[second].vector_idx)) < 0;
+              });
+    std::string sorted_index;
+    sorted_index.reserve(sorted_bucket_ids.size() * sizeof(uint32_t));
+    for (uint32_t bucket_id : sorted_bucket_ids) {
+      PutFixed32(&sorted_index, bucket_id);
+    }
+    io_status_ = file_->Append(Slice(sorted_index));
+    if (!io_status_.ok()) {
+      status_ = io_status_;
+      return status_;
+    }
+    properties_.index_size = sorted_index.size();
+    std::string* sorted_index_offset =
+        &properties_.user_collected_properties
+             [CuckooTablePropertyNames::kSortedIndexOffset];
+    sorted_index_offset->clear();
+    PutFixed64(sorted_index_offset, offset);
+    TEST_SYNC_POINT_CALLBACK("CuckooTableBuilder::Finish:SortedIndexOffset",
+                             sorted_index_offset);
+    offset += sorted_index.size();
+  }
+
   unused_bucket.resize(static_cast<size_t>(properties_.fixed_key_len));
   properties_.user_collected_properties[CuckooTablePropertyNames::kEmptyKey] =
       unused_bucket;
@@ -428,9 +473,12 @@ uint64_t CuckooTableBuilder::FileSize() const {
     return 0;
   }
 
+  // The sorted index holds a fixed32 bucket id per entry
+  const uint64_t sorted_index_size = num_entries_ * sizeof(uint32_t);
   if (use_module_hash_) {
     return static_cast<uint64_t>((key_size_ + value_size_) * num_entries_ /
-                                 max_hash_table_ratio_);
+                                 max_hash_table_ratio_) +
+           sorted_index_size;
   } else {
     // Account for buckets being a power of two.
     // As elements are added, file size remains constant for a while and
@@ -441,7 +489,8 @@ uint64_t CuckooTableBuilder::FileSize() const {
     if (expected_hash_table_size < (num_entries_ + 1) / max_hash_table_ratio_) {
       expected_hash_table_size *= 2;
     }
-    return (key_size_ + value_size_) * expected_hash_table_size - 1;
+    return (key_size_ + value_size_) * expected_hash_table_size - 1 +
+           sorted_index_size;
   }
 }
 
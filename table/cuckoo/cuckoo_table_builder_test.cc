@@ -227,7 +227,10 @@ TEST_F(CuckooBuilderTest, WriteSuccessNoCollisionFullKey) {
       ASSERT_OK(builder.status());
     }
     size_t bucket_size = keys[0].size() + values[0].size();
-    ASSERT_EQ(expected_table_size * bucket_size - 1, builder.FileSize());
+    // Includes the sorted index, a fixed32 bucket id per entry
+    ASSERT_EQ(expected_table_size * bucket_size - 1 +
+                  user_keys.size() * sizeof(uint32_t),
+              builder.FileSize());
     ASSERT_OK(builder.Finish());
     ASSERT_OK(file_writer->Close());
     ASSERT_LE(expected_table_size * bucket_size, builder.FileSize());
@@ -275,7 +278,10 @@ TEST_F(CuckooBuilderTest, WriteSuccessWithCollisionFullKey) {
     ASSERT_OK(builder.status());
   }
   size_t bucket_size = keys[0].size() + values[0].size();
-  ASSERT_EQ(expected_table_size * bucket_size - 1, builder.FileSize());
+  // Includes the sorted index, a fixed32 bucket id per entry
+  ASSERT_EQ(expected_table_size * bucket_size - 1 +
+                user_keys.size() * sizeof(uint32_t),
+            builder.FileSize());
   ASSERT_OK(builder.Finish());
   ASSERT_OK(file_writer->Close());
   ASSERT_LE(expected_table_size * bucket_size, builder.FileSize());
@@ -323,7 +329,10 @@ TEST_F(CuckooBuilderTest, WriteSuccessWithCollisionAndCuckooBlock) {
     ASSERT_OK(builder.status());
   }
   size_t bucket_size = keys[0].size() + values[0].size();
-  ASSERT_EQ(expected_table_size * bucket_size - 1, builder.FileSize());
+  // Includes the sorted index, a fixed32 bucket id per entry
+  ASSERT_EQ(expected_table_size * bucket_size - 1 +
+                user_keys.size() * sizeof(uint32_t),
+            builder.FileSize());
   ASSERT_OK(builder.Finish());
   ASSERT_OK(file_writer->Close());
   ASSERT_LE(expected_table_size * bucket_size, builder.FileSize());
@@ -372,7 +381,10 @@ TEST_F(CuckooBuilderTest, WithCollisionPathFullKey) {
     ASSERT_OK(builder.status());
   }
   size_t bucket_size = keys[0].size() + values[0].size();
-  ASSERT_EQ(expected_table_size * bucket_size - 1, builder.FileSize());
+  // Includes the sorted index, a fixed32 bucket id per entry
+  ASSERT_EQ(expected_table_size * bucket_size - 1 +
+                user_keys.size() * sizeof(uint32_t),
+            builder.FileSize());
   ASSERT_OK(builder.Finish());
   ASSERT_OK(file_writer->Close());
   ASSERT_LE(expected_table_size * bucket_size, builder.FileSize());
@@ -418,7 +430,10 @@ TEST_F(CuckooBuilderTest, WithCollisionPathFullKeyAndCuckooBlock) {
     ASSERT_OK(builder.status());
   }
   size_t bucket_size = keys[0].size() + values[0].size();
-  ASSERT_EQ(expected_table_size * bucket_size - 1, builder.FileSize());
+  // Includes the sorted index, a fixed32 bucket id per entry
+  ASSERT_EQ(expected_table_size * bucket_size - 1 +
+                user_keys.size() * sizeof(uint32_t),
+            builder.FileSize());
   ASSERT_OK(builder.Finish());
   ASSERT_OK(file_writer->Close());
   ASSERT_LE(expected_table_size * bucket_size, builder.FileSize());
@@ -461,7 +476,10 @@ TEST_F(CuckooBuilderTest, WriteSuccessNoCollisionUserKey) {
     ASSERT_OK(builder.status());
   }
   size_t bucket_size = user_keys[0].size() + values[0].size();
-  ASSERT_EQ(expected_table_size * bucket_size - 1, builder.FileSize());
+  // Includes the sorted index, a fixed32 bucket id per entry
+  ASSERT_EQ(expected_table_size * bucket_size - 1 +
+                user_keys.size() * sizeof(uint32_t),
+            builder.FileSize());
   ASSERT_OK(builder.Finish());
   ASSERT_OK(file_writer->Close());
   ASSERT_LE(expected_table_size * bucket_size, builder.FileSize());
@@ -505,7 +523,10 @@ TEST_F(CuckooBuilderTest, WriteSuccessWithCollisionUserKey) {
     ASSERT_OK(builder.status());
   }
   size_t bucket_size = user_keys[0].size() + values[0].size();
-  ASSERT_EQ(expected_table_size * bucket_size - 1, builder.FileSize());
+  // Includes the sorted index, a fixed32 bucket id per entry
+  ASSERT_EQ(expected_table_size * bucket_size - 1 +
+                user_keys.size() * sizeof(uint32_t),
+            builder.FileSize());
   ASSERT_OK(builder.Finish());
   ASSERT_OK(file_writer->Close());
   ASSERT_LE(expected_table_size * bucket_size, builder.FileSize());
@@ -548,7 +569,10 @@ TEST_F(CuckooBuilderTest, WithCollisionPathUserKey) {
     ASSERT_OK(builder.status());
   }
   size_t bucket_size = user_keys[0].size() + values[0].size();
-  ASSERT_EQ(expected_table_size * bucket_size - 1, builder.FileSize());
+  // Includes the sorted index, a fixed32 bucket id per entry
+  ASSERT_EQ(expected_table_size * bucket_size - 1 +
+                user_keys.size() * sizeof(uint32_t),
+            builder.FileSize());
   ASSERT_OK(builder.Finish());
   ASSERT_OK(file_writer->Close());
   ASSERT_LE(expected_table_size * bucket_size, builder.FileSize());
@@ -164,6 +164,24 @@ CuckooTableReader::CuckooTableReader(
   // TODO: rate limit reads of whole cuckoo tables.
   status_ = file_->Read(IOOptions(), 0, static_cast<size_t>(file_size),
                         &file_data_, nullptr, nullptr);
+  if (!status_.ok()) {
+    return;
+  }
+  auto sorted_index_offset =
+      user_props.find(CuckooTablePropertyNames::kSortedIndexOffset);
+  if (sorted_index_offset != user_props.end()) {
+    if (sorted_index_offset->second.size() != sizeof(uint64_t)) {
+      status_ = Status::Corruption("Invalid sorted index offset");
+      return;
+    }
+    const uint64_t offset = DecodeFixed64(sorted_index_offset->second.data());
+    const uint64_t size = table_props_->num_entries * sizeof(uint32_t);
+    if (offset > file_data_.size() || size > file_data_.size() - offset) {
+      status_ = Status::Corruption("Sorted index out of file bounds");
+      return;
+    }
+    sorted_index_ = Slice(file_data_.data() + offset, size);
+  }
 }
 
 Status CuckooTableReader::Get(const ReadOptions& /*readOptions*/,
@@ -275,10 +293,20 @@ class CuckooTableIterator : public InternalIterator {
 
   const BucketComparator bucket_comparator_;
   void PrepareKVAtCurrIdx();
+  uint32_t GetBucketId(uint32_t key_idx) const {
+    return persisted_bucket_ids_ != nullptr
+               ? DecodeFixed32(persisted_bucket_ids_ +
+                               key_idx * sizeof(uint32_t))
+               : sorted_bucket_ids_[key_idx];
+  }
   CuckooTableReader* reader_;
   bool initialized_;
-  // Contains a map of keys to bucket_id sorted in key order.
+  // Points to the sorted index of the file, if it has one.
+  const char* persisted_bucket_ids_;
+  // Contains a map of keys to bucket_id sorted in key order. Only built for
+  // files without a sorted index.
   std::vector<uint32_t> sorted_bucket_ids_;
+  uint32_t num_keys_;
   // We assume that the number of items can be stored in uint32 (4 Billion).
   uint32_t curr_key_idx_;
   Slice curr_value_;
@@ -290,6 +318,8 @@ CuckooTableIterator::CuckooTableIterator(CuckooTableReader* reader)
                          reader->bucket_length_, reader->user_key_length_),
       reader_(reader),
       initialized_(false),
+      persisted_bucket_ids_(nullptr),
+      num_keys_(0),
       curr_key_idx_(kInvalidIndex) {
   sorted_bucket_ids_.clear();
   curr_value_.clear();
@@ -300,6 +330,14 @@ void CuckooTableIterator::InitIfNeeded() {
   if (initialized_) {
     return;
   }
+  if (!reader_->sorted_index_.empty()) {
+    persisted_bucket_ids_ = reader_->sorted_index_.data();
+    num_keys_ = static_cast<uint32_t>(reader_->sorted_index_.size() /
+                                      sizeof(uint32_t));
+    curr_key_idx_ = kInvalidIndex;
+    initialized_ = true;
+    return;
+  }
   sorted_bucket_ids_.reserve(
       static_cast<size_t>(reader_->GetTableProperties()->num_entries));
   uint64_t num_buckets = reader_->table_size_ + reader_->cuckoo_block_size_ - 1;
@@ -315,6 +353,7 @@ void CuckooTableIterator::InitIfNeeded() {
          reader_->GetTableProperties()->num_entries);
   std::sort(sorted_bucket_ids_.begin(), sorted_bucket_ids_.end(),
             bucket_comparator_);
+  num_keys_ = static_cast<uint32_t>(sorted_bucket_ids_.size());
   curr_key_idx_ = kInvalidIndex;
   initialized_ = true;
 }
@@ -327,7 +366,7 @@ void CuckooTableIterator::SeekToFirst() {
 
 void CuckooTableIterator::SeekToLast() {
   InitIfNeeded();
-  curr_key_idx_ = static_cast<uint32_t>(sorted_bucket_ids_.size()) - 1;
+  curr_key_idx_ = num_keys_ - 1;
   PrepareKVAtCurrIdx();
 }
 
@@ -336,11 +375,18 @@ void CuckooTableIterator::Seek(const Slice& target) {
   const BucketComparator seek_comparator(
       reader_->file_data_, reader_->ucomp_, reader_->bucket_length_,
       reader_->user_key_length_, ExtractUserKey(target));
-  auto seek_it =
-      std::lower_bound(sorted_bucket_ids_.begin(), sorted_bucket_ids_.end(),
-                       kInvalidIndex, seek_comparator);
-  curr_key_idx_ =
-      static_cast<uint32_t>(std::distance(sorted_bucket_ids_.begin(), seek_it));
+  // Find the first key that is not less than the target.
+  uint32_t left = 0;
+  uint32_t right = num_keys_;
+  while (left < right) {
+    uint32_t mid = left + (right - left) / 2;
+    if (seek_comparator(GetBucketId(mid), kInvalidIndex)) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  curr_key_idx_ = left;
   PrepareKVAtCurrIdx();
 }
 
@@ -349,9 +395,7 @@ void CuckooTableIterator::SeekForPrev(const Slice& /*target*/) {
   assert(false);
 }
 
-bool CuckooTableIterator::Valid() const {
-  return curr_key_idx_ < sorted_bucket_ids_.size();
-}
+bool CuckooTableIterator::Valid() const { return curr_key_idx_ < num_keys_; }
 
 void CuckooTableIterator::PrepareKVAtCurrIdx() {
   if (!Valid()) {
@@ -359,7 +403,7 @@ void CuckooTableIterator::PrepareKVAtCurrIdx() {
     curr_key_.Clear();
     return;
   }
-  uint32_t id = sorted_bucket_ids_[curr_key_idx_];
+  uint32_t id = GetBucketId(curr_key_idx_);
   const char* offset =
       reader_->file_data_.data() + id * reader_->bucket_length_;
   if (reader_->is_last_level_) {
@@ -384,7 +428,7 @@ void CuckooTableIterator::Next() {
 
 void CuckooTableIterator::Prev() {
   if (curr_key_idx_ == 0) {
-    curr_key_idx_ = static_cast<uint32_t>(sorted_bucket_ids_.size());
+    curr_key_idx_ = num_keys_;
   }
   if (!Valid()) {
     curr_value_.clear();
@@ -78,6 +78,9 @@ class CuckooTableReader : public TableReader {
   void LoadAllKeys(std::vector<std::pair<Slice, uint32_t>>* key_to_bucket_id);
   std::unique_ptr<RandomAccessFileReader> file_;
   Slice file_data_;
+  // Bucket ids in user key order, as persisted by the builder. Empty for
+  // files written before the sorted index was introduced.
+  Slice sorted_index_;
   bool is_last_level_;
   bool identity_as_first_hash_;
   bool use_module_hash_;
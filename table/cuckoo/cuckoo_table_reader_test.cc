@@ -13,6 +13,7 @@ int main() {
 #else
 
 #include <cinttypes>
+#include <limits>
 #include <map>
 #include <string>
 #include <vector>
@@ -24,8 +25,10 @@ int main() {
 #include "table/cuckoo/cuckoo_table_reader.h"
 #include "table/get_context.h"
 #include "table/meta_blocks.h"
+#include "test_util/sync_point.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
+#include "util/coding.h"
 #include "util/gflags_compat.h"
 #include "util/random.h"
 #include "util/string_util.h"
@@ -135,7 +138,8 @@ class CuckooReaderTest : public testing::Test {
     }
   }
 
-  void CheckIterator(const Comparator* ucomp = BytewiseComparator()) {
+  void CheckIterator(const Comparator* ucomp = BytewiseComparator(),
+                     bool has_sorted_index = true) {
     std::unique_ptr<RandomAccessFileReader> file_reader;
     ASSERT_OK(RandomAccessFileReader::Create(
         env->GetFileSystem(), fname, file_options, &file_reader, nullptr));
@@ -143,6 +147,14 @@ class CuckooReaderTest : public testing::Test {
     CuckooTableReader reader(ioptions, std::move(file_reader), file_size, ucomp,
                              GetSliceHash);
     ASSERT_OK(reader.status());
+    // The iterator walks the sorted index persisted by the builder, or sorts
+    // the keys itself for files without it.
+    ASSERT_EQ(
+        has_sorted_index ? 1U : 0U,
+        reader.GetTableProperties()->user_collected_properties.count(
+            CuckooTablePropertyNames::kSortedIndexOffset));
+    ASSERT_EQ(has_sorted_index ? num_items * sizeof(uint32_t) : 0,
+              reader.GetTableProperties()->index_size);
     InternalIterator* it = reader.NewIterator(
         ReadOptions(), /*prefix_extractor=*/nullptr, /*arena=*/nullptr,
         /*skip_filters=*/false, TableReaderCaller::kUncategorized);
@@ -291,6 +303,86 @@ TEST_F(CuckooReaderTest, CheckIterator) {
   CheckIterator();
 }
 
+TEST_F(CuckooReaderTest, CheckIteratorWithoutSortedIndex) {
+  // Like the files written by older versions
+  SyncPoint::GetInstance()->SetCallBack(
+      "CuckooTableBuilder::Finish:WriteSortedIndex",
+      [](void* arg) { *static_cast<bool*>(arg) = false; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  SetUp(2 * kNumHashFunc);
+  fname = test::PerThreadDBPath("CuckooReader_CheckIteratorWithoutSortedIndex");
+  for (uint64_t i = 0; i < num_items; i++) {
+    user_keys[i] = "key" + NumToStr(i);
+    ParsedInternalKey ikey(user_keys[i], 1000, kTypeValue);
+    AppendInternalKey(&keys[i], ikey);
+    values[i] = "value" + NumToStr(i);
+    // Give disjoint hash values, in reverse order.
+    AddHashLookups(user_keys[i], num_items - i - 1, kNumHashFunc);
+  }
+  CreateCuckooFileAndCheckReader();
+  CheckIterator(BytewiseComparator(), false /* has_sorted_index */);
+  // Last level file.
+  UpdateKeys(true);
+  CreateCuckooFileAndCheckReader();
+  CheckIterator(BytewiseComparator(), false /* has_sorted_index */);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(CuckooReaderTest, InvalidSortedIndexOffset) {
+  SetUp(kNumHashFunc);
+  fname = test::PerThreadDBPath("CuckooReader_InvalidSortedIndexOffset");
+  for (uint64_t i = 0; i < num_items; i++) {
+    user_keys[i] = "key" + NumToStr(i);
+    ParsedInternalKey ikey(user_keys[i], 1000, kTypeValue);
+    AppendInternalKey(&keys[i], ikey);
+    values[i] = "value" + NumToStr(i);
+    AddHashLookups(user_keys[i], i, kNumHashFunc);
+  }
+
+  for (bool truncated : {true, false}) {
+    SyncPoint::GetInstance()->SetCallBack(
+        "CuckooTableBuilder::Finish:SortedIndexOffset", [&](void* arg) {
+          std::string* offset = static_cast<std::string*>(arg);
+          if (truncated) {
+            offset->resize(sizeof(uint32_t));
+          } else {
+            // Past the end of the file
+            offset->clear();
+            PutFixed64(offset, std::numeric_limits<uint64_t>::max() - 1);
+          }
+        });
+    SyncPoint::GetInstance()->EnableProcessing();
+
+    std::unique_ptr<WritableFileWriter> file_writer;
+    ASSERT_OK(WritableFileWriter::Create(env->GetFileSystem(), fname,
+                                         file_options, &file_writer, nullptr));
+    CuckooTableBuilder builder(
+        file_writer.get(), 0.9, kNumHashFunc, 100, BytewiseComparator(), 2,
+        false, false, GetSliceHash, 0 /* column_family_id */,
+        kDefaultColumnFamilyName);
+    for (uint32_t key_idx = 0; key_idx < num_items; ++key_idx) {
+      builder.Add(Slice(keys[key_idx]), Slice(values[key_idx]));
+    }
+    ASSERT_OK(builder.Finish());
+    file_size = builder.FileSize();
+    ASSERT_OK(file_writer->Close());
+
+    SyncPoint::GetInstance()->DisableProcessing();
+    SyncPoint::GetInstance()->ClearAllCallBacks();
+
+    std::unique_ptr<RandomAccessFileReader> file_reader;
+    ASSERT_OK(RandomAccessFileReader::Create(
+        env->GetFileSystem(), fname, file_options, &file_reader, nullptr));
+    const ImmutableOptions ioptions(options);
+    CuckooTableReader reader(ioptions, std::move(file_reader), file_size,
+                             BytewiseComparator(), GetSliceHash);
+    ASSERT_TRUE(reader.status().IsCorruption());
+  }
+}
+
 TEST_F(CuckooReaderTest, CheckIteratorUint64) {
   SetUp(2 * kNumHashFunc);
   fname = test::PerThreadDBPath("CuckooReader_CheckIterator");
@@ -220,6 +220,16 @@ static int RegisterBuiltinMemTableRepFactory(ObjectLibrary& library,
         }
         return guard->get();
       });
+  ObjectLibrary::PatternEntry bplus_tree_pattern("BPlusTreeRepFactory");
+  bplus_tree_pattern.AnotherName("bplus_tree");
+  library.AddFactory<MemTableRepFactory>(
+      bplus_tree_pattern,
+      [](const std::string& /*uri*/,
+         std::unique_ptr<MemTableRepFactory>* guard,
+         std::string* /*errmsg*/) {
+        guard->reset(NewBPlusTreeRepFactory());
+        return guard->get();
+      });
   library.AddFactory<MemTableRepFactory>(
       AsPattern("HashSkipListRepFactory", "prefix_hash"),
       [](const std::string& uri, std::unique_ptr<MemTableRepFactory>* guard,
@@ -84,6 +84,10 @@ class PlainTableIndex {
   IndexSearchResult GetOffset(uint32_t prefix_hash,
                               uint32_t* bucket_value) const;
 
+  // Prefetch the hash bucket that `prefix_hash` maps to, so that a following
+  // GetOffset() with the same hash is less likely to miss the CPU cache.
+  void Prefetch(uint32_t prefix_hash) const;
+
   // Initialize data from `index_data`, which points to raw data for
   // index stored in the SST file.
   Status InitFromRawData(Slice index_data);
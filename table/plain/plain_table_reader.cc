@@ -25,6 +25,7 @@
 
 #include "table/plain/plain_table_reader.h"
 
+#include <array>
 #include <string>
 #include <vector>
 
@@ -598,6 +599,55 @@ Status PlainTableReader::Get(const ReadOptions& /*ro*/, const Slice& target,
       return Status::OK();
     }
   }
+  return GetFromIndex(target, prefix_slice, prefix_hash, get_context);
+}
+
+void PlainTableReader::MultiGet(const ReadOptions& readOptions,
+                                const MultiGetContext::Range* mget_range,
+                                const SliceTransform* prefix_extractor,
+                                bool skip_filters) {
+  if (IsTotalOrderMode() && full_scan_mode_) {
+    TableReader::MultiGet(readOptions, mget_range, prefix_extractor,
+                          skip_filters);
+    return;
+  }
+
+  std::array<uint32_t, MultiGetContext::MAX_BATCH_SIZE> bloom_hashes;
+  std::array<Slice, MultiGetContext::MAX_BATCH_SIZE> prefixes;
+  // First pass: hash every key and prefetch what the second pass will probe.
+  for (auto iter = mget_range->begin(); iter != mget_range->end(); ++iter) {
+    const size_t idx = iter.index();
+    if (IsTotalOrderMode()) {
+      // Match whole user key for bloom filter check; in total order mode there
+      // is only one bucket 0, and we always use empty prefix.
+      prefixes[idx] = Slice();
+      bloom_hashes[idx] = GetSliceHash(ExtractUserKey(iter->ikey));
+    } else {
+      prefixes[idx] = GetPrefix(iter->ikey);
+      bloom_hashes[idx] = GetSliceHash(prefixes[idx]);
+      index_.Prefetch(bloom_hashes[idx]);
+    }
+    if (enable_bloom_) {
+      bloom_.Prefetch(bloom_hashes[idx]);
+    }
+  }
+
+  for (auto iter = mget_range->begin(); iter != mget_range->end(); ++iter) {
+    const size_t idx = iter.index();
+    if (!MatchBloom(bloom_hashes[idx])) {
+      *iter->s = Status::OK();
+      continue;
+    }
+    *iter->s = GetFromIndex(iter->ikey, prefixes[idx],
+                            IsTotalOrderMode() ? 0 : bloom_hashes[idx],
+                            iter->get_context);
+  }
+}
+
+Status PlainTableReader::GetFromIndex(const Slice& target,
+                                      const Slice& prefix_slice,
+                                      uint32_t prefix_hash,
+                                      GetContext* get_context) {
   uint32_t offset;
   bool prefix_match;
   PlainTableKeyDecoder decoder(&file_info_, encoding_type_, user_key_len_,
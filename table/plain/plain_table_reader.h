@@ -92,6 +92,14 @@ class PlainTableReader : public TableReader {
              GetContext* get_context, const SliceTransform* prefix_extractor,
              bool skip_filters = false) override;
 
+  // Looks up a batch of keys. The bloom filter probes and index buckets of
+  // all keys are prefetched before any of them is resolved, so the cache
+  // misses of the batch overlap instead of being paid one key at a time.
+  void MultiGet(const ReadOptions& readOptions,
+                const MultiGetContext::Range* mget_range,
+                const SliceTransform* prefix_extractor,
+                bool skip_filters = false) override;
+
   uint64_t ApproximateOffsetOf(const ReadOptions& read_options,
                                const Slice& key,
                                TableReaderCaller caller) override;
@@ -234,6 +242,12 @@ class PlainTableReader : public TableReader {
                    const Slice& prefix, uint32_t prefix_hash,
                    bool& prefix_matched, uint32_t* offset) const;
 
+  // Look up `target` in the data once the bloom filter (if any) has passed.
+  // `prefix` and `prefix_hash` are as returned for the key by
+  // GetPrefix()/GetSliceHash(), or empty and 0 in total order mode.
+  Status GetFromIndex(const Slice& target, const Slice& prefix,
+                      uint32_t prefix_hash, GetContext* get_context);
+
   bool IsTotalOrderMode() const { return (prefix_extractor_ == nullptr); }
 
   // No copying allowed
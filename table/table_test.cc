@@ -5849,6 +5849,83 @@ TEST_F(ChargeCompressionDictionaryBuildingBufferTest, BasicWithCacheFull) {
   EXPECT_EQ(cache->GetPinnedUsage(), 0 * kSizeDummyEntry);
 }
 
+TEST_F(ChargeCompressionDictionaryBuildingBufferTest,
+       ReleasedWhileEnteringUnbuffered) {
+  constexpr std::size_t kSizeDummyEntry = 256 * 1024;
+  constexpr std::size_t kCacheCapacity = 64 * 1024 * 1024;
+  constexpr std::size_t kMaxDictBytes = 1024;
+  constexpr std::size_t kMaxDictBufferBytes = 8 * kSizeDummyEntry;
+  constexpr int kNumKeys = 17;
+
+  // `CacheEntryRoleOptions::charged` is enabled by default for
+  // CacheEntryRole::kCompressionDictionaryBuildingBuffer
+  BlockBasedTableOptions table_options;
+  LRUCacheOptions lo;
+  lo.capacity = kCacheCapacity;
+  lo.num_shard_bits = 0;  // 2^0 shard
+  lo.strict_capacity_limit = true;
+  std::shared_ptr<Cache> cache(NewLRUCache(lo));
+  table_options.block_cache = cache;
+  table_options.flush_block_policy_factory =
+      std::make_shared<FlushBlockEveryKeyPolicyFactory>();
+
+  Options options;
+  options.compression = kSnappyCompression;
+  options.compression_opts.max_dict_bytes = kMaxDictBytes;
+  options.compression_opts.max_dict_buffer_bytes = kMaxDictBufferBytes;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  test::StringSink* sink = new test::StringSink();
+  std::unique_ptr<FSWritableFile> holder(sink);
+  std::unique_ptr<WritableFileWriter> file_writer(new WritableFileWriter(
+      std::move(holder), "test_file_name", FileOptions()));
+
+  ImmutableOptions ioptions(options);
+  MutableCFOptions moptions(options);
+  InternalKeyComparator ikc(options.comparator);
+  IntTblPropCollectorFactories int_tbl_prop_collector_factories;
+
+  std::unique_ptr<TableBuilder> builder(options.table_factory->NewTableBuilder(
+      TableBuilderOptions(ioptions, moptions, ikc,
+                          &int_tbl_prop_collector_factories, kSnappyCompression,
+                          options.compression_opts, kUnknownColumnFamily,
+                          "test_cf", -1 /* level */),
+      file_writer.get()));
+
+  // The cache charge seen after each buffered block is written
+  std::vector<std::size_t> pinned_usages;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTableBuilder::EnterUnbuffered:BlockReleased",
+      [&](void* /* arg */) { pinned_usages.push_back(cache->GetPinnedUsage()); });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Every key is flushed in a block of its own, and the block of the last key
+  // exceeds the buffer limit and triggers EnterUnbuffered()
+  std::size_t max_pinned_usage = 0;
+  for (int i = 0; i < kNumKeys; ++i) {
+    InternalKey ik("key" + std::to_string(100 + i), i /* sequence number */,
+                   kTypeValue);
+    builder->Add(ik.Encode(), std::string(kSizeDummyEntry / 2, 'a' + i));
+    max_pinned_usage = std::max(max_pinned_usage, cache->GetPinnedUsage());
+  }
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  EXPECT_GE(max_pinned_usage, kMaxDictBufferBytes - kSizeDummyEntry);
+
+  // The charge shrinks block by block instead of being dropped at the end
+  ASSERT_GT(pinned_usages.size(), 2U);
+  for (std::size_t i = 1; i < pinned_usages.size(); ++i) {
+    EXPECT_LE(pinned_usages[i], pinned_usages[i - 1]);
+  }
+  EXPECT_LT(pinned_usages.front(), max_pinned_usage);
+  EXPECT_GT(pinned_usages[pinned_usages.size() / 2], 0U);
+  EXPECT_LT(pinned_usages[pinned_usages.size() / 2], pinned_usages.front());
+  EXPECT_EQ(pinned_usages.back(), 0U);
+
+  ASSERT_OK(builder->Finish());
+  EXPECT_EQ(cache->GetPinnedUsage(), 0 * kSizeDummyEntry);
+}
+
 class CacheUsageOptionsOverridesTest : public DBTestBase {
  public:
   CacheUsageOptionsOverridesTest()
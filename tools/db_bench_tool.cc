@@ -587,6 +587,14 @@ DEFINE_uint32(
     "The percent threshold of the buffer size after which WBM will "
     "initiate delays.");
 
+DEFINE_uint64(wbm_arena_block_pool_capacity, 0,
+              "The max bytes of memtable arena blocks that the WBM keeps for "
+              "reuse by new memtables. 0 disables the pool.");
+
+DEFINE_bool(wbm_arena_block_pool_prefault, false,
+            "Touch every page of a newly allocated memtable arena block "
+            "(requires --wbm_arena_block_pool_capacity > 0)");
+
 DEFINE_int64(arena_block_size, ROCKSDB_NAMESPACE::Options().arena_block_size,
              "The size, in bytes, of one block in arena memory allocation.");
 
@@ -953,6 +961,10 @@ DEFINE_bool(memtable_whole_key_filtering,
             "Try to use whole key bloom filter in memtables.");
 DEFINE_bool(memtable_use_huge_page, false,
             "Try to use huge page in memtables.");
+DEFINE_bool(memtable_numa_local_allocation,
+            ROCKSDB_NAMESPACE::Options().memtable_numa_local_allocation,
+            "Serve the memtable allocations of concurrent writers from an "
+            "arena per NUMA node.");
 
 DEFINE_bool(whole_key_filtering,
             ROCKSDB_NAMESPACE::BlockBasedTableOptions().whole_key_filtering,
@@ -1040,6 +1052,16 @@ DEFINE_string(wal_compression, "none",
 static enum ROCKSDB_NAMESPACE::CompressionType FLAGS_wal_compression_e =
     ROCKSDB_NAMESPACE::kNoCompression;
 
+DEFINE_uint64(wal_compression_dict_bytes,
+              ROCKSDB_NAMESPACE::Options().wal_compression_dict_bytes,
+              "Size of the WAL compression dictionary sampled from the "
+              "previous WAL, 0 to disable.");
+
+DEFINE_uint64(memtable_wal_value_threshold,
+              ROCKSDB_NAMESPACE::Options().memtable_wal_value_threshold,
+              "Minimum size of the values that the memtable references in "
+              "the WAL instead of copying them, 0 to disable.");
+
 DEFINE_string(wal_dir, "", "If not empty, use the given dir for WAL");
 
 DEFINE_string(truth_db, "/dev/shm/truth_db/dbbench",
@@ -1080,6 +1102,11 @@ DEFINE_int32(level0_slowdown_writes_trigger,
              ROCKSDB_NAMESPACE::Options().level0_slowdown_writes_trigger,
              "Number of files in level-0 that will slow down writes.");
 
+DEFINE_bool(flush_to_non_overlapping_level,
+            ROCKSDB_NAMESPACE::Options().flush_to_non_overlapping_level,
+            "Add flushed files that overlap no L0 file to the deepest "
+            "non-overlapping level instead of L0.");
+
 DEFINE_int32(level0_file_num_compaction_trigger,
              ROCKSDB_NAMESPACE::Options().level0_file_num_compaction_trigger,
              "Number of files in level-0 when compactions start.");
@@ -1678,6 +1705,23 @@ DEFINE_bool(rate_limiter_auto_tuned, false,
             "Enable dynamic adjustment of rate limit according to demand for "
             "background I/O");
 
+DEFINE_double(rate_limiter_tenant_share, 0,
+              "If > 0 (and up to 1), every db (see --num_multi_db) gets a "
+              "tenant rate limiter reserving this share of the rate limiter "
+              "set by --rate_limiter_bytes_per_sec, which is shared by the "
+              "db-s. 0 means the db-s use the shared rate limiter directly.");
+
+DEFINE_string(rate_limiter_tenant_priority_weights, "1:1:1:1",
+              "Weights splitting the reserved rate of a tenant (see "
+              "--rate_limiter_tenant_share) between the I/O priorities, as "
+              "low:mid:high:user (compaction:-:flush:user I/O). 0 means no "
+              "reserved rate.");
+
+DEFINE_bool(rate_limiter_tenant_borrow, true,
+            "Allow tenant rate limiters (see --rate_limiter_tenant_share) to "
+            "exceed their reserved rate while the shared rate limiter is "
+            "idle.");
+
 DEFINE_bool(sine_write_rate, false, "Use a sine wave write_rate_limit");
 
 DEFINE_uint64(
@@ -1796,6 +1840,19 @@ DEFINE_bool(use_direct_io_for_flush_and_compaction,
             ROCKSDB_NAMESPACE::Options().use_direct_io_for_flush_and_compaction,
             "Use O_DIRECT for background flush and compaction writes");
 
+DEFINE_uint64(recycle_log_file_num,
+              ROCKSDB_NAMESPACE::Options().recycle_log_file_num,
+              "Number of WAL files to keep around for reuse");
+
+DEFINE_bool(preallocated_wal_ring,
+            ROCKSDB_NAMESPACE::Options().preallocated_wal_ring,
+            "Reuse a ring of --recycle_log_file_num preallocated WAL files "
+            "that are never truncated");
+
+DEFINE_bool(use_direct_io_for_wal,
+            ROCKSDB_NAMESPACE::Options().use_direct_io_for_wal,
+            "Use O_DIRECT for the writes to the preallocated WAL ring");
+
 DEFINE_bool(advise_random_on_open,
             ROCKSDB_NAMESPACE::Options().advise_random_on_open,
             "Advise random access on table file open");
@@ -1905,6 +1962,10 @@ DEFINE_bool(avoid_unnecessary_blocking_io,
 DEFINE_bool(avoid_flush_during_recovery,
             ROCKSDB_NAMESPACE::Options().avoid_flush_during_recovery,
             "If true, avoids flushing the recovered WAL data where possible.");
+DEFINE_bool(pipelined_wal_recovery,
+            ROCKSDB_NAMESPACE::Options().pipelined_wal_recovery,
+            "If true, the WAL records are read ahead of their insertion into "
+            "the memtables during recovery.");
 DEFINE_int64(multiread_stride, 0,
              "Stride length for the keys in a MultiGet batch");
 DEFINE_bool(multiread_batched, false, "Use the new MultiGet API");
@@ -1926,6 +1987,9 @@ DEFINE_string(merge_operator, "",
 DEFINE_int32(skip_list_lookahead, 0,
              "Used with skip_list memtablerep; try linear search first for "
              "this many steps from the previous position");
+DEFINE_bool(skip_list_thread_local_insert_hints, false,
+            "Used with skip_list memtablerep; start every concurrent insert "
+            "from the position of the previous insert of the same thread");
 DEFINE_bool(report_file_operations, false,
             "if report number of file operations");
 DEFINE_bool(report_open_timing, false, "if report open timing");
@@ -2016,13 +2080,16 @@ static Status CreateMemTableRepFactory(
     std::shared_ptr<MemTableRepFactory>* factory) {
   Status s;
   if (!strcasecmp(FLAGS_memtablerep.c_str(), SkipListFactory::kNickName())) {
-    factory->reset(new SkipListFactory(FLAGS_skip_list_lookahead));
+    factory->reset(new SkipListFactory(
+        FLAGS_skip_list_lookahead, FLAGS_skip_list_thread_local_insert_hints));
   } else if (!strcasecmp(FLAGS_memtablerep.c_str(), "prefix_hash")) {
     factory->reset(NewHashSkipListRepFactory(FLAGS_hash_bucket_count));
   } else if (!strcasecmp(FLAGS_memtablerep.c_str(), "hash_linkedlist")) {
     factory->reset(NewHashLinkListRepFactory(FLAGS_hash_bucket_count));
   } else if (!strcasecmp(FLAGS_memtablerep.c_str(), "hash_spdb")) {
     factory->reset(NewHashSpdbRepFactory(FLAGS_hash_bucket_count, false));
+  } else if (!strcasecmp(FLAGS_memtablerep.c_str(), "bplus_tree")) {
+    factory->reset(NewBPlusTreeRepFactory());
   }
   return s;
 }
@@ -4556,6 +4623,7 @@ class Benchmark {
     options.stats_history_buffer_size =
         static_cast<size_t>(FLAGS_stats_history_buffer_size);
     options.avoid_flush_during_recovery = FLAGS_avoid_flush_during_recovery;
+    options.pipelined_wal_recovery = FLAGS_pipelined_wal_recovery;
     options.avoid_unnecessary_blocking_io = FLAGS_avoid_unnecessary_blocking_io;
 
     options.compression_opts.level = FLAGS_compression_level;
@@ -4590,8 +4658,16 @@ class Benchmark {
     options.use_direct_reads = FLAGS_use_direct_reads;
     options.use_direct_io_for_flush_and_compaction =
         FLAGS_use_direct_io_for_flush_and_compaction;
+    options.recycle_log_file_num =
+        static_cast<size_t>(FLAGS_recycle_log_file_num);
+    options.preallocated_wal_ring = FLAGS_preallocated_wal_ring;
+    options.use_direct_io_for_wal = FLAGS_use_direct_io_for_wal;
     options.manual_wal_flush = FLAGS_manual_wal_flush;
     options.wal_compression = FLAGS_wal_compression_e;
+    options.wal_compression_dict_bytes =
+        static_cast<size_t>(FLAGS_wal_compression_dict_bytes);
+    options.memtable_wal_value_threshold =
+        static_cast<size_t>(FLAGS_memtable_wal_value_threshold);
     options.refresh_options_sec = FLAGS_refresh_options_sec;
     options.refresh_options_file = FLAGS_refresh_options_file;
     options.ttl = FLAGS_fifo_compaction_ttl;
@@ -4610,6 +4686,8 @@ class Benchmark {
       options.info_log.reset(new StderrLogger());
     }
     options.memtable_huge_page_size = FLAGS_memtable_use_huge_page ? 2048 : 0;
+    options.memtable_numa_local_allocation =
+        FLAGS_memtable_numa_local_allocation;
     options.memtable_prefix_bloom_size_ratio = FLAGS_memtable_bloom_size_ratio;
     options.memtable_whole_key_filtering = FLAGS_memtable_whole_key_filtering;
     if (FLAGS_memtable_insert_with_hint_prefix_size > 0) {
@@ -4945,6 +5023,8 @@ class Benchmark {
         FLAGS_level0_file_num_compaction_trigger;
     options.level0_slowdown_writes_trigger =
         FLAGS_level0_slowdown_writes_trigger;
+    options.flush_to_non_overlapping_level =
+        FLAGS_flush_to_non_overlapping_level;
     options.compression = FLAGS_compression_type_e;
     if (FLAGS_simulate_hybrid_fs_file != "") {
       options.bottommost_temperature = Temperature::kWarm;
@@ -5062,17 +5142,22 @@ class Benchmark {
       flush_initiation_options.max_num_parallel_flushes =
           FLAGS_max_num_parallel_flushes;
     }
+    WriteBufferManager::ArenaBlockPoolOptions arena_block_pool_options(
+        static_cast<size_t>(FLAGS_wbm_arena_block_pool_capacity),
+        FLAGS_wbm_arena_block_pool_prefault);
     if (options.write_buffer_manager == nullptr) {
       if (FLAGS_cost_write_buffer_to_cache) {
         options.write_buffer_manager.reset(new WriteBufferManager(
             FLAGS_db_write_buffer_size, cache_, FLAGS_allow_wbm_stalls,
             FLAGS_initiate_wbm_flushes, flush_initiation_options,
-            static_cast<uint16_t>(FLAGS_start_delay_percent)));
+            static_cast<uint16_t>(FLAGS_start_delay_percent),
+            arena_block_pool_options));
       } else {
         options.write_buffer_manager.reset(new WriteBufferManager(
             FLAGS_db_write_buffer_size, {} /* cache */, FLAGS_allow_wbm_stalls,
             FLAGS_initiate_wbm_flushes, flush_initiation_options,
-            static_cast<uint16_t>(FLAGS_start_delay_percent)));
+            static_cast<uint16_t>(FLAGS_start_delay_percent),
+            arena_block_pool_options));
       }
     }
 
@@ -5275,6 +5360,21 @@ class Benchmark {
     if (FLAGS_enable_speedb_features) {
       options.EnableSpeedbFeatures(so);
     }
+    if (FLAGS_rate_limiter_tenant_share > 0 && options.rate_limiter) {
+      // Every db is a tenant of the shared rate limiter
+      TenantRateLimiterOptions tenant_options;
+      tenant_options.share = FLAGS_rate_limiter_tenant_share;
+      tenant_options.borrow_unused = FLAGS_rate_limiter_tenant_borrow;
+      std::vector<std::string> weights =
+          StringSplit(FLAGS_rate_limiter_tenant_priority_weights, ':');
+      for (size_t i = 0;
+           i < weights.size() && i < tenant_options.priority_weights.size();
+           ++i) {
+        tenant_options.priority_weights[i] = std::stoi(weights[i]);
+      }
+      options.rate_limiter.reset(
+          NewTenantRateLimiter(options.rate_limiter, tenant_options));
+    }
     uint64_t open_start = FLAGS_report_open_timing ? FLAGS_env->NowNanos() : 0;
     Status s;
     // Open with column families if necessary.
@@ -9553,6 +9653,11 @@ void ValidateAndProcessEnvFlags(bool first_group,
 }
 
 void ParseSanitizeAndValidateMultipleDBsFlags(bool first_group) {
+  if (FLAGS_rate_limiter_tenant_share < 0 ||
+      FLAGS_rate_limiter_tenant_share > 1) {
+    ErrorExit("`-rate_limiter_tenant_share` must be in [0, 1]");
+  }
+
   if (FLAGS_num_multi_db < 0) {
     ErrorExit("'-num_multi_db` must be >= 0");
   }
@@ -188,6 +188,33 @@ TEST(Coding, Varint64Truncation) {
   ASSERT_EQ(large_value, result);
 }
 
+TEST(Coding, VarintWithTrailingBytes) {
+  // Decoding takes a word-at-a-time path when at least 8 bytes are available.
+  // Check that it agrees with the byte-by-byte path for every encoded length,
+  // regardless of what follows the encoding.
+  for (uint32_t bits = 0; bits <= 64; bits++) {
+    const uint64_t v = bits == 0 ? 0 : (~uint64_t{0} >> (64 - bits));
+    std::string encoded;
+    PutVarint64(&encoded, v);
+    for (char trailing : {'\x00', '\x7f', '\x80', '\xff'}) {
+      std::string s = encoded + std::string(kMaxVarint64Length, trailing);
+      uint64_t actual64 = 0;
+      const char* p = GetVarint64Ptr(s.data(), s.data() + s.size(), &actual64);
+      ASSERT_EQ(s.data() + encoded.size(), p);
+      ASSERT_EQ(v, actual64);
+
+      uint32_t actual32 = 0;
+      p = GetVarint32Ptr(s.data(), s.data() + s.size(), &actual32);
+      if (encoded.size() <= 5) {
+        ASSERT_EQ(s.data() + encoded.size(), p);
+        ASSERT_EQ(static_cast<uint32_t>(v), actual32);
+      } else {
+        ASSERT_EQ(nullptr, p);
+      }
+    }
+  }
+}
+
 TEST(Coding, Strings) {
   std::string s;
   PutLengthPrefixedSlice(&s, Slice(""));
@@ -5,19 +5,34 @@
 
 #include "util/compression.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace ROCKSDB_NAMESPACE {
 
+namespace {
+constexpr size_t kMaxVarint32Length = 5;
+}  // anonymous namespace
+
 StreamingCompress* StreamingCompress::Create(CompressionType compression_type,
                                              const CompressionOptions& opts,
                                              uint32_t compress_format_version,
-                                             size_t max_output_len) {
+                                             size_t max_output_len,
+                                             const Slice& compression_dict) {
   switch (compression_type) {
     case kZSTD: {
       if (!ZSTD_Streaming_Supported()) {
         return nullptr;
       }
       return new ZSTDStreamingCompress(opts, compress_format_version,
-                                       max_output_len);
+                                       max_output_len, compression_dict);
+    }
+    case kLZ4Compression: {
+      if (!LZ4_Streaming_Supported()) {
+        return nullptr;
+      }
+      return new LZ4StreamingCompress(opts, compress_format_version,
+                                      max_output_len, compression_dict);
     }
     default:
       return nullptr;
@@ -26,14 +41,21 @@ StreamingCompress* StreamingCompress::Create(CompressionType compression_type,
 
 StreamingUncompress* StreamingUncompress::Create(
     CompressionType compression_type, uint32_t compress_format_version,
-    size_t max_output_len) {
+    size_t max_output_len, const Slice& compression_dict) {
   switch (compression_type) {
     case kZSTD: {
       if (!ZSTD_Streaming_Supported()) {
         return nullptr;
       }
       return new ZSTDStreamingUncompress(compress_format_version,
-                                         max_output_len);
+                                         max_output_len, compression_dict);
+    }
+    case kLZ4Compression: {
+      if (!LZ4_Streaming_Supported()) {
+        return nullptr;
+      }
+      return new LZ4StreamingUncompress(compress_format_version,
+                                        max_output_len, compression_dict);
     }
     default:
       return nullptr;
@@ -119,4 +141,179 @@ void ZSTDStreamingUncompress::Reset() {
 #endif
 }
 
+LZ4StreamingCompress::LZ4StreamingCompress(const CompressionOptions& opts,
+                                           uint32_t compress_format_version,
+                                           size_t max_output_len,
+                                           const Slice& compression_dict)
+    : StreamingCompress(kLZ4Compression, opts, compress_format_version,
+                        max_output_len),
+      dict_(compression_dict.ToString()) {
+  assert(max_output_len > kMaxVarint32Length);
+  max_chunk_len_ = max_output_len - kMaxVarint32Length;
+#ifdef LZ4_STREAMING
+  stream_ = LZ4_createStream();
+  if (!dict_.empty()) {
+    dict_stream_ = LZ4_createStream();
+    LZ4_loadDict(dict_stream_, dict_.data(), static_cast<int>(dict_.size()));
+  }
+#endif
+}
+
+LZ4StreamingCompress::~LZ4StreamingCompress() {
+#ifdef LZ4_STREAMING
+  LZ4_freeStream(stream_);
+  if (dict_stream_ != nullptr) {
+    LZ4_freeStream(dict_stream_);
+  }
+#endif
+}
+
+int LZ4StreamingCompress::Compress(const char* input, size_t input_size,
+                                   char* output, size_t* output_pos) {
+  assert(input != nullptr && output != nullptr && output_pos != nullptr);
+  *output_pos = 0;
+  // Don't need to compress an empty input
+  if (input_size == 0) {
+    return 0;
+  }
+#ifndef LZ4_STREAMING
+  (void)input;
+  (void)input_size;
+  (void)output;
+  return -1;
+#else
+  if (input_ != input) {
+    // New input
+    // Catch errors where the previous input was not fully compressed.
+    assert(input_ == nullptr);
+    input_ = input;
+    input_pos_ = 0;
+  }
+  assert(input_pos_ < input_size);
+  const char* chunk = input + input_pos_;
+  const size_t chunk_len = std::min(input_size - input_pos_, max_chunk_len_);
+
+  // Compress past the longest possible chunk header, it is moved in front of
+  // the compressed data once its length is known. LZ4 gives up (returns 0)
+  // when the chunk does not fit.
+  char* compressed = output + 2 * kMaxVarint32Length;
+  const int compressed_capacity =
+      static_cast<int>(max_output_len_ - 2 * kMaxVarint32Length);
+  int compressed_len;
+  if (dict_stream_ != nullptr) {
+    memcpy(stream_, dict_stream_, sizeof(LZ4_stream_t));
+    compressed_len = LZ4_compress_fast_continue(
+        stream_, chunk, compressed, static_cast<int>(chunk_len),
+        compressed_capacity, 1 /* acceleration */);
+  } else {
+    compressed_len =
+        LZ4_compress_fast(chunk, compressed, static_cast<int>(chunk_len),
+                          compressed_capacity, 1 /* acceleration */);
+  }
+
+  char* header_end;
+  if (compressed_len > 0 &&
+      static_cast<size_t>(compressed_len) + VarintLength(chunk_len) <
+          chunk_len) {
+    header_end = EncodeVarint32(output, static_cast<uint32_t>(compressed_len)
+                                            << 1);
+    header_end = EncodeVarint32(header_end, static_cast<uint32_t>(chunk_len));
+    memmove(header_end, compressed, compressed_len);
+    *output_pos = static_cast<size_t>(header_end - output) + compressed_len;
+  } else {
+    // Incompressible
+    header_end =
+        EncodeVarint32(output, static_cast<uint32_t>(chunk_len) << 1 | 1);
+    memcpy(header_end, chunk, chunk_len);
+    *output_pos = static_cast<size_t>(header_end - output) + chunk_len;
+  }
+  assert(*output_pos <= max_output_len_);
+
+  input_pos_ += chunk_len;
+  const size_t remaining = input_size - input_pos_;
+  if (remaining == 0) {
+    Reset();
+  }
+  return static_cast<int>(remaining);
+#endif
+}
+
+void LZ4StreamingCompress::Reset() {
+  input_ = nullptr;
+  input_pos_ = 0;
+}
+
+int LZ4StreamingUncompress::Uncompress(const char* input, size_t input_size,
+                                       char* output, size_t* output_pos) {
+  assert(output != nullptr && output_pos != nullptr);
+  *output_pos = 0;
+  // Don't need to uncompress an empty input
+  if (input_size == 0) {
+    return 0;
+  }
+#ifdef LZ4_STREAMING
+  if (input) {
+    // New input, drop the chunks consumed so far
+    pending_.erase(0, pending_pos_);
+    pending_pos_ = 0;
+    pending_.append(input, input_size);
+  }
+  const char* start = pending_.data() + pending_pos_;
+  const char* limit = pending_.data() + pending_.size();
+  uint32_t tag = 0;
+  const char* p = GetVarint32Ptr(start, limit, &tag);
+  if (p == nullptr) {
+    // No (complete) chunk header yet
+    return 0;
+  }
+  const bool raw = (tag & 1) != 0;
+  const size_t stored_len = tag >> 1;
+  uint32_t chunk_len = static_cast<uint32_t>(stored_len);
+  if (!raw) {
+    p = GetVarint32Ptr(p, limit, &chunk_len);
+    if (p == nullptr) {
+      return 0;
+    }
+  }
+  if (chunk_len > max_output_len_) {
+    Reset();
+    return -1;
+  }
+  if (static_cast<size_t>(limit - p) < stored_len) {
+    // Wait for the rest of the chunk
+    return 0;
+  }
+  if (raw) {
+    memcpy(output, p, stored_len);
+  } else {
+    int uncompressed_len;
+    if (dict_.empty()) {
+      uncompressed_len =
+          LZ4_decompress_safe(p, output, static_cast<int>(stored_len),
+                              static_cast<int>(chunk_len));
+    } else {
+      uncompressed_len = LZ4_decompress_safe_usingDict(
+          p, output, static_cast<int>(stored_len), static_cast<int>(chunk_len),
+          dict_.data(), static_cast<int>(dict_.size()));
+    }
+    if (uncompressed_len != static_cast<int>(chunk_len)) {
+      Reset();
+      return -1;
+    }
+  }
+  *output_pos = chunk_len;
+  pending_pos_ = static_cast<size_t>(p - pending_.data()) + stored_len;
+  return static_cast<int>(pending_.size() - pending_pos_);
+#else
+  (void)input;
+  (void)output;
+  return -1;
+#endif
+}
+
+void LZ4StreamingUncompress::Reset() {
+  pending_.clear();
+  pending_pos_ = 0;
+}
+
 }  // namespace ROCKSDB_NAMESPACE
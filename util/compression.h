@@ -44,6 +44,11 @@
 #if defined(LZ4)
 #include <lz4.h>
 #include <lz4hc.h>
+// LZ4_compress_fast_continue() and LZ4_decompress_safe_usingDict() are used by
+// the streaming (WAL) compression and require r129+.
+#if LZ4_VERSION_NUMBER >= 10700
+#define LZ4_STREAMING
+#endif  // LZ4_VERSION_NUMBER >= 10700
 #endif
 
 #if defined(ZSTD)
@@ -536,6 +541,14 @@ inline bool LZ4_Supported() {
 #endif
 }
 
+inline bool LZ4_Streaming_Supported() {
+#ifdef LZ4_STREAMING
+  return true;
+#else
+  return false;
+#endif
+}
+
 inline bool XPRESS_Supported() {
 #ifdef XPRESS
   return true;
@@ -576,6 +589,8 @@ inline bool StreamingCompressionTypeSupported(
       return true;
     case kZSTD:
       return ZSTD_Streaming_Supported();
+    case kLZ4Compression:
+      return LZ4_Streaming_Supported();
     default:
       return false;
   }
@@ -1694,17 +1709,25 @@ inline CacheAllocationPtr UncompressData(
   }
 }
 
-// Records the compression type for subsequent WAL records.
+// Records the compression type for subsequent WAL records, along with the
+// dictionary the records are compressed with, if any. The dictionary follows
+// the type. A record with a dictionary is written with its own WAL record type
+// (see log::kSetCompressionDictType), so that readers that don't know about
+// dictionaries reject it instead of misinterpreting the WAL.
 class CompressionTypeRecord {
  public:
-  explicit CompressionTypeRecord(CompressionType compression_type)
-      : compression_type_(compression_type) {}
+  explicit CompressionTypeRecord(CompressionType compression_type,
+                                 const Slice& compression_dict = Slice())
+      : compression_type_(compression_type),
+        compression_dict_(compression_dict.ToString()) {}
 
   CompressionType GetCompressionType() const { return compression_type_; }
+  const std::string& GetCompressionDict() const { return compression_dict_; }
 
   inline void EncodeTo(std::string* dst) const {
     assert(dst != nullptr);
     PutFixed32(dst, compression_type_);
+    dst->append(compression_dict_);
   }
 
   inline Status DecodeFrom(Slice* src) {
@@ -1716,20 +1739,26 @@ class CompressionTypeRecord {
                                 "Error decoding WAL compression type");
     }
     CompressionType compression_type = static_cast<CompressionType>(val);
-    if (!StreamingCompressionTypeSupported(compression_type)) {
+    if (static_cast<uint32_t>(compression_type) != val ||
+        !StreamingCompressionTypeSupported(compression_type)) {
       return Status::Corruption(class_name,
                                 "WAL compression type not supported");
     }
     compression_type_ = compression_type;
+    compression_dict_.assign(src->data(), src->size());
+    src->remove_prefix(src->size());
     return Status::OK();
   }
 
   inline std::string DebugString() const {
-    return "compression_type: " + CompressionTypeToString(compression_type_);
+    return "compression_type: " + CompressionTypeToString(compression_type_) +
+           " compression_dict_size: " +
+           std::to_string(compression_dict_.size());
   }
 
  private:
   CompressionType compression_type_;
+  std::string compression_dict_;
 };
 
 // Base class to implement compression for a stream of buffers.
@@ -1762,10 +1791,14 @@ class StreamingCompress {
                        size_t* output_pos) = 0;
   // static method to create object of a class inherited from StreamingCompress
   // based on the actual compression type.
+  // compression_dict - optional dictionary (raw content) every compressed
+  // frame is primed with, the same dictionary must be passed to
+  // StreamingUncompress::Create()
   static StreamingCompress* Create(CompressionType compression_type,
                                    const CompressionOptions& opts,
                                    uint32_t compress_format_version,
-                                   size_t max_output_len);
+                                   size_t max_output_len,
+                                   const Slice& compression_dict = Slice());
   virtual void Reset() = 0;
 
  protected:
@@ -1805,7 +1838,8 @@ class StreamingUncompress {
                          size_t* output_pos) = 0;
   static StreamingUncompress* Create(CompressionType compression_type,
                                      uint32_t compress_format_version,
-                                     size_t max_output_len);
+                                     size_t max_output_len,
+                                     const Slice& compression_dict = Slice());
   virtual void Reset() = 0;
 
  protected:
@@ -1818,7 +1852,8 @@ class ZSTDStreamingCompress final : public StreamingCompress {
  public:
   explicit ZSTDStreamingCompress(const CompressionOptions& opts,
                                  uint32_t compress_format_version,
-                                 size_t max_output_len)
+                                 size_t max_output_len,
+                                 const Slice& compression_dict = Slice())
       : StreamingCompress(kZSTD, opts, compress_format_version,
                           max_output_len) {
 #ifdef ZSTD_ADVANCED
@@ -1826,7 +1861,14 @@ class ZSTDStreamingCompress final : public StreamingCompress {
     // Each compressed frame will have a checksum
     ZSTD_CCtx_setParameter(cctx_, ZSTD_c_checksumFlag, 1);
     assert(cctx_ != nullptr);
+    // The dictionary is digested once and sticks across Reset()
+    if (!compression_dict.empty()) {
+      ZSTD_CCtx_loadDictionary(cctx_, compression_dict.data(),
+                               compression_dict.size());
+    }
     input_buffer_ = {/*src=*/nullptr, /*size=*/0, /*pos=*/0};
+#else
+    (void)compression_dict;
 #endif
   }
   ~ZSTDStreamingCompress() override {
@@ -1846,12 +1888,19 @@ class ZSTDStreamingCompress final : public StreamingCompress {
 class ZSTDStreamingUncompress final : public StreamingUncompress {
  public:
   explicit ZSTDStreamingUncompress(uint32_t compress_format_version,
-                                   size_t max_output_len)
+                                   size_t max_output_len,
+                                   const Slice& compression_dict = Slice())
       : StreamingUncompress(kZSTD, compress_format_version, max_output_len) {
 #ifdef ZSTD_ADVANCED
     dctx_ = ZSTD_createDCtx();
     assert(dctx_ != nullptr);
+    if (!compression_dict.empty()) {
+      ZSTD_DCtx_loadDictionary(dctx_, compression_dict.data(),
+                               compression_dict.size());
+    }
     input_buffer_ = {/*src=*/nullptr, /*size=*/0, /*pos=*/0};
+#else
+    (void)compression_dict;
 #endif
   }
   ~ZSTDStreamingUncompress() override {
@@ -1870,4 +1919,54 @@ class ZSTDStreamingUncompress final : public StreamingUncompress {
 #endif
 };
 
+// Compresses every input in independent LZ4 blocks (chunks) that fit in
+// max_output_len, so no state is carried from one input to the next. Each
+// chunk is prefixed by varint32(stored_size << 1 | is_raw) followed, for
+// compressed chunks, by varint32(uncompressed_size). Chunks that don't shrink
+// are stored raw.
+class LZ4StreamingCompress final : public StreamingCompress {
+ public:
+  explicit LZ4StreamingCompress(const CompressionOptions& opts,
+                                uint32_t compress_format_version,
+                                size_t max_output_len,
+                                const Slice& compression_dict = Slice());
+  ~LZ4StreamingCompress() override;
+  int Compress(const char* input, size_t input_size, char* output,
+               size_t* output_pos) override;
+  void Reset() override;
+
+ private:
+  std::string dict_;
+  // Largest chunk of input that fits in max_output_len_ when stored raw
+  size_t max_chunk_len_;
+  const char* input_ = nullptr;
+  size_t input_pos_ = 0;
+#ifdef LZ4_STREAMING
+  // The stream with the dictionary loaded, copied over stream_ before every
+  // chunk so the dictionary is hashed only once
+  LZ4_stream_t* dict_stream_ = nullptr;
+  LZ4_stream_t* stream_ = nullptr;
+#endif
+};
+
+class LZ4StreamingUncompress final : public StreamingUncompress {
+ public:
+  explicit LZ4StreamingUncompress(uint32_t compress_format_version,
+                                  size_t max_output_len,
+                                  const Slice& compression_dict = Slice())
+      : StreamingUncompress(kLZ4Compression, compress_format_version,
+                            max_output_len),
+        dict_(compression_dict.ToString()) {}
+  // Uncompresses one chunk per call. A chunk may span several inputs, its
+  // head is kept until the rest of it arrives.
+  int Uncompress(const char* input, size_t input_size, char* output,
+                 size_t* output_pos) override;
+  void Reset() override;
+
+ private:
+  std::string dict_;
+  std::string pending_;
+  size_t pending_pos_ = 0;
+};
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <memory>
@@ -50,6 +51,9 @@ class Logger;
 // For 1% FP rate, that means that the latency of a look-up triggered by an FP
 // should be less than roughly 100x the cost of a Bloom filter op.
 //
+// All the probes of a key are within a single cache line, so a look-up or an
+// insertion costs at most one cache miss (see the speed hacks below).
+//
 // For simplicity and performance, the current implementation requires
 // num_probes to be a multiple of two and <= 10.
 //
@@ -82,6 +86,11 @@ class DynamicBloom {
   // Like AddHash, but may be called concurrent with other functions.
   void AddHashConcurrently(uint32_t hash);
 
+  // Like AddHashConcurrently for a batch of hashes. The cache lines of a
+  // group of hashes are prefetched before any of them is set, so that their
+  // cache misses overlap.
+  void AddHashesConcurrently(const uint32_t* hashes, size_t num_hashes);
+
   // Multithreaded access to this function is OK
   bool MayContain(const Slice& key) const;
 
@@ -107,7 +116,21 @@ class DynamicBloom {
   template <typename OrFunc>
   void AddHash(uint32_t hash, const OrFunc& or_func);
 
+  template <typename OrFunc>
+  void DoubleSet(uint32_t h32, size_t a, const OrFunc& or_func);
+
   bool DoubleProbe(uint32_t h32, size_t a) const;
+
+  static void OrConcurrently(std::atomic<uint64_t>* ptr, uint64_t mask) {
+    // Happens-before between AddHash and MaybeContains is handled by
+    // access to versions_->LastSequence(), so all we have to do here is
+    // avoid races (so we don't give the compiler a license to mess up
+    // our code) and not lose bits.  std::memory_order_relaxed is enough
+    // for that.
+    if ((mask & ptr->load(std::memory_order_relaxed)) != mask) {
+      ptr->fetch_or(mask, std::memory_order_relaxed);
+    }
+  }
 };
 
 inline void DynamicBloom::Add(const Slice& key) { AddHash(BloomHash(key)); }
@@ -124,16 +147,23 @@ inline void DynamicBloom::AddHash(uint32_t hash) {
 }
 
 inline void DynamicBloom::AddHashConcurrently(uint32_t hash) {
-  AddHash(hash, [](std::atomic<uint64_t>* ptr, uint64_t mask) {
-    // Happens-before between AddHash and MaybeContains is handled by
-    // access to versions_->LastSequence(), so all we have to do here is
-    // avoid races (so we don't give the compiler a license to mess up
-    // our code) and not lose bits.  std::memory_order_relaxed is enough
-    // for that.
-    if ((mask & ptr->load(std::memory_order_relaxed)) != mask) {
-      ptr->fetch_or(mask, std::memory_order_relaxed);
+  AddHash(hash, &OrConcurrently);
+}
+
+inline void DynamicBloom::AddHashesConcurrently(const uint32_t* hashes,
+                                                size_t num_hashes) {
+  constexpr size_t kGroupSize = MultiGetContext::MAX_BATCH_SIZE;
+  std::array<size_t, kGroupSize> word_offsets;
+  for (size_t start = 0; start < num_hashes; start += kGroupSize) {
+    size_t group_size = std::min(kGroupSize, num_hashes - start);
+    for (size_t i = 0; i < group_size; ++i) {
+      word_offsets[i] = FastRange32(hashes[start + i], kLen);
+      PREFETCH(data_ + word_offsets[i], 1, 3);
     }
-  });
+    for (size_t i = 0; i < group_size; ++i) {
+      DoubleSet(hashes[start + i], word_offsets[i], &OrConcurrently);
+    }
+  }
 }
 
 inline bool DynamicBloom::MayContain(const Slice& key) const {
@@ -184,7 +214,9 @@ inline void DynamicBloom::Prefetch(uint32_t h32) {
 // The FP rate penalty for this implementation, vs. standard Bloom filter, is
 // roughly 1.12x on top of the 1.15x penalty for a 512-bit cache-local Bloom.
 // This implementation does not explicitly use the cache line size, but is
-// effectively cache-local (up to 16 probes) because of the bit-xor offsetting.
+// effectively cache-local (up to 16 probes) because of the bit-xor offsetting:
+// the probed words of a key are within a block of at most 64 bytes, aligned
+// on its size.
 //
 // NB: could easily be upgraded to support a 64-bit hash and
 // total_bits > 2^32 (512MB). (The latter is a bad idea without the former,
@@ -217,6 +249,12 @@ template <typename OrFunc>
 inline void DynamicBloom::AddHash(uint32_t h32, const OrFunc& or_func) {
   size_t a = FastRange32(h32, kLen);
   PREFETCH(data_ + a, 0, 3);
+  DoubleSet(h32, a, or_func);
+}
+
+template <typename OrFunc>
+inline void DynamicBloom::DoubleSet(uint32_t h32, size_t a,
+                                    const OrFunc& or_func) {
   // Expand/remix with 64-bit golden ratio
   uint64_t h = 0x9e3779b97f4a7c13ULL * h32;
   for (unsigned i = 0;; ++i) {
@@ -12,6 +12,7 @@ int main() {
 #else
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cinttypes>
 #include <functional>
@@ -176,6 +177,77 @@ TEST_F(DynamicBloomTest, VaryingLengths) {
   ASSERT_LE(mediocre_filters, good_filters / 25);
 }
 
+TEST_F(DynamicBloomTest, FalsePositiveRate) {
+  KeyMaker km;
+  const uint32_t num_keys = 100000;
+  for (uint32_t num_probes : {4, 6, 8, 10}) {
+    Arena arena;
+    DynamicBloom bloom(&arena, num_keys * 10, num_probes);
+    for (uint64_t i = 0; i < num_keys; i++) {
+      bloom.Add(km.Nonseq(i));
+    }
+
+    int result = 0;
+    for (uint64_t i = 0; i < 30000; i++) {
+      if (bloom.MayContain(km.Nonseq(i + 1000000000))) {
+        result++;
+      }
+    }
+    double rate = result / 30000.0;
+    fprintf(stderr, "False positives (%u probes): %5.2f%%\n", num_probes,
+            rate * 100.0);
+    // About 1% with 10 bits per key
+    ASSERT_LT(rate, 0.02);
+  }
+}
+
+TEST_F(DynamicBloomTest, BatchedConcurrentAdd) {
+  KeyMaker km;
+  constexpr uint32_t num_keys = 100000;
+  constexpr size_t num_threads = 4;
+  Arena arena;
+  DynamicBloom bloom(&arena, num_keys * 10);
+
+  // Every thread adds its keys in batches of varying sizes, some larger than
+  // the prefetched group
+  std::vector<port::Thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&bloom, t]() {
+      KeyMaker thread_km;
+      std::vector<uint32_t> hashes;
+      size_t batch_size = 1;
+      for (uint64_t i = t; i < num_keys; i += num_threads) {
+        hashes.push_back(BloomHash(thread_km.Nonseq(i)));
+        if (hashes.size() == batch_size) {
+          bloom.AddHashesConcurrently(hashes.data(), hashes.size());
+          hashes.clear();
+          batch_size = batch_size % 100 + 1;
+        }
+      }
+      bloom.AddHashesConcurrently(hashes.data(), hashes.size());
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::array<Slice, MultiGetContext::MAX_BATCH_SIZE> keys;
+  std::array<bool, MultiGetContext::MAX_BATCH_SIZE> may_match;
+  std::array<KeyMaker, MultiGetContext::MAX_BATCH_SIZE> key_makers;
+  for (uint64_t i = 0; i < num_keys; i += keys.size()) {
+    int num = static_cast<int>(
+        std::min<uint64_t>(keys.size(), num_keys - i));
+    for (int j = 0; j < num; ++j) {
+      keys[j] = key_makers[j].Nonseq(i + j);
+    }
+    bloom.MayContain(num, keys.data(), may_match.data());
+    for (int j = 0; j < num; ++j) {
+      ASSERT_TRUE(may_match[j]);
+      ASSERT_TRUE(bloom.MayContain(km.Nonseq(i + j)));
+    }
+  }
+}
+
 TEST_F(DynamicBloomTest, perf) {
   KeyMaker km;
   StopWatchNano timer(SystemClock::Default().get());
@@ -201,6 +273,32 @@ TEST_F(DynamicBloomTest, perf) {
     fprintf(stderr, "dynamic bloom, avg add latency %3g\n",
             static_cast<double>(elapsed) / num_keys);
 
+    std::vector<uint32_t> hashes;
+    hashes.reserve(num_keys);
+    for (uint64_t i = 1; i <= num_keys; ++i) {
+      hashes.push_back(BloomHash(km.Nonseq(i)));
+    }
+    DynamicBloom concurrent_bloom(&arena, num_keys * 10, num_probes);
+    timer.Start();
+    for (uint32_t i = 0; i < num_keys; ++i) {
+      concurrent_bloom.AddHashConcurrently(hashes[i]);
+    }
+    elapsed = timer.ElapsedNanos();
+    fprintf(stderr, "dynamic bloom, avg concurrent add latency %3g\n",
+            static_cast<double>(elapsed) / num_keys);
+
+    // Batches of the size of a typical write batch
+    constexpr uint32_t kBatchSize = 16;
+    DynamicBloom batched_bloom(&arena, num_keys * 10, num_probes);
+    timer.Start();
+    for (uint32_t i = 0; i < num_keys; i += kBatchSize) {
+      batched_bloom.AddHashesConcurrently(&hashes[i],
+                                          std::min(kBatchSize, num_keys - i));
+    }
+    elapsed = timer.ElapsedNanos();
+    fprintf(stderr, "dynamic bloom, avg batched concurrent add latency %3g\n",
+            static_cast<double>(elapsed) / num_keys);
+
     uint32_t count = 0;
     timer.Start();
     for (uint64_t i = 1; i <= num_keys; ++i) {
@@ -213,6 +311,28 @@ TEST_F(DynamicBloomTest, perf) {
     assert(count > 0);
     fprintf(stderr, "dynamic bloom, avg query latency %3g\n",
             static_cast<double>(elapsed) / count);
+
+    // The batched probe of MultiGet
+    std::array<Slice, MultiGetContext::MAX_BATCH_SIZE> keys;
+    std::array<bool, MultiGetContext::MAX_BATCH_SIZE> may_match;
+    std::array<KeyMaker, MultiGetContext::MAX_BATCH_SIZE> key_makers;
+    count = 0;
+    timer.Start();
+    for (uint64_t i = 1; i <= num_keys; i += keys.size()) {
+      int num = static_cast<int>(
+          std::min<uint64_t>(keys.size(), num_keys - i + 1));
+      for (int j = 0; j < num; ++j) {
+        keys[j] = key_makers[j].Seq(i + j);
+      }
+      std_bloom.MayContain(num, keys.data(), may_match.data());
+      for (int j = 0; j < num; ++j) {
+        count += may_match[j];
+      }
+    }
+    elapsed = timer.ElapsedNanos();
+    ASSERT_EQ(count, num_keys);
+    fprintf(stderr, "dynamic bloom, avg batched query latency %3g\n",
+            static_cast<double>(elapsed) / count);
   }
 }
 
@@ -11,13 +11,19 @@ int main() {
 }
 #else
 
+#include <cinttypes>
+
+#include "db/log_writer.h"
 #include "file/writable_file_writer.h"
 #include "monitoring/histogram.h"
 #include "rocksdb/env.h"
+#include "rocksdb/file_system.h"
 #include "rocksdb/system_clock.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
+#include "util/compression.h"
 #include "util/gflags_compat.h"
+#include "util/random.h"
 
 using GFLAGS_NAMESPACE::ParseCommandLineFlags;
 using GFLAGS_NAMESPACE::SetUsageMessage;
@@ -29,34 +35,138 @@ DEFINE_int32(record_size, 249, "Size of each record.");
 DEFINE_int32(record_interval, 10000, "Interval between records (microSec)");
 DEFINE_int32(bytes_per_sync, 0, "bytes_per_sync parameter in EnvOptions");
 DEFINE_bool(enable_sync, false, "sync after each write.");
+DEFINE_string(wal_compression, "none",
+              "WAL compression of the records: none, zstd or lz4. When not "
+              "none, the records are written as WAL records (log::Writer).");
+DEFINE_uint64(wal_compression_dict_bytes, 0,
+              "Size of the compression dictionary, sampled from the records "
+              "of a previous log like DBOptions::wal_compression_dict_bytes.");
+DEFINE_double(compression_ratio, 0.5,
+              "Fraction of each record that is compressible.");
 
 namespace ROCKSDB_NAMESPACE {
+namespace {
+CompressionType StringToWalCompressionType(const std::string& name) {
+  if (name == "zstd") {
+    return kZSTD;
+  } else if (name == "lz4") {
+    return kLZ4Compression;
+  } else if (name != "none") {
+    fprintf(stderr, "Unknown WAL compression %s, not compressing\n",
+            name.c_str());
+  }
+  return kNoCompression;
+}
+
+// Generates the records, each with a different (random) content
+class RecordGenerator {
+ public:
+  RecordGenerator() : rnd_(301) {
+    test::CompressibleString(&rnd_, FLAGS_compression_ratio,
+                             FLAGS_record_size * 16, &data_);
+  }
+
+  Slice Next() {
+    const size_t offset = rnd_.Uniform(static_cast<int>(
+        data_.size() - static_cast<size_t>(FLAGS_record_size) + 1));
+    return Slice(data_.data() + offset, FLAGS_record_size);
+  }
+
+ private:
+  Random rnd_;
+  std::string data_;
+};
+
+std::unique_ptr<WritableFileWriter> NewFileWriter(
+    Env* env, const std::string& file_name, const DBOptions& options) {
+  const auto& fs = env->GetFileSystem();
+  FileOptions file_options = fs->OptimizeForLogWrite(FileOptions(), options);
+  file_options.bytes_per_sync = FLAGS_bytes_per_sync;
+  std::unique_ptr<FSWritableFile> file;
+  IOStatus s =
+      fs->NewWritableFile(file_name, file_options, &file, nullptr /* dbg */);
+  if (!s.ok()) {
+    fprintf(stderr, "Cannot create %s: %s\n", file_name.c_str(),
+            s.ToString().c_str());
+    exit(1);
+  }
+  return std::unique_ptr<WritableFileWriter>(new WritableFileWriter(
+      std::move(file), file_name, file_options,
+      env->GetSystemClock().get(), nullptr /* io_tracer */,
+      nullptr /* stats */, options.listeners));
+}
+
+// Writes records to a throwaway log until the writer has sampled the
+// dictionary, as the previous WAL of a DB would
+std::string SampleCompressionDict(Env* env, const DBOptions& options,
+                                  CompressionType compression_type,
+                                  RecordGenerator* generator) {
+  std::string dict;
+  if (FLAGS_wal_compression_dict_bytes == 0) {
+    return dict;
+  }
+  const std::string file_name =
+      test::PerThreadDBPath("log_write_benchmark_dict.log");
+  log::Writer writer(NewFileWriter(env, file_name, options), 0 /* log_number */,
+                     false /* recycle_log_files */, false /* manual_flush */,
+                     compression_type,
+                     static_cast<size_t>(FLAGS_wal_compression_dict_bytes));
+  writer.AddCompressionTypeRecord().PermitUncheckedError();
+  while (!writer.GetCompressionDictSample(&dict)) {
+    writer.AddRecord(generator->Next()).PermitUncheckedError();
+  }
+  writer.Close().PermitUncheckedError();
+  env->DeleteFile(file_name).PermitUncheckedError();
+  return dict;
+}
+}  // anonymous namespace
+
 void RunBenchmark() {
   std::string file_name = test::PerThreadDBPath("log_write_benchmark.log");
   DBOptions options;
   Env* env = Env::Default();
   const auto& clock = env->GetSystemClock();
-  EnvOptions env_options = env->OptimizeForLogWrite(EnvOptions(), options);
-  env_options.bytes_per_sync = FLAGS_bytes_per_sync;
-  std::unique_ptr<WritableFile> file;
-  env->NewWritableFile(file_name, &file, env_options);
-  std::unique_ptr<WritableFileWriter> writer;
-  writer.reset(new WritableFileWriter(std::move(file), file_name, env_options,
-                                      clock, nullptr /* stats */,
-                                      options.listeners));
+  const CompressionType compression_type =
+      StringToWalCompressionType(FLAGS_wal_compression);
+  if (!StreamingCompressionTypeSupported(compression_type)) {
+    fprintf(stderr, "WAL compression %s is not supported\n",
+            FLAGS_wal_compression.c_str());
+    return;
+  }
+  RecordGenerator generator;
 
-  std::string record;
-  record.assign(FLAGS_record_size, 'X');
+  std::unique_ptr<WritableFileWriter> writer;
+  std::unique_ptr<log::Writer> log_writer;
+  if (compression_type == kNoCompression) {
+    writer = NewFileWriter(env, file_name, options);
+  } else {
+    const std::string dict =
+        SampleCompressionDict(env, options, compression_type, &generator);
+    log_writer.reset(new log::Writer(
+        NewFileWriter(env, file_name, options), 0 /* log_number */,
+        false /* recycle_log_files */, false /* manual_flush */,
+        compression_type));
+    log_writer->AddCompressionTypeRecord(dict).PermitUncheckedError();
+  }
 
   HistogramImpl hist;
 
   uint64_t start_time = clock->NowMicros();
   for (int i = 0; i < FLAGS_num_records; i++) {
+    const Slice record = generator.Next();
     uint64_t start_nanos = clock->NowNanos();
-    writer->Append(record);
-    writer->Flush();
-    if (FLAGS_enable_sync) {
-      writer->Sync(false);
+    if (log_writer) {
+      // Flushes the record
+      log_writer->AddRecord(record);
+      if (FLAGS_enable_sync) {
+        log_writer->file()->Sync(false);
+      }
+    } else {
+      writer->Append(record);
+      writer->Flush();
+      if (FLAGS_enable_sync) {
+        writer->Sync(false);
+      }
     }
     hist.Add(clock->NowNanos() - start_nanos);
 
@@ -73,6 +183,11 @@ void RunBenchmark() {
 
   fprintf(stderr, "Distribution of latency of append+flush: \n%s",
           hist.ToString().c_str());
+  const uint64_t file_size = log_writer ? log_writer->file()->GetFileSize()
+                                        : writer->GetFileSize();
+  fprintf(stderr, "Wrote %" PRIu64 " bytes for %" PRIu64 " record bytes\n",
+          file_size,
+          static_cast<uint64_t>(FLAGS_num_records) * FLAGS_record_size);
 }
 }  // namespace ROCKSDB_NAMESPACE
 
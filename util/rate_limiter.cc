@@ -9,6 +9,7 @@
 
 #include <algorithm>
 
+#include "monitoring/histogram.h"
 #include "monitoring/statistics_impl.h"
 #include "port/port.h"
 #include "rocksdb/system_clock.h"
@@ -46,7 +47,7 @@ struct GenericRateLimiter::Req {
 GenericRateLimiter::GenericRateLimiter(
     int64_t rate_bytes_per_sec, int64_t refill_period_us, int32_t fairness,
     RateLimiter::Mode mode, const std::shared_ptr<SystemClock>& clock,
-    bool auto_tuned)
+    bool auto_tuned, const LatencyAwareRateLimiterOptions* latency_options)
     : RateLimiter(mode),
       refill_period_us_(refill_period_us),
       rate_bytes_per_sec_(auto_tuned ? rate_bytes_per_sec / 2
@@ -65,11 +66,30 @@ GenericRateLimiter::GenericRateLimiter(
       auto_tuned_(auto_tuned),
       num_drains_(0),
       max_bytes_per_sec_(rate_bytes_per_sec),
-      tuned_time_(NowMicrosMonotonicLocked()) {
+      tuned_time_(NowMicrosMonotonicLocked()),
+      latency_stats_(nullptr),
+      min_bytes_per_sec_(0) {
   for (int i = Env::IO_LOW; i < Env::IO_TOTAL; ++i) {
     total_requests_[i] = 0;
     total_bytes_through_[i] = 0;
   }
+  if (latency_options != nullptr) {
+    assert(!auto_tuned);
+    latency_options_.reset(
+        new LatencyAwareRateLimiterOptions(*latency_options));
+    if (latency_options_->statistics != nullptr) {
+      latency_stats_ =
+          latency_options_->statistics->CheckedCast<StatisticsImpl>();
+    }
+    min_bytes_per_sec_ =
+        latency_options_->min_bytes_per_sec > 0
+            ? std::min(latency_options_->min_bytes_per_sec, max_bytes_per_sec_)
+            : std::max<int64_t>(max_bytes_per_sec_ / 20, 1);
+    if (latency_stats_ != nullptr) {
+      latency_snapshot_ =
+          latency_stats_->getHistogramImpl(latency_options_->histogram);
+    }
+  }
 }
 
 GenericRateLimiter::~GenericRateLimiter() {
@@ -124,6 +144,12 @@ void GenericRateLimiter::Request(int64_t bytes, const Env::IOPriority pri,
       Status s = TuneLocked();
       s.PermitUncheckedError();  //**TODO: What to do on error?
     }
+  } else if (latency_stats_ != nullptr) {
+    std::chrono::microseconds now(NowMicrosMonotonicLocked());
+    if (now - tuned_time_ >=
+        std::chrono::microseconds(latency_options_->tune_period_us)) {
+      TuneByLatencyLocked();
+    }
   }
 
   if (stop_) {
@@ -359,6 +385,50 @@ Status GenericRateLimiter::TuneLocked() {
   return Status::OK();
 }
 
+void GenericRateLimiter::TuneByLatencyLocked() {
+  // Multiplicative decrease while the foreground latency is above the target,
+  // additive increase once it's back below the release watermark, which keeps
+  // the rate from oscillating around the target.
+  const int kDecreasePct = 25;
+  const int kIncreasePctOfMax = 10;
+  const int kReleaseWatermarkPct = 90;
+
+  tuned_time_ = std::chrono::microseconds(NowMicrosMonotonicLocked());
+
+  std::unique_ptr<HistogramImpl> snapshot =
+      latency_stats_->getHistogramImpl(latency_options_->histogram);
+  HistogramImpl period_latency;
+  period_latency.Merge(*snapshot);
+  period_latency.Subtract(*latency_snapshot_);
+  latency_snapshot_ = std::move(snapshot);
+
+  const bool idle = period_latency.num() < latency_options_->min_samples;
+  const double latency =
+      idle ? 0.0 : period_latency.Percentile(latency_options_->percentile);
+  const double target =
+      static_cast<double>(latency_options_->target_latency_micros);
+
+  int64_t prev_bytes_per_sec = GetBytesPerSecond();
+  int64_t new_bytes_per_sec = prev_bytes_per_sec;
+  if (!idle && latency > target) {
+    // sanitize to prevent overflow
+    int64_t sanitized_prev_bytes_per_sec =
+        std::min(prev_bytes_per_sec, std::numeric_limits<int64_t>::max() / 100);
+    new_bytes_per_sec =
+        std::max(min_bytes_per_sec_,
+                 sanitized_prev_bytes_per_sec * (100 - kDecreasePct) / 100);
+  } else if (latency * 100 < target * kReleaseWatermarkPct) {
+    int64_t increase =
+        std::max<int64_t>(max_bytes_per_sec_ / 100 * kIncreasePctOfMax, 1);
+    new_bytes_per_sec =
+        prev_bytes_per_sec +
+        std::min(increase, max_bytes_per_sec_ - prev_bytes_per_sec);
+  }
+  if (new_bytes_per_sec != prev_bytes_per_sec) {
+    SetBytesPerSecondLocked(new_bytes_per_sec);
+  }
+}
+
 RateLimiter* NewGenericRateLimiter(
     int64_t rate_bytes_per_sec, int64_t refill_period_us /* = 100 * 1000 */,
     int32_t fairness /* = 10 */,
@@ -373,4 +443,198 @@ RateLimiter* NewGenericRateLimiter(
   return limiter.release();
 }
 
+RateLimiter* NewLatencyAwareRateLimiter(
+    int64_t max_bytes_per_sec, const LatencyAwareRateLimiterOptions& options,
+    int64_t refill_period_us /* = 100 * 1000 */, int32_t fairness /* = 10 */,
+    RateLimiter::Mode mode /* = RateLimiter::Mode::kWritesOnly */) {
+  assert(max_bytes_per_sec > 0);
+  assert(refill_period_us > 0);
+  assert(fairness > 0);
+  assert(options.statistics != nullptr);
+  assert(options.target_latency_micros > 0);
+  std::unique_ptr<RateLimiter> limiter(new GenericRateLimiter(
+      max_bytes_per_sec, refill_period_us, fairness, mode,
+      SystemClock::Default(), false /* auto_tuned */, &options));
+  return limiter.release();
+}
+
+namespace {
+// The mode of a rate limiter, from the op types it limits (GetMode() is
+// protected)
+RateLimiter::Mode GetRateLimiterMode(RateLimiter* rate_limiter) {
+  const bool reads = rate_limiter->IsRateLimited(RateLimiter::OpType::kRead);
+  const bool writes = rate_limiter->IsRateLimited(RateLimiter::OpType::kWrite);
+  if (reads && writes) {
+    return RateLimiter::Mode::kAllIo;
+  }
+  return reads ? RateLimiter::Mode::kReadsOnly : RateLimiter::Mode::kWritesOnly;
+}
+}  // namespace
+
+TenantRateLimiter::TenantRateLimiter(std::shared_ptr<RateLimiter> parent,
+                                     const TenantRateLimiterOptions& options,
+                                     const std::shared_ptr<SystemClock>& clock)
+    : RateLimiter(GetRateLimiterMode(parent.get())),
+      parent_(std::move(parent)),
+      priority_weights_(options.priority_weights),
+      borrow_unused_(options.borrow_unused),
+      clock_(clock),
+      total_priority_weight_(0),
+      share_(std::min(std::max(options.share, 0.0), 1.0)),
+      total_bytes_borrowed_(0) {
+  const uint64_t now_us = clock_->NowMicros();
+  for (int i = Env::IO_LOW; i < Env::IO_TOTAL; ++i) {
+    total_priority_weight_ += std::max(priority_weights_[i], 0);
+    available_bytes_[i] = 0;
+    last_refill_us_[i] = now_us;
+    num_pending_[i] = 0;
+    total_requests_[i] = 0;
+    total_bytes_through_[i] = 0;
+  }
+}
+
+void TenantRateLimiter::SetBytesPerSecond(int64_t bytes_per_second) {
+  assert(bytes_per_second > 0);
+  const int64_t parent_bytes_per_sec = parent_->GetBytesPerSecond();
+  MutexLock g(&mutex_);
+  // Accumulate the tokens earned at the old rate first
+  for (int i = Env::IO_LOW; i < Env::IO_TOTAL; ++i) {
+    RefillLocked(static_cast<Env::IOPriority>(i));
+  }
+  share_ = parent_bytes_per_sec > 0
+               ? std::min(static_cast<double>(bytes_per_second) /
+                              static_cast<double>(parent_bytes_per_sec),
+                          1.0)
+               : 1.0;
+}
+
+int64_t TenantRateLimiter::GetBytesPerSecond() const {
+  const int64_t parent_bytes_per_sec = parent_->GetBytesPerSecond();
+  MutexLock g(&mutex_);
+  return static_cast<int64_t>(share_ * parent_bytes_per_sec);
+}
+
+double TenantRateLimiter::ReservedBytesPerSecLocked(Env::IOPriority pri) const {
+  mutex_.AssertHeld();
+  if (total_priority_weight_ <= 0 || priority_weights_[pri] <= 0) {
+    return 0;
+  }
+  return share_ * static_cast<double>(parent_->GetBytesPerSecond()) *
+         priority_weights_[pri] / total_priority_weight_;
+}
+
+void TenantRateLimiter::RefillLocked(Env::IOPriority pri) {
+  mutex_.AssertHeld();
+  const uint64_t now_us = clock_->NowMicros();
+  if (now_us <= last_refill_us_[pri]) {
+    return;
+  }
+  // Unused tokens are kept up to a single burst
+  available_bytes_[pri] = std::min(
+      available_bytes_[pri] + ReservedBytesPerSecLocked(pri) *
+                                  static_cast<double>(now_us -
+                                                      last_refill_us_[pri]) /
+                                  std::micro::den,
+      static_cast<double>(parent_->GetSingleBurstBytes()));
+  last_refill_us_[pri] = now_us;
+}
+
+bool TenantRateLimiter::IsParentIdle() const {
+  int64_t parent_pending_requests = 0;
+  Status s = parent_->GetTotalPendingRequests(&parent_pending_requests);
+  // A parent that does not report its pending requests is considered idle,
+  // i.e. the tenant only reserves a rate when it may tell it is contended
+  return !s.ok() || parent_pending_requests == 0;
+}
+
+void TenantRateLimiter::Request(const int64_t bytes, const Env::IOPriority pri,
+                                Statistics* stats) {
+  if (pri != Env::IO_TOTAL) {
+    MutexLock g(&mutex_);
+    ++total_requests_[pri];
+    ++num_pending_[pri];
+    while (true) {
+      RefillLocked(pri);
+      const double reserved_bytes_per_sec = ReservedBytesPerSecLocked(pri);
+      if (reserved_bytes_per_sec <= 0 ||
+          available_bytes_[pri] >= static_cast<double>(bytes)) {
+        available_bytes_[pri] = std::max(
+            available_bytes_[pri] - static_cast<double>(bytes), 0.0);
+        break;
+      }
+      if (borrow_unused_ && IsParentIdle()) {
+        total_bytes_borrowed_ +=
+            bytes - static_cast<int64_t>(available_bytes_[pri]);
+        available_bytes_[pri] = 0;
+        break;
+      }
+
+      const double missing_bytes =
+          static_cast<double>(bytes) - available_bytes_[pri];
+      uint64_t wait_us = static_cast<uint64_t>(
+          missing_bytes * std::micro::den / reserved_bytes_per_sec + 1);
+      if (borrow_unused_) {
+        wait_us = std::min(wait_us, kMaxWaitUs);
+      }
+      mutex_.Unlock();
+      TEST_SYNC_POINT_CALLBACK("TenantRateLimiter::Request:Wait", &wait_us);
+      clock_->SleepForMicroseconds(static_cast<int>(wait_us));
+      mutex_.Lock();
+    }
+    --num_pending_[pri];
+    total_bytes_through_[pri] += bytes;
+  }
+
+  parent_->Request(bytes, pri, stats);
+}
+
+int64_t TenantRateLimiter::GetTotalBytesThrough(
+    const Env::IOPriority pri) const {
+  MutexLock g(&mutex_);
+  if (pri == Env::IO_TOTAL) {
+    int64_t total_bytes_through_sum = 0;
+    for (int i = Env::IO_LOW; i < Env::IO_TOTAL; ++i) {
+      total_bytes_through_sum += total_bytes_through_[i];
+    }
+    return total_bytes_through_sum;
+  }
+  return total_bytes_through_[pri];
+}
+
+int64_t TenantRateLimiter::GetTotalRequests(const Env::IOPriority pri) const {
+  MutexLock g(&mutex_);
+  if (pri == Env::IO_TOTAL) {
+    int64_t total_requests_sum = 0;
+    for (int i = Env::IO_LOW; i < Env::IO_TOTAL; ++i) {
+      total_requests_sum += total_requests_[i];
+    }
+    return total_requests_sum;
+  }
+  return total_requests_[pri];
+}
+
+Status TenantRateLimiter::GetTotalPendingRequests(
+    int64_t* total_pending_requests, const Env::IOPriority pri) const {
+  assert(total_pending_requests != nullptr);
+  MutexLock g(&mutex_);
+  if (pri == Env::IO_TOTAL) {
+    int64_t total_pending_requests_sum = 0;
+    for (int i = Env::IO_LOW; i < Env::IO_TOTAL; ++i) {
+      total_pending_requests_sum += num_pending_[i];
+    }
+    *total_pending_requests = total_pending_requests_sum;
+  } else {
+    *total_pending_requests = num_pending_[pri];
+  }
+  return Status::OK();
+}
+
+RateLimiter* NewTenantRateLimiter(std::shared_ptr<RateLimiter> parent,
+                                  const TenantRateLimiterOptions& options) {
+  assert(parent != nullptr);
+  assert(options.share > 0 && options.share <= 1);
+  return new TenantRateLimiter(std::move(parent), options,
+                               SystemClock::Default());
+}
+
 }  // namespace ROCKSDB_NAMESPACE
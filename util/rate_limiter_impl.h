@@ -10,6 +10,7 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <deque>
@@ -24,12 +25,17 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class HistogramImpl;
+class StatisticsImpl;
+
 class GenericRateLimiter : public RateLimiter {
  public:
   GenericRateLimiter(int64_t refill_bytes, int64_t refill_period_us,
                      int32_t fairness, RateLimiter::Mode mode,
                      const std::shared_ptr<SystemClock>& clock,
-                     bool auto_tuned);
+                     bool auto_tuned,
+                     const LatencyAwareRateLimiterOptions* latency_options =
+                         nullptr);
 
   virtual ~GenericRateLimiter();
 
@@ -106,6 +112,7 @@ class GenericRateLimiter : public RateLimiter {
   std::vector<Env::IOPriority> GeneratePriorityIterationOrderLocked();
   int64_t CalculateRefillBytesPerPeriodLocked(int64_t rate_bytes_per_sec);
   Status TuneLocked();
+  void TuneByLatencyLocked();
   void SetBytesPerSecondLocked(int64_t bytes_per_second);
 
   uint64_t NowMicrosMonotonicLocked() {
@@ -141,6 +148,77 @@ class GenericRateLimiter : public RateLimiter {
   int64_t num_drains_;
   const int64_t max_bytes_per_sec_;
   std::chrono::microseconds tuned_time_;
+
+  // Set when the rate is tuned by the foreground latency
+  std::unique_ptr<const LatencyAwareRateLimiterOptions> latency_options_;
+  const StatisticsImpl* latency_stats_;
+  int64_t min_bytes_per_sec_;
+  // The latency histogram at the last tuning
+  std::unique_ptr<HistogramImpl> latency_snapshot_;
+};
+
+class TenantRateLimiter : public RateLimiter {
+ public:
+  TenantRateLimiter(std::shared_ptr<RateLimiter> parent,
+                    const TenantRateLimiterOptions& options,
+                    const std::shared_ptr<SystemClock>& clock);
+
+  virtual void SetBytesPerSecond(int64_t bytes_per_second) override;
+
+  using RateLimiter::Request;
+  virtual void Request(const int64_t bytes, const Env::IOPriority pri,
+                       Statistics* stats) override;
+
+  virtual int64_t GetSingleBurstBytes() const override {
+    return parent_->GetSingleBurstBytes();
+  }
+
+  virtual int64_t GetTotalBytesThrough(
+      const Env::IOPriority pri = Env::IO_TOTAL) const override;
+
+  virtual int64_t GetTotalRequests(
+      const Env::IOPriority pri = Env::IO_TOTAL) const override;
+
+  virtual Status GetTotalPendingRequests(
+      int64_t* total_pending_requests,
+      const Env::IOPriority pri = Env::IO_TOTAL) const override;
+
+  virtual int64_t GetBytesPerSecond() const override;
+
+  virtual bool IsRateLimited(OpType op_type) override {
+    return parent_->IsRateLimited(op_type);
+  }
+
+  // Bytes granted beyond the reserved rate thanks to an idle parent
+  int64_t GetTotalBytesBorrowed() const {
+    MutexLock g(&mutex_);
+    return total_bytes_borrowed_;
+  }
+
+ private:
+  // Returns the reserved rate of an activity, 0 if it has none
+  double ReservedBytesPerSecLocked(Env::IOPriority pri) const;
+  void RefillLocked(Env::IOPriority pri);
+  bool IsParentIdle() const;
+
+  // Upper bound of a single wait, so waiting requests notice an idle parent
+  // or a rate change
+  static constexpr uint64_t kMaxWaitUs = 10 * 1000;
+
+  const std::shared_ptr<RateLimiter> parent_;
+  const std::array<int, Env::IO_TOTAL> priority_weights_;
+  const bool borrow_unused_;
+  const std::shared_ptr<SystemClock> clock_;
+  int total_priority_weight_;
+
+  mutable port::Mutex mutex_;
+  double share_;
+  double available_bytes_[Env::IO_TOTAL];
+  uint64_t last_refill_us_[Env::IO_TOTAL];
+  int64_t num_pending_[Env::IO_TOTAL];
+  int64_t total_requests_[Env::IO_TOTAL];
+  int64_t total_bytes_through_[Env::IO_TOTAL];
+  int64_t total_bytes_borrowed_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
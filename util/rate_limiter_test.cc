@@ -511,6 +511,227 @@ TEST_F(RateLimiterTest, AutoTuneIncreaseWhenFull) {
   ASSERT_LT(new_bytes_per_sec, orig_bytes_per_sec);
 }
 
+TEST_F(RateLimiterTest, LatencyAwareTune) {
+  const std::chrono::seconds kTunePeriod(1);
+  const int64_t kMaxBytesPerSec = 1000;
+  const int64_t kMinBytesPerSec = 300;
+
+  SpecialEnv special_env(Env::Default(), /*time_elapse_only_sleep*/ true);
+
+  LatencyAwareRateLimiterOptions latency_options;
+  latency_options.statistics = CreateDBStatistics();
+  // The upper limit of a histogram bucket
+  latency_options.target_latency_micros = 1300;
+  latency_options.min_bytes_per_sec = kMinBytesPerSec;
+  latency_options.tune_period_us =
+      std::chrono::microseconds(kTunePeriod).count();
+  latency_options.min_samples = 100;
+  std::unique_ptr<RateLimiter> rate_limiter(new GenericRateLimiter(
+      kMaxBytesPerSec, 100 * 1000 /* refill_period_us */, 10 /* fairness */,
+      RateLimiter::Mode::kWritesOnly, special_env.GetSystemClock(),
+      false /* auto_tuned */, &latency_options));
+  ASSERT_EQ(kMaxBytesPerSec, rate_limiter->GetBytesPerSecond());
+
+  // Reads of a period are followed by a background write which triggers the
+  // tuning
+  auto run_period = [&](uint64_t read_latency_micros, int num_reads) {
+    for (int i = 0; i < num_reads; ++i) {
+      latency_options.statistics->recordInHistogram(DB_GET,
+                                                    read_latency_micros);
+    }
+    special_env.SleepForMicroseconds(
+        static_cast<int>(latency_options.tune_period_us));
+    rate_limiter->Request(1 /* bytes */, Env::IO_LOW, nullptr /* stats */,
+                          RateLimiter::OpType::kWrite);
+    return rate_limiter->GetBytesPerSecond();
+  };
+
+  // Slow reads throttle the background writes, down to the min rate
+  ASSERT_EQ(750, run_period(5000, 200));
+  ASSERT_EQ(562, run_period(5000, 200));
+  ASSERT_EQ(421, run_period(5000, 200));
+  ASSERT_EQ(315, run_period(5000, 200));
+  ASSERT_EQ(kMinBytesPerSec, run_period(5000, 200));
+
+  // Only the reads of the last period count: a p99 read slightly below the
+  // target holds the rate
+  ASSERT_EQ(kMinBytesPerSec, run_period(1300, 200));
+
+  // Fast reads release the throttle
+  ASSERT_EQ(400, run_period(100, 200));
+  ASSERT_EQ(500, run_period(100, 200));
+  // So does no foreground load, up to the max rate
+  for (int i = 0; i < 10; ++i) {
+    run_period(5000, 10);
+  }
+  ASSERT_EQ(kMaxBytesPerSec, rate_limiter->GetBytesPerSecond());
+}
+
+namespace {
+// Grants every request right away, reporting a configurable number of pending
+// requests so tests control whether tenants may borrow
+class FakeParentRateLimiter : public RateLimiter {
+ public:
+  explicit FakeParentRateLimiter(int64_t bytes_per_second)
+      : bytes_per_second_(bytes_per_second) {}
+
+  void SetBytesPerSecond(int64_t bytes_per_second) override {
+    bytes_per_second_ = bytes_per_second;
+  }
+
+  using RateLimiter::Request;
+  void Request(const int64_t bytes, const Env::IOPriority /*pri*/,
+               Statistics* /*stats*/) override {
+    total_bytes_through_ += bytes;
+  }
+
+  int64_t GetSingleBurstBytes() const override { return 1000; }
+
+  int64_t GetTotalBytesThrough(
+      const Env::IOPriority /*pri*/ = Env::IO_TOTAL) const override {
+    return total_bytes_through_;
+  }
+
+  int64_t GetTotalRequests(
+      const Env::IOPriority /*pri*/ = Env::IO_TOTAL) const override {
+    return 0;
+  }
+
+  Status GetTotalPendingRequests(
+      int64_t* total_pending_requests,
+      const Env::IOPriority /*pri*/ = Env::IO_TOTAL) const override {
+    *total_pending_requests = pending_requests_;
+    return Status::OK();
+  }
+
+  int64_t GetBytesPerSecond() const override { return bytes_per_second_; }
+
+  int64_t pending_requests_ = 1;
+
+ private:
+  int64_t bytes_per_second_;
+  int64_t total_bytes_through_ = 0;
+};
+
+class ModeExposingTenantRateLimiter : public TenantRateLimiter {
+ public:
+  using TenantRateLimiter::TenantRateLimiter;
+  using TenantRateLimiter::GetMode;
+};
+}  // anonymous namespace
+
+TEST_F(RateLimiterTest, TenantReservedRate) {
+  SpecialEnv special_env(Env::Default(), /*time_elapse_only_sleep*/ true);
+  auto parent = std::make_shared<FakeParentRateLimiter>(1000);
+
+  TenantRateLimiterOptions options;
+  options.share = 0.5;
+  options.priority_weights = {{1 /* IO_LOW */, 0 /* IO_MID */,
+                               0 /* IO_HIGH */, 3 /* IO_USER */}};
+  options.borrow_unused = false;
+  TenantRateLimiter limiter(parent, options, special_env.GetSystemClock());
+  ASSERT_EQ(500, limiter.GetBytesPerSecond());
+
+  // Compactions get a quarter of the tenant's 500 bytes/sec and user I/O
+  // three quarters, so both move their bytes in the same time
+  uint64_t start_us = special_env.NowMicros();
+  for (int i = 0; i < 10; ++i) {
+    limiter.Request(125, Env::IO_LOW, nullptr /* stats */,
+                    RateLimiter::OpType::kWrite);
+    limiter.Request(375, Env::IO_USER, nullptr /* stats */,
+                    RateLimiter::OpType::kWrite);
+  }
+  const uint64_t elapsed_us = special_env.NowMicros() - start_us;
+  ASSERT_GE(elapsed_us, 9 * 1000 * 1000);
+  ASSERT_LE(elapsed_us, 11 * 1000 * 1000);
+
+  // Activities without a weight are only limited by the parent
+  start_us = special_env.NowMicros();
+  limiter.Request(1000, Env::IO_HIGH, nullptr /* stats */,
+                  RateLimiter::OpType::kWrite);
+  ASSERT_EQ(start_us, special_env.NowMicros());
+
+  ASSERT_EQ(1250, limiter.GetTotalBytesThrough(Env::IO_LOW));
+  ASSERT_EQ(3750, limiter.GetTotalBytesThrough(Env::IO_USER));
+  ASSERT_EQ(6000, limiter.GetTotalBytesThrough());
+  ASSERT_EQ(21, limiter.GetTotalRequests());
+  ASSERT_EQ(6000, parent->GetTotalBytesThrough());
+  ASSERT_EQ(0, limiter.GetTotalBytesBorrowed());
+
+  // Changing the rate of the tenant changes its share of the parent
+  limiter.SetBytesPerSecond(250);
+  ASSERT_EQ(250, limiter.GetBytesPerSecond());
+}
+
+TEST_F(RateLimiterTest, TenantBorrowsUnusedRate) {
+  SpecialEnv special_env(Env::Default(), /*time_elapse_only_sleep*/ true);
+  auto parent = std::make_shared<FakeParentRateLimiter>(1000);
+
+  TenantRateLimiterOptions options;
+  options.share = 0.1;
+  TenantRateLimiter limiter(parent, options, special_env.GetSystemClock());
+
+  // An idle parent lends its capacity
+  parent->pending_requests_ = 0;
+  uint64_t start_us = special_env.NowMicros();
+  for (int i = 0; i < 10; ++i) {
+    limiter.Request(1000, Env::IO_LOW, nullptr /* stats */,
+                    RateLimiter::OpType::kWrite);
+  }
+  ASSERT_EQ(start_us, special_env.NowMicros());
+  ASSERT_EQ(10000, limiter.GetTotalBytesBorrowed());
+
+  // Once contended, the tenant is back to its reserved 25 bytes/sec per
+  // activity
+  parent->pending_requests_ = 1;
+  start_us = special_env.NowMicros();
+  limiter.Request(100, Env::IO_LOW, nullptr /* stats */,
+                  RateLimiter::OpType::kWrite);
+  const uint64_t elapsed_us = special_env.NowMicros() - start_us;
+  ASSERT_GE(elapsed_us, 3900 * 1000);
+  ASSERT_LE(elapsed_us, 4100 * 1000);
+  ASSERT_EQ(10000, limiter.GetTotalBytesBorrowed());
+}
+
+TEST_F(RateLimiterTest, TenantHierarchy) {
+  std::shared_ptr<RateLimiter> parent(NewGenericRateLimiter(
+      1000 * 1000 /* rate_bytes_per_sec */, 100 * 1000 /* refill_period_us */,
+      10 /* fairness */, RateLimiter::Mode::kAllIo));
+
+  TenantRateLimiterOptions options;
+  options.share = 0.5;
+  std::shared_ptr<RateLimiter> tenant(NewTenantRateLimiter(parent, options));
+  std::unique_ptr<RateLimiter> sub_tenant(NewTenantRateLimiter(tenant, options));
+
+  ASSERT_EQ(500 * 1000, tenant->GetBytesPerSecond());
+  ASSERT_EQ(250 * 1000, sub_tenant->GetBytesPerSecond());
+  ASSERT_EQ(parent->GetSingleBurstBytes(), sub_tenant->GetSingleBurstBytes());
+  ASSERT_TRUE(sub_tenant->IsRateLimited(RateLimiter::OpType::kRead));
+
+  sub_tenant->Request(100, Env::IO_USER, nullptr /* stats */,
+                      RateLimiter::OpType::kRead);
+  ASSERT_EQ(100, sub_tenant->GetTotalBytesThrough());
+  ASSERT_EQ(100, tenant->GetTotalBytesThrough());
+  ASSERT_EQ(100, parent->GetTotalBytesThrough());
+}
+
+TEST_F(RateLimiterTest, TenantUsesParentMode) {
+  for (auto mode :
+       {RateLimiter::Mode::kReadsOnly, RateLimiter::Mode::kWritesOnly,
+        RateLimiter::Mode::kAllIo}) {
+    std::shared_ptr<RateLimiter> parent(NewGenericRateLimiter(
+        1000 * 1000 /* rate_bytes_per_sec */,
+        100 * 1000 /* refill_period_us */, 10 /* fairness */, mode));
+    ModeExposingTenantRateLimiter tenant(parent, TenantRateLimiterOptions(),
+                                         SystemClock::Default());
+    ASSERT_EQ(mode, tenant.GetMode());
+    ASSERT_EQ(mode != RateLimiter::Mode::kWritesOnly,
+              tenant.IsRateLimited(RateLimiter::OpType::kRead));
+    ASSERT_EQ(mode != RateLimiter::Mode::kReadsOnly,
+              tenant.IsRateLimited(RateLimiter::OpType::kWrite));
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
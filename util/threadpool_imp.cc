@@ -28,6 +28,8 @@
 #endif
 
 #ifdef OS_LINUX
+#include <pthread.h>
+#include <sched.h>
 #include <sys/resource.h>
 #include <sys/syscall.h>
 #endif
@@ -57,6 +59,26 @@ void ThreadPoolImpl::PthreadCall(const char* label, int result) {
   }
 }
 
+#ifdef OS_LINUX
+namespace {
+// The CPUs the process may run on, as they were when the first thread pool
+// was created. Pool threads are only ever restricted to a subset of them.
+const cpu_set_t& ProcessCpuSet() {
+  static const cpu_set_t process_cpu_set = []() {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+      for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        CPU_SET(cpu, &cpu_set);
+      }
+    }
+    return cpu_set;
+  }();
+  return process_cpu_set;
+}
+}  // namespace
+#endif
+
 struct ThreadPoolImpl::Impl {
   Impl();
   ~Impl();
@@ -74,6 +96,8 @@ struct ThreadPoolImpl::Impl {
 
   void LowerCPUPriority(CpuPriority pri);
 
+  Status SetCpuAffinity(const std::vector<int>& cpus);
+
   void WakeUpAllThreads() { bgsignal_.notify_all(); }
 
   void BGThread(size_t thread_id);
@@ -140,6 +164,11 @@ struct ThreadPoolImpl::Impl {
 
   bool low_io_priority_;
   CpuPriority cpu_priority_;
+#ifdef OS_LINUX
+  // CPUs the threads are restricted to, the CPUs of the process by default.
+  // Applied to every thread when it is started.
+  cpu_set_t cpu_affinity_;
+#endif
   Env::Priority priority_;
   Env* env_;
 
@@ -187,7 +216,11 @@ inline ThreadPoolImpl::Impl::Impl()
       queue_(),
       mu_(),
       bgsignal_(),
-      bgthreads_() {}
+      bgthreads_() {
+#ifdef OS_LINUX
+  cpu_affinity_ = ProcessCpuSet();
+#endif
+}
 
 inline ThreadPoolImpl::Impl::~Impl() { assert(bgthreads_.size() == 0U); }
 
@@ -227,6 +260,40 @@ inline void ThreadPoolImpl::Impl::LowerCPUPriority(CpuPriority pri) {
   cpu_priority_ = pri;
 }
 
+inline Status ThreadPoolImpl::Impl::SetCpuAffinity(
+    const std::vector<int>& cpus) {
+#ifdef OS_LINUX
+  const cpu_set_t& process_cpu_set = ProcessCpuSet();
+  cpu_set_t cpu_set;
+  if (cpus.empty()) {
+    cpu_set = process_cpu_set;
+  } else {
+    CPU_ZERO(&cpu_set);
+    for (int cpu : cpus) {
+      if (cpu < 0 || cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &process_cpu_set)) {
+        return Status::InvalidArgument("CPU " + std::to_string(cpu) +
+                                       " is not available to the process");
+      }
+      CPU_SET(cpu, &cpu_set);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mu_);
+  cpu_affinity_ = cpu_set;
+  for (auto& th : bgthreads_) {
+    int result = pthread_setaffinity_np(th.native_handle(),
+                                        sizeof(cpu_affinity_), &cpu_affinity_);
+    if (result != 0) {
+      return Status::IOError("pthread_setaffinity_np", errnoStr(result).c_str());
+    }
+  }
+  return Status::OK();
+#else
+  (void)cpus;
+  return Status::NotSupported("CPU affinity is only supported on Linux");
+#endif
+}
+
 void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
   bool low_io_priority = false;
   CpuPriority current_cpu_priority = CpuPriority::kNormal;
@@ -408,6 +475,12 @@ void ThreadPoolImpl::Impl::StartBGThreads() {
     }
     pthread_setname_np(th_handle, thread_name_stream.str().c_str());
 #endif
+#endif
+#ifdef OS_LINUX
+    // A new thread inherits the CPUs of the thread scheduling the job, which
+    // may belong to another pool. The pool keeps working if this fails.
+    pthread_setaffinity_np(p_t.native_handle(), sizeof(cpu_affinity_),
+                           &cpu_affinity_);
 #endif
     bgthreads_.push_back(std::move(p_t));
   }
@@ -505,6 +578,10 @@ void ThreadPoolImpl::LowerCPUPriority(CpuPriority pri) {
   impl_->LowerCPUPriority(pri);
 }
 
+Status ThreadPoolImpl::SetCpuAffinity(const std::vector<int>& cpus) {
+  return impl_->SetCpuAffinity(cpus);
+}
+
 void ThreadPoolImpl::IncBackgroundThreadsIfNeeded(int num) {
   impl_->SetBackgroundThreadsInternal(num, false);
 }
@@ -53,6 +53,11 @@ class ThreadPoolImpl : public ThreadPool {
   // Currently only has effect on Linux
   void LowerCPUPriority(CpuPriority pri);
 
+  // Restrict threads to the given CPUs, or to the CPUs of the process if
+  // empty. Returns InvalidArgument for a CPU the process may not run on.
+  // Currently only supported on Linux
+  Status SetCpuAffinity(const std::vector<int>& cpus);
+
   // Ensure there is at aleast num threads in the pool
   // but do not kill threads if there are more
   void IncBackgroundThreadsIfNeeded(int num);